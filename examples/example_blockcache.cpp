@@ -0,0 +1,146 @@
+//========================================================================
+//
+// This file is part of the leanux toolkit.
+//
+// Copyright (C) 2015-2016 Jan-Marten Spit http://www.o-rho.com/leanux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, distribute with modifications, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE ABOVE COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Except as contained in this notice, the name(s) of the above copyright
+// holders shall not be used in advertising or otherwise to promote the
+// sale, use or other dealings in this Software without prior written
+// authorization.
+//========================================================================
+
+/**
+ * Stress test for the block::MajorMinor cache. Reader threads hammer the name and devicefile
+ * lookups while a writer thread adds and removes devices in a fake diskstats file. Every lookup
+ * must either resolve to the (fixed) mapping of the fake device, or not resolve at all.
+ */
+
+#include "block.hpp"
+#include "oops.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+using namespace leanux;
+
+const unsigned int fake_major = 240;
+const unsigned int fake_devices = 64;
+const unsigned int readers = 8;
+const unsigned int rounds = 200;
+
+std::atomic<bool> done( false );
+std::atomic<unsigned long> lookups( 0 );
+std::atomic<unsigned long> errors( 0 );
+
+string fakeName( unsigned int minor ) {
+  stringstream ss;
+  ss << "fake" << minor;
+  return ss.str();
+}
+
+/**
+ * Write the fake diskstats, odd rounds drop the odd minors.
+ */
+void writeDiskStats( const string &path, unsigned int round ) {
+  string tmp = path + ".tmp";
+  ofstream o( tmp.c_str() );
+  for ( unsigned int m = 0; m < fake_devices; m++ ) {
+    if ( round % 2 == 1 && m % 2 == 1 ) continue;
+    o << fake_major << " " << m << " " << fakeName( m ) << " 0 0 0 0 0 0 0 0 0 0 0" << endl;
+  }
+  o.close();
+  if ( rename( tmp.c_str(), path.c_str() ) ) throw Oops( __FILE__, __LINE__, errno );
+}
+
+void reader( unsigned int seed ) {
+  while ( !done ) {
+    unsigned int m = rand_r( &seed ) % fake_devices;
+    block::MajorMinor mm( fake_major, m );
+    string name = block::MajorMinor::getNameByMajorMinor( mm );
+    if ( name != "" && name != fakeName( m ) ) errors++;
+    block::MajorMinor found = block::MajorMinor::getMajorMinorByName( fakeName( m ) );
+    if ( found != block::MajorMinor::invalid && found != mm ) errors++;
+    string file = block::MajorMinor::getDeviceFileByMajorMinor( mm );
+    if ( file != "" && file != "/dev/" + fakeName( m ) ) errors++;
+    if ( block::MajorMinor::getMajorMinorByName( "nosuchdevice" ) != block::MajorMinor::invalid ) errors++;
+    lookups += 4;
+  }
+}
+
+int main() {
+  try {
+    char dir[] = "/tmp/example-blockcache-XXXXXX";
+    if ( !mkdtemp( dir ) ) throw Oops( __FILE__, __LINE__, errno );
+    string path = string( dir ) + "/diskstats";
+    writeDiskStats( path, 0 );
+    block::diskstats_path = path;
+
+    vector<thread> threads;
+    for ( unsigned int r = 0; r < readers; r++ ) threads.push_back( thread( reader, r ) );
+    unsigned long generation = block::MajorMinor::getGeneration();
+    for ( unsigned int round = 1; round <= rounds; round++ ) {
+      writeDiskStats( path, round );
+      block::MajorMinor::refreshCache();
+      usleep( 1000 );
+    }
+    done = true;
+    for ( unsigned int r = 0; r < readers; r++ ) threads[r].join();
+
+    if ( block::MajorMinor::getGeneration() != generation + rounds ) {
+      cerr << "expected generation " << generation + rounds << ", got " << block::MajorMinor::getGeneration() << endl;
+      errors++;
+    }
+    // the final round (even) has all devices
+    for ( unsigned int m = 0; m < fake_devices; m++ ) {
+      if ( block::MajorMinor::getNameByMajorMinor( block::MajorMinor( fake_major, m ) ) != fakeName( m ) ) errors++;
+    }
+    // a device that appears while the /dev watch stays silent resolves after a miss once a rebuild is due
+    {
+      ofstream o( path.c_str(), ios::app );
+      o << fake_major << " " << fake_devices << " " << fakeName( fake_devices ) << " 0 0 0 0 0 0 0 0 0 0 0" << endl;
+    }
+    block::MajorMinor::getMajorMinorByName( fakeName( fake_devices ) );
+    usleep( 1100000 );
+    if ( block::MajorMinor::getMajorMinorByName( fakeName( fake_devices ) ) != block::MajorMinor( fake_major, fake_devices ) ) {
+      cerr << "added device " << fakeName( fake_devices ) << " not resolved after a cache miss" << endl;
+      errors++;
+    }
+    unlink( path.c_str() );
+    rmdir( dir );
+    cout << lookups << " lookups, " << errors << " errors" << endl;
+  }
+  catch ( const Oops &oops ) {
+    cerr << oops.getMessage() << endl;
+    return 1;
+  }
+  return errors > 0;
+}
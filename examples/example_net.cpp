@@ -138,6 +138,19 @@ int main( int argc, char *argv[] ) {
 
     leanux::net::NetStatDeviceMap snap1,snap2;
     leanux::net::NetStatDeviceVector delta;
+    if ( leanux::net::linkNetStat( snap1 ) ) {
+      leanux::net::procNetStat( snap2 );
+      if ( snap1.size() != snap2.size() ) {
+        cout << "rtnetlink reports " << snap1.size() << " devices, /proc/net/dev " << snap2.size() << endl;
+        return 1;
+      }
+      for ( leanux::net::NetStatDeviceMap::const_iterator i = snap1.begin(); i != snap1.end(); i++ ) {
+        if ( snap2.find( i->first ) == snap2.end() ) {
+          cout << "device " << i->first << " not in /proc/net/dev" << endl;
+          return 1;
+        }
+      }
+    } else cout << "rtnetlink link statistics unavailable" << endl;
     struct timeval t1,t2;
     leanux::net::getNetStat( snap1 );
     gettimeofday( &t1, 0 );
@@ -173,6 +186,60 @@ int main( int argc, char *argv[] ) {
       else cout << setw(10) << " ";
       cout << endl;
     }
+    cout << endl;
+
+    leanux::net::ProtoStatReader protoreader;
+    leanux::net::ProtoStat proto1, proto2, protodelta;
+    protoreader.read( proto1 );
+    gettimeofday( &t1, 0 );
+    leanux::util::Sleep( 1, 0 );
+    protoreader.read( proto2 );
+    gettimeofday( &t2, 0 );
+    if ( proto2.ip_in_receives < proto1.ip_in_receives || proto2.tcp_out_segs < proto1.tcp_out_segs ) {
+      cout << "protocol counters decreased" << endl;
+      return 1;
+    }
+    leanux::net::getProtoStatDelta( proto1, proto2, protodelta );
+    dt = leanux::util::deltaTime( t1, t2 );
+    cout << "ip received/s      : " << protodelta.ip_in_receives / dt << endl;
+    cout << "tcp segments in/s  : " << protodelta.tcp_in_segs / dt << endl;
+    cout << "tcp segments out/s : " << protodelta.tcp_out_segs / dt << endl;
+    cout << "tcp retransmits/s  : " << protodelta.tcp_retrans_segs / dt << endl;
+    cout << "tcp listen drops/s : " << protodelta.tcp_listen_drops / dt << endl;
+    cout << "udp received/s     : " << protodelta.udp_in_datagrams / dt << endl;
+    cout << "udp rcvbuf errors/s: " << protodelta.udp_rcvbuf_errors / dt << endl;
+    cout << endl;
+
+    leanux::net::SoftNetStatMap softnet1, softnet2;
+    leanux::net::SoftNetStatVector softnetdelta;
+    leanux::net::getSoftNetStat( softnet1 );
+    leanux::net::NetQueueStatMap queue1, queue2;
+    leanux::net::NetQueueStatVector queuedelta;
+    leanux::net::getNetQueueStat( queue1 );
+    gettimeofday( &t1, 0 );
+    leanux::util::Sleep( 1, 0 );
+    leanux::net::getSoftNetStat( softnet2 );
+    leanux::net::getNetQueueStat( queue2 );
+    gettimeofday( &t2, 0 );
+    dt = leanux::util::deltaTime( t1, t2 );
+    if ( softnet2.empty() ) {
+      cout << "no softnet statistics" << endl;
+      return 1;
+    }
+    leanux::net::getSoftNetStatDelta( softnet1, softnet2, softnetdelta );
+    cout << setw(5) << "cpu" << setw(12) << "pkt/s" << setw(10) << "drop/s" << setw(10) << "sqz/s" << endl;
+    for ( leanux::net::SoftNetStatVector::const_iterator i = softnetdelta.begin(); i != softnetdelta.end(); i++ ) {
+      cout << setw(5) << (*i).cpu;
+      cout << setw(12) << fixed << setprecision(2) << (*i).processed / dt;
+      cout << setw(10) << fixed << setprecision(2) << (*i).dropped / dt;
+      cout << setw(10) << fixed << setprecision(2) << (*i).time_squeeze / dt;
+      cout << endl;
+    }
+    leanux::net::getNetQueueStatDelta( queue1, queue2, queuedelta );
+    for ( leanux::net::NetQueueStatVector::const_iterator i = queuedelta.begin(); i != queuedelta.end(); i++ ) {
+      cout << (*i).device << " tx-" << (*i).queue << " timeouts " << (*i).tx_timeout;
+      cout << " bql " << (*i).bql_inflight << "/" << (*i).bql_limit << ( (*i).isHot() ? " hot" : "" ) << endl;
+    }
   }
   catch ( leanux::Oops &oops ) {
     cout << oops << endl;
@@ -126,17 +126,21 @@ int main( int argc, char *argv[] ) {
       cout << setw(8) << "fd" << " file" << endl;
       leanux::process::OpenFileMap files;
       leanux::process::getOpenFiles( pid, files );
+      leanux::net::SocketIndex sockets;
       for ( leanux::process::OpenFileMap::const_iterator i = files.begin(); i != files.end(); ++i ) {
         ino_t inode;
         if ( sscanf( i->second.c_str(), "socket:[%lu]", &inode ) == 1 ) {
           leanux::net::TCP4SocketInfo tcp4info;
+          leanux::net::TCP6SocketInfo tcp6info;
           leanux::net::UnixDomainSocketInfo udsinfo;
           leanux::net::UDP4SocketInfo udp4info;
-          if ( leanux::net::findTCP4SocketByINode( inode, tcp4info ) ) {
+          if ( sockets.findTCP4( inode, tcp4info ) ) {
             cout << setw(8) << i->first << " " << tcp4info << endl;
-          } else if ( leanux::net::findUnixDomainSocketByINode( inode, udsinfo ) ) {
+          } else if ( sockets.findTCP6( inode, tcp6info ) ) {
+            cout << setw(8) << i->first << " " << tcp6info << endl;
+          } else if ( sockets.findUnixDomain( inode, udsinfo ) ) {
             cout << setw(8) << i->first << " " << udsinfo << endl;
-          } else if ( leanux::net::findUDP4SocketByINode( inode, udp4info ) ) {
+          } else if ( sockets.findUDP4( inode, udp4info ) ) {
             cout << setw(8) << i->first << " " << udp4info << endl;
           } else cout << setw(8) << i->first << " " << i->second << endl;
         } else cout << setw(8) << i->first << " " << i->second << endl;
@@ -0,0 +1,156 @@
+//========================================================================
+//
+// This file is part of the leanux toolkit.
+//
+// Copyright (C) 2015-2016 Jan-Marten Spit http://www.o-rho.com/leanux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, distribute with modifications, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE ABOVE COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Except as contained in this notice, the name(s) of the above copyright
+// holders shall not be used in advertising or otherwise to promote the
+// sale, use or other dealings in this Software without prior written
+// authorization.
+//========================================================================
+
+/**
+ * Benchmark of the procfs and sysfs readers. Reads the same attributes with a std::ifstream per
+ * value, as util::fileReadUL did before, through util::fileReadUL, and relative to the cached
+ * directory of a util::PseudoFS, checking that all read the same values.
+ */
+
+#include "system.hpp"
+#include "util.hpp"
+#include "oops.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace leanux;
+
+/**
+ * Read an unsigned long with a std::ifstream per call.
+ */
+unsigned long streamReadUL( const std::string &filename ) {
+  std::ifstream i( filename.c_str() );
+  unsigned long result = 0;
+  if ( i.good() ) {
+    i >> result;
+  } else throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+  return result;
+}
+
+/**
+ * An attribute to read, relative to a PseudoFS.
+ */
+struct Attribute {
+  const util::PseudoFS& (*fs)();
+  const char *path;
+};
+
+int main() {
+  try {
+    leanux::init();
+    const Attribute attributes[] = {
+      { util::ProcFS::proc, "sys/vm/dirty_ratio" },
+      { util::ProcFS::proc, "sys/kernel/pid_max" },
+      { util::SysFS::net, "lo/mtu" },
+      { util::SysFS::net, "lo/tx_queue_len" },
+      { util::SysFS::cpu, "online" }
+    };
+    const size_t count = sizeof(attributes) / sizeof(Attribute);
+    const unsigned int rounds = 20000;
+    int errors = 0;
+
+    for ( size_t a = 0; a < count; a++ ) {
+      std::string filename = attributes[a].fs().getDir() + "/" + attributes[a].path;
+      unsigned long expected = streamReadUL( filename );
+      unsigned long value = 0;
+      if ( util::fileReadUL( filename ) != expected || !attributes[a].fs().readUL( attributes[a].path, value ) || value != expected ) {
+        cerr << filename << ": expected " << expected << endl;
+        errors++;
+      }
+    }
+
+    util::Stopwatch sw;
+    unsigned long sum_stream = 0;
+    for ( unsigned int r = 0; r < rounds; r++ ) {
+      for ( size_t a = 0; a < count; a++ ) {
+        sum_stream += streamReadUL( attributes[a].fs().getDir() + "/" + attributes[a].path );
+      }
+    }
+    double stream_seconds = sw.stop() / ( rounds * count );
+
+    sw.start();
+    unsigned long sum_file = 0;
+    for ( unsigned int r = 0; r < rounds; r++ ) {
+      for ( size_t a = 0; a < count; a++ ) {
+        sum_file += util::fileReadUL( attributes[a].fs().getDir() + "/" + attributes[a].path );
+      }
+    }
+    double file_seconds = sw.stop() / ( rounds * count );
+
+    sw.start();
+    unsigned long sum_relative = 0;
+    for ( unsigned int r = 0; r < rounds; r++ ) {
+      for ( size_t a = 0; a < count; a++ ) {
+        unsigned long value = 0;
+        attributes[a].fs().readUL( attributes[a].path, value );
+        sum_relative += value;
+      }
+    }
+    double relative_seconds = sw.stop() / ( rounds * count );
+
+    cout << "std::ifstream : " << util::NumStr( stream_seconds * 1.0E6 ) << "us per read" << endl;
+    cout << "fileReadUL    : " << util::NumStr( file_seconds * 1.0E6 ) << "us per read";
+    cout << " (" << util::NumStr( stream_seconds / file_seconds ) << "x)" << endl;
+    cout << "PseudoFS      : " << util::NumStr( relative_seconds * 1.0E6 ) << "us per read";
+    cout << " (" << util::NumStr( stream_seconds / relative_seconds ) << "x)" << endl;
+
+    // the buffer is per thread, so concurrent readers must not see each others contents
+    std::vector<std::thread> threads;
+    std::vector<int> thread_errors( count, 0 );
+    for ( size_t a = 0; a < count; a++ ) {
+      threads.push_back( std::thread( [&attributes, &thread_errors, a]() {
+        std::string expected;
+        attributes[a].fs().readLine( attributes[a].path, expected );
+        for ( unsigned int r = 0; r < 2000; r++ ) {
+          std::string value;
+          if ( !attributes[a].fs().readLine( attributes[a].path, value ) || value != expected ) thread_errors[a]++;
+        }
+      } ) );
+    }
+    for ( size_t t = 0; t < threads.size(); t++ ) threads[t].join();
+    for ( size_t a = 0; a < count; a++ ) {
+      if ( thread_errors[a] ) {
+        cerr << attributes[a].path << ": " << thread_errors[a] << " concurrent reads differ" << endl;
+        errors++;
+      }
+    }
+
+    return errors ? 1 : 0;
+  }
+  catch ( const Oops &oops ) {
+    cerr << oops.getMessage() << endl;
+    return 1;
+  }
+}
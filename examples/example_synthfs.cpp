@@ -0,0 +1,449 @@
+//========================================================================
+//
+// This file is part of the leanux toolkit.
+//
+// Copyright (C) 2015-2016 Jan-Marten Spit http://www.o-rho.com/leanux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, distribute with modifications, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE ABOVE COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Except as contained in this notice, the name(s) of the above copyright
+// holders shall not be used in advertising or otherwise to promote the
+// sale, use or other dealings in this Software without prior written
+// authorization.
+//========================================================================
+
+/**
+ * Benchmark and regression test of the collectors against a synthetic procfs and sysfs tree.
+ * Generates a tree with a given number of tasks, disks, network interfaces and CPUs below a
+ * temporary directory, points util::setPseudoFSRoot at it, times the collectors and checks their
+ * results against the (deterministic) generated contents. Only the files the timed collectors read
+ * are generated. By default the tree is small, run with -p for production scale (100k tasks, 5000
+ * disks, 2000 interfaces and 512 CPUs), with -k to keep the tree instead of removing it.
+ */
+
+#include "block.hpp"
+#include "cpu.hpp"
+#include "device.hpp"
+#include "net.hpp"
+#include "process.hpp"
+#include "system.hpp"
+#include "util.hpp"
+#include "oops.hpp"
+
+#include <errno.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+using namespace leanux;
+
+/**
+ * Size of the synthetic tree.
+ */
+struct Scale {
+  unsigned int tasks;
+  unsigned int disks;
+  unsigned int interfaces;
+  unsigned int cpus;
+};
+
+/** Default, kept small enough to run as a test. */
+const Scale small_scale = { 2000, 100, 40, 16 };
+
+/** Production scale. */
+const Scale production_scale = { 100000, 5000, 2000, 512 };
+
+/** The first synthetic pid. */
+const pid_t first_pid = 1000;
+
+/** The major number of the synthetic (NVMe) disks. */
+const unsigned int disk_major = 259;
+
+/** The number of partitions on the first disk. */
+const unsigned int partitions = 2;
+
+/** The major number of the synthetic device mapper device, built on the partitions. */
+const unsigned int dm_major = 253;
+
+/** The number of transmit queues per synthetic interface. */
+const unsigned int tx_queues = 2;
+
+/** Every socket_every-th task owns a socket. */
+const unsigned int socket_every = 10;
+
+/** The inode of the socket of the first task. */
+const ino_t first_inode = 100000;
+
+void makeDir( const string &path ) {
+  if ( mkdir( path.c_str(), 0755 ) && errno != EEXIST ) throw Oops( __FILE__, __LINE__, errno );
+}
+
+void makeLink( const string &target, const string &path ) {
+  if ( symlink( target.c_str(), path.c_str() ) ) throw Oops( __FILE__, __LINE__, errno );
+}
+
+void writeFile( const string &path, const string &content ) {
+  ofstream o( path.c_str() );
+  o << content;
+  if ( !o.good() ) throw Oops( __FILE__, __LINE__, "failed to write '" + path + "'" );
+}
+
+string taskComm( unsigned int task ) {
+  stringstream ss;
+  ss << "task" << task % 100;
+  return ss.str();
+}
+
+string diskName( unsigned int disk ) {
+  stringstream ss;
+  ss << "nvme" << disk / 100 << "n" << disk % 100 + 1;
+  return ss.str();
+}
+
+/** The name of partition p of the first disk. */
+string partitionName( unsigned int p ) {
+  stringstream ss;
+  ss << diskName( 0 ) << "p" << p;
+  return ss.str();
+}
+
+string interfaceName( unsigned int interface ) {
+  stringstream ss;
+  ss << "syn" << interface;
+  return ss.str();
+}
+
+/**
+ * proc/<pid>/task/<pid>/stat, proc/<pid>/wchan and proc/<pid>/fd, every task a single threaded process.
+ */
+void generateTasks( const string &root, unsigned int tasks ) {
+  for ( unsigned int t = 0; t < tasks; t++ ) {
+    stringstream ss;
+    ss << root << "/proc/" << first_pid + t;
+    string dir = ss.str();
+    makeDir( dir );
+    makeDir( dir + "/task" );
+    ss << "/task/" << first_pid + t;
+    makeDir( ss.str() );
+    stringstream stat;
+    stat << first_pid + t << " (" << taskComm( t ) << ") S " << first_pid << " " << first_pid + t << " " << first_pid + t
+         << " 0 -1 4194304 " << t << " 0 0 0 " << t % 1000 << " " << t % 100 << " 0 0 20 0 1 0 " << t
+         << " 10485760 512 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 " << t % 512 << " 0 0 0 0 0" << endl;
+    writeFile( ss.str() + "/stat", stat.str() );
+    writeFile( dir + "/wchan", "0" );
+    makeDir( dir + "/fd" );
+    makeLink( "/dev/null", dir + "/fd/0" );
+    if ( t % socket_every == 0 ) {
+      stringstream link;
+      link << "socket:[" << first_inode + t << "]";
+      makeLink( link.str(), dir + "/fd/3" );
+    }
+  }
+}
+
+/**
+ * The stat, inflight and size attributes of a disk or partition, and its sys/class/block link.
+ */
+void generateBlockDevice( const string &root, const string &dir, const string &name, const string &stat, const string &inflight ) {
+  makeDir( root + "/sys/" + dir );
+  writeFile( root + "/sys/" + dir + "/stat", stat + "\n" );
+  writeFile( root + "/sys/" + dir + "/inflight", inflight + "\n" );
+  writeFile( root + "/sys/" + dir + "/size", "2097152\n" );
+  makeLink( "../../" + dir, root + "/sys/class/block/" + name );
+}
+
+/**
+ * proc/diskstats, the device directories below sys/devices and their sys/class/block and sys/block links.
+ * The first disk has partitions, numbered after the disks, and a device mapper device dm-0 spans them.
+ * proc/self/mountinfo mounts the first partition on /synth.
+ */
+void generateDisks( const string &root, unsigned int disks ) {
+  stringstream diskstats;
+  makeDir( root + "/sys/devices/synth" );
+  for ( unsigned int d = 0; d < disks; d++ ) {
+    string name = diskName( d );
+    stringstream stat;
+    stat << d << " 0 " << d * 8 << " " << d % 1000 << " " << 2 * d << " 0 " << d * 16 << " " << d % 100
+         << " 0 " << d % 1000 << " " << d % 1000 << " 0 0 0 0 " << d % 10 << " 0";
+    diskstats << setw(4) << disk_major << " " << setw(7) << d << " " << name << " " << stat.str() << endl;
+    stringstream controller;
+    controller << "devices/synth/nvme" << d / 100;
+    makeDir( root + "/sys/" + controller.str() );
+    string dir = controller.str() + "/" + name;
+    stringstream inflight;
+    inflight << d % 4 << " " << d % 8;
+    generateBlockDevice( root, dir, name, stat.str(), inflight.str() );
+    makeLink( "../" + dir, root + "/sys/block/" + name );
+    if ( d > 0 ) continue;
+    for ( unsigned int p = 1; p <= partitions; p++ ) {
+      stringstream pstat, pinflight;
+      pstat << 1000 + p << " 0 8 1 " << 2000 + p << " 0 16 1 0 1 1";
+      pinflight << p << " 0";
+      diskstats << setw(4) << disk_major << " " << setw(7) << disks + p - 1 << " " << partitionName( p ) << " " << pstat.str() << endl;
+      generateBlockDevice( root, dir + "/" + partitionName( p ), partitionName( p ), pstat.str(), pinflight.str() );
+    }
+  }
+  makeDir( root + "/sys/devices/virtual" );
+  makeDir( root + "/sys/devices/virtual/block" );
+  const string dm = "devices/virtual/block/dm-0";
+  generateBlockDevice( root, dm, "dm-0", "5000 0 8 1 6000 0 16 1 0 1 1", "0 0" );
+  diskstats << setw(4) << dm_major << " " << setw(7) << 0 << " dm-0 5000 0 8 1 6000 0 16 1 0 1 1" << endl;
+  makeDir( root + "/sys/" + dm + "/slaves" );
+  for ( unsigned int p = 1; p <= partitions; p++ ) {
+    makeLink( "../../../../../sys/class/block/" + partitionName( p ), root + "/sys/" + dm + "/slaves/" + partitionName( p ) );
+  }
+  writeFile( root + "/proc/diskstats", diskstats.str() );
+  stringstream mountinfo;
+  mountinfo << "30 1 " << disk_major << ":" << disks << " / /synth rw,noatime shared:1 - ext4 /dev/" << partitionName( 1 ) << " rw" << endl;
+  writeFile( root + "/proc/self/mountinfo", mountinfo.str() );
+}
+
+/**
+ * proc/net/dev and the interface directories below sys/devices/virtual/net with their sys/class/net links.
+ */
+void generateInterfaces( const string &root, unsigned int interfaces ) {
+  stringstream dev;
+  dev << "Inter-|   Receive                                                |  Transmit" << endl;
+  dev << " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed" << endl;
+  makeDir( root + "/sys/devices/virtual" );
+  makeDir( root + "/sys/devices/virtual/net" );
+  for ( unsigned int i = 0; i < interfaces; i++ ) {
+    string name = interfaceName( i );
+    dev << setw(6) << name << ": " << i * 1500 << " " << i << " 0 0 0 0 0 0 " << i * 3000 << " " << 2 * i << " 0 0 0 0 0 0" << endl;
+    string dir = "devices/virtual/net/" + name;
+    makeDir( root + "/sys/" + dir );
+    makeDir( root + "/sys/" + dir + "/queues" );
+    for ( unsigned int q = 0; q < tx_queues; q++ ) {
+      stringstream queue;
+      queue << root << "/sys/" << dir << "/queues/tx-" << q;
+      makeDir( queue.str() );
+      makeDir( queue.str() + "/byte_queue_limits" );
+      writeFile( queue.str() + "/tx_timeout", "0\n" );
+      writeFile( queue.str() + "/byte_queue_limits/stall_cnt", "0\n" );
+      writeFile( queue.str() + "/byte_queue_limits/inflight", "0\n" );
+      stringstream limit;
+      limit << i + q << endl;
+      writeFile( queue.str() + "/byte_queue_limits/limit", limit.str() );
+    }
+    makeLink( "../../" + dir, root + "/sys/class/net/" + name );
+  }
+  writeFile( root + "/proc/net/dev", dev.str() );
+}
+
+/**
+ * proc/stat and sys/devices/system/cpu, two packages with two threads per core.
+ */
+void generateCPUs( const string &root, unsigned int cpus ) {
+  stringstream stat;
+  stat << "cpu  " << cpus * 100 << " 0 " << cpus * 50 << " " << cpus * 1000 << " 0 0 0 0 0 0" << endl;
+  makeDir( root + "/sys/devices/system" );
+  makeDir( root + "/sys/devices/system/cpu" );
+  for ( unsigned int c = 0; c < cpus; c++ ) {
+    stat << "cpu" << c << " 100 0 50 1000 " << c << " 0 0 0 0 0" << endl;
+    stringstream dir;
+    dir << root << "/sys/devices/system/cpu/cpu" << c;
+    makeDir( dir.str() );
+    makeDir( dir.str() + "/topology" );
+    stringstream package, core;
+    package << c / ( cpus / 2 ) << endl;
+    core << ( c % ( cpus / 2 ) ) / 2 << endl;
+    writeFile( dir.str() + "/topology/physical_package_id", package.str() );
+    writeFile( dir.str() + "/topology/core_id", core.str() );
+  }
+  stat << "btime 0" << endl;
+  writeFile( root + "/proc/stat", stat.str() );
+}
+
+void generate( const string &root, const Scale &scale ) {
+  const char* dirs[] = { "/proc", "/proc/net", "/proc/self", "/sys", "/sys/devices", "/sys/class", "/sys/class/block",
+                         "/sys/class/net", "/sys/block", "/sys/bus" };
+  for ( size_t d = 0; d < sizeof(dirs) / sizeof(const char*); d++ ) makeDir( root + dirs[d] );
+  generateTasks( root, scale.tasks );
+  generateDisks( root, scale.disks );
+  generateInterfaces( root, scale.interfaces );
+  generateCPUs( root, scale.cpus );
+}
+
+int removeEntry( const char *path, const struct stat *, int, struct FTW * ) {
+  return remove( path );
+}
+
+/**
+ * Report the time per round and per item, and count an error if the collector found an unexpected number of items.
+ */
+int report( const string &what, double seconds, unsigned int rounds, size_t found, size_t expected ) {
+  cout << setw(18) << left << what << right << fixed << setprecision(1);
+  cout << setw(9) << seconds / rounds * 1.0E3 << "ms " << setw(7) << seconds / rounds / ( expected ? expected : 1 ) * 1.0E6 << "us per item";
+  cout << " (" << found << " items)" << endl;
+  if ( found != expected ) {
+    cerr << what << ": expected " << expected << " items, found " << found << endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  try {
+    Scale scale = small_scale;
+    bool keep = false;
+    int opt;
+    while ( ( opt = getopt( argc, argv, "pk" ) ) != -1 ) {
+      switch ( opt ) {
+        case 'p' : scale = production_scale; break;
+        case 'k' : keep = true; break;
+        default :
+          cerr << "usage: " << argv[0] << " [-p] [-k]" << endl;
+          return 1;
+      }
+    }
+    char dir[] = "/tmp/example-synthfs-XXXXXX";
+    if ( !mkdtemp( dir ) ) throw Oops( __FILE__, __LINE__, errno );
+    string root = dir;
+    util::Stopwatch sw;
+    generate( root, scale );
+    cout << "generated " << root << " (" << scale.tasks << " tasks, " << scale.disks << " disks, ";
+    cout << scale.interfaces << " interfaces, " << scale.cpus << " cpus) in " << util::NumStr( sw.stop() ) << "s" << endl;
+
+    util::setPseudoFSRoot( root );
+    if ( sysdevice::sysdevice_root != root + "/sys/devices" ) throw Oops( __FILE__, __LINE__, "sysdevice_root does not follow the root" );
+    const unsigned int rounds = 3;
+    int errors = 0;
+
+    process::ProcPidStatMap procs;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) process::getAllProcPidStat( procs );
+    errors += report( "getAllProcPidStat", sw.stop(), rounds, procs.size(), scale.tasks );
+    for ( unsigned int t = 0; t < scale.tasks; t++ ) {
+      process::ProcPidStatMap::const_iterator p = procs.find( first_pid + t );
+      if ( p == procs.end() || p->second.comm != taskComm( t ) || p->second.ppid != first_pid ||
+           p->second.minflt != t || p->second.processor != t % 512 ) errors++;
+    }
+
+    process::SocketOwnerMap owners;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) process::getSocketOwners( owners );
+    errors += report( "getSocketOwners", sw.stop(), rounds, owners.size(), ( scale.tasks + socket_every - 1 ) / socket_every );
+    for ( unsigned int t = 0; t < scale.tasks; t += socket_every ) {
+      process::SocketOwnerMap::const_iterator o = owners.find( first_inode + t );
+      if ( o == owners.end() || o->second != (pid_t)( first_pid + t ) ) errors++;
+    }
+
+    block::DeviceStatsMap disks;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) block::getStats( disks );
+    errors += report( "block::getStats", sw.stop(), rounds, disks.size(), scale.disks + partitions + 1 );
+    for ( unsigned int d = 0; d < scale.disks; d++ ) {
+      block::DeviceStatsMap::const_iterator s = disks.find( block::MajorMinor( disk_major, d ) );
+      if ( s == disks.end() || s->second.reads != d || s->second.writes != 2 * d ||
+           s->second.flushes != d % 10 || s->second.inflight_reads != d % 4 || s->second.inflight_writes != d % 8 ) errors++;
+    }
+    if ( block::MajorMinor::getNameByMajorMinor( block::MajorMinor( disk_major, scale.disks - 1 ) ) != diskName( scale.disks - 1 ) ) errors++;
+    // a partition has its own statistics, not those of its whole disk
+    for ( unsigned int p = 1; p <= partitions; p++ ) {
+      block::MajorMinor mm( disk_major, scale.disks + p - 1 );
+      block::DeviceStats stats;
+      if ( !mm.isPartition() || block::MajorMinor::deriveWholeDisk( mm ) != block::MajorMinor( disk_major, 0 ) ||
+           !mm.getStats( stats ) || stats.reads != 1000 + p || stats.writes != 2000 + p || stats.inflight_reads != p ||
+           disks[mm].reads != 1000 + p ) {
+        cerr << partitionName( p ) << ": unexpected statistics" << endl;
+        errors++;
+      }
+    }
+
+    // dm-0 rolls up the I/O of the partitions it spans, not that of their whole disk
+    block::Topology stacking;
+    block::DeviceStatsMap rolled;
+    stacking.rollUp( disks, rolled );
+    block::MajorMinor dm( dm_major, 0 );
+    if ( stacking.getLeaves( dm ).size() != partitions || rolled[dm].reads != 1001 + 1002 || rolled[dm].writes != 2001 + 2002 ) {
+      cerr << "dm-0: unexpected rolled up statistics" << endl;
+      errors++;
+    }
+
+    std::map<block::MajorMinor,block::MountInfo> mounts;
+    block::enumMounts( mounts );
+    if ( mounts.size() != 1 || mounts[block::MajorMinor( disk_major, scale.disks )].mountpoint != "/synth" ) {
+      cerr << "enumMounts: expected " << partitionName( 1 ) << " on /synth" << endl;
+      errors++;
+    }
+
+    net::NetStatDeviceMap interfaces;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) net::procNetStat( interfaces );
+    errors += report( "procNetStat", sw.stop(), rounds, interfaces.size(), scale.interfaces );
+    for ( unsigned int i = 0; i < scale.interfaces; i++ ) {
+      net::NetStatDeviceMap::const_iterator n = interfaces.find( interfaceName( i ) );
+      if ( n == interfaces.end() || n->second.rx_bytes != i * 1500 || n->second.tx_packets != 2 * i ) errors++;
+    }
+
+    net::NetQueueStatMap queues;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) net::getNetQueueStat( queues );
+    errors += report( "getNetQueueStat", sw.stop(), rounds, queues.size(), scale.interfaces * tx_queues );
+    for ( unsigned int i = 0; i < scale.interfaces; i++ ) {
+      net::NetQueueStatMap::const_iterator q = queues.find( interfaceName( i ) + "/tx-1" );
+      if ( q == queues.end() || q->second.bql_limit != i + 1 ) errors++;
+    }
+
+    cpu::CPUStatsMap cpus;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) cpu::getCPUStats( cpus );
+    errors += report( "getCPUStats", sw.stop(), rounds, cpus.size(), scale.cpus );
+    for ( unsigned int c = 0; c < scale.cpus; c++ ) {
+      cpu::CPUStatsMap::const_iterator s = cpus.find( c );
+      if ( s == cpus.end() || s->second.iowait != (double)c / system::getUserHz() ) errors++;
+    }
+
+    cpu::CPUTopology topology;
+    sw.start();
+    for ( unsigned int r = 0; r < rounds; r++ ) cpu::getCPUTopology( topology );
+    errors += report( "getCPUTopology", sw.stop(), rounds, topology.logical, scale.cpus );
+    if ( topology.physical != 2 || topology.cores != scale.cpus / 2 ) {
+      cerr << "expected 2 packages and " << scale.cpus / 2 << " cores, found " << topology.physical << " and " << topology.cores << endl;
+      errors++;
+    }
+
+    util::setPseudoFSRoot( "" );
+    // the mount table watch follows the root back to the real /proc
+    block::enumMounts( mounts );
+    if ( mounts.find( block::MajorMinor( disk_major, scale.disks ) ) != mounts.end() &&
+         mounts[block::MajorMinor( disk_major, scale.disks )].mountpoint == "/synth" ) {
+      cerr << "enumMounts: still reading the synthetic mount table" << endl;
+      errors++;
+    }
+    if ( keep ) cout << "kept " << root << endl;
+    else if ( nftw( dir, removeEntry, 64, FTW_DEPTH | FTW_PHYS ) ) throw Oops( __FILE__, __LINE__, errno );
+    if ( errors ) cerr << errors << " errors" << endl;
+    return errors ? 1 : 0;
+  }
+  catch ( const Oops &oops ) {
+    cerr << oops.getMessage() << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,234 @@
+//========================================================================
+//
+// This file is part of the leanux toolkit.
+//
+// Copyright (C) 2015-2016 Jan-Marten Spit http://www.o-rho.com/leanux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, distribute with modifications, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE ABOVE COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Except as contained in this notice, the name(s) of the above copyright
+// holders shall not be used in advertising or otherwise to promote the
+// sale, use or other dealings in this Software without prior written
+// authorization.
+//========================================================================
+
+/**
+ * Benchmark of the TCP socket enumeration paths. Opens many loopback connections and
+ * streams the listening and established sockets through sock_diag and through /proc/net/tcp,
+ * checking that both see the same connections.
+ */
+
+#include "net.hpp"
+#include "util.hpp"
+#include "oops.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace leanux;
+
+const unsigned int max_connections = 5000;
+const unsigned int rounds = 5;
+
+/**
+ * Counts the established sockets from and to the benchmark port.
+ */
+class CountSink : public net::TCPSocketSink {
+  public:
+    CountSink( unsigned int port ) : port_( port ), sockets( 0 ), servers( 0 ), clients( 0 ) {};
+    virtual void put( const net::TCP4SocketInfo &info ) {
+      sockets++;
+      if ( info.tcp_state != net::TCP_ESTABLISHED ) return;
+      if ( info.local_port == port_ ) servers++;
+      if ( info.remote_port == port_ ) clients++;
+    };
+    virtual void put( const net::TCP6SocketInfo &info ) { sockets++; };
+    unsigned int port_;
+    unsigned long sockets;
+    unsigned long servers;
+    unsigned long clients;
+};
+
+int main() {
+  try {
+    // each connection takes a client and a server descriptor
+    struct rlimit rl;
+    if ( getrlimit( RLIMIT_NOFILE, &rl ) ) throw Oops( __FILE__, __LINE__, errno );
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit( RLIMIT_NOFILE, &rl );
+    getrlimit( RLIMIT_NOFILE, &rl );
+    unsigned int connections = max_connections;
+    if ( rl.rlim_cur < 2 * connections + 64 ) connections = ( rl.rlim_cur - 64 ) / 2;
+
+    int listener = socket( AF_INET, SOCK_STREAM, 0 );
+    if ( listener < 0 ) throw Oops( __FILE__, __LINE__, errno );
+    struct sockaddr_in addr;
+    memset( &addr, 0, sizeof(addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if ( bind( listener, (struct sockaddr*)&addr, sizeof(addr) ) ) throw Oops( __FILE__, __LINE__, errno );
+    if ( listen( listener, 1024 ) ) throw Oops( __FILE__, __LINE__, errno );
+    if ( getsockname( listener, (struct sockaddr*)&addr, &len ) ) throw Oops( __FILE__, __LINE__, errno );
+    unsigned int port = ntohs( addr.sin_port );
+
+    vector<int> fds;
+    for ( unsigned int c = 0; c < connections; c++ ) {
+      int client = socket( AF_INET, SOCK_STREAM, 0 );
+      if ( client < 0 ) throw Oops( __FILE__, __LINE__, errno );
+      if ( connect( client, (struct sockaddr*)&addr, sizeof(addr) ) ) throw Oops( __FILE__, __LINE__, errno );
+      int server = accept( listener, 0, 0 );
+      if ( server < 0 ) throw Oops( __FILE__, __LINE__, errno );
+      fds.push_back( client );
+      fds.push_back( server );
+    }
+    cout << connections << " loopback connections on port " << port << endl;
+
+    unsigned int states = net::getTCPStateFlag( net::TCP_LISTEN ) | net::getTCPStateFlag( net::TCP_ESTABLISHED );
+    int errors = 0;
+
+    util::Stopwatch sw;
+    CountSink proc( port );
+    for ( unsigned int r = 0; r < rounds; r++ ) {
+      proc = CountSink( port );
+      net::procTCPSockets( AF_INET, states, proc );
+    }
+    double proc_seconds = sw.stop() / rounds;
+    cout << "/proc/net/tcp : " << proc.sockets << " sockets in " << util::TimeStrSec( proc_seconds ) << endl;
+    if ( proc.servers != connections || proc.clients != connections ) {
+      cerr << "/proc/net/tcp: expected " << connections << " server and client sockets, got " << proc.servers << " and " << proc.clients << endl;
+      errors++;
+    }
+
+    sw.start();
+    CountSink diag( port );
+    bool available = true;
+    for ( unsigned int r = 0; r < rounds && available; r++ ) {
+      diag = CountSink( port );
+      available = net::diagTCPSockets( AF_INET, states, diag );
+    }
+    double diag_seconds = sw.stop() / rounds;
+    if ( available ) {
+      cout << "sock_diag     : " << diag.sockets << " sockets in " << util::TimeStrSec( diag_seconds );
+      cout << " (" << util::NumStr( proc_seconds / diag_seconds ) << "x)" << endl;
+      if ( diag.servers != connections || diag.clients != connections ) {
+        cerr << "sock_diag: expected " << connections << " server and client sockets, got " << diag.servers << " and " << diag.clients << endl;
+        errors++;
+      }
+    } else cout << "sock_diag     : not available" << endl;
+
+    sw.start();
+    net::TCPKeyCounterVector servers;
+    net::TCPKeyCounterVector clients;
+    net::getTCPConnectionCounters( servers, clients );
+    cout << "counters      : " << servers.size() << " servers, " << clients.size() << " clients in " << util::TimeStrSec( sw.stop() ) << endl;
+
+    // the sampler must count like getTCPConnectionCounters, and summarize TCP_INFO if sock_diag is available
+    const unsigned int top = 16;
+    net::TCPConnectionSampler sampler( top );
+    net::TCPKeyCounterVector sservers;
+    net::TCPKeyCounterVector sclients;
+    sw.start();
+    sampler.sample( sservers, sclients );
+    cout << "sampler       : " << sservers.size() << " servers, " << sclients.size() << " clients in " << util::TimeStrSec( sw.stop() ) << endl;
+    unsigned long sampled = 0;
+    for ( net::TCPKeyCounterVector::const_iterator i = sservers.begin(); i != sservers.end(); i++ ) sampled += (*i).getInfo().sampled;
+    for ( net::TCPKeyCounterVector::const_iterator i = sclients.begin(); i != sclients.end(); i++ ) sampled += (*i).getInfo().sampled;
+    if ( sservers.size() != servers.size() || sclients.size() != clients.size() ) {
+      cerr << "sampler: expected " << servers.size() << " servers and " << clients.size() << " clients" << endl;
+      errors++;
+    }
+    if ( available && sampled != top ) {
+      cerr << "sampler: expected TCP_INFO of " << top << " connections, got " << sampled << endl;
+      errors++;
+    }
+
+    // resolve the socket of each descriptor as an open file would be, through one
+    // SocketIndex, and through findTCP4SocketByINode on a sample
+    sw.start();
+    net::SocketIndex index;
+    unsigned long found = 0;
+    for ( vector<int>::const_iterator f = fds.begin(); f != fds.end(); f++ ) {
+      struct stat st;
+      net::TCP4SocketInfo info;
+      if ( fstat( *f, &st ) == 0 && index.findTCP4( st.st_ino, info ) ) found++;
+    }
+    double index_seconds = sw.stop();
+    cout << "SocketIndex   : " << found << " of " << fds.size() << " descriptors in " << util::TimeStrSec( index_seconds ) << endl;
+    if ( found != fds.size() ) {
+      cerr << "SocketIndex: expected " << fds.size() << " sockets, found " << found << endl;
+      errors++;
+    }
+    const unsigned int scans = 16;
+    sw.start();
+    for ( unsigned int f = 0; f < scans && f < fds.size(); f++ ) {
+      struct stat st;
+      net::TCP4SocketInfo info;
+      if ( fstat( fds[f], &st ) || !net::findTCP4SocketByINode( st.st_ino, info ) ) {
+        cerr << "findTCP4SocketByINode: socket of descriptor " << fds[f] << " not found" << endl;
+        errors++;
+      }
+    }
+    double scan_seconds = sw.stop() / scans * fds.size();
+    cout << "scans         : " << fds.size() << " descriptors in " << util::TimeStrSec( scan_seconds ) << " (estimated)";
+    cout << " (" << util::NumStr( scan_seconds / index_seconds ) << "x)" << endl;
+
+    // the traffic over some connections must be attributed to this process
+    const unsigned int busy = 8;
+    net::ProcessNetSampler procnet;
+    net::ProcessNetStatVector pstats;
+    procnet.sample( pstats );
+    char buf[1000] = {};
+    for ( unsigned int c = 0; c < busy; c++ ) {
+      if ( write( fds[c*2], buf, sizeof(buf) ) != sizeof(buf) ) throw Oops( __FILE__, __LINE__, errno );
+      if ( read( fds[c*2+1], buf, sizeof(buf) ) <= 0 ) throw Oops( __FILE__, __LINE__, errno );
+    }
+    usleep( 10000 );
+    sw.start();
+    procnet.sample( pstats );
+    cout << "process net   : " << pstats.size() << " processes in " << util::TimeStrSec( sw.stop() ) << endl;
+    if ( available ) {
+      net::ProcessNetStatVector::const_iterator p = pstats.begin();
+      while ( p != pstats.end() && (*p).pid != getpid() ) p++;
+      if ( p == pstats.end() || (*p).connections != busy * 2 || (*p).bytes_sent < busy * sizeof(buf) || (*p).bytes_received < busy * sizeof(buf) ) {
+        cerr << "ProcessNetSampler: traffic of " << busy * 2 << " connections not attributed to pid " << getpid() << endl;
+        errors++;
+      }
+    }
+
+    for ( vector<int>::const_iterator f = fds.begin(); f != fds.end(); f++ ) close( *f );
+    close( listener );
+    return errors > 0;
+  }
+  catch ( const Oops &oops ) {
+    cerr << oops.getMessage() << endl;
+    return 1;
+  }
+}
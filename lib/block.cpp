@@ -43,6 +43,10 @@
 #include <sys/sysmacros.h>
 #include <sys/stat.h>
 #include <sys/statfs.h>
+#include <sys/time.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <dirent.h>
@@ -52,20 +56,19 @@
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <set>
 #include <sstream>
 
 namespace leanux {
 
   namespace block {
 
-    std::map< std::string, MajorMinor > MajorMinor::name2mm_;
-
-    std::map< MajorMinor, std::string> MajorMinor::mm2name_;
-
-    std::map< std::string, MajorMinor > MajorMinor::file2mm_;
-
-    std::map< MajorMinor, std::string> MajorMinor::mm2file_;
-
     const MajorMinor MajorMinor::invalid = MajorMinor( 0, 0 );
 
     /**
@@ -91,6 +94,381 @@ namespace leanux {
      */
     udevMode udev_mode = umBlockMM;
 
+    std::string diskstats_path = "";
+
+    std::string mountstats_path = "";
+
+    std::string bdistats_path = "";
+
+    /**
+     * Resolve an overridable path.
+     * @param path the override, such as diskstats_path.
+     * @param def the default, used when path is empty.
+     * @return path, or def if path is empty.
+     */
+    inline std::string overridable( const std::string &path, const std::string &def ) {
+      return path.empty() ? def : path;
+    }
+
+    /** The diskstats file in use. */
+    std::string diskstatsPath() {
+      return overridable( diskstats_path, util::ProcFS::path( "diskstats" ) );
+    }
+
+    /** The mountstats file in use. */
+    std::string mountstatsPath() {
+      return overridable( mountstats_path, util::ProcFS::path( "self/mountstats" ) );
+    }
+
+    /** The bdi directory in use. */
+    std::string bdistatsPath() {
+      return overridable( bdistats_path, util::SysFS::path( "kernel/debug/bdi" ) );
+    }
+
+    /**
+     * Immutable snapshot of the mappings between device names, devicefiles and
+     * MajorMinor numbers. Lookups atomically load the current snapshot and search it
+     * without locking, rebuilds publish a new snapshot (RCU style).
+     */
+    struct DeviceCache {
+      /** device name to MajorMinor. */
+      std::map<std::string,MajorMinor> name2mm;
+      /** MajorMinor to device name. */
+      std::map<MajorMinor,std::string> mm2name;
+      /** devicefile to MajorMinor. */
+      std::map<std::string,MajorMinor> file2mm;
+      /** MajorMinor to devicefile. */
+      std::map<MajorMinor,std::string> mm2file;
+      /** device generation, incremented when devices are added or removed. */
+      unsigned long generation;
+    };
+
+    /**
+     * Immutable snapshot of the negative caches, lookups that did not resolve
+     * in a device generation.
+     */
+    struct MissCache {
+      /** device names that did not resolve. */
+      std::set<std::string> names;
+      /** devicefiles that did not resolve. */
+      std::set<std::string> files;
+      /** MajorMinor numbers that did not resolve. */
+      std::set<MajorMinor> mms;
+      /** the device generation the misses apply to. */
+      unsigned long generation;
+    };
+
+    /**
+     * Immutable snapshot of the mount table as used by enumMounts.
+     */
+    struct MountTable {
+      /** mounted filesystems by MajorMinor. */
+      std::map<MajorMinor,MountInfo> mounts;
+      /** the device generation the table was built in. */
+      unsigned long generation;
+      /** the mountinfo file the table was parsed from, which follows util::setPseudoFSRoot. */
+      std::string path;
+    };
+
+    typedef std::shared_ptr<const DeviceCache> DeviceCachePtr;
+    typedef std::shared_ptr<const MissCache> MissCachePtr;
+    typedef std::shared_ptr<const MountTable> MountTablePtr;
+
+    /** current DeviceCache snapshot, only accessed through std::atomic_load/std::atomic_store. */
+    DeviceCachePtr device_cache;
+
+    /** current MissCache snapshot, only accessed through std::atomic_load/std::atomic_store. */
+    MissCachePtr miss_cache;
+
+    /** current MountTable snapshot, only accessed through std::atomic_load/std::atomic_store. */
+    MountTablePtr mount_table;
+
+    /** file descriptor on /proc/self/mountinfo polled for mount table changes, -1 if not open. */
+    int mount_watch = -1;
+
+    /** the path mount_watch was opened on. */
+    std::string mount_watch_path;
+
+    /** serializes writers of mount_table, mount_watch and mount_watch_path. */
+    std::mutex mount_mutex;
+
+    /** serializes writers of device_cache, miss_cache, cache_age and cache_watch. */
+    std::mutex cache_mutex;
+
+    /** steady clock time of the last device_cache rebuild in milliseconds, read without locking. */
+    std::atomic<long long> cache_age( 0 );
+
+    /**
+     * Get the steady clock time in milliseconds.
+     */
+    long long steadyMillis() {
+      return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    /** inotify file descriptor watching for device changes, -1 if no watch is active. */
+    int cache_watch = -1;
+
+    /** cache of MajorMinor to DeviceDescriptor for a single device generation. */
+    std::map<MajorMinor,DeviceDescriptor> descriptors;
+
+    /** device generation descriptors were cached in. */
+    unsigned long descriptors_generation = 0;
+
+    /** serializes access to descriptors and descriptors_generation. */
+    std::mutex descriptors_mutex;
+
+    /**
+     * Get the udev database path for the device.
+     * @param m the device.
+     * @param name the device name, only used when udev_mode is umBlockName.
+     * @return the udev database path.
+     */
+    std::string udevPath( const MajorMinor &m, const std::string &name ) {
+      std::stringstream ss;
+      switch ( udev_mode ) {
+        case umBlockMM :
+          ss << "block" << m;
+          break;
+        case umBMM :
+          ss << "b" << m;
+          break;
+        case umBlockName :
+          ss << "block:" << name;
+          break;
+      }
+      return udev_path + ss.str();
+    }
+
+    /**
+     * Get the devicefile aliases ('S:' lines) from udev properties that
+     * resolve to the device.
+     * @param m the device.
+     * @param props the udev properties of the device.
+     * @param aliases receives the aliases.
+     */
+    void readAliases( const MajorMinor &m, const UdevProperties &props, std::list< std::string > &aliases ) {
+      aliases.clear();
+      for ( std::list<std::string>::const_iterator l = props.getSymlinks().begin(); l != props.getSymlinks().end(); l++ ) {
+        struct stat st;
+        if ( !stat( (*l).c_str(), &st ) ) {
+          if ( st.st_rdev == m.getDevT() ) {
+            aliases.push_back( *l );
+          }
+        }
+      }
+    }
+
+    /**
+     * Cached udev properties of a device, with the identity of the udev database file
+     * it was loaded from. udev replaces the file on change, so a changed inode or mtime
+     * invalidates the entry.
+     */
+    struct UdevCacheEntry {
+      /** the parsed properties. */
+      std::shared_ptr<const UdevProperties> props;
+      /** inode of the udev database file. */
+      ino_t ino;
+      /** modification time of the udev database file. */
+      struct timespec mtime;
+    };
+
+    /** cache of udev properties by MajorMinor. */
+    std::map<MajorMinor,UdevCacheEntry> udev_cache;
+
+    /** device generation udev_cache was last pruned in. */
+    unsigned long udev_cache_generation = 0;
+
+    /** serializes access to udev_cache and udev_cache_generation. */
+    std::mutex udev_mutex;
+
+    /**
+     * Get the current device_cache snapshot, see below.
+     */
+    DeviceCachePtr syncCache();
+
+    /**
+     * Get the udev properties of a device, parsing the udev database file only when
+     * it was not seen before, or has been replaced. When devices were added or removed,
+     * the entries of devices that are gone are dropped, so the cache does not grow
+     * on hosts where devices come and go.
+     * @param m the device.
+     * @return the udev properties.
+     */
+    std::shared_ptr<const UdevProperties> getUdevProperties( const MajorMinor &m ) {
+      DeviceCachePtr cache = syncCache();
+      std::string udevp = m.getUDevPath();
+      struct stat st;
+      if ( stat( udevp.c_str(), &st ) ) return std::shared_ptr<const UdevProperties>( new UdevProperties() );
+      {
+        std::lock_guard<std::mutex> lock( udev_mutex );
+        if ( cache->generation != udev_cache_generation ) {
+          std::map<MajorMinor,UdevCacheEntry>::iterator e = udev_cache.begin();
+          while ( e != udev_cache.end() ) {
+            if ( cache->mm2name.find( e->first ) == cache->mm2name.end() ) udev_cache.erase( e++ );
+            else e++;
+          }
+          udev_cache_generation = cache->generation;
+        }
+        std::map<MajorMinor,UdevCacheEntry>::const_iterator i = udev_cache.find( m );
+        if ( i != udev_cache.end() && i->second.ino == st.st_ino &&
+             i->second.mtime.tv_sec == st.st_mtim.tv_sec && i->second.mtime.tv_nsec == st.st_mtim.tv_nsec )
+          return i->second.props;
+      }
+      UdevProperties *props = new UdevProperties();
+      props->load( udevp );
+      UdevCacheEntry entry;
+      entry.props = std::shared_ptr<const UdevProperties>( props );
+      entry.ino = st.st_ino;
+      entry.mtime = st.st_mtim;
+      std::lock_guard<std::mutex> lock( udev_mutex );
+      udev_cache[m] = entry;
+      return entry.props;
+    }
+
+    /**
+     * Bring the device_cache in line with diskstats_path. Devices already cached are
+     * left alone, only added devices have their devicefile resolved, and removed devices
+     * are dropped. A new snapshot is published only if devices were added or removed.
+     * The caller must hold cache_mutex.
+     * @return the current snapshot.
+     */
+    DeviceCachePtr buildCache() {
+      std::string path = diskstatsPath();
+      std::ifstream i( path.c_str() );
+      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '" + path + "'" );
+      std::map< MajorMinor, std::string > current;
+      unsigned int major, minor;
+      std::string device;
+      while ( i >> major >> minor >> device ) {
+        current[ MajorMinor( major, minor ) ] = device;
+        i.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      }
+      cache_age = steadyMillis();
+      DeviceCachePtr old = std::atomic_load( &device_cache );
+      if ( old && old->mm2name == current ) return old;
+      DeviceCache *cache = old ? new DeviceCache( *old ) : new DeviceCache();
+      cache->generation = old ? old->generation + 1 : 1;
+      //drop devices that have gone or have been renamed
+      std::map< MajorMinor, std::string >::iterator c = cache->mm2name.begin();
+      while ( c != cache->mm2name.end() ) {
+        std::map< MajorMinor, std::string >::const_iterator n = current.find( c->first );
+        if ( n == current.end() || n->second != c->second ) {
+          cache->name2mm.erase( c->second );
+          std::map< MajorMinor, std::string >::iterator f = cache->mm2file.find( c->first );
+          if ( f != cache->mm2file.end() ) {
+            cache->file2mm.erase( f->second );
+            cache->mm2file.erase( f );
+          }
+          cache->mm2name.erase( c++ );
+        } else c++;
+      }
+      //resolve devicefiles for new devices only
+      for ( std::map< MajorMinor, std::string >::const_iterator n = current.begin(); n != current.end(); n++ ) {
+        if ( cache->mm2name.find( n->first ) != cache->mm2name.end() ) continue;
+        cache->name2mm[ n->second ] = n->first;
+        cache->mm2name[ n->first ] = n->second;
+        //check devicefile
+        std::list<std::string> aliasses;
+        UdevProperties props;
+        props.load( udevPath( n->first, n->second ) );
+        readAliases( n->first, props, aliasses );
+        bool nodevice = true;
+        for ( std::list<std::string>::const_iterator a = aliasses.begin(); a != aliasses.end(); a++ ) {
+          std::string rp = util::realPath( *a );
+          if ( rp != "" ) {
+            cache->file2mm[ rp ] = n->first;
+            cache->mm2file[ n->first ] = rp;
+            nodevice = false;
+            break;
+          }
+        }
+        if ( nodevice ) {
+          std::string rp = "/dev/" + n->second;
+          cache->file2mm[ rp ] = n->first;
+          cache->mm2file[ n->first ] = rp;
+        }
+      }
+      DeviceCachePtr result( cache );
+      std::atomic_store( &device_cache, result );
+      return result;
+    }
+
+    /**
+     * Get the current device_cache snapshot, synchronized with block device changes.
+     * The first call sets up an inotify watch on /dev and /dev/mapper and builds the cache.
+     * Subsequent calls only drain the (non-blocking) watch, and update the cache
+     * when devices have been added or removed. So in steady state, no files are read.
+     * @return the current snapshot.
+     */
+    DeviceCachePtr syncCache() {
+      DeviceCachePtr cache = std::atomic_load( &device_cache );
+      if ( !cache ) {
+        std::lock_guard<std::mutex> lock( cache_mutex );
+        cache = std::atomic_load( &device_cache );
+        if ( cache ) return cache;
+        cache_watch = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+        if ( cache_watch >= 0 ) {
+          const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+          // devtmpfs adds and removes block device nodes in /dev, device mapper
+          // names appear in /dev/mapper.
+          if ( inotify_add_watch( cache_watch, "/dev", mask ) < 0 ) {
+            close( cache_watch );
+            cache_watch = -1;
+          } else {
+            inotify_add_watch( cache_watch, "/dev/mapper", mask );
+          }
+        }
+        return buildCache();
+      }
+      if ( cache_watch >= 0 ) {
+        char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        bool changed = false;
+        while ( read( cache_watch, buf, sizeof(buf) ) > 0 ) changed = true;
+        if ( changed ) {
+          std::lock_guard<std::mutex> lock( cache_mutex );
+          return buildCache();
+        }
+      }
+      return cache;
+    }
+
+    /**
+     * Decide whether a cache miss warrants a rebuild, which is at most once per second.
+     * This applies even if the inotify watch is active, as the watch may never fire, as in a
+     * container with a private /dev, so a miss is final only until the next rebuild is due.
+     * @return the rebuilt snapshot, or an empty pointer if not rebuilt.
+     */
+    DeviceCachePtr missCache() {
+      if ( steadyMillis() - cache_age < 1000 ) return DeviceCachePtr();
+      std::lock_guard<std::mutex> lock( cache_mutex );
+      if ( steadyMillis() - cache_age < 1000 ) return DeviceCachePtr();
+      return buildCache();
+    }
+
+    /**
+     * Get the current miss_cache snapshot if it applies to the generation.
+     * @param generation the device generation.
+     * @return the snapshot, or an empty pointer.
+     */
+    MissCachePtr getMisses( unsigned long generation ) {
+      MissCachePtr misses = std::atomic_load( &miss_cache );
+      if ( misses && misses->generation == generation ) return misses;
+      return MissCachePtr();
+    }
+
+    /**
+     * Copy the miss_cache snapshot for modification, the caller must hold cache_mutex
+     * and publish the copy.
+     * @param generation the device generation.
+     * @return a new MissCache, empty if the current one applies to another generation.
+     */
+    MissCache* copyMisses( unsigned long generation ) {
+      MissCachePtr misses = getMisses( generation );
+      MissCache *result = misses ? new MissCache( *misses ) : new MissCache();
+      result->generation = generation;
+      return result;
+    }
+
     /**
      * Detect the udevMode from the given MajorMinor and udev_path.
      */
@@ -164,98 +542,137 @@ namespace leanux {
             break;
         }
       }
-      dev_ = MKDEV( strtoul( smajor.c_str(), 0, 10 ), strtoul( sminor.c_str(), 0, 10 ) );
+      dev_ = makedev( strtoul( smajor.c_str(), 0, 10 ), strtoul( sminor.c_str(), 0, 10 ) );
       return *this;
     }
 
-    void MajorMinor::buildCache() {
-      name2mm_.clear();
-      mm2name_.clear();
-      std::ifstream i( "/proc/diskstats" );
-      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '/proc/diskstats'" );
-      unsigned int major, minor;
-      std::string device;
-      while ( i.good() ) {
-        i >> major >> minor >> device;
-        name2mm_[ device ] = MajorMinor( major, minor );
-        mm2name_[ MajorMinor( major, minor ) ] = device;
-        //check devicefile
-        std::list<std::string> aliasses;
-        MajorMinor( major, minor ).getAliases( aliasses );
-        bool nodevice = true;
-        for ( std::list<std::string>::const_iterator a = aliasses.begin(); a != aliasses.end(); a++ ) {
-          std::string rp = util::realPath( *a );
-          if ( rp != "" ) {
-            file2mm_[ rp ] = MajorMinor( major, minor );
-            mm2file_[ MajorMinor( major, minor ) ] = rp;
-            nodevice = false;
-            break;
-          }
-        }
-        if ( nodevice ) {
-          std::string rp = "/dev/" + device;
-          file2mm_[ rp ] = MajorMinor( major, minor );
-          mm2file_[ MajorMinor( major, minor ) ] = rp;
-        }
-
-        i.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-      }
-    }
-
     MajorMinor MajorMinor::getMajorMinorByName( const std::string& devicename ) {
-      std::map< std::string, MajorMinor >::const_iterator i = name2mm_.find( devicename );
-      if ( i != name2mm_.end() ) {
-        return i->second;
-      } else {
-        buildCache();
-        i = name2mm_.find( devicename );
-        if ( i != name2mm_.end() ) {
-          return i->second;
-        }
-      }
+      DeviceCachePtr cache = syncCache();
+      std::map< std::string, MajorMinor >::const_iterator i = cache->name2mm.find( devicename );
+      if ( i != cache->name2mm.end() ) return i->second;
+      DeviceCachePtr rebuilt = missCache();
+      if ( rebuilt ) {
+        cache = rebuilt;
+        i = cache->name2mm.find( devicename );
+        if ( i != cache->name2mm.end() ) return i->second;
+      }
+      MissCachePtr misses = getMisses( cache->generation );
+      if ( misses && misses->names.find( devicename ) != misses->names.end() ) return MajorMinor::invalid;
+      std::lock_guard<std::mutex> lock( cache_mutex );
+      MissCache *update = copyMisses( cache->generation );
+      update->names.insert( devicename );
+      std::atomic_store( &miss_cache, MissCachePtr( update ) );
       return MajorMinor::invalid;
     }
 
     MajorMinor MajorMinor::getMajorMinorByDeviceFile( const std::string& devicefile ) {
-      std::map< std::string, MajorMinor >::const_iterator i = file2mm_.find( devicefile );
-      if ( i != file2mm_.end() ) {
-        return i->second;
-      } else {
-        buildCache();
-        i = file2mm_.find( devicefile );
-        if ( i != file2mm_.end() ) {
-          return i->second;
-        }
-      }
+      DeviceCachePtr cache = syncCache();
+      std::map< std::string, MajorMinor >::const_iterator i = cache->file2mm.find( devicefile );
+      if ( i != cache->file2mm.end() ) return i->second;
+      DeviceCachePtr rebuilt = missCache();
+      if ( rebuilt ) {
+        cache = rebuilt;
+        i = cache->file2mm.find( devicefile );
+        if ( i != cache->file2mm.end() ) return i->second;
+      }
+      MissCachePtr misses = getMisses( cache->generation );
+      if ( misses && misses->files.find( devicefile ) != misses->files.end() ) return MajorMinor::invalid;
+      std::lock_guard<std::mutex> lock( cache_mutex );
+      MissCache *update = copyMisses( cache->generation );
+      update->files.insert( devicefile );
+      std::atomic_store( &miss_cache, MissCachePtr( update ) );
       return MajorMinor::invalid;
     }
 
     std::string MajorMinor::getNameByMajorMinor( const MajorMinor &m ) {
-      std::map< MajorMinor, std::string >::const_iterator i = mm2name_.find( m );
-      if ( i != mm2name_.end() ) {
-        return i->second;
-      } else {
-        buildCache();
-        i = mm2name_.find( m );
-        if ( i != mm2name_.end() ) {
-          return i->second;
-        }
-      }
+      DeviceCachePtr cache = syncCache();
+      std::map< MajorMinor, std::string >::const_iterator i = cache->mm2name.find( m );
+      if ( i != cache->mm2name.end() ) return i->second;
+      DeviceCachePtr rebuilt = missCache();
+      if ( rebuilt ) {
+        cache = rebuilt;
+        i = cache->mm2name.find( m );
+        if ( i != cache->mm2name.end() ) return i->second;
+      }
+      MissCachePtr misses = getMisses( cache->generation );
+      if ( misses && misses->mms.find( m ) != misses->mms.end() ) return "";
+      std::lock_guard<std::mutex> lock( cache_mutex );
+      MissCache *update = copyMisses( cache->generation );
+      update->mms.insert( m );
+      std::atomic_store( &miss_cache, MissCachePtr( update ) );
       return "";
     }
 
     std::string MajorMinor::getDeviceFileByMajorMinor( const MajorMinor &m ) {
-      std::map< MajorMinor, std::string >::const_iterator i = mm2file_.find( m );
-      if ( i != mm2file_.end() ) {
-        return i->second;
-      } else {
-        buildCache();
-        i = mm2file_.find( m );
-        if ( i != mm2file_.end() ) {
-          return i->second;
+      DeviceCachePtr cache = syncCache();
+      std::map< MajorMinor, std::string >::const_iterator i = cache->mm2file.find( m );
+      if ( i != cache->mm2file.end() ) return i->second;
+      DeviceCachePtr rebuilt = missCache();
+      if ( rebuilt ) {
+        cache = rebuilt;
+        i = cache->mm2file.find( m );
+        if ( i != cache->mm2file.end() ) return i->second;
+      }
+      MissCachePtr misses = getMisses( cache->generation );
+      if ( misses && misses->mms.find( m ) != misses->mms.end() ) return "";
+      std::lock_guard<std::mutex> lock( cache_mutex );
+      MissCache *update = copyMisses( cache->generation );
+      update->mms.insert( m );
+      std::atomic_store( &miss_cache, MissCachePtr( update ) );
+      return "";
+    }
+
+    void MajorMinor::refreshCache() {
+      syncCache();
+      std::lock_guard<std::mutex> lock( cache_mutex );
+      buildCache();
+    }
+
+    unsigned long MajorMinor::getGeneration() {
+      return syncCache()->generation;
+    }
+
+    DeviceDescriptor MajorMinor::getDescriptor( const MajorMinor &m ) {
+      unsigned long generation = getGeneration();
+      {
+        std::lock_guard<std::mutex> lock( descriptors_mutex );
+        if ( generation != descriptors_generation ) {
+          descriptors.clear();
+          descriptors_generation = generation;
         }
+        std::map< MajorMinor, DeviceDescriptor >::const_iterator i = descriptors.find( m );
+        if ( i != descriptors.end() ) return i->second;
+      }
+      DeviceDescriptor desc;
+      desc.name = getNameByMajorMinor( m );
+      desc.dclass = m.getClass();
+      desc.wholedisk = m.isWholeDisk();
+      desc.sectorsize = 0;
+      try {
+        desc.sectorsize = m.getSectorSize();
       }
-      return "";
+      catch ( const Oops &oops ) {
+      }
+      desc.model = m.getModel();
+      try {
+        desc.wwn = m.getWWN();
+      }
+      catch ( const Oops &oops ) {
+      }
+      desc.diskid = desc.name;
+      try {
+        desc.diskid = m.getDiskId();
+      }
+      catch ( const Oops &oops ) {
+      }
+      try {
+        desc.syspath = m.getSysPath();
+      }
+      catch ( const Oops &oops ) {
+      }
+      std::lock_guard<std::mutex> lock( descriptors_mutex );
+      if ( generation == descriptors_generation ) descriptors[m] = desc;
+      return desc;
     }
 
     /**
@@ -291,7 +708,7 @@ namespace leanux {
     unsigned long MajorMinor::getSCSIIODone() const {
       unsigned long result = 0;
       try {
-        result = util::fileReadHexString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/iodone_cnt" );
+        result = util::fileReadHexString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/iodone_cnt" );
       }
       catch ( Oops &oops ) {
       }
@@ -301,7 +718,7 @@ namespace leanux {
     unsigned long MajorMinor::getSCSIIORequest() const {
       unsigned long result = 0;
       try {
-        result = util::fileReadHexString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/iorequest_cnt" );
+        result = util::fileReadHexString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/iorequest_cnt" );
       }
       catch ( Oops &oops ) {
       }
@@ -311,7 +728,7 @@ namespace leanux {
     unsigned long MajorMinor::getSCSIIOError() const {
       unsigned long result = 0;
       try {
-        result = util::fileReadHexString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/ioerr_cnt" );
+        result = util::fileReadHexString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/ioerr_cnt" );
       }
       catch ( Oops &oops ) {
       }
@@ -319,13 +736,13 @@ namespace leanux {
     }
 
     MajorMinor MajorMinor::deriveWholeDisk( const MajorMinor& partition ) {
-      if ( isSCSIDisk( MAJOR(partition.dev_) ) ) {
-        return MajorMinor( MKDEV(MAJOR(partition.dev_), MINOR(partition.dev_) - MINOR(partition.dev_) % 16  ) );
-      } else if ( isIDEDisk( MAJOR(partition.dev_) ) ) {
-        return MajorMinor( MKDEV(MAJOR(partition.dev_), MINOR(partition.dev_) - MINOR(partition.dev_) % 64  ) );
-      } else if ( isVirtIODisk( MajorMinor( MAJOR(partition.dev_), 0 ) ) ) {
-        return MajorMinor( MKDEV(MAJOR(partition.dev_), MINOR(partition.dev_) - MINOR(partition.dev_) % 16  ) );
-      } else if ( isNVMeDisk( MajorMinor( MAJOR(partition.dev_), 0 ) ) ) {
+      if ( isSCSIDisk( major(partition.dev_) ) ) {
+        return MajorMinor( makedev(major(partition.dev_), minor(partition.dev_) - minor(partition.dev_) % 16  ) );
+      } else if ( isIDEDisk( major(partition.dev_) ) ) {
+        return MajorMinor( makedev(major(partition.dev_), minor(partition.dev_) - minor(partition.dev_) % 64  ) );
+      } else if ( isVirtIODisk( MajorMinor( major(partition.dev_), 0 ) ) ) {
+        return MajorMinor( makedev(major(partition.dev_), minor(partition.dev_) - minor(partition.dev_) % 16  ) );
+      } else if ( isNVMeDisk( MajorMinor( major(partition.dev_), 0 ) ) ) {
         std::string devname = getNameByMajorMinor( partition );
         unsigned int host = 0;
         unsigned int disk = 0;
@@ -462,9 +879,9 @@ namespace leanux {
     std::string MajorMinor::getSysPath() const {
       std::string devname = "";
       if ( isPartition() )
-        devname = "/sys/block/" + MajorMinor::deriveWholeDisk(*this).getName();
+        devname = util::SysFS::path( "block/" ) + MajorMinor::deriveWholeDisk(*this).getName();
       else
-        devname = "/sys/block/" + getName();
+        devname = util::SysFS::path( "block/" ) + getName();
       std::string resolved_path = util::realPath( devname );
       if ( resolved_path == devname) throw Oops( __FILE__, __LINE__, "realpath failed on'" + devname +"'" );
       else {
@@ -474,39 +891,39 @@ namespace leanux {
     }
 
     std::string MajorMinor::getSerial() const {
-      std::string file = "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/serial";
+      std::string file = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/serial";
       if ( util::fileReadAccess( file ) )
-        return util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/serial" );
-      else {
-        std::string udevp = getUDevPath();
-        std::ifstream i( udevp.c_str() );
-        std::string line = "";
-        std::string result = "";
-        while ( i.good() ) {
-          getline( i, line );
-          if ( strncmp( line.c_str(), "E:ID_SERIAL_SHORT=", 18 ) == 0 ) {
-            result = line.substr(18);
-            break;
-          }
-        }
-        return result;
-      }
+        return util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/serial" );
+      else
+        return getUdevProperty( "ID_SERIAL_SHORT" );
     }
 
     std::string MajorMinor::getUDevPath() const {
-      std::stringstream ss;
-      switch ( udev_mode ) {
-        case umBlockMM :
-          ss << "block" << *this;
-          break;
-        case umBMM :
-          ss << "b" << *this;
-          break;
-        case umBlockName :
-          ss << "block:" << MajorMinor::getNameByMajorMinor( *this );
-          break;
+      if ( udev_mode == umBlockName )
+        return udevPath( *this, MajorMinor::getNameByMajorMinor( *this ) );
+      else
+        return udevPath( *this, "" );
+    }
+
+    std::string MajorMinor::getUdevProperty( const std::string &key ) const {
+      return getUdevProperties( *this )->get( key );
+    }
+
+    bool UdevProperties::load( const std::string &file ) {
+      properties_.clear();
+      symlinks_.clear();
+      std::ifstream i( file.c_str() );
+      if ( !i.good() ) return false;
+      std::string line = "";
+      while ( getline( i, line ) ) {
+        if ( strncmp( line.c_str(), "E:", 2 ) == 0 ) {
+          size_t p = line.find( '=', 2 );
+          if ( p != std::string::npos ) properties_[ line.substr( 2, p - 2 ) ] = line.substr( p + 1 );
+        } else if ( strncmp( line.c_str(), "S:", 2 ) == 0 ) {
+          symlinks_.push_back( "/dev/" + line.substr(2) );
+        }
       }
-      return udev_path + ss.str();
+      return true;
     }
 
     bool MajorMinor::getRotational() const {
@@ -515,7 +932,7 @@ namespace leanux {
       MajorMinor mm = *this;
       if ( isPartition() ) mm = MajorMinor::deriveWholeDisk(*this);
       try {
-        result = util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(mm) + "/queue/rotational" )[0] == '1';
+        result = util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(mm) + "/queue/rotational" )[0] == '1';
       }
       catch ( Oops & oops ) {
       }
@@ -533,12 +950,12 @@ namespace leanux {
 
     unsigned long MajorMinor::getSectorSize() const {
       MajorMinor wholedisk = MajorMinor::deriveWholeDisk( *this );
-      return util::fileReadUL( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(wholedisk) + "/queue/hw_sector_size" );
+      return util::fileReadUL( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(wholedisk) + "/queue/hw_sector_size" );
     }
 
     std::string MajorMinor::getRevision() const {
       try {
-        std::string result =  util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/rev" );
+        std::string result =  util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/rev" );
         return result;
       }
       catch ( const leanux::Oops &oops ) {
@@ -547,13 +964,13 @@ namespace leanux {
     }
 
     unsigned long MajorMinor::getSize() const {
-      return util::fileReadUL( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/size" ) * 512UL;
+      return util::fileReadUL( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/size" ) * 512UL;
     }
 
     std::string MajorMinor::getDMName() const {
       std::string result = "";
       try {
-        result = util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/dm/name" );
+        result = util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/dm/name" );
       }
       catch ( Oops &oops ) {
       }
@@ -563,7 +980,7 @@ namespace leanux {
     std::string MajorMinor::getDMUUID() const {
       std::string result = "";
       try {
-        result = util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/dm/uuid" );
+        result = util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/dm/uuid" );
       }
       catch ( Oops &oops ) {
       }
@@ -571,49 +988,27 @@ namespace leanux {
     }
 
     std::string MajorMinor::getDMTargetTypes() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      std::string result = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:DM_TARGET_TYPES=", 18 ) == 0 ) {
-          result = line.substr(18);
-          break;
-        }
-      }
-      return result;
+      return getUdevProperty( "DM_TARGET_TYPES" );
     }
 
     std::string MajorMinor::getModel() const {
-      std::string file = "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/model";
+      std::string file = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/model";
       if ( util::fileReadAccess( file ) )
         return util::fileReadString( file );
-      else {
-        std::string udevp = getUDevPath();
-        std::ifstream i( udevp.c_str() );
-        std::string line = "";
-        std::string result = "";
-        while ( i.good() ) {
-          getline( i, line );
-          if ( strncmp( line.c_str(), "E:ID_MODEL=", 11 ) == 0 ) {
-            result = line.substr(11);
-          }
-        }
-        return result;
-      }
+      else
+        return getUdevProperty( "ID_MODEL" );
     }
 
     std::string MajorMinor::getKernelModule() const {
       std::string devname  = MajorMinor::getNameByMajorMinor( *this );
       std::string result = "";
       try {
-        result = util::fileReadString( "/sys/block/" + devname + "/device/modalias" );
+        result = util::fileReadString( util::SysFS::path( "block/" ) + devname + "/device/modalias" );
       }
       catch ( const Oops& oops ) {
         //oddity in nvme devices
         try {
-          result = util::fileReadString( "/sys/block/" + devname + "/device/device/modalias" );
+          result = util::fileReadString( util::SysFS::path( "block/" ) + devname + "/device/device/modalias" );
         }
         catch ( const Oops& oops ) {
           return "";
@@ -623,101 +1018,36 @@ namespace leanux {
     }
 
     unsigned long MajorMinor::getRPM() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      unsigned long result = 0;
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:ID_ATA_ROTATION_RATE_RPM=", 27 ) == 0 ) {
-          result = strtoul( line.substr(27).c_str(),  0, 10 );
-          break;
-        }
-      }
-      return result;
+      return strtoul( getUdevProperty( "ID_ATA_ROTATION_RATE_RPM" ).c_str(), 0, 10 );
     }
 
     std::string MajorMinor::getFSType() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
+      std::shared_ptr<const UdevProperties> props = getUdevProperties( *this );
       std::string result = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:ID_FS_TYPE=", 13 ) == 0 ) {
-          result = line.substr(13).c_str();
-          if ( result == "" ) result = "block device";
-          break;
-        }
+      if ( props->has( "ID_FS_TYPE" ) ) {
+        result = props->get( "ID_FS_TYPE" );
+        if ( result == "" ) result = "block device";
       }
       return result;
     }
 
     std::string MajorMinor::getFSUsage() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      std::string result = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:ID_FS_USAGE=", 14 ) == 0 ) {
-          result = line.substr(14).c_str();
-          break;
-        }
-      }
-      return result;
+      return getUdevProperty( "ID_FS_USAGE" );
     }
 
     std::string MajorMinor::getVGName() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      std::string result = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:DM_VG_NAME=", 13 ) == 0 ) {
-          result = line.substr(13).c_str();
-          break;
-        }
-      }
-      return result;
+      return getUdevProperty( "DM_VG_NAME" );
     }
 
     std::string MajorMinor::getLVName() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      std::string result = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:DM_LV_NAME=", 13 ) == 0 ) {
-          result = line.substr(13).c_str();
-          break;
-        }
-      }
-      return result;
+      return getUdevProperty( "DM_LV_NAME" );
     }
 
     bool MajorMinor::getLVMInfo( std::string &vgname, std::string& lvname ) const {
-      vgname = "";
-      lvname = "";
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      std::string result = "";
-      int found = 0;
-      while ( i.good() && found < 2 ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:DM_VG_NAME=", 13 ) == 0 ) {
-          vgname = line.substr(13).c_str();
-          found++;
-        } else
-        if ( strncmp( line.c_str(), "E:DM_LV_NAME=", 13 ) == 0 ) {
-          lvname = line.substr(13).c_str();
-          found++;
-        }
-      }
-      return found == 2;
+      std::shared_ptr<const UdevProperties> props = getUdevProperties( *this );
+      vgname = props->get( "DM_VG_NAME" );
+      lvname = props->get( "DM_LV_NAME" );
+      return props->has( "DM_VG_NAME" ) && props->has( "DM_LV_NAME" );
     }
 
     std::string MajorMinor::getLVMPV2VG() const {
@@ -736,36 +1066,25 @@ namespace leanux {
     }
 
     std::string MajorMinor::getMDLevel() const {
-      return util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/md/level" );
+      return util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/md/level" );
     }
 
     std::string MajorMinor::getMDName() const {
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      std::string result = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "E:MD_NAME=", 10 ) == 0 ) {
-          result = line.substr(10).c_str();
-          break;
-        }
-      }
-      return result;
+      return getUdevProperty( "MD_NAME" );
     }
 
     unsigned long MajorMinor::getMDChunkSize() const {
-      return util::fileReadUL( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/md/chunk_size" );
+      return util::fileReadUL( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/md/chunk_size" );
     }
 
     std::string MajorMinor::getIOScheduler() const {
       std::string devname  = MajorMinor::getNameByMajorMinor( *this );
-      std::string path = "/sys/class/block/" + devname + "/queue/scheduler";
+      std::string path = util::SysFS::path( "class/block/" ) + devname + "/queue/scheduler";
       if ( !util::fileReadAccess( path) ) {
         if ( isPartition() ) {
           MajorMinor mm = MajorMinor::deriveWholeDisk(*this);
           devname  = MajorMinor::getNameByMajorMinor( mm );
-          path = "/sys/class/block/" + devname + "/queue/scheduler";
+          path = util::SysFS::path( "class/block/" ) + devname + "/queue/scheduler";
           if ( !util::fileReadAccess( path)  ) return "?";
         } else return "?";
       }
@@ -777,24 +1096,24 @@ namespace leanux {
     }
 
     std::string MajorMinor::getMDMetaDataVersion() const {
-      return util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/md/metadata_version" );
+      return util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/md/metadata_version" );
     }
 
     std::string MajorMinor::getMDArrayState() const {
-      return util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/md/array_state" );
+      return util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/md/array_state" );
     }
 
     void MajorMinor::getMDRaidDisks( std::vector<MajorMinor> &disks ) const {
       disks.clear();
       std::string devname = MajorMinor::getNameByMajorMinor(*this);
-      std::string path = "/sys/class/block/" + devname + "/md/";
+      std::string path = util::SysFS::path( "class/block/" ) + devname + "/md/";
       DIR *d;
       struct dirent *dir;
       d = opendir( path.c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strncmp( dir->d_name, "dev-", 4 ) == 0 ) {
-            std::string dev = util::fileReadString( "/sys/class/block/" + devname + "/md/" + dir->d_name + "/block/dev" );
+            std::string dev = util::fileReadString( util::SysFS::path( "class/block/" ) + devname + "/md/" + dir->d_name + "/block/dev" );
             disks.push_back( MajorMinor( dev ) );
           }
         }
@@ -807,7 +1126,7 @@ namespace leanux {
       std::vector<MajorMinor> disks;
       getMDRaidDisks( disks );
       std::string devname = MajorMinor::getNameByMajorMinor(*this);
-      std::string path = "/sys/class/block/" + devname + "/md/";
+      std::string path = util::SysFS::path( "class/block/" ) + devname + "/md/";
       for ( unsigned long i = 0; i < disks.size(); i++ ) {
         std::stringstream p;
         p << path << "dev-" << disks[i].getName() << "/state";
@@ -826,37 +1145,22 @@ namespace leanux {
     }
 
     unsigned long MajorMinor::getMDDevices() const {
-      return util::fileReadUL( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/md/raid_disks" );
+      return util::fileReadUL( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/md/raid_disks" );
     }
 
     void MajorMinor::getAliases( std::list< std::string > &aliases ) const {
-      aliases.clear();
-      std::string udevp = getUDevPath();
-      std::ifstream i( udevp.c_str() );
-      std::string line = "";
-      while ( i.good() ) {
-        getline( i, line );
-        if ( strncmp( line.c_str(), "S:", 2 ) == 0 ) {
-          std::string dev = "/dev/" + line.substr(2);
-          struct stat st;
-          if ( !stat( dev.c_str(), &st ) ) {
-            if ( st.st_rdev == getDevT() ) {
-              aliases.push_back( "/dev/" + line.substr(2) );
-            }
-          }
-        }
-      }
+      readAliases( *this, *getUdevProperties( *this ), aliases );
     }
 
     std::string MajorMinor::getSCSIHCTL() const {
-      std::string path = "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/device/scsi_disk";
+      std::string path = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/device/scsi_disk";
       return util::findDir( path, "" );
     }
 
     std::string MajorMinor::getCacheMode() const {
       try {
         std::string devname  = MajorMinor::getNameByMajorMinor( *this );
-        std::string path = "/sys/class/block/" + devname + "/device/scsi_disk/" + getSCSIHCTL() + "/cache_type";
+        std::string path = util::SysFS::path( "class/block/" ) + devname + "/device/scsi_disk/" + getSCSIHCTL() + "/cache_type";
         return util::fileReadString( path );
       }
       catch ( const Oops &oops ) {
@@ -866,24 +1170,24 @@ namespace leanux {
 
     unsigned long MajorMinor::getMaxHWIOSize() const {
       std::string devname  = MajorMinor::getNameByMajorMinor( *this );
-      return 1024 * util::fileReadUL( "/sys/class/block/" + devname + "/queue/max_hw_sectors_kb" );
+      return 1024 * util::fileReadUL( util::SysFS::path( "class/block/" ) + devname + "/queue/max_hw_sectors_kb" );
     }
 
     unsigned long MajorMinor::getMaxIOSize() const {
       std::string devname  = MajorMinor::getNameByMajorMinor( *this );
-      return 1024 * util::fileReadUL( "/sys/class/block/" + devname + "/queue/max_sectors_kb" );
+      return 1024 * util::fileReadUL( util::SysFS::path( "class/block/" ) + devname + "/queue/max_sectors_kb" );
     }
 
     unsigned long MajorMinor::getMinIOSize() const {
       std::string devname  = MajorMinor::getNameByMajorMinor( *this );
-      return util::fileReadUL( "/sys/class/block/" + devname + "/queue/minimum_io_size" );
+      return util::fileReadUL( util::SysFS::path( "class/block/" ) + devname + "/queue/minimum_io_size" );
     }
 
     unsigned long MajorMinor::getReadAhead() const {
       MajorMinor mm = *this;
       if ( mm.isPartition() ) mm = MajorMinor::deriveWholeDisk(*this);
       std::string devname  = MajorMinor::getNameByMajorMinor( mm );
-      return 1024 * util::fileReadUL( "/sys/class/block/" + devname + "/queue/read_ahead_kb" );
+      return 1024 * util::fileReadUL( util::SysFS::path( "class/block/" ) + devname + "/queue/read_ahead_kb" );
     }
 
     std::string MajorMinor::getATAPort() const {
@@ -900,27 +1204,16 @@ namespace leanux {
 
     std::string MajorMinor::getWWN() const {
       if ( isNVMeDisk(*this ) ) {
-        return util::fileReadString( "/sys/class/block/" + MajorMinor::getNameByMajorMinor(*this) + "/wwid" );
+        return util::fileReadString( util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor(*this) + "/wwid" );
       } else {
-        std::string udevp = getUDevPath();
-        std::ifstream i( udevp.c_str() );
-        std::string line = "";
-        std::string result = "";
-        while ( i.good() ) {
-          getline( i, line );
-          if ( strncmp( line.c_str(), "E:ID_WWN_WITH_EXTENSION=", 24 ) == 0 ) {
-            result = line.substr(24);
-            break;
-          }
-        }
-        return result;
+        return getUdevProperty( "ID_WWN_WITH_EXTENSION" );
       }
     }
 
     void MajorMinor::getPartitions( std::list< std::string > &partitions ) const {
       partitions.clear();
       std::string devname = MajorMinor::getNameByMajorMinor(*this);
-      std::string path = "/sys/class/block/" + devname;
+      std::string path = util::SysFS::path( "class/block/" ) + devname;
       DIR *d;
       struct dirent *dir;
       d = opendir( path.c_str() );
@@ -948,14 +1241,14 @@ namespace leanux {
 
     std::string getATAPortLink( const std::string& ata_port ) {
       std::string result = "";
-      std::string path = "/sys/class/ata_port/" + ata_port + "/device/";
+      std::string path = util::SysFS::path( "class/ata_port/" ) + ata_port + "/device/";
       result = util::findDir( path, "link" );
       return result;
     }
 
     std::string getATALinkSpeed( const std::string& ata_port, const std::string& ata_link ) {
       std::string result = "";
-      std::string path = "/sys/class/ata_port/" + ata_port + "/device/" + ata_link + "/ata_link/" + ata_link + "/sata_spd";
+      std::string path = util::SysFS::path( "class/ata_port/" ) + ata_port + "/device/" + ata_link + "/ata_link/" + ata_link + "/sata_spd";
       result = util::fileReadString( path );
       return result;
     }
@@ -1029,54 +1322,92 @@ namespace leanux {
       else return MajorMinor( major(st.st_rdev), minor(st.st_rdev) );
     }
 
-    void enumMounts( std::map<MajorMinor,MountInfo> &mounts ) {
-      mounts.clear();
-      std::ifstream pm( "/proc/mounts" );
-      while ( pm.good() ) {
+    /**
+     * Parse /proc/self/mountinfo (from the start of the open file descriptor) into a new MountTable.
+     * Lines look like
+     * '36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue',
+     * where 98:0 is the MajorMinor of the filesystem. Filesystems without a
+     * backing block device report major 0, for which (as btrfs does) the MajorMinor is resolved
+     * from the mount source instead.
+     * @param fd the open /proc/self/mountinfo file descriptor.
+     * @return the new MountTable.
+     */
+    MountTable* parseMountInfo( int fd ) {
+      MountTable *table = new MountTable();
+      table->generation = MajorMinor::getGeneration();
+      std::string content = "";
+      char buf[65536];
+      ssize_t r = 0;
+      if ( lseek( fd, 0, SEEK_SET ) == 0 ) {
+        while ( ( r = read( fd, buf, sizeof(buf) ) ) > 0 ) content.append( buf, r );
+      }
+      std::istringstream is( content );
+      std::string line;
+      while ( getline( is, line ) ) {
+        std::istringstream ls( line );
+        std::string id, parent, mm, root, options, field;
         MountInfo temp;
-        int dummy;
-        pm >> temp.device;
-        pm >> temp.mountpoint;
-        pm >> temp.fstype;
-        pm >> temp.attrs;
-        pm >> dummy;
-        pm >> dummy;
-
-        if ( temp.device.length() > 0 && temp.device[0] == '/' ) {
-          MajorMinor m = getFileMajorMinor( temp.device );
-          // hack for btrfs quirk
-          if ( temp.fstype == "btrfs" ) temp.mountpoint = "btrfs:" + m.getName();
-          if ( m.isValid() && mounts.find(m) == mounts.end() ) {
-            mounts[m] = temp;
-          }
+        ls >> id >> parent >> mm >> root >> temp.mountpoint >> options;
+        // skip optional fields up to the separator
+        while ( ls >> field && field != "-" );
+        std::string superoptions;
+        ls >> temp.fstype >> temp.device >> superoptions;
+        if ( temp.device.length() == 0 || temp.device[0] != '/' ) continue;
+        // /proc/mounts style attributes, the per-mount options followed by the superblock options
+        temp.attrs = options;
+        size_t p = superoptions.find( ',' );
+        if ( p != std::string::npos ) temp.attrs += superoptions.substr( p );
+        unsigned int major = 0, minor = 0;
+        if ( sscanf( mm.c_str(), "%u:%u", &major, &minor ) != 2 ) continue;
+        MajorMinor m( major, minor );
+        if ( major == 0 ) m = getFileMajorMinor( temp.device );
+        // hack for btrfs quirk
+        if ( temp.fstype == "btrfs" ) temp.mountpoint = "btrfs:" + m.getName();
+        if ( m.isValid() && table->mounts.find(m) == table->mounts.end() ) {
+          table->mounts[m] = temp;
         }
       }
+      return table;
     }
 
-    void enumMounts( std::map<MajorMinor,MountInfo> &mounts, std::map<std::string,MajorMinor> &devicefilecache ) {
-      mounts.clear();
-      std::ifstream pm( "/proc/mounts" );
-      while ( pm.good() ) {
-        MountInfo temp;
-        int dummy;
-        pm >> temp.device;
-        pm >> temp.mountpoint;
-        pm >> temp.fstype;
-        pm >> temp.attrs;
-        pm >> dummy;
-        pm >> dummy;
-        if ( temp.device.length() > 0 && temp.device[0] == '/' ) {
-          std::map<std::string,MajorMinor>::const_iterator icache = devicefilecache.find(temp.device);
-          MajorMinor m = MajorMinor::invalid;
-          if ( icache == devicefilecache.end() ) {
-            m = getFileMajorMinor( temp.device );
-            devicefilecache[temp.device] = m;
-          } else m = icache->second;
-          // hack for btrfs quirk
-          if ( temp.fstype == "btrfs" ) temp.mountpoint = "btrfs:" + m.getName();
-          if ( m.isValid() && mounts.find(m) == mounts.end() ) mounts[m] = temp;
-        }
-      }
+    /**
+     * Get the current mount table, synchronized with mount table changes. The kernel
+     * signals POLLPRI on /proc/self/mountinfo when the mount table changes, so the table is
+     * only reparsed when the kernel signals a change, or the device generation changed. When
+     * util::setPseudoFSRoot moved /proc, the watch is reopened below the new root.
+     * @return the current MountTable.
+     */
+    MountTablePtr syncMountTable() {
+      MountTablePtr table = std::atomic_load( &mount_table );
+      if ( table ) {
+        struct pollfd pfd;
+        pfd.fd = mount_watch;
+        pfd.events = POLLPRI;
+        pfd.revents = 0;
+        bool changed = poll( &pfd, 1, 0 ) > 0 && ( pfd.revents & ( POLLPRI | POLLERR ) );
+        if ( !changed && table->generation == MajorMinor::getGeneration() &&
+             table->path == util::ProcFS::path( "self/mountinfo" ) ) return table;
+      }
+      std::lock_guard<std::mutex> lock( mount_mutex );
+      std::string path = util::ProcFS::path( "self/mountinfo" );
+      if ( mount_watch >= 0 && mount_watch_path != path ) {
+        close( mount_watch );
+        mount_watch = -1;
+      }
+      if ( mount_watch < 0 ) {
+        mount_watch = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+        if ( mount_watch < 0 ) throw Oops( __FILE__, __LINE__, errno );
+        mount_watch_path = path;
+      }
+      MountTable *parsed = parseMountInfo( mount_watch );
+      parsed->path = path;
+      table = MountTablePtr( parsed );
+      std::atomic_store( &mount_table, table );
+      return table;
+    }
+
+    void enumMounts( std::map<MajorMinor,MountInfo> &mounts ) {
+      mounts = syncMountTable()->mounts;
     }
 
     std::string MajorMinor::getDiskId() const {
@@ -1090,8 +1421,9 @@ namespace leanux {
     }
 
     void enumDevices( std::list<MajorMinor> &devices ) {
-      std::ifstream i( "/proc/diskstats" );
-      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '/proc/diskstats'" );
+      std::string path = diskstatsPath();
+      std::ifstream i( path.c_str() );
+      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '" + path + "'" );
       int major, minor;
       devices.clear();
       while ( i.good() && ! i.eof() ) {
@@ -1103,8 +1435,9 @@ namespace leanux {
     }
 
     void enumDevices( std::list<MajorMinor> &devices, DeviceClass t ) {
-      std::ifstream i( "/proc/diskstats" );
-      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '/proc/diskstats'" );
+      std::string path = diskstatsPath();
+      std::ifstream i( path.c_str() );
+      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '" + path + "'" );
       int major, minor;
       devices.clear();
       while ( i.good() && ! i.eof() ) {
@@ -1127,8 +1460,9 @@ namespace leanux {
     }
 
     void enumWholeDisks( std::list<MajorMinor> &devices ) {
-      std::ifstream i( "/proc/diskstats" );
-      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '/proc/diskstats'" );
+      std::string path = diskstatsPath();
+      std::ifstream i( path.c_str() );
+      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '" + path + "'" );
       int major, minor;
       devices.clear();
       while ( i.good() && ! i.eof() ) {
@@ -1170,10 +1504,10 @@ namespace leanux {
       std::string path;
       if ( isPartition() ) {
         MajorMinor whole = MajorMinor::deriveWholeDisk( *this );
-        path = "/sys/class/block/" + MajorMinor::getNameByMajorMinor( whole ) + "/" + devname;
+        path = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor( whole ) + "/" + devname;
       }
       else {
-        path = "/sys/class/block/" + devname;
+        path = util::SysFS::path( "class/block/" ) + devname;
       }
       path += "/holders";
       DIR *d;
@@ -1196,10 +1530,10 @@ namespace leanux {
       std::string path;
       if ( isPartition() ) {
         MajorMinor whole = MajorMinor::deriveWholeDisk( *this );
-        path = "/sys/class/block/" + MajorMinor::getNameByMajorMinor( whole );
+        path = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor( whole );
       }
       else {
-        path = "/sys/class/block/" + devname;
+        path = util::SysFS::path( "class/block/" ) + devname;
       }
       path += "/slaves";
       DIR *d;
@@ -1216,55 +1550,85 @@ namespace leanux {
       slaves.sort();
     }
 
+    /**
+     * Parse the statistics fields of a block device, as in /proc/diskstats after the device name,
+     * or in the sysfs stat attribute. Linux 4.18 appended 4 discard fields to the 11 original
+     * fields, Linux 5.5 appended 2 flush fields. Fields absent in the running kernel are set to 0.
+     * @param line the fields.
+     * @param stats the DeviceStats to fill, except for the SCSI and inflight counters.
+     * @return false if the line has less than the 11 original fields.
+     */
+    bool parseStatFields( const char *line, DeviceStats &stats ) {
+      unsigned long *fields[] = {
+        &stats.reads, &stats.reads_merged, &stats.read_sectors, &stats.read_ms,
+        &stats.writes, &stats.writes_merged, &stats.write_sectors, &stats.write_ms,
+        &stats.io_in_progress, &stats.io_ms, &stats.io_weighted_ms,
+        &stats.discards, &stats.discards_merged, &stats.discard_sectors, &stats.discard_ms,
+        &stats.flushes, &stats.flush_ms };
+      const size_t nfields = sizeof(fields)/sizeof(fields[0]);
+      size_t parsed = 0;
+      const char *p = line;
+      for ( ; parsed < nfields; parsed++ ) {
+        char *e = 0;
+        unsigned long v = strtoul( p, &e, 10 );
+        if ( e == p ) break;
+        *fields[parsed] = v;
+        p = e;
+      }
+      for ( size_t f = parsed; f < nfields; f++ ) *fields[f] = 0;
+      return parsed >= 11;
+    }
+
+    /**
+     * Read the number of reads and writes in flight from the sysfs inflight attribute of a device.
+     * Both are set to 0 if the attribute cannot be read.
+     * @param name the device name.
+     * @param stats the DeviceStats to set inflight_reads and inflight_writes of.
+     */
+    void readInflight( const std::string &name, DeviceStats &stats ) {
+      stats.inflight_reads = 0;
+      stats.inflight_writes = 0;
+      const char *buf = util::SysFS::block().read( ( name + "/inflight" ).c_str() );
+      if ( !buf ) return;
+      if ( sscanf( buf, "%lu %lu", &stats.inflight_reads, &stats.inflight_writes ) != 2 ) {
+        stats.inflight_reads = 0;
+        stats.inflight_writes = 0;
+      }
+    }
+
     bool MajorMinor::getStats( DeviceStats& stats ) const {
-      std::string path = getSysPath() + "/stat";
-      std::ifstream i( path.c_str() );
-      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '" + getSysPath() + "'" );
-      i >> stats.reads;
-      i >> stats.reads_merged;
-      i >> stats.read_sectors;
-      i >> stats.read_ms;
-      i >> stats.writes;
-      i >> stats.writes_merged;
-      i >> stats.write_sectors;
-      i >> stats.write_ms;
-      i >> stats.io_in_progress;
-      i >> stats.io_ms;
-      i >> stats.io_weighted_ms;
+      // /sys/class/block has an entry for partitions as well, with their own stat
+      std::string path = getName() + "/stat";
+      const char *line = util::SysFS::block().read( path.c_str() );
+      if ( !line ) throw Oops( __FILE__, __LINE__, "failed to open '" + util::SysFS::block().getDir() + "/" + path + "'" );
+      if ( !*line ) return false;
+      bool ok = parseStatFields( line, stats );
       stats.iodone_cnt = getSCSIIODone();
       stats.iorequest_cnt = getSCSIIORequest();
       stats.ioerr_cnt = getSCSIIOError();
-      return i.good();
+      readInflight( MajorMinor::getNameByMajorMinor(*this), stats );
+      return ok;
     }
 
     void getStats( DeviceStatsMap &statsmap ) {
       statsmap.clear();
-      std::ifstream i( "/proc/diskstats" );
-      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '/proc/diskstats'" );
-      unsigned long major, minor;
-      std::string devname;
-      while ( i.good() && ! i.eof() ) {
+      std::string path = diskstatsPath();
+      std::ifstream i( path.c_str() );
+      if ( !i.good() ) throw Oops( __FILE__, __LINE__, "failed to open '" + path + "'" );
+      std::string line;
+      while ( getline( i, line ) ) {
+        unsigned long major, minor;
+        char devname[64];
+        int offset = 0;
+        if ( sscanf( line.c_str(), "%lu %lu %63s %n", &major, &minor, devname, &offset ) < 3 || offset == 0 ) continue;
         DeviceStats stats;
-        i >> major >> minor >> devname;
-        if ( i.good() ) {
-          i >> stats.reads;
-          i >> stats.reads_merged;
-          i >> stats.read_sectors;
-          i >> stats.read_ms;
-          i >> stats.writes;
-          i >> stats.writes_merged;
-          i >> stats.write_sectors;
-          i >> stats.write_ms;
-          i >> stats.io_in_progress;
-          i >> stats.io_ms;
-          i >> stats.io_weighted_ms;
-          MajorMinor mm( major, minor );
-          stats.iodone_cnt = mm.getSCSIIODone();
-          stats.iorequest_cnt = mm.getSCSIIORequest();
-          stats.ioerr_cnt = mm.getSCSIIOError();
-          statsmap[ mm ] = stats;
-        }
-        i.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        if ( !parseStatFields( line.c_str() + offset, stats ) ) continue;
+        MajorMinor mm( major, minor );
+        stats.iodone_cnt = mm.getSCSIIODone();
+        stats.iorequest_cnt = mm.getSCSIIORequest();
+        stats.ioerr_cnt = mm.getSCSIIOError();
+        readInflight( devname, stats );
+        statsmap[ mm ] = stats;
       }
     }
 
@@ -1282,7 +1646,12 @@ namespace leanux {
                s2->second.writes_merged >= s1->second.writes_merged &&
                s2->second.write_sectors >= s1->second.write_sectors &&
                s2->second.write_ms >= s1->second.write_ms &&
-               s2->second.io_ms >= s1->second.io_ms
+               s2->second.io_ms >= s1->second.io_ms &&
+               s2->second.discards >= s1->second.discards &&
+               s2->second.discard_sectors >= s1->second.discard_sectors &&
+               s2->second.discard_ms >= s1->second.discard_ms &&
+               s2->second.flushes >= s1->second.flushes &&
+               s2->second.flush_ms >= s1->second.flush_ms
             ) {
             delta[s1->first].reads = s2->second.reads - s1->second.reads;
             delta[s1->first].reads_merged = s2->second.reads_merged - s1->second.reads_merged;
@@ -1298,6 +1667,15 @@ namespace leanux {
             delta[s1->first].iodone_cnt = s2->second.iodone_cnt - s1->second.iodone_cnt;
             delta[s1->first].iorequest_cnt = s2->second.iorequest_cnt - s1->second.iorequest_cnt;
             delta[s1->first].ioerr_cnt = s2->second.ioerr_cnt - s1->second.ioerr_cnt;
+            delta[s1->first].discards = s2->second.discards - s1->second.discards;
+            delta[s1->first].discards_merged = s2->second.discards_merged - s1->second.discards_merged;
+            delta[s1->first].discard_sectors = s2->second.discard_sectors - s1->second.discard_sectors;
+            delta[s1->first].discard_ms = s2->second.discard_ms - s1->second.discard_ms;
+            delta[s1->first].flushes = s2->second.flushes - s1->second.flushes;
+            delta[s1->first].flush_ms = s2->second.flush_ms - s1->second.flush_ms;
+            // in flight counts are not cumulative, the delta has the later values
+            delta[s1->first].inflight_reads = s2->second.inflight_reads;
+            delta[s1->first].inflight_writes = s2->second.inflight_writes;
             vec.push_back( s2->first );
           }
         }
@@ -1313,9 +1691,274 @@ namespace leanux {
       } else return m1 < m2;
     }
 
-    unsigned long getMountUsedBytes() {
-      unsigned long result = 0;
-      std::ifstream pm( "/proc/mounts" );
+    void getBDIStats( BDIStatsMap &statsmap ) {
+      statsmap.clear();
+      std::string bdi = bdistatsPath();
+      DIR *d = opendir( bdi.c_str() );
+      if ( !d ) return;
+      struct dirent *entry = 0;
+      while ( ( entry = readdir( d ) ) ) {
+        // BDI's of block devices are named major:minor, others (nfs, fuse) have major 0
+        unsigned int major = 0, minor = 0;
+        if ( sscanf( entry->d_name, "%u:%u", &major, &minor ) != 2 || major == 0 ) continue;
+        std::ifstream i( ( bdi + "/" + entry->d_name + "/stats" ).c_str() );
+        if ( !i.good() ) continue;
+        BDIStats stats;
+        memset( &stats, 0, sizeof(stats) );
+        std::string key;
+        unsigned long value;
+        // lines as in 'BdiWriteback:            0 kB'
+        while ( i >> key >> value ) {
+          if ( key == "BdiWriteback:" ) stats.writeback = value * 1024;
+          else if ( key == "BdiReclaimable:" ) stats.reclaimable = value * 1024;
+          else if ( key == "BdiDirtyThresh:" ) stats.dirty_thresh = value * 1024;
+          else if ( key == "BdiDirtied:" ) stats.dirtied = value * 1024;
+          else if ( key == "BdiWritten:" ) stats.written = value * 1024;
+          else if ( key == "BdiWriteBandwidth:" ) stats.write_bandwidth = value * 1024;
+          i.ignore( std::numeric_limits<std::streamsize>::max(), '\n' );
+        }
+        statsmap[ MajorMinor( major, minor ) ] = stats;
+      }
+      closedir( d );
+    }
+
+    /**
+     * Parse the 'per-op statistics' line of an NFS operation, such as
+     * '        READ: 1024 1024 0 135168 4327424 12 380 401' where the fields after the
+     * operation name are NFSOpStats::ops up to NFSOpStats::execute_ms. Newer kernels append
+     * more fields, which are ignored.
+     * @param p start of the line.
+     * @param eol end of the line.
+     * @param ops the NFSOpStatsMap to add the operation to, if it has been requested at all.
+     */
+    void parseNFSOpLine( const char *p, const char *eol, NFSOpStatsMap &ops ) {
+      while ( p < eol && ( *p == ' ' || *p == '\t' ) ) p++;
+      const char *colon = static_cast<const char*>( memchr( p, ':', eol - p ) );
+      if ( !colon || colon == p ) return;
+      unsigned long v[8];
+      char *q = const_cast<char*>( colon + 1 );
+      for ( int i = 0; i < 8; i++ ) {
+        char *e = 0;
+        v[i] = strtoul( q, &e, 10 );
+        if ( e == q || e > eol ) return;
+        q = e;
+      }
+      if ( v[0] == 0 ) return;
+      NFSOpStats &stats = ops[ std::string( p, colon - p ) ];
+      stats.ops = v[0];
+      stats.trans = v[1];
+      stats.timeouts = v[2];
+      stats.bytes_sent = v[3];
+      stats.bytes_recv = v[4];
+      stats.queue_ms = v[5];
+      stats.rtt_ms = v[6];
+      stats.execute_ms = v[7];
+    }
+
+    void getNFSMountStats( NFSMountStatsMap &stats ) {
+      stats.clear();
+      std::string path = mountstatsPath();
+      int fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 ) throw Oops( __FILE__, __LINE__, "failed to open '" + path + "'" );
+      // with many NFS mounts the file is large, so read it in one go and scan it in place
+      std::string content = "";
+      char buf[65536];
+      ssize_t r = 0;
+      while ( ( r = read( fd, buf, sizeof(buf) ) ) > 0 ) content.append( buf, r );
+      close( fd );
+      const char *p = content.c_str();
+      const char *end = p + content.length();
+      NFSOpStatsMap *current = 0;
+      bool perop = false;
+      while ( p < end ) {
+        const char *eol = static_cast<const char*>( memchr( p, '\n', end - p ) );
+        if ( !eol ) eol = end;
+        if ( strncmp( p, "device ", 7 ) == 0 ) {
+          // device srv:/export mounted on /mnt with fstype nfs4 statvers=1.1
+          current = 0;
+          perop = false;
+          std::string line( p, eol - p );
+          size_t on = line.find( " mounted on " );
+          size_t with = line.find( " with fstype ", on );
+          if ( on != std::string::npos && with != std::string::npos &&
+               line.compare( with + 13, 3, "nfs" ) == 0 ) {
+            current = &stats[ line.substr( on + 12, with - on - 12 ) ];
+          }
+        } else if ( current ) {
+          if ( perop ) parseNFSOpLine( p, eol, *current );
+          else {
+            const char *t = p;
+            while ( t < eol && ( *t == ' ' || *t == '\t' ) ) t++;
+            perop = strncmp( t, "per-op statistics", 17 ) == 0;
+          }
+        }
+        p = eol + 1;
+      }
+    }
+
+    void deltaNFSMountStats( const NFSMountStatsMap &snap1, const NFSMountStatsMap &snap2, NFSMountStatsMap &delta ) {
+      delta.clear();
+      for ( NFSMountStatsMap::const_iterator m2 = snap2.begin(); m2 != snap2.end(); ++m2 ) {
+        NFSMountStatsMap::const_iterator m1 = snap1.find( m2->first );
+        if ( m1 == snap1.end() ) continue;
+        const NFSOpStatsMap &ops1 = m1->second;
+        NFSOpStatsMap &result = delta[m2->first];
+        for ( NFSOpStatsMap::const_iterator o2 = m2->second.begin(); o2 != m2->second.end(); ++o2 ) {
+          NFSOpStats d = o2->second;
+          NFSOpStatsMap::const_iterator o1 = ops1.find( o2->first );
+          if ( o1 != ops1.end() ) {
+            const NFSOpStats &s1 = o1->second;
+            const NFSOpStats &s2 = o2->second;
+            if ( s2.ops < s1.ops || s2.trans < s1.trans || s2.timeouts < s1.timeouts ||
+                 s2.bytes_sent < s1.bytes_sent || s2.bytes_recv < s1.bytes_recv ||
+                 s2.queue_ms < s1.queue_ms || s2.rtt_ms < s1.rtt_ms || s2.execute_ms < s1.execute_ms ) continue;
+            d.ops = s2.ops - s1.ops;
+            d.trans = s2.trans - s1.trans;
+            d.timeouts = s2.timeouts - s1.timeouts;
+            d.bytes_sent = s2.bytes_sent - s1.bytes_sent;
+            d.bytes_recv = s2.bytes_recv - s1.bytes_recv;
+            d.queue_ms = s2.queue_ms - s1.queue_ms;
+            d.rtt_ms = s2.rtt_ms - s1.rtt_ms;
+            d.execute_ms = s2.execute_ms - s1.execute_ms;
+          }
+          if ( d.ops > 0 ) result[o2->first] = d;
+        }
+      }
+    }
+
+    /**
+     * Add the counters of one DeviceStats to another.
+     * @param to the DeviceStats to add to.
+     * @param from the DeviceStats to add.
+     */
+    void addDeviceStats( DeviceStats &to, const DeviceStats &from ) {
+      to.reads += from.reads;
+      to.reads_merged += from.reads_merged;
+      to.read_sectors += from.read_sectors;
+      to.read_ms += from.read_ms;
+      to.writes += from.writes;
+      to.writes_merged += from.writes_merged;
+      to.write_sectors += from.write_sectors;
+      to.write_ms += from.write_ms;
+      to.io_in_progress += from.io_in_progress;
+      to.io_ms += from.io_ms;
+      to.io_weighted_ms += from.io_weighted_ms;
+      to.iodone_cnt += from.iodone_cnt;
+      to.iorequest_cnt += from.iorequest_cnt;
+      to.ioerr_cnt += from.ioerr_cnt;
+      to.discards += from.discards;
+      to.discards_merged += from.discards_merged;
+      to.discard_sectors += from.discard_sectors;
+      to.discard_ms += from.discard_ms;
+      to.flushes += from.flushes;
+      to.flush_ms += from.flush_ms;
+      to.inflight_reads += from.inflight_reads;
+      to.inflight_writes += from.inflight_writes;
+    }
+
+    Topology::Topology() {
+      build();
+    }
+
+    bool Topology::refresh() {
+      if ( MajorMinor::getGeneration() == generation_ ) return false;
+      build();
+      return true;
+    }
+
+    void Topology::build() {
+      nodes_.clear();
+      generation_ = MajorMinor::getGeneration();
+      std::list<MajorMinor> devices;
+      enumDevices( devices );
+      for ( std::list<MajorMinor>::const_iterator m = devices.begin(); m != devices.end(); ++m ) {
+        Node &node = nodes_[*m];
+        if ( m->isPartition() ) {
+          MajorMinor whole = MajorMinor::deriveWholeDisk( *m );
+          if ( whole != *m ) node.slaves.push_back( whole );
+          continue;
+        }
+        std::string path = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor( *m ) + "/slaves";
+        DIR *d = opendir( path.c_str() );
+        if ( !d ) continue;
+        struct dirent *dir;
+        while ( (dir = readdir(d)) != NULL ) {
+          if ( dir->d_name[0] == '.' ) continue;
+          MajorMinor slave = MajorMinor::getMajorMinorByName( dir->d_name );
+          if ( slave.isValid() ) node.slaves.push_back( slave );
+        }
+        closedir( d );
+      }
+      for ( std::map<MajorMinor,Node>::iterator n = nodes_.begin(); n != nodes_.end(); ++n ) {
+        n->second.slaves.sort();
+        for ( std::list<MajorMinor>::const_iterator s = n->second.slaves.begin(); s != n->second.slaves.end(); ++s ) {
+          nodes_[*s].holders.push_back( n->first );
+        }
+      }
+      std::set<MajorMinor> visiting;
+      for ( std::map<MajorMinor,Node>::iterator n = nodes_.begin(); n != nodes_.end(); ++n ) {
+        n->second.holders.sort();
+        buildLeaves( n->first, visiting );
+      }
+    }
+
+    const std::list<MajorMinor>& Topology::buildLeaves( const MajorMinor &m, std::set<MajorMinor> &visiting ) {
+      Node &node = nodes_[m];
+      if ( !node.leaves.empty() || visiting.find( m ) != visiting.end() ) return node.leaves;
+      // a partition is a leaf, so only its own I/O rolls up into the devices built on it
+      if ( node.slaves.empty() || m.isPartition() ) {
+        node.leaves.push_back( m );
+        return node.leaves;
+      }
+      visiting.insert( m );
+      std::set<MajorMinor> leaves;
+      for ( std::list<MajorMinor>::const_iterator s = node.slaves.begin(); s != node.slaves.end(); ++s ) {
+        const std::list<MajorMinor> &sl = buildLeaves( *s, visiting );
+        leaves.insert( sl.begin(), sl.end() );
+      }
+      visiting.erase( m );
+      node.leaves.assign( leaves.begin(), leaves.end() );
+      return node.leaves;
+    }
+
+    /** Returned for devices not in a Topology. */
+    static const std::list<MajorMinor> no_devices;
+
+    const std::list<MajorMinor>& Topology::getHolders( const MajorMinor &m ) const {
+      std::map<MajorMinor,Node>::const_iterator n = nodes_.find( m );
+      return n != nodes_.end() ? n->second.holders : no_devices;
+    }
+
+    const std::list<MajorMinor>& Topology::getSlaves( const MajorMinor &m ) const {
+      std::map<MajorMinor,Node>::const_iterator n = nodes_.find( m );
+      return n != nodes_.end() ? n->second.slaves : no_devices;
+    }
+
+    const std::list<MajorMinor>& Topology::getLeaves( const MajorMinor &m ) const {
+      std::map<MajorMinor,Node>::const_iterator n = nodes_.find( m );
+      return n != nodes_.end() ? n->second.leaves : no_devices;
+    }
+
+    void Topology::rollUp( const DeviceStatsMap &stats, DeviceStatsMap &rolled ) const {
+      rolled.clear();
+      for ( DeviceStatsMap::const_iterator s = stats.begin(); s != stats.end(); ++s ) {
+        DeviceStats &sum = rolled[s->first];
+        memset( &sum, 0, sizeof(sum) );
+        const std::list<MajorMinor> &leaves = getLeaves( s->first );
+        if ( leaves.empty() ) {
+          sum = s->second;
+          continue;
+        }
+        for ( std::list<MajorMinor>::const_iterator l = leaves.begin(); l != leaves.end(); ++l ) {
+          DeviceStatsMap::const_iterator ls = stats.find( *l );
+          if ( ls != stats.end() ) addDeviceStats( sum, ls->second );
+        }
+      }
+    }
+
+    void enumMountpoints( std::list<std::string> &mountpoints ) {
+      mountpoints.clear();
+      std::ifstream pm( util::ProcFS::path( "mounts" ).c_str() );
       while ( pm.good() ) {
         MountInfo temp;
         int dummy1,dummy2;
@@ -1325,15 +1968,16 @@ namespace leanux {
         pm >> temp.attrs;
         pm >> dummy1;
         pm >> dummy2;
-        if ( temp.device.length() > 0 && temp.device[0] == '/' ) {
-          struct stat stat_b;
-          if ( !stat( temp.mountpoint.c_str(), &stat_b ) ) {
-            struct statfs statfs_b;
-            if ( !statfs( temp.mountpoint.c_str(), &statfs_b ) ) {
-              result += ( stat_b.st_blksize * (statfs_b.f_blocks-statfs_b.f_bavail ));
-            }
-          }
-        }
+        if ( pm.good() && temp.device.length() > 0 && temp.device[0] == '/' ) mountpoints.push_back( temp.mountpoint );
+      }
+    }
+
+    unsigned long getMountUsedBytes() {
+      std::list<std::string> mountpoints;
+      enumMountpoints( mountpoints );
+      unsigned long result = 0;
+      for ( std::list<std::string>::const_iterator m = mountpoints.begin(); m != mountpoints.end(); m++ ) {
+        result += getMountUsedBytes( *m );
       }
       return result;
     }
@@ -1349,6 +1993,266 @@ namespace leanux {
       return 0;
     }
 
+    /**
+     * State shared between a MountUsageSampler and its workers.
+     */
+    struct MountUsageState {
+      /** protects all members. */
+      std::mutex mutex;
+      /** signals the workers that work is queued or stop is set. */
+      std::condition_variable work;
+      /** signals the sampler that a request completed. */
+      std::condition_variable done;
+      /** queued mountpoints. */
+      std::list<std::string> queue;
+      /** mountpoints queued or being sampled. */
+      std::set<std::string> inflight;
+      /** last known used bytes per mountpoint. */
+      std::map<std::string,unsigned long> used;
+      /** number of completed requests per mountpoint. */
+      std::map<std::string,unsigned long> completed;
+      /** number of workers not blocked on a request that the sampler keeps available. */
+      unsigned int workers;
+      /** number of running workers. */
+      unsigned int threads;
+      /** number of workers busy with a request. */
+      unsigned int busy;
+      /** workers exit when set. */
+      bool stop;
+    };
+
+    /**
+     * MountUsageSampler worker thread.
+     */
+    void mountUsageWorker( std::shared_ptr<MountUsageState> state );
+
+    /**
+     * Start workers until the number of workers not busy with a request reaches the
+     * configured number. Workers still busy from an earlier sample are blocked on slow or
+     * hung filesystems, and are replaced. The caller must hold the state mutex.
+     */
+    void startMountUsageWorkers( std::shared_ptr<MountUsageState> state ) {
+      while ( state->threads - state->busy < state->workers ) {
+        std::thread( mountUsageWorker, state ).detach();
+        state->threads++;
+      }
+    }
+
+    void mountUsageWorker( std::shared_ptr<MountUsageState> state ) {
+      std::unique_lock<std::mutex> lock( state->mutex );
+      while ( true ) {
+        while ( !state->stop && state->queue.empty() ) state->work.wait( lock );
+        if ( state->stop ) break;
+        std::string mountpoint = state->queue.front();
+        state->queue.pop_front();
+        state->busy++;
+        lock.unlock();
+        unsigned long used = getMountUsedBytes( mountpoint );
+        lock.lock();
+        state->busy--;
+        state->used[mountpoint] = used;
+        state->completed[mountpoint]++;
+        state->inflight.erase( mountpoint );
+        state->done.notify_all();
+        // a worker added to replace one blocked on a hung filesystem is surplus once that returns
+        if ( state->threads - state->busy > state->workers ) break;
+      }
+      state->threads--;
+    }
+
+    MountUsageSampler::MountUsageSampler( unsigned int workers, double timeout ) : state_( new MountUsageState() ), timeout_( timeout ) {
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      state_->workers = workers;
+      state_->threads = 0;
+      state_->busy = 0;
+      state_->stop = false;
+      startMountUsageWorkers( state_ );
+    }
+
+    MountUsageSampler::~MountUsageSampler() {
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      state_->stop = true;
+      state_->work.notify_all();
+    }
+
+    void MountUsageSampler::sample( const std::list<std::string> &mountpoints, MountUsageMap &usage ) {
+      usage.clear();
+      std::unique_lock<std::mutex> lock( state_->mutex );
+      std::map<std::string,unsigned long> requested;
+      startMountUsageWorkers( state_ );
+      for ( std::list<std::string>::const_iterator m = mountpoints.begin(); m != mountpoints.end(); m++ ) {
+        // an outstanding request means the mountpoint is still busy answering an earlier sample,
+        // it is reported stale without waiting for it
+        if ( state_->inflight.find( *m ) != state_->inflight.end() ) continue;
+        requested[*m] = state_->completed[*m];
+        state_->inflight.insert( *m );
+        state_->queue.push_back( *m );
+      }
+      state_->work.notify_all();
+      std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+        std::chrono::microseconds( (long)(timeout_ * 1000000.0) );
+      std::map<std::string,unsigned long>::const_iterator r = requested.begin();
+      while ( r != requested.end() ) {
+        if ( state_->completed[r->first] != r->second ) r++;
+        else if ( state_->done.wait_until( lock, deadline ) == std::cv_status::timeout ) break;
+      }
+      for ( std::list<std::string>::const_iterator m = mountpoints.begin(); m != mountpoints.end(); m++ ) {
+        MountUsage mu;
+        r = requested.find( *m );
+        mu.stale = r == requested.end() || state_->completed[*m] == r->second;
+        std::map<std::string,unsigned long>::const_iterator u = state_->used.find( *m );
+        mu.used = u != state_->used.end() ? u->second : 0;
+        usage[*m] = mu;
+      }
+    }
+
+    /**
+     * State shared between an InflightSampler and its thread.
+     */
+    struct InflightState {
+      /** protects all members. */
+      std::mutex mutex;
+      /** signals the thread that stop is set. */
+      std::condition_variable wakeup;
+      /** open inflight attribute per whole disk. */
+      std::map<MajorMinor,int> fds;
+      /** descriptors replaced by a scan, closed by the thread once it no longer reads them. */
+      std::list<int> retired;
+      /** incremented by each scan, so the thread can drop a sample taken over a rescan. */
+      unsigned long scans;
+      /** histograms since the last collect. */
+      InflightHistoMap histos;
+      /** busy samples per disk in the current one second window. */
+      std::map<MajorMinor,unsigned int> window_busy;
+      /** samples in the current one second window. */
+      unsigned int window_samples;
+      /** samples per second. */
+      unsigned int hz;
+      /** the thread exits when set. */
+      bool stop;
+    };
+
+    /**
+     * InflightSampler thread.
+     */
+    void inflightWorker( std::shared_ptr<InflightState> state ) {
+      std::unique_lock<std::mutex> lock( state->mutex );
+      std::chrono::steady_clock::duration period = std::chrono::microseconds( 1000000 / state->hz );
+      std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+      char buf[64];
+      while ( !state->stop ) {
+        for ( std::list<int>::const_iterator f = state->retired.begin(); f != state->retired.end(); f++ ) {
+          close( *f );
+        }
+        state->retired.clear();
+        // read without the lock, scan() retires instead of closing the descriptors read here
+        std::map<MajorMinor,int> fds = state->fds;
+        unsigned long scans = state->scans;
+        lock.unlock();
+        std::map<MajorMinor,unsigned long> depths;
+        for ( std::map<MajorMinor,int>::const_iterator f = fds.begin(); f != fds.end(); f++ ) {
+          ssize_t r = pread( f->second, buf, sizeof(buf) - 1, 0 );
+          if ( r <= 0 ) continue;
+          buf[r] = 0;
+          unsigned long reads = 0, writes = 0;
+          if ( sscanf( buf, "%lu %lu", &reads, &writes ) != 2 ) continue;
+          depths[f->first] = reads + writes;
+        }
+        lock.lock();
+        if ( state->stop ) break;
+        if ( scans != state->scans ) continue;
+        for ( std::map<MajorMinor,unsigned long>::const_iterator d = depths.begin(); d != depths.end(); d++ ) {
+          InflightHisto &histo = state->histos[d->first];
+          histo.depth[ InflightSampler::depthBucket( d->second ) ]++;
+          histo.samples++;
+          if ( d->second > 0 ) state->window_busy[d->first]++;
+        }
+        state->window_samples++;
+        if ( state->window_samples >= state->hz ) {
+          for ( std::map<MajorMinor,int>::const_iterator f = state->fds.begin(); f != state->fds.end(); f++ ) {
+            unsigned int bucket = state->window_busy[f->first] * inflight_util_buckets / state->window_samples;
+            if ( bucket >= inflight_util_buckets ) bucket = inflight_util_buckets - 1;
+            state->histos[f->first].util[bucket]++;
+          }
+          state->window_busy.clear();
+          state->window_samples = 0;
+        }
+        next += period;
+        // when behind, do not catch up with a burst of samples
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if ( next < now ) next = now;
+        while ( !state->stop && state->wakeup.wait_until( lock, next ) != std::cv_status::timeout );
+      }
+      for ( std::map<MajorMinor,int>::const_iterator f = state->fds.begin(); f != state->fds.end(); f++ ) {
+        close( f->second );
+      }
+      state->fds.clear();
+      for ( std::list<int>::const_iterator f = state->retired.begin(); f != state->retired.end(); f++ ) {
+        close( *f );
+      }
+      state->retired.clear();
+    }
+
+    InflightSampler::InflightSampler( unsigned int hz ) : state_( new InflightState() ), generation_( 0 ) {
+      if ( hz < 10 || hz > 100 ) throw Oops( __FILE__, __LINE__, "inflight sample frequency must be within 10-100 Hz" );
+      state_->scans = 0;
+      state_->window_samples = 0;
+      state_->hz = hz;
+      state_->stop = false;
+      scan();
+      std::thread( inflightWorker, state_ ).detach();
+    }
+
+    InflightSampler::~InflightSampler() {
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      state_->stop = true;
+      state_->wakeup.notify_all();
+    }
+
+    void InflightSampler::scan() {
+      generation_ = MajorMinor::getGeneration();
+      std::list<MajorMinor> disks;
+      enumWholeDisks( disks );
+      std::map<MajorMinor,int> fds;
+      for ( std::list<MajorMinor>::const_iterator d = disks.begin(); d != disks.end(); d++ ) {
+        std::string path = util::SysFS::path( "class/block/" ) + MajorMinor::getNameByMajorMinor( *d ) + "/inflight";
+        int fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+        if ( fd >= 0 ) fds[*d] = fd;
+      }
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      state_->fds.swap( fds );
+      for ( std::map<MajorMinor,int>::const_iterator f = fds.begin(); f != fds.end(); f++ ) {
+        state_->retired.push_back( f->second );
+      }
+      state_->scans++;
+      // restart the one second window, so it does not mix the old and the new disks
+      state_->window_busy.clear();
+      state_->window_samples = 0;
+    }
+
+    void InflightSampler::collect( InflightHistoMap &histos ) {
+      if ( MajorMinor::getGeneration() != generation_ ) scan();
+      histos.clear();
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      histos.swap( state_->histos );
+    }
+
+    unsigned int InflightSampler::depthBucket( unsigned long depth ) {
+      if ( depth <= 2 ) return depth;
+      unsigned int bucket = 2;
+      unsigned long limit = 2;
+      while ( depth > limit && bucket < inflight_depth_buckets - 1 ) {
+        limit *= 2;
+        bucket++;
+      }
+      return bucket;
+    }
+
+    unsigned long InflightSampler::depthBucketLow( unsigned int bucket ) {
+      if ( bucket <= 2 ) return bucket;
+      return ( 1UL << (bucket - 2) ) + 1;
+    }
+
   }
 
 }
@@ -40,11 +40,13 @@
 #include <ostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <set>
 #include <vector>
 #include <iostream>
 
 #include <stdlib.h>
-#include <linux/kdev_t.h>
+#include <sys/sysmacros.h>
 #include <stdio.h>
 
 namespace leanux {
@@ -66,6 +68,28 @@ namespace leanux {
      */
     void init();
 
+    /**
+     * Override of the diskstats file read by the block API. When empty (the default)
+     * 'diskstats' below util::ProcFS is read, which follows util::setPseudoFSRoot.
+     * Only to be changed (for testing) before any block API is used.
+     */
+    extern std::string diskstats_path;
+
+    /**
+     * Override of the NFS client statistics file read by getNFSMountStats. When empty (the default)
+     * 'self/mountstats' below util::ProcFS is read.
+     * Only to be changed (for testing) before any block API is used.
+     */
+    extern std::string mountstats_path;
+
+    /**
+     * Override of the directory holding the per backing device info (BDI) statistics read by
+     * getBDIStats. When empty (the default) 'kernel/debug/bdi' below util::SysFS is read, which
+     * requires debugfs to be mounted.
+     * Only to be changed (for testing) before any block API is used.
+     */
+    extern std::string bdistats_path;
+
     /** Mounted filesystem configuration. */
     struct MountInfo {
       /** The name of the device containing the filesystem. */
@@ -106,7 +130,8 @@ namespace leanux {
     };
 
     /**
-     * Device stats from /proc/diskstats
+     * Device stats from /proc/diskstats. The number of fields depends on the kernel version,
+     * fields not reported by the running kernel are 0.
      * @see iostats.txt in the Linux kernel docs.
      */
     struct DeviceStats {
@@ -124,6 +149,29 @@ namespace leanux {
       unsigned long iodone_cnt;     /**< number of SCSI IO's completed */
       unsigned long iorequest_cnt;  /**< number of SCSI IO's requested */
       unsigned long ioerr_cnt;      /**< number of SCSI IO errors */
+      unsigned long discards;       /**< number of discard operations, 0 before Linux 4.18 */
+      unsigned long discards_merged;/**< number of discard operations merged with other discard operations */
+      unsigned long discard_sectors;/**< number of sectors discarded */
+      unsigned long discard_ms;     /**< number of milliseconds spent discarding */
+      unsigned long flushes;        /**< number of flush operations, 0 before Linux 5.5 */
+      unsigned long flush_ms;       /**< number of milliseconds spent flushing */
+      unsigned long inflight_reads; /**< number of reads in flight, from the sysfs inflight attribute */
+      unsigned long inflight_writes;/**< number of writes in flight, from the sysfs inflight attribute */
+    };
+
+    /**
+     * Static attributes of a block device, which do not change for the life of the device.
+     * @see MajorMinor::getDescriptor
+     */
+    struct DeviceDescriptor {
+      std::string name;             /**< device name as in /proc/diskstats */
+      DeviceClass dclass;           /**< the device class */
+      bool wholedisk;               /**< true if the device is a whole disk */
+      unsigned long sectorsize;     /**< hardware sector size, 0 if unknown */
+      std::string model;            /**< device model */
+      std::string wwn;              /**< device WWN */
+      std::string diskid;           /**< device disk id */
+      std::string syspath;          /**< resolved sysfs path */
     };
 
     /**
@@ -139,7 +187,7 @@ namespace leanux {
          * @param min the minor number.
          */
         MajorMinor( unsigned long maj, unsigned long min ) {
-          dev_ = MKDEV(maj,min);
+          dev_ = makedev(maj,min);
         }
 
         /**
@@ -154,7 +202,7 @@ namespace leanux {
          * Default constructor
          */
         MajorMinor() {
-          dev_ = MKDEV(0,0);
+          dev_ = makedev(0,0);
         }
 
         /**
@@ -194,13 +242,13 @@ namespace leanux {
          * Get the major.
          * @return the major.
          */
-        long getMajor() const { return MAJOR(dev_); };
+        long getMajor() const { return major(dev_); };
 
         /**
          * Get the minor.
          * @return the minor.
          */
-        long getMinor() const { return MINOR(dev_); };
+        long getMinor() const { return minor(dev_); };
 
         /**
          * compare MajorMinor objects.
@@ -272,7 +320,7 @@ namespace leanux {
          * @return true when the MajorMinor represents a MetaDisk.
          */
         inline bool isMetaDisk() const {
-          return isMetaDisk( MAJOR(dev_) );
+          return isMetaDisk( major(dev_) );
         }
 
         /**
@@ -280,9 +328,9 @@ namespace leanux {
          * @return true if the MajorMinor represents a whole IDE or SCSI disk.
          */
         bool isWholeDisk() const {
-          if ( isSCSIDisk( MAJOR(dev_) ) ) return (MINOR(dev_) % 16) == 0;
-          else if ( isIDEDisk( MAJOR(dev_) ) ) return (MINOR(dev_) % 64 ) == 0;
-          else if ( isVirtIODisk( *this ) && MINOR(dev_) % 16 == 0 ) return true;
+          if ( isSCSIDisk( major(dev_) ) ) return (minor(dev_) % 16) == 0;
+          else if ( isIDEDisk( major(dev_) ) ) return (minor(dev_) % 64 ) == 0;
+          else if ( isVirtIODisk( *this ) && minor(dev_) % 16 == 0 ) return true;
           else if ( isNVMeDisk( *this ) && !isPartition() ) return true;
           else if ( isMMCDisk( *this ) && !isPartition() ) return true;
           else return false;
@@ -292,10 +340,10 @@ namespace leanux {
          * @return true if the block device is a disk partition.
          */
         bool isPartition() const {
-          if ( isSCSIDisk( MAJOR(dev_) ) ) return (MINOR(dev_) % 16) != 0;
-          else if ( isIDEDisk( MAJOR(dev_) ) ) return (MINOR(dev_) % 64 ) != 0;
-          else if ( isVirtIODisk( MajorMinor( MAJOR(dev_), 0  )  ) ) return (MINOR(dev_) % 16 ) != 0;
-          else if ( isNVMeDisk( MajorMinor( MAJOR(dev_), 0 ) ) ) {
+          if ( isSCSIDisk( major(dev_) ) ) return (minor(dev_) % 16) != 0;
+          else if ( isIDEDisk( major(dev_) ) ) return (minor(dev_) % 64 ) != 0;
+          else if ( isVirtIODisk( MajorMinor( major(dev_), 0  )  ) ) return (minor(dev_) % 16 ) != 0;
+          else if ( isNVMeDisk( MajorMinor( major(dev_), 0 ) ) ) {
             unsigned int host = 0;
             unsigned int disk = 0;
             unsigned int partition = 0;
@@ -303,14 +351,14 @@ namespace leanux {
             int r = sscanf( devname.c_str(), "nvme%un%up%u", &host, &disk, &partition );
             return r == 3;
           }
-          else if ( isMMCDisk( MajorMinor( MAJOR(dev_), MINOR(dev_) ) ) ) {
+          else if ( isMMCDisk( MajorMinor( major(dev_), minor(dev_) ) ) ) {
             unsigned int disk = 0;
             unsigned int partition = 0;
             std::string devname = getNameByMajorMinor( * this );
             int r = sscanf( devname.c_str(), "mmcblk%up%u", &disk, &partition );
             return r == 2;
           }
-          else if ( isBCacheDisk( MajorMinor( MAJOR(dev_), MINOR(dev_) ) ) ) {
+          else if ( isBCacheDisk( MajorMinor( major(dev_), minor(dev_) ) ) ) {
             // it seems creating partitions on bcache devices does not really work
             // but if it would/will it would look like this
             unsigned int disk = 0;
@@ -366,6 +414,35 @@ namespace leanux {
          */
         std::string getName() const { return getNameByMajorMinor( *this ); };
 
+        /**
+         * Get the device generation, which is incremented each time block devices
+         * are added or removed.
+         * @return the device generation.
+         */
+        static unsigned long getGeneration();
+
+        /**
+         * Get the cached DeviceDescriptor for the device. The descriptor is read from sysfs
+         * once per device generation, so repeated calls are cheap.
+         * @param m the device MajorMinor.
+         * @return a copy of the DeviceDescriptor.
+         */
+        static DeviceDescriptor getDescriptor( const MajorMinor &m );
+
+        /**
+         * get the cached DeviceDescriptor for this MajorMinor.
+         * @return a copy of the DeviceDescriptor.
+         * @see getDescriptor( const MajorMinor &m )
+         */
+        DeviceDescriptor getDescriptor() const { return getDescriptor( *this ); };
+
+        /**
+         * Force the cached mapping between device names, devicefiles and MajorMinor numbers
+         * to be brought in line with diskstats_path. Normally not required, as the cache
+         * follows device changes through an inotify watch on /dev.
+         */
+        static void refreshCache();
+
         /**
          * get the devicefile for this MajorMinor.
          * @return the device file.
@@ -422,6 +499,15 @@ namespace leanux {
          */
         std::string getUDevPath() const;
 
+        /**
+         * Get a property (E: line) from the udev database for this device, such as 'ID_FS_TYPE'.
+         * The udev database file is parsed once into a UdevProperties object, which is shared by
+         * all getters and only re-read when udev replaces the file.
+         * @param key the property name.
+         * @return the property value, or an empty string if the property is absent.
+         * @see UdevProperties
+         */
+        std::string getUdevProperty( const std::string &key ) const;
 
         /**
          * Chech if a disk is mechanical or solid state.
@@ -707,39 +793,79 @@ namespace leanux {
         unsigned long getSCSIIOError() const;
 
       private:
-        /** (re)build the cached mapping between device names and MajorMinor numbers. */
-        static void buildCache();
-
         /**
          * The corresponding Linux dev_t.
          */
         dev_t dev_;
 
-        /** time of last rebuild. */
-        static struct timeval cacheage_;
-
-        /** cache of device name to MajorMinor mapping. */
-        static std::map<std::string,MajorMinor> name2mm_;
-
-        /** cache of MajorMinor to device name mapping. */
-        static std::map<MajorMinor,std::string> mm2name_;
-
-        /** cache of devicefile to MajorMinor mapping. */
-        static std::map<std::string,MajorMinor> file2mm_;
-
-        /** cache of MajorMinor to devicefile mapping. */
-        static std::map<MajorMinor,std::string> mm2file_;
-
     };
 
     /**
      * Write MajorMinor to stream as a string, eg {8,0} is written as '8:0'.
      */
     inline std::ostream& operator<<( std::ostream& s, const MajorMinor& m ) {
-      s << MAJOR(m.getDevT()) << ":" << MINOR(m.getDevT());
+      s << major(m.getDevT()) << ":" << minor(m.getDevT());
       return s;
     }
 
+    /**
+     * Properties of a block device as stored by udev in its database, parsed once
+     * into a key/value table.
+     * Each line in the udev database file starts with a type character and a colon,
+     * of which the 'E:' lines hold KEY=value properties and the 'S:' lines hold
+     * devicefile symlinks relative to /dev.
+     * @see MajorMinor::getUDevPath
+     */
+    class UdevProperties {
+      public:
+        /**
+         * Construct empty.
+         */
+        UdevProperties() {};
+
+        /**
+         * Construct from the udev database file of the device.
+         * @param m the device.
+         */
+        UdevProperties( const MajorMinor &m ) { load( m.getUDevPath() ); };
+
+        /**
+         * (Re)load from a udev database file.
+         * @param file the udev database file.
+         * @return false if the file could not be read.
+         */
+        bool load( const std::string &file );
+
+        /**
+         * Test if a property is present.
+         * @param key the property name.
+         * @return true if present.
+         */
+        bool has( const std::string &key ) const { return properties_.find( key ) != properties_.end(); };
+
+        /**
+         * Get a property value.
+         * @param key the property name.
+         * @return the value or an empty string if absent.
+         */
+        std::string get( const std::string &key ) const {
+          std::map<std::string,std::string>::const_iterator i = properties_.find( key );
+          if ( i != properties_.end() ) return i->second; else return "";
+        };
+
+        /**
+         * Get the symlinks as full paths (S: lines).
+         * @return the symlinks.
+         */
+        const std::list<std::string>& getSymlinks() const { return symlinks_; };
+
+      private:
+        /** E: lines. */
+        std::map<std::string,std::string> properties_;
+        /** S: lines, as full paths. */
+        std::list<std::string> symlinks_;
+    };
+
     /**
      * return the ata port name from the device path
      */
@@ -766,21 +892,13 @@ namespace leanux {
     std::string getATALinkSpeed( const std::string& ata_port, const std::string& ata_link );
 
     /**
-     * Get a map of MajorMinor to MountInfo from /proc/mounts.
+     * Get a map of MajorMinor to MountInfo from /proc/self/mountinfo. The mount table is
+     * cached, and only reparsed when the kernel signals a mount table change, so repeated calls
+     * are cheap. Safe to call from multiple threads.
      * @param mounts receives the map.
      */
     void enumMounts( std::map<MajorMinor,MountInfo> &mounts );
 
-    /**
-     * Variant of enumMounts that accepts a cache of previously detected mappings between
-     * device special file names and MajorMinor. This cache will be updated when
-     * entries are absent, so the first call may specify an empty cache, causing
-     * subsequent calls to hit and avoid a relatively costly lookup.
-     * @param mounts receives the map.
-     * @param cache read through on cache miss, add to cache.
-     */
-    void enumMounts( std::map<MajorMinor,MountInfo> &mounts, std::map<std::string,MajorMinor> &cache );
-
     /**
      * get the MajorMinor for a device file or aliases to it, resolves
      * the devicefile with realpath.
@@ -790,7 +908,15 @@ namespace leanux {
     MajorMinor getFileMajorMinor( const std::string &devicefile );
 
     /**
-     * Used bytes over all mounted filesystems.
+     * Get the mountpoints of all block device backed filesystems from /proc/mounts, in
+     * mount order. Unlike enumMounts, a filesystem mounted more than once (such as a bind mount)
+     * is listed for each mountpoint, and btrfs mountpoints are the real paths.
+     * @param mountpoints receives the mountpoints.
+     */
+    void enumMountpoints( std::list<std::string> &mountpoints );
+
+    /**
+     * Used bytes over all mountpoints listed by enumMountpoints.
      * @return the number of bytes used.
      */
     unsigned long getMountUsedBytes();
@@ -804,6 +930,69 @@ namespace leanux {
      */
     unsigned long getMountUsedBytes( const std::string &mount );
 
+    /**
+     * Filesystem usage of a mountpoint as sampled by MountUsageSampler.
+     */
+    struct MountUsage {
+      unsigned long used;   /**< bytes used, the last known value if stale */
+      bool stale;           /**< true if the filesystem did not answer in time */
+    };
+
+    /**
+     * Map of mountpoint to MountUsage.
+     */
+    typedef std::map<std::string,MountUsage> MountUsageMap;
+
+    /** Shared state of a MountUsageSampler and its workers. */
+    struct MountUsageState;
+
+    /**
+     * Samples filesystem usage with a pool of worker threads, so that a hung
+     * filesystem (such as an unresponsive NFS or CIFS mount) cannot block the caller.
+     * A mountpoint that does not answer within the timeout is reported stale with its
+     * last known value, and is not requested again until the outstanding request returns,
+     * so a hung mountpoint occupies at most a single worker. Until then, later samples
+     * report it stale at once instead of waiting for it. Workers blocked on hung
+     * mountpoints are replaced, so the other mountpoints are still sampled, and the
+     * surplus workers exit once the hung requests return.
+     */
+    class MountUsageSampler {
+      public:
+        /**
+         * Construct and start the workers.
+         * @param workers the number of worker threads available to requests, not counting
+         * workers blocked on hung mountpoints.
+         * @param timeout the maximum number of seconds sample() waits for the workers.
+         */
+        MountUsageSampler( unsigned int workers = 4, double timeout = 0.5 );
+
+        /**
+         * Stop the workers. Workers blocked on a hung filesystem are detached and
+         * exit once their request returns.
+         */
+        ~MountUsageSampler();
+
+        /**
+         * Sample the used bytes of the mountpoints, waiting at most the timeout.
+         * @param mountpoints the mountpoints to sample.
+         * @param usage receives the MountUsage per mountpoint.
+         */
+        void sample( const std::list<std::string> &mountpoints, MountUsageMap &usage );
+
+      private:
+        /** not copyable. */
+        MountUsageSampler( const MountUsageSampler& );
+
+        /** not assignable. */
+        MountUsageSampler& operator=( const MountUsageSampler& );
+
+        /** state shared with the workers, which may outlive the sampler. */
+        std::shared_ptr<MountUsageState> state_;
+
+        /** the maximum number of seconds to wait for the workers. */
+        double timeout_;
+    };
+
     /**
      * get a list of all block devices
      * @param devices the device list to fill
@@ -919,6 +1108,233 @@ namespace leanux {
         const DeviceStatsMap *delta_;
     };
 
+    /**
+     * The stacking of block devices (multipath, device mapper, LVM, md, partitions) as a graph.
+     * A device holds the devices it is built on, its slaves, and a partition holds its whole disk.
+     * The graph is read from sysfs once, and only read again by refresh after devices have been
+     * added or removed, so that stacked devices can be related to the devices beneath them in
+     * sampling loops without reading sysfs per sample.
+     */
+    class Topology {
+      public:
+
+        /**
+         * Construct from the current block devices.
+         */
+        Topology();
+
+        /**
+         * Read the graph from sysfs again, if the device generation changed since it was read.
+         * @return true if the graph was read again.
+         * @see MajorMinor::getGeneration
+         */
+        bool refresh();
+
+        /**
+         * The devices built directly on m, its holders and partitions.
+         * @param m the device.
+         * @return the holders, sorted by MajorMinor, empty if m is unknown.
+         */
+        const std::list<MajorMinor>& getHolders( const MajorMinor &m ) const;
+
+        /**
+         * The devices m is built directly on, its slaves or, for a partition, its whole disk.
+         * @param m the device.
+         * @return the slaves, sorted by MajorMinor, empty if m is unknown.
+         */
+        const std::list<MajorMinor>& getSlaves( const MajorMinor &m ) const;
+
+        /**
+         * The devices at the bottom of the stack beneath m, such as the paths of a multipath
+         * device or the disks beneath a logical volume. A device without slaves is its own leaf,
+         * as is a partition, so a logical volume on partitions has those partitions as leaves.
+         * Each leaf is listed once, also when reached along several paths.
+         * @param m the device.
+         * @return the leaves, sorted by MajorMinor, empty if m is unknown.
+         */
+        const std::list<MajorMinor>& getLeaves( const MajorMinor &m ) const;
+
+        /**
+         * Roll up statistics along the stack, for each device the sum of the statistics
+         * of its leaves is put in rolled. The rolled-up latencies of a device follow from the summed
+         * times and counts, as for any DeviceStats.
+         * @param stats the (typically delta) statistics per device, as from deltaDeviceStats.
+         * @param rolled receives the rolled-up statistics of each device in stats.
+         */
+        void rollUp( const DeviceStatsMap &stats, DeviceStatsMap &rolled ) const;
+
+      private:
+
+        /** A device in the graph. */
+        struct Node {
+          std::list<MajorMinor> holders;  /**< devices built on this device */
+          std::list<MajorMinor> slaves;   /**< devices this device is built on */
+          std::list<MajorMinor> leaves;   /**< devices at the bottom of the stack beneath this device */
+        };
+
+        /** Read the graph from sysfs. */
+        void build();
+
+        /**
+         * Compute the leaves of a node and those of the nodes beneath it.
+         * @param m the device.
+         * @param visiting the devices on the current path, to stop at cycles.
+         */
+        const std::list<MajorMinor>& buildLeaves( const MajorMinor &m, std::set<MajorMinor> &visiting );
+
+        /** The nodes by MajorMinor. */
+        std::map<MajorMinor,Node> nodes_;
+
+        /** The device generation the graph was read at. */
+        unsigned long generation_;
+    };
+
+    /**
+     * Writeback statistics of a backing device (BDI) from bdistats_path/major:minor/stats.
+     * The writeback, reclaimable and threshold values are current, dirtied and written are
+     * cumulative.
+     */
+    struct BDIStats {
+      unsigned long writeback;        /**< bytes under writeback */
+      unsigned long reclaimable;      /**< dirty bytes not yet under writeback */
+      unsigned long dirty_thresh;     /**< dirty bytes threshold of this BDI, beyond which writers are throttled */
+      unsigned long dirtied;          /**< bytes dirtied */
+      unsigned long written;          /**< bytes written back */
+      unsigned long write_bandwidth;  /**< estimated writeback bandwidth in bytes per second */
+    };
+
+    /** map of MajorMinor to BDIStats. */
+    typedef std::map<MajorMinor,BDIStats> BDIStatsMap;
+
+    /**
+     * Get the writeback statistics of the backing devices that are block devices.
+     * Leaves statsmap empty when bdistats_path is not accessible, as when debugfs is not mounted.
+     * @param statsmap the BDIStatsMap to fill.
+     */
+    void getBDIStats( BDIStatsMap &statsmap );
+
+    /**
+     * NFS client RPC statistics of a single operation (READ, WRITE, GETATTR, ...) on a
+     * single NFS mount, as reported in the 'per-op statistics' section of /proc/self/mountstats.
+     * Counters are cumulative since mount time, or relative when produced by deltaNFSMountStats.
+     */
+    struct NFSOpStats {
+      unsigned long ops;              /**< operations requested */
+      unsigned long trans;            /**< RPC transmissions, exceeds ops on retransmission */
+      unsigned long timeouts;         /**< major timeouts */
+      unsigned long bytes_sent;       /**< bytes sent, including RPC headers */
+      unsigned long bytes_recv;       /**< bytes received, including RPC headers */
+      unsigned long queue_ms;         /**< milliseconds requests spent queued before transmission */
+      unsigned long rtt_ms;           /**< milliseconds waiting for the server to reply */
+      unsigned long execute_ms;       /**< milliseconds from request to completion, includes queue and rtt */
+    };
+
+    /** map of NFS operation name to NFSOpStats. */
+    typedef std::map<std::string,NFSOpStats> NFSOpStatsMap;
+
+    /** map of NFS mountpoint to its NFSOpStatsMap. */
+    typedef std::map<std::string,NFSOpStatsMap> NFSMountStatsMap;
+
+    /**
+     * Get the per-op statistics of all mounted NFS filesystems from mountstats_path.
+     * Operations that have never been requested are left out.
+     * @param stats the NFSMountStatsMap to fill.
+     */
+    void getNFSMountStats( NFSMountStatsMap &stats );
+
+    /**
+     * Create a delta of two NFSMountStatsMaps. Only mountpoints present in both snapshots are
+     * returned in delta, without the operations that had no requests in between the snapshots.
+     * An operation absent from snap1 counts from zero, an operation whose counters went back
+     * (remount) is left out.
+     * @param snap1 first (earlier) NFSMountStatsMap.
+     * @param snap2 second (later) NFSMountStatsMap.
+     * @param delta NFSMountStatsMap receiving the delta.
+     */
+    void deltaNFSMountStats( const NFSMountStatsMap &snap1, const NFSMountStatsMap &snap2, NFSMountStatsMap &delta );
+
+    /** number of queue depth buckets in an InflightHisto. */
+    const unsigned int inflight_depth_buckets = 8;
+
+    /** number of utilization buckets in an InflightHisto. */
+    const unsigned int inflight_util_buckets = 10;
+
+    /**
+     * Queue depth and utilization histograms of a disk as sampled by InflightSampler.
+     */
+    struct InflightHisto {
+      /** samples per queue depth (reads+writes in flight) bucket, see InflightSampler::depthBucket. */
+      unsigned long depth[inflight_depth_buckets];
+      /** one second windows per utilization bucket, bucket i counts windows busy i*10% up to (i+1)*10%. */
+      unsigned long util[inflight_util_buckets];
+      /** the number of samples taken. */
+      unsigned long samples;
+    };
+
+    /** map of MajorMinor to InflightHisto. */
+    typedef std::map<MajorMinor,InflightHisto> InflightHistoMap;
+
+    /** Shared state of an InflightSampler and its thread. */
+    struct InflightState;
+
+    /**
+     * Samples the requests in flight of all whole disks from /sys/class/block/<name>/inflight
+     * in a thread, at a frequency high enough to see the queue depth and bursts of
+     * utilization that the averages over a snapshot interval hide. The inflight
+     * attributes are kept open and read with pread, so a sample costs a single system call per disk.
+     */
+    class InflightSampler {
+      public:
+        /**
+         * Construct and start the sampling thread.
+         * @param hz the number of samples per second, from 10 up to 100.
+         * @throw Oops if hz is out of range.
+         */
+        InflightSampler( unsigned int hz );
+
+        /**
+         * Stop the sampling thread.
+         */
+        ~InflightSampler();
+
+        /**
+         * Get the histograms accumulated since the previous collect (or construction), and
+         * start new ones. The disks are looked up again when devices were added or removed.
+         * @param histos receives the InflightHisto per whole disk.
+         */
+        void collect( InflightHistoMap &histos );
+
+        /**
+         * The queue depth bucket of a depth: 0, 1, 2, 3-4, 5-8, 9-16, 17-32 and above 32.
+         * @param depth the number of requests in flight.
+         * @return the bucket index, less than inflight_depth_buckets.
+         */
+        static unsigned int depthBucket( unsigned long depth );
+
+        /**
+         * The lowest depth in a queue depth bucket.
+         * @param bucket the bucket index.
+         * @return the lowest depth counted in the bucket.
+         */
+        static unsigned long depthBucketLow( unsigned int bucket );
+
+      private:
+        /** not copyable. */
+        InflightSampler( const InflightSampler& );
+
+        /** not assignable. */
+        InflightSampler& operator=( const InflightSampler& );
+
+        /** open the inflight attributes of the whole disks when the device generation changed. */
+        void scan();
+
+        /** state shared with the thread, which may outlive the sampler. */
+        std::shared_ptr<InflightState> state_;
+
+        /** the device generation at the last scan. */
+        unsigned long generation_;
+    };
+
   }
 
 }
@@ -118,7 +118,7 @@ namespace leanux {
     }
 
     bool getCPUInfo( CPUInfo &info ) {
-      std::ifstream ifs( "/proc/cpuinfo" );
+      std::ifstream ifs( util::ProcFS::path( "cpuinfo" ).c_str() );
       std::string s;
       int num_found = 0;
       while ( ifs.good() && !ifs.eof() && num_found < 3 ) {
@@ -155,7 +155,7 @@ namespace leanux {
     }
 
     void getCPUStats( CPUStatsMap &stats ) {
-      std::ifstream ifs( "/proc/stat" );
+      std::ifstream ifs( util::ProcFS::path( "stat" ).c_str() );
       std::string s;
       stats.clear();
       while ( ifs.good() && !ifs.eof() ) {
@@ -263,28 +263,29 @@ namespace leanux {
 
 
     void getLoadAvg( LoadAvg &avg ) {
-      std::ifstream ifs( "/proc/loadavg" );
-      std::string s;
-      getline( ifs, s );
-      if ( ifs.good() ) {
-        if ( sscanf( s.c_str(), "%lf %lf %lf", &avg.avg5_, &avg.avg10_, &avg.avg15_ ) != 3 )
+      const char *s = util::ProcFS::proc().read( "loadavg" );
+      if ( s ) {
+        if ( sscanf( s, "%lf %lf %lf", &avg.avg5_, &avg.avg10_, &avg.avg15_ ) != 3 )
           throw Oops( __FILE__, __LINE__, "failed to parse /proc/loadavg" );
       } else throw Oops( __FILE__, __LINE__, "unable ro read /proc/loadavg" );
     }
 
     SchedInfo getSchedInfo() {
       SchedInfo rq;
-      std::ifstream ifs( "/proc/stat" );
-      std::string s;
+      const char *s = util::ProcFS::proc().read( "stat" );
       rq.running = 0;
       rq.blocked = 0;
       int match = 0;
-      while ( ifs.good() && !ifs.eof() && match < 4 ) {
-        getline( ifs, s );
-        if ( sscanf( s.c_str(), "procs_running %u", &rq.running ) == 1 ) match++;
-        else if ( sscanf( s.c_str(), "procs_blocked %u", &rq.blocked ) == 1 ) match++;
-        else if ( sscanf( s.c_str(), "processes %lu", &rq.processes ) == 1 ) match++;
-        else if ( sscanf( s.c_str(), "ctxt %lu", &rq.ctxt ) == 1 ) match++;
+      // the per-cpu lines are skipped on their first character
+      while ( s && *s && match < 4 ) {
+        if ( *s != 'c' || s[1] != 'p' ) {
+          if ( sscanf( s, "procs_running %u", &rq.running ) == 1 ) match++;
+          else if ( sscanf( s, "procs_blocked %u", &rq.blocked ) == 1 ) match++;
+          else if ( sscanf( s, "processes %lu", &rq.processes ) == 1 ) match++;
+          else if ( sscanf( s, "ctxt %lu", &rq.ctxt ) == 1 ) match++;
+        }
+        s = strchr( s, '\n' );
+        if ( s ) s++;
       }
       if ( match != 4 ) throw Oops( __FILE__, __LINE__, "/proc/stat parse failure" );
       return rq;
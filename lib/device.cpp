@@ -54,19 +54,23 @@ namespace leanux {
 
   namespace sysdevice {
 
-    const SysDevicePath sysdevice_root = "/sys/devices";
-    const SysDevicePath sysbus_root = "/sys/bus";
+    const SysDevicePath& sysdevice_root = util::SysFS::devices();
+    const SysDevicePath& sysbus_root = util::SysFS::bus();
 
     void SysDevice::tokenize( const SysDevicePath &path, std::list<std::string> &tokens ) {
       std::set<std::string> omit;
       omit.insert("sys");
       omit.insert("devices");
-      util::tokenize( path, tokens, '/', omit, true );
+      const std::string &root = util::getPseudoFSRoot();
+      if ( root.length() && path.compare( 0, root.length(), root ) == 0 )
+        util::tokenize( path.substr( root.length() ), tokens, '/', omit, true );
+      else
+        util::tokenize( path, tokens, '/', omit, true );
     }
 
     bool SysDevice::validatePath( const SysDevicePath &path ) {
       if ( leanux::util::directoryExists( path ) || leanux::util::fileReadAccess( path ) ) {
-        if ( strncmp( path.c_str(), sysdevice_root.c_str(), 12 ) == 0 ) return true;
+        if ( path.compare( 0, sysdevice_root.length(), sysdevice_root ) == 0 ) return true;
       }
       return false;
     }
@@ -1681,28 +1685,28 @@ namespace leanux {
     }
 
     bool VirtualRoot::accept( SysDevicePath &path ) {
-      if ( path == "/sys/devices/virtual" ) {
+      if ( path == sysdevice_root + "/virtual" ) {
         path_ = path;
         leaf_ = "virtual";
-        path = "/sys/devices";
+        path = sysdevice_root;
         return true;
       } else return false;
     }
 
     bool VirtualBlockRoot::accept( SysDevicePath &path ) {
-      if ( path == "/sys/devices/virtual/block" ) {
+      if ( path == sysdevice_root + "/virtual/block" ) {
         path_ = path;
         leaf_ = "block";
-        path = "/sys/devices/virtual";
+        path = sysdevice_root + "/virtual";
         return true;
       } else return false;
     }
 
     bool VirtualNetRoot::accept( SysDevicePath &path ) {
-      if ( path == "/sys/devices/virtual/net" ) {
+      if ( path == sysdevice_root + "/virtual/net" ) {
         path_ = path;
         leaf_ = "net";
-        path = "/sys/devices/virtual";
+        path = sysdevice_root + "/virtual";
         return true;
       } else return false;
     }
@@ -1783,11 +1787,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/class/block" );
+      d = opendir( util::SysFS::path( "class/block" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( "/sys/class/block/" + (std::string)dir->d_name ) );
+            paths.push_back( util::realPath( util::SysFS::path( "class/block/" ) + (std::string)dir->d_name ) );
           }
         }
       }
@@ -1798,11 +1802,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/class/net" );
+      d = opendir( util::SysFS::path( "class/net" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( "/sys/class/net/" + (std::string)dir->d_name ) );
+            paths.push_back( util::realPath( util::SysFS::path( "class/net/" ) + (std::string)dir->d_name ) );
           }
         }
       }
@@ -1813,11 +1817,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/class/pci_bus" );
+      d = opendir( util::SysFS::path( "class/pci_bus" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( "/sys/class/pci_bus/" + (std::string)dir->d_name + "/device" ) );
+            paths.push_back( util::realPath( util::SysFS::path( "class/pci_bus/" ) + (std::string)dir->d_name + "/device" ) );
           }
         }
       }
@@ -1828,11 +1832,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/bus/pci/devices" );
+      d = opendir( ( sysbus_root + "/pci/devices" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( "/sys/bus/pci/devices/" + (std::string)dir->d_name ) );
+            paths.push_back( util::realPath( sysbus_root + "/pci/devices/" + (std::string)dir->d_name ) );
           }
         }
       }
@@ -1843,11 +1847,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/bus/usb/devices" );
+      d = opendir( ( sysbus_root + "/usb/devices" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( "/sys/bus/usb/devices/" + (std::string)dir->d_name ) );
+            paths.push_back( util::realPath( sysbus_root + "/usb/devices/" + (std::string)dir->d_name ) );
           }
         }
       }
@@ -1858,11 +1862,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/class/ata_port" );
+      d = opendir( util::SysFS::path( "class/ata_port" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( "/sys/class/ata_port/" + (std::string)dir->d_name + "/device" ) );
+            paths.push_back( util::realPath( util::SysFS::path( "class/ata_port/" ) + (std::string)dir->d_name + "/device" ) );
           }
         }
       }
@@ -1873,11 +1877,11 @@ namespace leanux {
       paths.clear();
       DIR *d;
       struct dirent *dir;
-      d = opendir( "/sys/class/scsi_host" );
+      d = opendir( util::SysFS::path( "class/scsi_host" ).c_str() );
       if ( d ) {
         while ( (dir = readdir(d)) != NULL ) {
           if ( strlen(dir->d_name) > 0 && dir->d_name[0] != '.' ) {
-            paths.push_back( util::realPath( util::realPath( "/sys/class/scsi_host/" + (std::string)dir->d_name ) + "/../.." ) );
+            paths.push_back( util::realPath( util::realPath( util::SysFS::path( "class/scsi_host/" ) + (std::string)dir->d_name ) + "/../.." ) );
           }
         }
       }
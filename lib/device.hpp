@@ -70,14 +70,14 @@ namespace leanux {
     typedef std::string SysDevicePath;
 
     /**
-     * const for '/sys/devices'
+     * '/sys/devices', below the root set with util::setPseudoFSRoot.
      */
-    extern const SysDevicePath sysdevice_root;
+    extern const SysDevicePath& sysdevice_root;
 
     /**
-     * const for '/sys/bus'
+     * '/sys/bus', below the root set with util::setPseudoFSRoot.
      */
-    extern const SysDevicePath sysbus_root;
+    extern const SysDevicePath& sysbus_root;
 
     class PropertyValue {
       public:
@@ -35,6 +35,7 @@
  */
 #include "system.hpp"
 #include "net.hpp"
+#include "process.hpp"
 #include "util.hpp"
 
 
@@ -46,87 +47,313 @@
 #include <fstream>
 #include <set>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+#include <errno.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
 #include <netdb.h>
 #include <ifaddrs.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/tcp.h>
 
 namespace leanux {
 
   namespace net {
 
-    std::string MACOUIDatabase = "/usr/share/misc/oui.txt";
+    /**
+     * The location of oui.txt, located by the first getMACOUI, empty if not found.
+     */
+    std::string MACOUIDatabase = "";
+
+    /**
+     * Locate oui.txt, which varies among GNU/Linux distributions.
+     */
+    void locateMACOUIDatabase() {
+      const char* paths[] = { "/usr/share/misc/oui.txt", "/usr/share/hwdata/oui.txt", "/usr/share/oui.txt", "/usr/share/ieee-data/oui.txt" };
+      for ( size_t i = 0; i < sizeof(paths)/sizeof(paths[0]); i++ ) {
+        if ( util::fileReadAccess( paths[i] ) ) {
+          MACOUIDatabase = paths[i];
+          return;
+        }
+      }
+    }
 
-    void init() {
-      if ( util::fileReadAccess( "/usr/share/misc/oui.txt" ) ) {
-        MACOUIDatabase = "/usr/share/misc/oui.txt";
-      } else
-      if ( util::fileReadAccess( "/usr/share/hwdata/oui.txt" ) ) {
-        MACOUIDatabase = "/usr/share/hwdata/oui.txt";
-      } else
-      if ( util::fileReadAccess( "/usr/share/oui.txt" ) ) {
-        MACOUIDatabase = "/usr/share/oui.txt";
-      } else
-      if ( util::fileReadAccess( "/usr/share/ieee-data/oui.txt" ) ) {
-        MACOUIDatabase = "/usr/share/ieee-data/oui.txt";
-      } else
-      throw Oops( __FILE__, __LINE__, "leanux cannot find oui.txt file" );
+    /**
+     * Read the first word of a /sys/class/net/[device] attribute, as operator>> would.
+     * @return the word, empty if the attribute cannot be read.
+     */
+    std::string readDeviceWord( const std::string &device, const char *attribute ) {
+      const char *s = util::SysFS::net().read( ( device + "/" + attribute ).c_str() );
+      if ( !s ) return "";
+      while ( isspace( (unsigned char)*s ) ) s++;
+      size_t n = 0;
+      while ( s[n] && !isspace( (unsigned char)s[n] ) ) n++;
+      return std::string( s, n );
     }
 
     std::string getDeviceOperState( const std::string &device ) {
-      std::ifstream i( std::string("/sys/class/net/" + device + "/operstate").c_str() );
-      std::string r;
-      i >> r;
-      return r;
+      return readDeviceWord( device, "operstate" );
     }
 
     unsigned long getDeviceSpeed( const std::string &device ) {
       unsigned long r = 0;
-      try {
-        std::ifstream i( std::string("/sys/class/net/" + device + "/speed").c_str() );
-        i >> r;
-      }
-      catch ( ... ) {
-      }
+      util::SysFS::net().readUL( ( device + "/speed" ).c_str(), r );
       return r;
     }
 
     int getDeviceCarrier( const std::string &device ) {
       int r = 0;
-      try {
-        std::ifstream i( std::string("/sys/class/net/" + device + "/carrier").c_str() );
-        i >> r;
-      }
-      catch ( ... ) {
-      }
+      util::SysFS::net().readInt( ( device + "/carrier" ).c_str(), r );
       return r;
     }
 
     std::string getDeviceDuplex( const std::string &device ) {
-      std::string r = "";
+      return readDeviceWord( device, "duplex" );
+    }
+
+    std::string getDeviceMACAddress( const std::string &device ) {
+      return readDeviceWord( device, "address" );
+    }
+
+    /**
+     * Sorted binary index over oui.txt, so a lookup is a binary search without parsing.
+     * The image is a header, count (prefix,offset) entries sorted by prefix and a pool of
+     * records. A record is the number of address lines followed by the vendor, the country
+     * code and the address lines as nul-terminated strings. The image is written next to the
+     * configuration and mmapped by later processes, it is rebuilt when oui.txt changes.
+     */
+    class OUIIndex {
+      public:
+        OUIIndex() : data_(0), size_(0), mapped_(false) {};
+        ~OUIIndex() { if ( mapped_ ) munmap( (void*)data_, size_ ); };
+
+        /**
+         * Map a valid index for source, or build one.
+         * @return false if source cannot be parsed.
+         */
+        bool load( const std::string &source );
+
+        /**
+         * Find the OUI of a 24 bit MAC prefix.
+         * @return false if not found.
+         */
+        bool find( uint32_t prefix, OUI &oui ) const;
+
+      private:
+        struct Header {
+          char magic[8];
+          uint64_t source_size;
+          int64_t source_mtime;
+          uint32_t count;
+          uint32_t pool_size;
+        };
+
+        struct Entry {
+          uint32_t prefix;
+          uint32_t offset;
+        };
+
+        static const char magic[8];
+
+        bool valid( const char *data, size_t size, const struct stat &source ) const;
+        bool map( const std::string &path, const struct stat &source );
+        bool build( const std::string &source, const struct stat &st );
+        void write( const std::string &path ) const;
+
+        const char *data_;
+        size_t size_;
+        bool mapped_;
+        std::vector<char> image_;
+    };
+
+    const char OUIIndex::magic[8] = { 'L', 'X', 'O', 'U', 'I', 'D', 'X', '1' };
+
+    /**
+     * Candidate index locations, the system wide cache first.
+     */
+    std::list<std::string> getOUIIndexPaths() {
+      std::list<std::string> paths;
+      paths.push_back( "/var/cache/leanux/oui.idx" );
       try {
-        std::ifstream i( std::string("/sys/class/net/" + device + "/duplex").c_str() );
-        i >> r;
+        paths.push_back( util::getUserConfigDir() + "/.leanux-oui.idx" );
       }
-      catch ( ... ) {
+      catch ( const Oops &oops ) {
       }
-      return r;
+      return paths;
     }
 
-    std::string getDeviceMACAddress( const std::string &device ) {
-      std::ifstream i( std::string("/sys/class/net/" + device + "/address").c_str() );
-      std::string r;
-      i >> r;
-      return r;
+    bool OUIIndex::load( const std::string &source ) {
+      struct stat st;
+      if ( stat( source.c_str(), &st ) != 0 ) return false;
+      std::list<std::string> paths = getOUIIndexPaths();
+      for ( std::list<std::string>::const_iterator p = paths.begin(); p != paths.end(); ++p ) {
+        if ( map( *p, st ) ) return true;
+      }
+      if ( !build( source, st ) ) return false;
+      if ( geteuid() == 0 ) mkdir( "/var/cache/leanux", 0755 );
+      for ( std::list<std::string>::const_iterator p = paths.begin(); p != paths.end(); ++p ) {
+        try {
+          write( *p );
+          break;
+        }
+        catch ( const Oops &oops ) {
+        }
+      }
+      return true;
     }
 
-    void getMACOUI( const std::string &mac, OUI &oui ) {
-      oui.vendor = "";
-      oui.countrycode = "";
-      oui.address.clear();
-      std::string search = mac.substr(0,2) + mac.substr(3,2) + mac.substr(6,2);
-      std::transform(search.begin(), search.end(), search.begin(), toupper);
+    bool OUIIndex::valid( const char *data, size_t size, const struct stat &source ) const {
+      if ( size < sizeof(Header) ) return false;
+      const Header *h = (const Header*)data;
+      if ( memcmp( h->magic, magic, sizeof(magic) ) != 0 ) return false;
+      if ( h->source_size != (uint64_t)source.st_size || h->source_mtime != (int64_t)source.st_mtime ) return false;
+      if ( size != sizeof(Header) + (size_t)h->count * sizeof(Entry) + h->pool_size ) return false;
+      // all strings in the pool are terminated
+      return h->pool_size == 0 || data[size-1] == 0;
+    }
+
+    bool OUIIndex::map( const std::string &path, const struct stat &source ) {
+      int fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 ) return false;
+      struct stat st;
+      void *p = MAP_FAILED;
+      if ( fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+        p = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+      }
+      close( fd );
+      if ( p == MAP_FAILED ) return false;
+      if ( !valid( (const char*)p, st.st_size, source ) ) {
+        munmap( p, st.st_size );
+        return false;
+      }
+      data_ = (const char*)p;
+      size_ = st.st_size;
+      mapped_ = true;
+      return true;
+    }
 
+    bool OUIIndex::build( const std::string &source, const struct stat &st ) {
+      std::ifstream f( source.c_str() );
+      if ( !f.good() ) return false;
+      std::vector<Entry> entries;
+      std::vector<char> pool;
+      std::string s;
+      while ( getline( f, s ) ) {
+        if ( s.length() > 0 && s[s.length()-1] == '\r' ) s.erase( s.length() - 1 );
+        // the '286FB9     (base 16)		vendor' line starts a record
+        if ( s.length() < 7 || !( s[6] == ' ' || s[6] == '\t' ) ) continue;
+        char *end = 0;
+        std::string hex = s.substr( 0, 6 );
+        unsigned long prefix = strtoul( hex.c_str(), &end, 16 );
+        if ( end != hex.c_str() + 6 ) continue;
+        size_t lasttab = s.find_last_of( '\t' );
+        if ( lasttab == std::string::npos || lasttab >= s.length() - 1 ) return false;
+        std::string vendor = s.substr( lasttab + 1 );
+        std::vector<std::string> lines;
+        while ( lines.size() < 10 && getline( f, s ) ) {
+          if ( s.length() > 0 && s[s.length()-1] == '\r' ) s.erase( s.length() - 1 );
+          if ( s == "" ) break;
+          lasttab = s.find_last_of( '\t' );
+          if ( lasttab != std::string::npos ) lines.push_back( s.substr( lasttab + 1 ) ); else break;
+        }
+        Entry e;
+        e.prefix = prefix;
+        e.offset = pool.size();
+        entries.push_back( e );
+        // the last line is the country code, private registrations have no address
+        pool.push_back( lines.size() > 1 ? lines.size() - 1 : 0 );
+        pool.insert( pool.end(), vendor.c_str(), vendor.c_str() + vendor.length() + 1 );
+        std::string country = lines.size() > 1 ? lines.back() : "";
+        pool.insert( pool.end(), country.c_str(), country.c_str() + country.length() + 1 );
+        for ( size_t l = 0; l + 1 < lines.size(); l++ ) {
+          pool.insert( pool.end(), lines[l].c_str(), lines[l].c_str() + lines[l].length() + 1 );
+        }
+      }
+      if ( entries.empty() ) return false;
+      // as the linear scan did, the first record of a duplicate prefix wins
+      std::stable_sort( entries.begin(), entries.end(), []( const Entry &a, const Entry &b ) { return a.prefix < b.prefix; } );
+      entries.erase( std::unique( entries.begin(), entries.end(), []( const Entry &a, const Entry &b ) { return a.prefix == b.prefix; } ), entries.end() );
+      Header h;
+      memcpy( h.magic, magic, sizeof(magic) );
+      h.source_size = st.st_size;
+      h.source_mtime = st.st_mtime;
+      h.count = entries.size();
+      h.pool_size = pool.size();
+      image_.resize( sizeof(Header) + entries.size() * sizeof(Entry) + pool.size() );
+      memcpy( image_.data(), &h, sizeof(h) );
+      memcpy( image_.data() + sizeof(h), entries.data(), entries.size() * sizeof(Entry) );
+      memcpy( image_.data() + sizeof(h) + entries.size() * sizeof(Entry), pool.data(), pool.size() );
+      data_ = image_.data();
+      size_ = image_.size();
+      return true;
+    }
+
+    void OUIIndex::write( const std::string &path ) const {
+      // write aside and rename, so concurrent readers never map a partial index
+      std::string tmp = path + ".XXXXXX";
+      std::vector<char> name( tmp.c_str(), tmp.c_str() + tmp.length() + 1 );
+      int fd = mkstemp( name.data() );
+      if ( fd < 0 ) throw Oops( __FILE__, __LINE__, errno );
+      bool ok = fchmod( fd, 0644 ) == 0 && ::write( fd, data_, size_ ) == (ssize_t)size_;
+      ok = close( fd ) == 0 && ok;
+      if ( !ok || rename( name.data(), path.c_str() ) != 0 ) {
+        int e = errno;
+        unlink( name.data() );
+        throw Oops( __FILE__, __LINE__, e );
+      }
+    }
+
+    bool OUIIndex::find( uint32_t prefix, OUI &oui ) const {
+      const Header *h = (const Header*)data_;
+      const Entry *first = (const Entry*)( data_ + sizeof(Header) );
+      const Entry *last = first + h->count;
+      const Entry *e = std::lower_bound( first, last, prefix, []( const Entry &a, uint32_t p ) { return a.prefix < p; } );
+      if ( e == last || e->prefix != prefix || e->offset >= h->pool_size ) return false;
+      const char *pool = (const char*)last;
+      const char *r = pool + e->offset;
+      unsigned int lines = (unsigned char)*r++;
+      oui.vendor = r;
+      r += oui.vendor.length() + 1;
+      oui.countrycode = r;
+      r += oui.countrycode.length() + 1;
+      for ( unsigned int l = 0; l < lines && r < pool + h->pool_size; l++ ) {
+        oui.address.push_back( r );
+        r += oui.address.back().length() + 1;
+      }
+      return true;
+    }
+
+    /**
+     * The index over MACOUIDatabase, loaded on the first getMACOUI.
+     */
+    OUIIndex oui_index;
+    std::once_flag oui_index_once;
+    bool oui_index_loaded = false;
+
+    /**
+     * Find the OUI by scanning oui.txt, used when no index can be built.
+     */
+    void scanMACOUI( const std::string &search, OUI &oui ) {
       std::ifstream f( MACOUIDatabase.c_str() );
       if ( !f.good() ) throw Oops( __FILE__, __LINE__, "error opening oui.txt" );
 
@@ -158,6 +385,25 @@ namespace leanux {
       }
     }
 
+    void getMACOUI( const std::string &mac, OUI &oui ) {
+      oui.vendor = "";
+      oui.countrycode = "";
+      oui.address.clear();
+      std::string search = mac.substr(0,2) + mac.substr(3,2) + mac.substr(6,2);
+      std::transform(search.begin(), search.end(), search.begin(), toupper);
+
+      std::call_once( oui_index_once, []() {
+        locateMACOUIDatabase();
+        if ( MACOUIDatabase != "" ) oui_index_loaded = oui_index.load( MACOUIDatabase );
+      } );
+      if ( MACOUIDatabase == "" ) return;
+      if ( oui_index_loaded ) {
+        char *end = 0;
+        uint32_t prefix = strtoul( search.c_str(), &end, 16 );
+        if ( end == search.c_str() + 6 ) oui_index.find( prefix, oui );
+      } else scanMACOUI( search, oui );
+    }
+
     void getDeviceIP4Addresses( const std::string &device, std::list<std::string> &addrlist ) {
       addrlist.clear();
       struct ifaddrs *ifap, *ifa;
@@ -180,7 +426,7 @@ namespace leanux {
 
     void getDeviceIP6Addresses( const std::string &device, std::list<std::string> &addrlist ) {
       addrlist.clear();
-      std::ifstream i( "/proc/net/if_inet6" );
+      std::ifstream i( util::ProcFS::path( "net/if_inet6" ).c_str() );
       while ( i.good() && ! i.eof() ) {
         std::string s;
         getline( i, s );
@@ -280,7 +526,7 @@ namespace leanux {
 
     void enumDevices( std::list<std::string> &devices ) {
       devices.clear();
-      std::ifstream ifs( "/proc/net/dev" );
+      std::ifstream ifs( util::ProcFS::path( "net/dev" ).c_str() );
       if ( ! ifs.good() ) throw Oops( __FILE__, __LINE__, "unable to read /proc/net/dev" );
       while ( ifs.good() && ! ifs.eof() ) {
         std::string s;
@@ -294,7 +540,7 @@ namespace leanux {
     }
 
     void enumTCP4Sockets( std::list<TCP4SocketInfo> &sockets ) {
-      std::ifstream i( "/proc/net/tcp" );
+      std::ifstream i( util::ProcFS::path( "net/tcp" ).c_str() );
       sockets.clear();
       while ( i.good() && ! i.eof() ) {
         std::string s;
@@ -307,7 +553,7 @@ namespace leanux {
     }
 
     void enumTCP6Sockets( std::list<TCP6SocketInfo> &sockets ) {
-      std::ifstream i( "/proc/net/tcp6" );
+      std::ifstream i( util::ProcFS::path( "net/tcp6" ).c_str() );
       sockets.clear();
       while ( i.good() && ! i.eof() ) {
         std::string s;
@@ -319,6 +565,159 @@ namespace leanux {
       }
     }
 
+    /**
+     * Copy the fields of interest from the INET_DIAG_INFO attribute of an inet_diag_msg, if any.
+     * Older kernels send a shorter struct tcp_info, the missing fields are 0.
+     * @return true if the message has an INET_DIAG_INFO attribute.
+     */
+    bool getDiagTCPInfo( struct nlmsghdr *h, TCPInfo &info ) {
+      struct inet_diag_msg *msg = (struct inet_diag_msg*)NLMSG_DATA( h );
+      int len = h->nlmsg_len - NLMSG_LENGTH( sizeof(*msg) );
+      for ( struct rtattr *attr = (struct rtattr*)(msg + 1); RTA_OK( attr, len ); attr = RTA_NEXT( attr, len ) ) {
+        if ( attr->rta_type == INET_DIAG_INFO ) {
+          struct tcp_info ti;
+          memset( &ti, 0, sizeof(ti) );
+          memcpy( &ti, RTA_DATA( attr ), std::min( (size_t)RTA_PAYLOAD( attr ), sizeof(ti) ) );
+          info.rtt = ti.tcpi_rtt;
+          info.rttvar = ti.tcpi_rttvar;
+          info.snd_cwnd = ti.tcpi_snd_cwnd;
+          info.total_retrans = ti.tcpi_total_retrans;
+          info.delivery_rate = ti.tcpi_delivery_rate;
+          info.busy_time = ti.tcpi_busy_time;
+          info.rwnd_limited = ti.tcpi_rwnd_limited;
+          info.sndbuf_limited = ti.tcpi_sndbuf_limited;
+          info.bytes_acked = ti.tcpi_bytes_acked;
+          info.bytes_received = ti.tcpi_bytes_received;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool diagTCPSockets( int family, unsigned int states, TCPSocketSink &sink, bool want_info ) {
+      int fd = socket( AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG );
+      if ( fd < 0 ) return false;
+      struct {
+        struct nlmsghdr nlh;
+        struct inet_diag_req_v2 req;
+      } request;
+      memset( &request, 0, sizeof(request) );
+      request.nlh.nlmsg_len = sizeof(request);
+      request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+      request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+      request.req.sdiag_family = family;
+      request.req.sdiag_protocol = IPPROTO_TCP;
+      request.req.idiag_states = states;
+      if ( want_info ) request.req.idiag_ext = 1 << ( INET_DIAG_INFO - 1 );
+      struct sockaddr_nl kernel;
+      memset( &kernel, 0, sizeof(kernel) );
+      kernel.nl_family = AF_NETLINK;
+      if ( sendto( fd, &request, sizeof(request), 0, (struct sockaddr*)&kernel, sizeof(kernel) ) < 0 ) {
+        int error = errno;
+        close( fd );
+        errno = error;
+        return false;
+      }
+      // a dump arrives as a series of datagrams, each holding as many records as fit
+      static const size_t bufsize = 65536;
+      std::vector<char> buf( bufsize );
+      unsigned long streamed = 0;
+      TCPInfo tcpinfo;
+      bool done = false;
+      int error = 0;
+      try {
+        while ( !done && !error ) {
+          ssize_t r = recv( fd, buf.data(), bufsize, 0 );
+          if ( r < 0 ) {
+            if ( errno == EINTR ) continue;
+            error = errno;
+            break;
+          }
+          if ( r == 0 ) break;
+          for ( struct nlmsghdr *h = (struct nlmsghdr*)buf.data(); NLMSG_OK( h, r ); h = NLMSG_NEXT( h, r ) ) {
+            if ( h->nlmsg_type == NLMSG_DONE ) {
+              done = true;
+              break;
+            } else if ( h->nlmsg_type == NLMSG_ERROR ) {
+              struct nlmsgerr *e = (struct nlmsgerr*)NLMSG_DATA( h );
+              error = e->error ? -e->error : EPROTO;
+              break;
+            }
+            struct inet_diag_msg *msg = (struct inet_diag_msg*)NLMSG_DATA( h );
+            if ( msg->idiag_family == AF_INET ) {
+              TCP4SocketInfo info;
+              // same representation as parsed from /proc/net/tcp
+              info.local_addr = msg->id.idiag_src[0];
+              info.local_port = ntohs( msg->id.idiag_sport );
+              info.remote_addr = msg->id.idiag_dst[0];
+              info.remote_port = ntohs( msg->id.idiag_dport );
+              info.tcp_state = msg->idiag_state;
+              info.tx_queue = msg->idiag_wqueue;
+              info.rx_queue = msg->idiag_rqueue;
+              info.uid = msg->idiag_uid;
+              info.inode = msg->idiag_inode;
+              if ( want_info && getDiagTCPInfo( h, tcpinfo ) ) sink.putInfo( info, tcpinfo );
+              else sink.put( info );
+            } else if ( msg->idiag_family == AF_INET6 ) {
+              TCP6SocketInfo info;
+              memcpy( info.local_addr.s6_addr, msg->id.idiag_src, sizeof(info.local_addr.s6_addr) );
+              info.local_port = ntohs( msg->id.idiag_sport );
+              memcpy( info.remote_addr.s6_addr, msg->id.idiag_dst, sizeof(info.remote_addr.s6_addr) );
+              info.remote_port = ntohs( msg->id.idiag_dport );
+              info.tcp_state = msg->idiag_state;
+              info.tx_queue = msg->idiag_wqueue;
+              info.rx_queue = msg->idiag_rqueue;
+              info.uid = msg->idiag_uid;
+              info.inode = msg->idiag_inode;
+              if ( want_info && getDiagTCPInfo( h, tcpinfo ) ) sink.putInfo( info, tcpinfo );
+              else sink.put( info );
+            }
+            streamed++;
+          }
+        }
+      } catch ( ... ) {
+        // the sink threw
+        close( fd );
+        throw;
+      }
+      close( fd );
+      if ( done ) return true;
+      if ( streamed == 0 ) {
+        errno = error ? error : EPROTO;
+        return false;
+      }
+      throw Oops( __FILE__, __LINE__, error ? error : EPROTO );
+    }
+
+    void procTCPSockets( int family, unsigned int states, TCPSocketSink &sink ) {
+      std::ifstream i( util::ProcFS::path( family == AF_INET6 ? "net/tcp6" : "net/tcp" ).c_str() );
+      std::string s;
+      while ( getline( i, s ) ) {
+        if ( family == AF_INET6 ) {
+          TCP6SocketInfo inf;
+          if ( parseTCP6Line( s, inf ) && inf.tcp_state < 32 && ( states & (1U << inf.tcp_state) ) ) sink.put( inf );
+        } else {
+          TCP4SocketInfo inf;
+          if ( parseTCP4Line( s, inf ) && inf.tcp_state < 32 && ( states & (1U << inf.tcp_state) ) ) sink.put( inf );
+        }
+      }
+    }
+
+    /**
+     * Set once diagTCPSockets failed because sock_diag is not supported, after which
+     * streamTCPSockets reads /proc. Transient failures fall back to /proc for that call only.
+     */
+    std::atomic<bool> tcp_diag_unavailable( false );
+
+    bool streamTCPSockets( int family, unsigned int states, TCPSocketSink &sink, bool info ) {
+      if ( !tcp_diag_unavailable ) {
+        if ( diagTCPSockets( family, states, sink, info ) ) return true;
+        if ( errno == EPROTONOSUPPORT || errno == ENOENT ) tcp_diag_unavailable = true;
+      }
+      procTCPSockets( family, states, sink );
+      return false;
+    }
+
     std::string getTCPStateString( int tcp_state ) {
       switch( tcp_state ) {
         case TCP_ESTABLISHED:
@@ -370,6 +769,21 @@ namespace leanux {
       return os;
     }
 
+    std::ostream& operator<<( std::ostream& os, const TCP6SocketInfo &inf ) {
+      os << "(tcp6 socket";
+      os << " status=" << getTCPStateString( inf.tcp_state );
+      os << " user=" << system::getUserName( inf.uid );
+      os << " inode=" << inf.inode;
+      os << " rxq=" << inf.rx_queue;
+      os << " txq=" << inf.tx_queue;
+      os << " local=[" << convertAF_INET6( &inf.local_addr ) << "]:" << inf.local_port;
+      if ( inf.tcp_state != TCP_LISTEN ) {
+        os << " remote=[" << convertAF_INET6( &inf.remote_addr ) << "]:" << inf.remote_port;
+      }
+      os << ")";
+      return os;
+    }
+
     int whatAF_INET( const std::string &addr ) {
       struct addrinfo hint, *res = NULL;
       int ret;
@@ -409,6 +823,144 @@ namespace leanux {
       return "";
     }
 
+    struct ResolverState {
+      /** a cached address. */
+      struct Entry {
+        /** the address. */
+        std::string addr;
+        /** the resolved name, the address itself if unknown. */
+        std::string name;
+        /** when the entry must be resolved again. */
+        time_t expires;
+        /** true while queued or being resolved. */
+        bool pending;
+      };
+      /** protects all members. */
+      std::mutex mutex;
+      /** signals the threads that the queue is not empty or stop is set. */
+      std::condition_variable work;
+      /** signals waiters that pending dropped to zero. */
+      std::condition_variable idle;
+      /** cached entries, most recently used first. */
+      std::list<Entry> lru;
+      /** lru entries by address. */
+      std::unordered_map<std::string,std::list<Entry>::iterator> index;
+      /** addresses to resolve. */
+      std::deque<std::string> queue;
+      /** number of queued and in progress lookups. */
+      size_t pending;
+      /** number of threads. */
+      unsigned int workers;
+      /** number of threads resolving. */
+      unsigned int busy;
+      /** maximum number of threads. */
+      unsigned int max_workers;
+      /** maximum number of entries. */
+      size_t capacity;
+      /** seconds a name is cached. */
+      unsigned int positive_ttl;
+      /** seconds a failure is cached. */
+      unsigned int negative_ttl;
+      /** the threads exit when set. */
+      bool stop;
+    };
+
+    /**
+     * Resolver thread.
+     */
+    void resolverWorker( std::shared_ptr<ResolverState> state ) {
+      std::unique_lock<std::mutex> lock( state->mutex );
+      while ( true ) {
+        state->work.wait( lock, [&state]() { return state->stop || !state->queue.empty(); } );
+        if ( state->stop ) break;
+        std::string addr = state->queue.front();
+        state->queue.pop_front();
+        state->busy++;
+        lock.unlock();
+        std::string name = "";
+        try {
+          name = resolveIP( addr );
+        }
+        catch ( const Oops &oops ) {
+        }
+        lock.lock();
+        state->busy--;
+        std::unordered_map<std::string,std::list<ResolverState::Entry>::iterator>::iterator i = state->index.find( addr );
+        if ( i != state->index.end() ) {
+          bool resolved = name != "" && name != addr;
+          i->second->name = resolved ? name : addr;
+          i->second->expires = time( 0 ) + ( resolved ? state->positive_ttl : state->negative_ttl );
+          i->second->pending = false;
+        }
+        if ( --state->pending == 0 ) state->idle.notify_all();
+      }
+      state->workers--;
+    }
+
+    Resolver::Resolver( unsigned int workers, size_t capacity, unsigned int positive_ttl, unsigned int negative_ttl ) : state_( new ResolverState() ) {
+      state_->pending = 0;
+      state_->workers = 0;
+      state_->busy = 0;
+      state_->max_workers = workers > 0 ? workers : 1;
+      state_->capacity = capacity > 0 ? capacity : 1;
+      state_->positive_ttl = positive_ttl;
+      state_->negative_ttl = negative_ttl;
+      state_->stop = false;
+    }
+
+    Resolver::~Resolver() {
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      state_->stop = true;
+      state_->work.notify_all();
+      state_->idle.notify_all();
+    }
+
+    std::string Resolver::lookup( const std::string &addr ) {
+      std::lock_guard<std::mutex> lock( state_->mutex );
+      std::list<ResolverState::Entry> &lru = state_->lru;
+      std::string result = addr;
+      std::unordered_map<std::string,std::list<ResolverState::Entry>::iterator>::iterator i = state_->index.find( addr );
+      if ( i != state_->index.end() ) {
+        lru.splice( lru.begin(), lru, i->second );
+        ResolverState::Entry &e = *i->second;
+        // an expired name is still returned while it is resolved again
+        if ( e.pending || e.expires > time( 0 ) || state_->queue.size() >= state_->capacity ) return e.name;
+        e.pending = true;
+        result = e.name;
+      } else {
+        if ( state_->queue.size() >= state_->capacity ) return addr;
+        ResolverState::Entry e;
+        e.addr = addr;
+        e.name = addr;
+        e.expires = 0;
+        e.pending = true;
+        lru.push_front( e );
+        state_->index[addr] = lru.begin();
+        // evict the least recently used, entries being resolved stay
+        std::list<ResolverState::Entry>::iterator victim = lru.end();
+        while ( lru.size() > state_->capacity && victim != lru.begin() ) {
+          --victim;
+          if ( !victim->pending ) {
+            state_->index.erase( victim->addr );
+            victim = lru.erase( victim );
+          }
+        }
+      }
+      state_->queue.push_back( addr );
+      state_->pending++;
+      if ( state_->workers < state_->max_workers && state_->queue.size() > state_->workers - state_->busy ) {
+        state_->workers++;
+        std::thread( resolverWorker, state_ ).detach();
+      }
+      state_->work.notify_one();
+      return result;
+    }
+
+    bool Resolver::wait( unsigned int ms ) {
+      std::unique_lock<std::mutex> lock( state_->mutex );
+      return state_->idle.wait_for( lock, std::chrono::milliseconds( ms ), [this]() { return state_->pending == 0 || state_->stop; } ) && state_->pending == 0;
+    }
+
     std::string getServiceName( int port ) {
       struct servent* se = getservbyport( htons(port), NULL );
       if ( se ) return se->s_name; else {
@@ -419,7 +971,7 @@ namespace leanux {
     }
 
     std::string getSysPath( const std::string &device ) {
-      std::string rel = "/sys/class/net/" + device;
+      std::string rel = util::SysFS::path( "class/net/" ) + device;
       if ( util::directoryExists( rel ) ) {
         return util::realPath( rel );
       }
@@ -428,7 +980,7 @@ namespace leanux {
 
     bool findTCP4SocketByINode( ino_t inode, TCP4SocketInfo &info ) {
       bool result = false;
-      std::ifstream i( "/proc/net/tcp" );
+      std::ifstream i( util::ProcFS::path( "net/tcp" ).c_str() );
       while ( i.good() && ! i.eof() ) {
         std::string s;
         getline( i, s );
@@ -442,20 +994,31 @@ namespace leanux {
       return result;
     }
 
+    /**
+     * parse a line from /proc/net/unix.
+     */
+    bool parseUnixDomainLine( const std::string &s, UnixDomainSocketInfo &info ) {
+      UnixDomainSocketInfo tmp;
+      char buf[2048];
+      memset( buf, 0, sizeof(buf) );
+      int r = sscanf( s.c_str(), "%*x: %lu %*u %lu %*u %u %lu %2047s",
+                                 &tmp.refcount, &tmp.flags, &tmp.state, &tmp.inode, buf );
+      if ( r >= 4 ) {
+        info = tmp;
+        info.path = buf;
+        return true;
+      } else return false;
+    }
+
     bool findUnixDomainSocketByINode( ino_t inode, UnixDomainSocketInfo &info ) {
       bool result = false;
-      std::ifstream i( "/proc/net/unix" );
+      std::ifstream i( util::ProcFS::path( "net/unix" ).c_str() );
       while ( i.good() && ! i.eof() ) {
         std::string s;
         getline( i, s );
         UnixDomainSocketInfo tmp;
-        char buf[2048];
-        memset( buf, 0, sizeof(buf) );
-        int r = sscanf( s.c_str(), "%*x: %lu %*u %lu %*u %u %lu %s",
-                                   &tmp.refcount, &tmp.flags, &tmp.state, &tmp.inode, buf );
-        if ( r >= 4  && tmp.inode == inode ) {
+        if ( parseUnixDomainLine( s, tmp ) && tmp.inode == inode ) {
           info = tmp;
-          info.path = buf;
           result = true;
           break;
         }
@@ -489,7 +1052,7 @@ namespace leanux {
 
     bool findUDP4SocketByINode( ino_t inode, UDP4SocketInfo &info ) {
       bool result = false;
-      std::ifstream i( "/proc/net/udp" );
+      std::ifstream i( util::ProcFS::path( "net/udp" ).c_str() );
       while ( i.good() && ! i.eof() ) {
         std::string s;
         getline( i, s );
@@ -523,16 +1086,235 @@ namespace leanux {
       return os;
     }
 
-    void getNetStat( NetStatDeviceMap &stats ) {
+    /**
+     * TCPSocketSink adding the sockets to the SocketIndex maps. Sockets without an
+     * inode (TIME_WAIT, orphans) cannot be open files and are skipped.
+     */
+    class SocketIndexSink : public TCPSocketSink {
+      public:
+        SocketIndexSink( std::unordered_map<ino_t,TCP4SocketInfo> &tcp4, std::unordered_map<ino_t,TCP6SocketInfo> &tcp6 ) :
+          tcp4_( tcp4 ), tcp6_( tcp6 ) {};
+        virtual void put( const TCP4SocketInfo &info ) { if ( info.inode ) tcp4_[info.inode] = info; };
+        virtual void put( const TCP6SocketInfo &info ) { if ( info.inode ) tcp6_[info.inode] = info; };
+      private:
+        std::unordered_map<ino_t,TCP4SocketInfo> &tcp4_;
+        std::unordered_map<ino_t,TCP6SocketInfo> &tcp6_;
+    };
+
+    void SocketIndex::refresh() {
+      tcp4_.clear();
+      tcp6_.clear();
+      udp4_.clear();
+      unix_.clear();
+      SocketIndexSink sink( tcp4_, tcp6_ );
+      streamTCPSockets( AF_INET, TCP_STATES_ALL, sink );
+      streamTCPSockets( AF_INET6, TCP_STATES_ALL, sink );
+      std::string s;
+      std::ifstream udp( util::ProcFS::path( "net/udp" ).c_str() );
+      while ( getline( udp, s ) ) {
+        UDP4SocketInfo info;
+        if ( parseUDP4Line( s, info ) && info.inode ) udp4_[info.inode] = info;
+      }
+      std::ifstream uds( util::ProcFS::path( "net/unix" ).c_str() );
+      while ( getline( uds, s ) ) {
+        UnixDomainSocketInfo info;
+        if ( parseUnixDomainLine( s, info ) && info.inode ) unix_[info.inode] = info;
+      }
+    }
+
+    bool SocketIndex::findTCP4( ino_t inode, TCP4SocketInfo &info ) const {
+      std::unordered_map<ino_t,TCP4SocketInfo>::const_iterator i = tcp4_.find( inode );
+      if ( i == tcp4_.end() ) return false;
+      info = i->second;
+      return true;
+    }
+
+    bool SocketIndex::findTCP6( ino_t inode, TCP6SocketInfo &info ) const {
+      std::unordered_map<ino_t,TCP6SocketInfo>::const_iterator i = tcp6_.find( inode );
+      if ( i == tcp6_.end() ) return false;
+      info = i->second;
+      return true;
+    }
+
+    bool SocketIndex::findUDP4( ino_t inode, UDP4SocketInfo &info ) const {
+      std::unordered_map<ino_t,UDP4SocketInfo>::const_iterator i = udp4_.find( inode );
+      if ( i == udp4_.end() ) return false;
+      info = i->second;
+      return true;
+    }
+
+    bool SocketIndex::findUnixDomain( ino_t inode, UnixDomainSocketInfo &info ) const {
+      std::unordered_map<ino_t,UnixDomainSocketInfo>::const_iterator i = unix_.find( inode );
+      if ( i == unix_.end() ) return false;
+      info = i->second;
+      return true;
+    }
+
+    NetDeviceFilter::NetDeviceFilter( const std::list<std::string> &prefixes ) {
+      for ( std::list<std::string>::const_iterator i = prefixes.begin(); i != prefixes.end(); ++i ) {
+        exclude( *i );
+      }
+    }
+
+    void NetDeviceFilter::exclude( const std::string &prefix ) {
+      size_t b = prefix.find_first_not_of( " \t" );
+      if ( b == std::string::npos ) return;
+      size_t e = prefix.find_last_not_of( " \t" );
+      prefixes_.push_back( prefix.substr( b, e - b + 1 ) );
+    }
+
+    bool NetDeviceFilter::accept( const char *device ) const {
+      for ( std::vector<std::string>::const_iterator i = prefixes_.begin(); i != prefixes_.end(); ++i ) {
+        if ( strncmp( device, (*i).c_str(), (*i).length() ) == 0 ) return false;
+      }
+      return true;
+    }
+
+    /**
+     * Fill a NetStat from rtnl_link_stats64, aggregating into the /proc/net/dev fields
+     * the same way the kernel does.
+     */
+    void fillNetStat( NetStat &ns, const struct rtattr *stats64 ) {
+      // older kernels may send a shorter struct, the missing tail reads as zero
+      struct rtnl_link_stats64 ls;
+      memset( &ls, 0, sizeof(ls) );
+      memcpy( &ls, RTA_DATA( stats64 ), std::min( (size_t)RTA_PAYLOAD( stats64 ), sizeof(ls) ) );
+      ns.rx_bytes = ls.rx_bytes;
+      ns.rx_packets = ls.rx_packets;
+      ns.rx_errors = ls.rx_errors;
+      ns.rx_dropped = ls.rx_dropped + ls.rx_missed_errors;
+      ns.rx_fifo = ls.rx_fifo_errors;
+      ns.rx_frame = ls.rx_length_errors + ls.rx_over_errors + ls.rx_crc_errors + ls.rx_frame_errors;
+      ns.rx_compressed = ls.rx_compressed;
+      ns.rx_multicast = ls.multicast;
+      ns.tx_bytes = ls.tx_bytes;
+      ns.tx_packets = ls.tx_packets;
+      ns.tx_errors = ls.tx_errors;
+      ns.tx_dropped = ls.tx_dropped;
+      ns.tx_fifo = ls.tx_fifo_errors;
+      ns.tx_collisions = ls.collisions;
+      ns.tx_carrier = ls.tx_carrier_errors + ls.tx_aborted_errors + ls.tx_window_errors + ls.tx_heartbeat_errors;
+      ns.tx_compressed = ls.tx_compressed;
+      ns.detailed = true;
+      ns.rx_length_errors = ls.rx_length_errors;
+      ns.rx_over_errors = ls.rx_over_errors;
+      ns.rx_crc_errors = ls.rx_crc_errors;
+      ns.rx_frame_errors = ls.rx_frame_errors;
+      ns.rx_missed_errors = ls.rx_missed_errors;
+      ns.rx_nohandler = ls.rx_nohandler;
+      ns.tx_aborted_errors = ls.tx_aborted_errors;
+      ns.tx_carrier_errors = ls.tx_carrier_errors;
+      ns.tx_window_errors = ls.tx_window_errors;
+      ns.tx_heartbeat_errors = ls.tx_heartbeat_errors;
+    }
+
+    /**
+     * Send a rtnetlink dump request and pass each reply message to handler.
+     * @return true if the dump completed, otherwise errno holds the reason.
+     */
+    bool rtnlDump( int fd, struct nlmsghdr *request, const std::function<void(struct nlmsghdr*)> &handler ) {
+      struct sockaddr_nl kernel;
+      memset( &kernel, 0, sizeof(kernel) );
+      kernel.nl_family = AF_NETLINK;
+      if ( sendto( fd, request, request->nlmsg_len, 0, (struct sockaddr*)&kernel, sizeof(kernel) ) < 0 ) return false;
+      static const size_t bufsize = 65536;
+      std::vector<char> buf( bufsize );
+      while ( true ) {
+        ssize_t r = recv( fd, buf.data(), bufsize, 0 );
+        if ( r < 0 && errno == EINTR ) continue;
+        if ( r == 0 ) errno = EIO;
+        if ( r <= 0 ) return false;
+        for ( struct nlmsghdr *h = (struct nlmsghdr*)buf.data(); NLMSG_OK( h, r ); h = NLMSG_NEXT( h, r ) ) {
+          if ( h->nlmsg_type == NLMSG_DONE ) return true;
+          if ( h->nlmsg_type == NLMSG_ERROR ) {
+            struct nlmsgerr *err = (struct nlmsgerr*)NLMSG_DATA( h );
+            errno = err->error ? -err->error : EPROTO;
+            return false;
+          }
+          handler( h );
+        }
+      }
+    }
+
+    bool linkNetStat( NetStatDeviceMap &stats, const NetDeviceFilter *filter ) {
       stats.clear();
-      std::ifstream ifs( "/proc/net/dev" );
+      int fd = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE );
+      if ( fd < 0 ) return false;
+      bool done = false;
+      {
+        // RTM_GETSTATS (linux 4.7) returns just the counters, far cheaper than a link dump
+        struct {
+          struct nlmsghdr nlh;
+          struct if_stats_msg ifsm;
+        } request;
+        memset( &request, 0, sizeof(request) );
+        request.nlh.nlmsg_len = sizeof(request);
+        request.nlh.nlmsg_type = RTM_GETSTATS;
+        request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        request.ifsm.filter_mask = IFLA_STATS_FILTER_BIT( IFLA_STATS_LINK_64 );
+        done = rtnlDump( fd, &request.nlh, [&]( struct nlmsghdr *h ) {
+          if ( h->nlmsg_type != RTM_NEWSTATS ) return;
+          struct if_stats_msg *ifsm = (struct if_stats_msg*)NLMSG_DATA( h );
+          // the replies carry only the index, and devices may be renamed (udev does so right after
+          // creation) or swap names at any time, so the name is resolved in every sample
+          struct ifreq ifr;
+          memset( &ifr, 0, sizeof(ifr) );
+          ifr.ifr_ifindex = ifsm->ifindex;
+          if ( ioctl( fd, SIOCGIFNAME, &ifr ) != 0 ) return;
+          if ( filter && !filter->accept( ifr.ifr_name ) ) return;
+          int len = h->nlmsg_len - NLMSG_LENGTH( sizeof(*ifsm) );
+          for ( struct rtattr *a = (struct rtattr*)( (char*)ifsm + NLMSG_ALIGN( sizeof(*ifsm) ) ); RTA_OK( a, len ); a = RTA_NEXT( a, len ) ) {
+            if ( a->rta_type == IFLA_STATS_LINK_64 ) fillNetStat( stats[ifr.ifr_name], a );
+          }
+        } );
+      }
+      if ( !done ) {
+        // older kernels, dump the links and take IFLA_STATS64. The failed dump may have left
+        // replies queued on the socket, so the fallback uses a fresh one.
+        stats.clear();
+        close( fd );
+        fd = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE );
+        if ( fd < 0 ) return false;
+        struct {
+          struct nlmsghdr nlh;
+          struct ifinfomsg ifi;
+        } request;
+        memset( &request, 0, sizeof(request) );
+        request.nlh.nlmsg_len = sizeof(request);
+        request.nlh.nlmsg_type = RTM_GETLINK;
+        request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        request.ifi.ifi_family = AF_UNSPEC;
+        done = rtnlDump( fd, &request.nlh, [&]( struct nlmsghdr *h ) {
+          if ( h->nlmsg_type != RTM_NEWLINK ) return;
+          struct ifinfomsg *ifi = (struct ifinfomsg*)NLMSG_DATA( h );
+          const char *name = 0;
+          const struct rtattr *stats64 = 0;
+          int len = IFLA_PAYLOAD( h );
+          for ( struct rtattr *a = IFLA_RTA( ifi ); RTA_OK( a, len ); a = RTA_NEXT( a, len ) ) {
+            if ( a->rta_type == IFLA_IFNAME ) name = (const char*)RTA_DATA( a );
+            else if ( a->rta_type == IFLA_STATS64 ) stats64 = a;
+          }
+          if ( !name || !stats64 || ( filter && !filter->accept( name ) ) ) return;
+          fillNetStat( stats[name], stats64 );
+        } );
+      }
+      int err = errno;
+      close( fd );
+      if ( !done ) stats.clear();
+      errno = err;
+      return done;
+    }
+
+    void procNetStat( NetStatDeviceMap &stats, const NetDeviceFilter *filter ) {
+      stats.clear();
+      std::ifstream ifs( util::ProcFS::path( "net/dev" ).c_str() );
       if ( ! ifs.good() ) throw Oops( __FILE__, __LINE__, "unable to read /proc/net/dev" );
       while ( ifs.good() && ! ifs.eof() ) {
         std::string s;
         char dev_buf[128];
         getline( ifs, s );
-        NetStat ns;
-        int r = sscanf( s.c_str(), "%128s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu",
+        NetStat ns = NetStat();
+        int r = sscanf( s.c_str(), "%127s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu",
                                    dev_buf,
                                    &ns.rx_bytes,
                                    &ns.rx_packets,
@@ -550,9 +1332,25 @@ namespace leanux {
                                    &ns.tx_collisions,
                                    &ns.tx_carrier,
                                    &ns.tx_compressed );
-        if ( strlen( dev_buf ) > 0 && strlen( dev_buf ) < 128 ) dev_buf[ strlen( dev_buf ) - 1 ] = 0;
-        if ( r == 17 ) stats[dev_buf] = ns;
+        if ( r != 17 ) continue;
+        if ( strlen( dev_buf ) > 0 ) dev_buf[ strlen( dev_buf ) - 1 ] = 0;
+        if ( filter && !filter->accept( dev_buf ) ) continue;
+        stats[dev_buf] = ns;
+      }
+    }
+
+    /**
+     * Set once linkNetStat failed because rtnetlink is not supported, after which getNetStat
+     * reads /proc. Transient failures (such as ENOBUFS) fall back to /proc for that call only.
+     */
+    std::atomic<bool> rtnl_link_unavailable( false );
+
+    void getNetStat( NetStatDeviceMap &stats, const NetDeviceFilter *filter ) {
+      if ( !rtnl_link_unavailable ) {
+        if ( linkNetStat( stats, filter ) ) return;
+        if ( errno == EOPNOTSUPP || errno == EPROTONOSUPPORT || errno == EINVAL ) rtnl_link_unavailable = true;
       }
+      procNetStat( stats, filter );
     }
 
     void getNetStatDelta( const NetStatDeviceMap& snap1, const NetStatDeviceMap& snap2, NetStatDeviceVector& delta ) {
@@ -579,6 +1377,18 @@ namespace leanux {
           d.tx_collisions = s2->second.tx_collisions - s1->second.tx_collisions;
           d.tx_carrier = s2->second.tx_carrier - s1->second.tx_carrier;
           d.tx_compressed = s2->second.tx_compressed - s1->second.tx_compressed;
+
+          d.detailed = s1->second.detailed && s2->second.detailed;
+          d.rx_length_errors = s2->second.rx_length_errors - s1->second.rx_length_errors;
+          d.rx_over_errors = s2->second.rx_over_errors - s1->second.rx_over_errors;
+          d.rx_crc_errors = s2->second.rx_crc_errors - s1->second.rx_crc_errors;
+          d.rx_frame_errors = s2->second.rx_frame_errors - s1->second.rx_frame_errors;
+          d.rx_missed_errors = s2->second.rx_missed_errors - s1->second.rx_missed_errors;
+          d.rx_nohandler = s2->second.rx_nohandler - s1->second.rx_nohandler;
+          d.tx_aborted_errors = s2->second.tx_aborted_errors - s1->second.tx_aborted_errors;
+          d.tx_carrier_errors = s2->second.tx_carrier_errors - s1->second.tx_carrier_errors;
+          d.tx_window_errors = s2->second.tx_window_errors - s1->second.tx_window_errors;
+          d.tx_heartbeat_errors = s2->second.tx_heartbeat_errors - s1->second.tx_heartbeat_errors;
         } else {
           d.rx_bytes = s2->second.rx_bytes;
           d.rx_packets = s2->second.rx_packets;
@@ -597,63 +1407,720 @@ namespace leanux {
           d.tx_collisions = s2->second.tx_collisions;
           d.tx_carrier = s2->second.tx_carrier;
           d.tx_compressed = s2->second.tx_compressed;
+
+          d.detailed = s2->second.detailed;
+          d.rx_length_errors = s2->second.rx_length_errors;
+          d.rx_over_errors = s2->second.rx_over_errors;
+          d.rx_crc_errors = s2->second.rx_crc_errors;
+          d.rx_frame_errors = s2->second.rx_frame_errors;
+          d.rx_missed_errors = s2->second.rx_missed_errors;
+          d.rx_nohandler = s2->second.rx_nohandler;
+          d.tx_aborted_errors = s2->second.tx_aborted_errors;
+          d.tx_carrier_errors = s2->second.tx_carrier_errors;
+          d.tx_window_errors = s2->second.tx_window_errors;
+          d.tx_heartbeat_errors = s2->second.tx_heartbeat_errors;
         }
         delta.push_back( d );
       }
       sort( delta.begin(), delta.end() );
     }
 
-    void getTCPConnectionCounters( std::list<TCPKeyCounter> &servers, std::list<TCPKeyCounter> &clients ) {
-      servers.clear();
-      clients.clear();
-      std::list<net::TCP4SocketInfo> conn4;
-      std::set<unsigned int> server_ports4;
-      std::list<net::TCP4SocketInfo> esta4;
-      net::enumTCP4Sockets( conn4 );
+    /**
+     * A kept protocol counter, the name is the section name followed by the counter name,
+     * as in /proc/net/snmp6, so "Tcp: RetransSegs" in /proc/net/snmp is "TcpRetransSegs".
+     */
+    struct ProtoCounter {
+      const char *name;
+      unsigned long ProtoStat::*field;
+    };
+
+    const ProtoCounter proto_counters[] = {
+      { "IpInReceives", &ProtoStat::ip_in_receives },
+      { "IpInDelivers", &ProtoStat::ip_in_delivers },
+      { "IpOutRequests", &ProtoStat::ip_out_requests },
+      { "IpInDiscards", &ProtoStat::ip_in_discards },
+      { "IpOutDiscards", &ProtoStat::ip_out_discards },
+      { "IpOutNoRoutes", &ProtoStat::ip_out_no_routes },
+      { "IpReasmFails", &ProtoStat::ip_reasm_fails },
+      { "Ip6InReceives", &ProtoStat::ip_in_receives },
+      { "Ip6InDelivers", &ProtoStat::ip_in_delivers },
+      { "Ip6OutRequests", &ProtoStat::ip_out_requests },
+      { "Ip6InDiscards", &ProtoStat::ip_in_discards },
+      { "Ip6OutDiscards", &ProtoStat::ip_out_discards },
+      { "Ip6OutNoRoutes", &ProtoStat::ip_out_no_routes },
+      { "Ip6ReasmFails", &ProtoStat::ip_reasm_fails },
+      { "TcpActiveOpens", &ProtoStat::tcp_active_opens },
+      { "TcpPassiveOpens", &ProtoStat::tcp_passive_opens },
+      { "TcpAttemptFails", &ProtoStat::tcp_attempt_fails },
+      { "TcpEstabResets", &ProtoStat::tcp_estab_resets },
+      { "TcpInSegs", &ProtoStat::tcp_in_segs },
+      { "TcpOutSegs", &ProtoStat::tcp_out_segs },
+      { "TcpRetransSegs", &ProtoStat::tcp_retrans_segs },
+      { "TcpInErrs", &ProtoStat::tcp_in_errs },
+      { "TcpOutRsts", &ProtoStat::tcp_out_rsts },
+      { "TcpExtListenOverflows", &ProtoStat::tcp_listen_overflows },
+      { "TcpExtListenDrops", &ProtoStat::tcp_listen_drops },
+      { "TcpExtTCPReqQFullDrop", &ProtoStat::tcp_reqq_full_drops },
+      { "TcpExtTCPSynRetrans", &ProtoStat::tcp_syn_retrans },
+      { "TcpExtTCPTimeouts", &ProtoStat::tcp_timeouts },
+      { "TcpExtTCPMemoryPressures", &ProtoStat::tcp_memory_pressures },
+      { "TcpExtTCPAbortOnMemory", &ProtoStat::tcp_abort_on_memory },
+      { "TcpExtPruneCalled", &ProtoStat::tcp_prune_called },
+      { "TcpExtTCPBacklogDrop", &ProtoStat::tcp_backlog_drops },
+      { "UdpInDatagrams", &ProtoStat::udp_in_datagrams },
+      { "UdpOutDatagrams", &ProtoStat::udp_out_datagrams },
+      { "UdpNoPorts", &ProtoStat::udp_no_ports },
+      { "UdpInErrors", &ProtoStat::udp_in_errors },
+      { "UdpRcvbufErrors", &ProtoStat::udp_rcvbuf_errors },
+      { "UdpSndbufErrors", &ProtoStat::udp_sndbuf_errors },
+      { "Udp6InDatagrams", &ProtoStat::udp_in_datagrams },
+      { "Udp6OutDatagrams", &ProtoStat::udp_out_datagrams },
+      { "Udp6NoPorts", &ProtoStat::udp_no_ports },
+      { "Udp6InErrors", &ProtoStat::udp_in_errors },
+      { "Udp6RcvbufErrors", &ProtoStat::udp_rcvbuf_errors },
+      { "Udp6SndbufErrors", &ProtoStat::udp_sndbuf_errors },
+    };
 
-      for ( std::list<net::TCP4SocketInfo>::const_iterator c = conn4.begin(); c != conn4.end(); c++ ) {
-        if ( (*c).tcp_state == net::TCP_LISTEN ) server_ports4.insert( (*c).local_port );
-        else if ( (*c).tcp_state == net::TCP_ESTABLISHED ) esta4.push_back( (*c) );
+    /**
+     * The ProtoStat fields, each once.
+     */
+    unsigned long ProtoStat::* const proto_fields[] = {
+      &ProtoStat::ip_in_receives, &ProtoStat::ip_in_delivers, &ProtoStat::ip_out_requests,
+      &ProtoStat::ip_in_discards, &ProtoStat::ip_out_discards, &ProtoStat::ip_out_no_routes,
+      &ProtoStat::ip_reasm_fails,
+      &ProtoStat::tcp_active_opens, &ProtoStat::tcp_passive_opens, &ProtoStat::tcp_attempt_fails,
+      &ProtoStat::tcp_estab_resets, &ProtoStat::tcp_in_segs, &ProtoStat::tcp_out_segs,
+      &ProtoStat::tcp_retrans_segs, &ProtoStat::tcp_in_errs, &ProtoStat::tcp_out_rsts,
+      &ProtoStat::tcp_listen_overflows, &ProtoStat::tcp_listen_drops, &ProtoStat::tcp_reqq_full_drops,
+      &ProtoStat::tcp_syn_retrans, &ProtoStat::tcp_timeouts, &ProtoStat::tcp_memory_pressures,
+      &ProtoStat::tcp_abort_on_memory, &ProtoStat::tcp_prune_called, &ProtoStat::tcp_backlog_drops,
+      &ProtoStat::udp_in_datagrams, &ProtoStat::udp_out_datagrams, &ProtoStat::udp_no_ports,
+      &ProtoStat::udp_in_errors, &ProtoStat::udp_rcvbuf_errors, &ProtoStat::udp_sndbuf_errors
+    };
+
+    /**
+     * Find the ProtoStat field of a counter name.
+     * @return the field or 0 if the counter is not kept.
+     */
+    unsigned long ProtoStat::* findProtoField( const std::string &name ) {
+      for ( size_t i = 0; i < sizeof(proto_counters)/sizeof(ProtoCounter); i++ ) {
+        if ( name == proto_counters[i].name ) return proto_counters[i].field;
       }
+      return 0;
+    }
 
-      std::map<TCPKey, unsigned int> server_map;
-      std::map<TCPKey, unsigned int> client_map;
+    /**
+     * Read a (small) procfs file in one go.
+     * @return false if the file cannot be opened.
+     */
+    bool readProcText( const char *file, std::string &text ) {
+      text.clear();
+      int fd = open( file, O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 ) return false;
+      char buf[8192];
+      ssize_t r;
+      while ( (r = ::read( fd, buf, sizeof(buf) )) > 0 ) text.append( buf, r );
+      close( fd );
+      return true;
+    }
 
-      for ( std::list<net::TCP4SocketInfo>::const_iterator i = esta4.begin(); i != esta4.end(); i++ ) {
-        if ( server_ports4.find( (*i).local_port  ) != server_ports4.end() ) {
-          server_map[ TCPKey( net::convertAF_INET( (*i).local_addr ), (*i).local_port, (*i).uid ) ] += 1;
-        } else {
-          client_map[ TCPKey( net::convertAF_INET( (*i).remote_addr ), (*i).remote_port, (*i).uid ) ] += 1;
+    void ProtoStatReader::readTables( const char *file, std::vector<Table> &tables, ProtoStat &stat ) {
+      std::string text;
+      if ( !readProcText( file, text ) ) return;
+      size_t pos = 0;
+      size_t t = 0;
+      while ( pos < text.length() ) {
+        size_t eoh = text.find( '\n', pos );
+        if ( eoh == std::string::npos ) break;
+        size_t eov = text.find( '\n', eoh + 1 );
+        if ( eov == std::string::npos ) eov = text.length();
+        if ( t >= tables.size() || text.compare( pos, eoh - pos, tables[t].header ) != 0 ) {
+          // unknown layout, map the counter names of this header line
+          tables.resize( t + 1 );
+          Table &table = tables[t];
+          table.header = text.substr( pos, eoh - pos );
+          table.fields.clear();
+          std::stringstream ss( table.header );
+          std::string section;
+          std::string name;
+          ss >> section;
+          if ( section.length() ) section.erase( section.length() - 1 );
+          while ( ss >> name ) table.fields.push_back( findProtoField( section + name ) );
         }
+        const Table &table = tables[t];
+        size_t colon = text.find( ':', eoh + 1 );
+        const char *p = text.c_str() + ( colon < eov ? colon + 1 : eov );
+        const char *end = text.c_str() + eov;
+        for ( std::vector<Field>::const_iterator f = table.fields.begin(); f != table.fields.end() && p < end; ++f ) {
+          char *next;
+          unsigned long value = strtoul( p, &next, 10 );
+          if ( next == p ) break;
+          if ( *f ) stat.*(*f) += value;
+          p = next;
+        }
+        pos = eov + 1;
+        t++;
+      }
+    }
+
+    void ProtoStatReader::readPairs( const char *file, Table &table, ProtoStat &stat ) {
+      std::string text;
+      if ( !readProcText( file, text ) ) return;
+      // the names in snmp6 are on the same lines as the values, so the joined names are the header
+      std::string names;
+      names.reserve( table.header.length() );
+      std::vector<unsigned long> values;
+      values.reserve( table.fields.size() );
+      const char *p = text.c_str();
+      const char *end = p + text.length();
+      while ( p < end ) {
+        const char *n = p;
+        while ( p < end && *p != ' ' && *p != '\t' ) p++;
+        names.append( n, p - n );
+        names += ' ';
+        char *next;
+        values.push_back( strtoul( p, &next, 10 ) );
+        p = next;
+        while ( p < end && *p != '\n' ) p++;
+        p++;
       }
+      if ( names != table.header ) {
+        table.header = names;
+        table.fields.clear();
+        std::stringstream ss( names );
+        std::string name;
+        while ( ss >> name ) table.fields.push_back( findProtoField( name ) );
+      }
+      for ( size_t i = 0; i < values.size() && i < table.fields.size(); i++ ) {
+        if ( table.fields[i] ) stat.*(table.fields[i]) += values[i];
+      }
+    }
 
-      std::list<net::TCP6SocketInfo> conn6;
-      std::set<unsigned int> server_ports6;
-      std::list<net::TCP6SocketInfo> esta6;
-      net::enumTCP6Sockets( conn6 );
+    void ProtoStatReader::read( ProtoStat &stat ) {
+      stat = ProtoStat();
+      readTables( util::ProcFS::path( "net/snmp" ).c_str(), snmp_, stat );
+      readTables( util::ProcFS::path( "net/netstat" ).c_str(), netstat_, stat );
+      readPairs( util::ProcFS::path( "net/snmp6" ).c_str(), snmp6_, stat );
+    }
 
-      for ( std::list<net::TCP6SocketInfo>::const_iterator c = conn6.begin(); c != conn6.end(); c++ ) {
-        if ( (*c).tcp_state == net::TCP_LISTEN ) server_ports6.insert( (*c).local_port );
-        else if ( (*c).tcp_state == net::TCP_ESTABLISHED ) esta6.push_back( (*c) );
+    void getProtoStatDelta( const ProtoStat &stat1, const ProtoStat &stat2, ProtoStat &delta ) {
+      for ( size_t i = 0; i < sizeof(proto_fields)/sizeof(proto_fields[0]); i++ ) {
+        delta.*proto_fields[i] = stat2.*proto_fields[i] - stat1.*proto_fields[i];
       }
+    }
 
-      for ( std::list<net::TCP6SocketInfo>::const_iterator i = esta6.begin(); i != esta6.end(); i++ ) {
-        if ( server_ports6.find( (*i).local_port  ) != server_ports6.end() ) {
-          server_map[ TCPKey( net::convertAF_INET6( &(*i).local_addr ), (*i).local_port, (*i).uid ) ] += 1;
-        } else {
-          client_map[ TCPKey( net::convertAF_INET6( &(*i).remote_addr ), (*i).remote_port, (*i).uid ) ] += 1;
+    void getSoftNetStat( SoftNetStatMap &stats ) {
+      stats.clear();
+      std::string text;
+      if ( !readProcText( util::ProcFS::path( "net/softnet_stat" ).c_str(), text ) ) return;
+      // one line of hexadecimal columns per online CPU, the CPU itself is column 12 since 5.10
+      unsigned int line = 0;
+      const char *p = text.c_str();
+      while ( *p ) {
+        unsigned long cols[13];
+        unsigned int ncols = 0;
+        while ( *p && *p != '\n' ) {
+          char *e = 0;
+          unsigned long v = strtoul( p, &e, 16 );
+          if ( e == p ) break;
+          if ( ncols < 13 ) cols[ncols] = v;
+          ncols++;
+          p = e;
+          while ( *p == ' ' ) p++;
+        }
+        while ( *p && *p != '\n' ) p++;
+        if ( *p ) p++;
+        if ( ncols >= 11 ) {
+          SoftNetStat stat;
+          stat.cpu = ncols >= 13 ? cols[12] : line;
+          stat.processed = cols[0];
+          stat.dropped = cols[1];
+          stat.time_squeeze = cols[2];
+          stat.received_rps = cols[9];
+          stat.flow_limit = cols[10];
+          stats[stat.cpu] = stat;
+        }
+        line++;
+      }
+    }
+
+    void getSoftNetStatDelta( const SoftNetStatMap& snap1, const SoftNetStatMap& snap2, SoftNetStatVector& delta ) {
+      delta.clear();
+      for ( SoftNetStatMap::const_iterator s2 = snap2.begin(); s2 != snap2.end(); ++s2 ) {
+        SoftNetStatMap::const_iterator s1 = snap1.find( s2->first );
+        SoftNetStat d = s2->second;
+        if ( s1 != snap1.end() ) {
+          d.processed -= s1->second.processed;
+          d.dropped -= s1->second.dropped;
+          d.time_squeeze -= s1->second.time_squeeze;
+          d.received_rps -= s1->second.received_rps;
+          d.flow_limit -= s1->second.flow_limit;
+        }
+        delta.push_back( d );
+      }
+      std::sort( delta.begin(), delta.end() );
+    }
+
+    void getNetQueueStat( NetQueueStatMap &stats, const NetDeviceFilter *filter ) {
+      stats.clear();
+      const std::string net_path = util::SysFS::path( "class/net" );
+      DIR *d = opendir( net_path.c_str() );
+      if ( !d ) return;
+      struct dirent *entry = 0;
+      while ( ( entry = readdir( d ) ) ) {
+        if ( entry->d_name[0] == '.' ) continue;
+        if ( filter && !filter->accept( entry->d_name ) ) continue;
+        std::string queues_path = net_path + "/" + entry->d_name + "/queues";
+        std::string relative = std::string( entry->d_name ) + "/queues/";
+        DIR *q = opendir( queues_path.c_str() );
+        if ( !q ) continue;
+        struct dirent *qentry = 0;
+        while ( ( qentry = readdir( q ) ) ) {
+          unsigned int queue = 0;
+          if ( sscanf( qentry->d_name, "tx-%u", &queue ) != 1 ) continue;
+          std::string path = relative + qentry->d_name;
+          const util::PseudoFS &sysnet = util::SysFS::net();
+          NetQueueStat stat;
+          stat.device = entry->d_name;
+          stat.queue = queue;
+          stat.tx_timeout = 0;
+          stat.bql_stall_cnt = 0;
+          stat.bql_inflight = 0;
+          stat.bql_limit = 0;
+          sysnet.readUL( ( path + "/tx_timeout" ).c_str(), stat.tx_timeout );
+          sysnet.readUL( ( path + "/byte_queue_limits/stall_cnt" ).c_str(), stat.bql_stall_cnt );
+          sysnet.readUL( ( path + "/byte_queue_limits/inflight" ).c_str(), stat.bql_inflight );
+          sysnet.readUL( ( path + "/byte_queue_limits/limit" ).c_str(), stat.bql_limit );
+          stats[ stat.device + "/" + qentry->d_name ] = stat;
+        }
+        closedir( q );
+      }
+      closedir( d );
+    }
+
+    void getNetQueueStatDelta( const NetQueueStatMap& snap1, const NetQueueStatMap& snap2, NetQueueStatVector& delta ) {
+      delta.clear();
+      for ( NetQueueStatMap::const_iterator s2 = snap2.begin(); s2 != snap2.end(); ++s2 ) {
+        NetQueueStatMap::const_iterator s1 = snap1.find( s2->first );
+        NetQueueStat d = s2->second;
+        if ( s1 != snap1.end() ) {
+          d.tx_timeout -= s1->second.tx_timeout;
+          d.bql_stall_cnt -= s1->second.bql_stall_cnt;
         }
+        delta.push_back( d );
+      }
+      std::sort( delta.begin(), delta.end() );
+    }
+
+    /**
+     * TCPSocketSink collecting the local ports of listening sockets.
+     */
+    class TCPListenSink : public TCPSocketSink {
+      public:
+        virtual void put( const TCP4SocketInfo &info ) { ports4.insert( info.local_port ); };
+        virtual void put( const TCP6SocketInfo &info ) { ports6.insert( info.local_port ); };
+        /** local ports of listening TCP4 sockets. */
+        std::set<unsigned int> ports4;
+        /** local ports of listening TCP6 sockets. */
+        std::set<unsigned int> ports6;
+    };
+
+    TCPKey::TCPKey( const std::string &ip, unsigned int port, unsigned int uid ) {
+      memset( addr_, 0, sizeof(addr_) );
+      if ( inet_pton( AF_INET, ip.c_str(), addr_ ) == 1 ) family_ = AF_INET;
+      else if ( inet_pton( AF_INET6, ip.c_str(), addr_ ) == 1 ) family_ = AF_INET6;
+      else {
+        family_ = 0;
+        memset( addr_, 0, sizeof(addr_) );
       }
+      port_ = port;
+      uid_ = uid;
+    }
 
-      for ( std::map<TCPKey, unsigned int>::const_iterator i = server_map.begin(); i != server_map.end(); ++i ) {
-        servers.push_back( TCPKeyCounter( i->first, i->second ) );
+    size_t TCPKey::hash() const {
+      // FNV-1a
+      uint64_t h = 14695981039346656037ULL;
+      for ( size_t i = 0; i < sizeof(addr_); i++ ) {
+        h ^= addr_[i];
+        h *= 1099511628211ULL;
       }
-      servers.sort();
+      h ^= family_;
+      h *= 1099511628211ULL;
+      h ^= port_;
+      h *= 1099511628211ULL;
+      h ^= uid_;
+      h *= 1099511628211ULL;
+      return h ^ (h >> 32);
+    }
+
+    std::string TCPKey::getIP() const {
+      if ( family_ == 0 ) return "";
+      char buf[INET6_ADDRSTRLEN];
+      inet_ntop( family_, addr_, buf, sizeof(buf) );
+      return buf;
+    }
 
-      for ( std::map<TCPKey, unsigned int>::const_iterator i = client_map.begin(); i != client_map.end(); ++i ) {
-        clients.push_back( TCPKeyCounter( i->first, i->second ) );
+    /**
+     * Open addressing (linear probing) hash table counting TCPKeys.
+     */
+    class TCPKeyTable {
+      public:
+        TCPKeyTable() : slots_( 64 ), used_( 0 ) {};
+
+        /**
+         * Count a key.
+         * @param key the TCPKey.
+         */
+        void add( const TCPKey &key ) {
+          if ( ( used_ + 1 ) * 2 > slots_.size() ) grow();
+          Slot &slot = find( slots_, key );
+          if ( slot.count == 0 ) {
+            slot.key = key;
+            used_++;
+          }
+          slot.count++;
+        };
+
+        /**
+         * Get the counted keys by descending count.
+         * @param counters receives the TCPKeyCounters.
+         */
+        void getCounters( TCPKeyCounterVector &counters ) const {
+          counters.clear();
+          counters.reserve( used_ );
+          for ( std::vector<Slot>::const_iterator s = slots_.begin(); s != slots_.end(); s++ ) {
+            if ( s->count ) counters.push_back( TCPKeyCounter( s->key, s->count ) );
+          }
+          std::sort( counters.begin(), counters.end() );
+        };
+
+      private:
+        /** a table slot, empty if count is 0. */
+        struct Slot {
+          Slot() : count( 0 ) {};
+          TCPKey key;
+          unsigned int count;
+        };
+
+        /**
+         * Find the slot of key, or the empty slot where it belongs.
+         * @param slots the slots, of which the size is a power of 2.
+         * @param key the TCPKey.
+         * @return the slot.
+         */
+        static Slot& find( std::vector<Slot> &slots, const TCPKey &key ) {
+          size_t mask = slots.size() - 1;
+          size_t i = key.hash() & mask;
+          while ( slots[i].count && !( slots[i].key == key ) ) i = ( i + 1 ) & mask;
+          return slots[i];
+        };
+
+        /** double the number of slots. */
+        void grow() {
+          std::vector<Slot> slots( slots_.size() * 2 );
+          for ( std::vector<Slot>::const_iterator s = slots_.begin(); s != slots_.end(); s++ ) {
+            if ( s->count ) find( slots, s->key ) = *s;
+          }
+          slots_.swap( slots );
+        };
+
+        /** the slots. */
+        std::vector<Slot> slots_;
+
+        /** number of used slots. */
+        size_t used_;
+    };
+
+    /**
+     * TCPSocketSink counting established sockets by server (local) or client (remote) TCPKey.
+     */
+    class TCPEstablishedSink : public TCPSocketSink {
+      public:
+        TCPEstablishedSink( const TCPListenSink &listen ) : listen_( listen ) {};
+        virtual void put( const TCP4SocketInfo &info ) {
+          TCPKey key;
+          count( key, classify( info, key ) );
+        };
+        virtual void put( const TCP6SocketInfo &info ) {
+          TCPKey key;
+          count( key, classify( info, key ) );
+        };
+        /** established connections per server TCPKey. */
+        TCPKeyTable servers;
+        /** established connections per client TCPKey. */
+        TCPKeyTable clients;
+      protected:
+        /**
+         * Get the TCPKey of a socket.
+         * @return true if the socket is a server socket (the local port is listening).
+         */
+        bool classify( const TCP4SocketInfo &info, TCPKey &key ) const {
+          uint32_t addr;
+          if ( listen_.ports4.find( info.local_port ) != listen_.ports4.end() ) {
+            addr = info.local_addr;
+            key = TCPKey( AF_INET, &addr, info.local_port, info.uid );
+            return true;
+          }
+          addr = info.remote_addr;
+          key = TCPKey( AF_INET, &addr, info.remote_port, info.uid );
+          return false;
+        };
+        bool classify( const TCP6SocketInfo &info, TCPKey &key ) const {
+          if ( listen_.ports6.find( info.local_port ) != listen_.ports6.end() ) {
+            key = TCPKey( AF_INET6, &info.local_addr, info.local_port, info.uid );
+            return true;
+          }
+          key = TCPKey( AF_INET6, &info.remote_addr, info.remote_port, info.uid );
+          return false;
+        };
+        void count( const TCPKey &key, bool server ) {
+          if ( server ) servers.add( key ); else clients.add( key );
+        };
+      private:
+        /** the listening ports. */
+        const TCPListenSink &listen_;
+    };
+
+    void getTCPConnectionCounters( TCPKeyCounterVector &servers, TCPKeyCounterVector &clients ) {
+      // the few listening sockets first, so that the established sockets can be counted as they stream in
+      TCPListenSink listen;
+      streamTCPSockets( AF_INET, getTCPStateFlag( TCP_LISTEN ), listen );
+      streamTCPSockets( AF_INET6, getTCPStateFlag( TCP_LISTEN ), listen );
+      TCPEstablishedSink established( listen );
+      streamTCPSockets( AF_INET, getTCPStateFlag( TCP_ESTABLISHED ), established );
+      streamTCPSockets( AF_INET6, getTCPStateFlag( TCP_ESTABLISHED ), established );
+      established.servers.getCounters( servers );
+      established.clients.getCounters( clients );
+    }
+
+    /**
+     * A connection ranked by TCPInfoSink.
+     */
+    struct TCPInfoCandidate {
+      /** bytes moved in the sample interval. */
+      unsigned long activity;
+      /** true for a server connection. */
+      bool server;
+      TCPKey key;
+      TCPInfo info;
+      /** the cumulative counters moved in the sample interval. */
+      TCPConnectionSampler::Cumulative delta;
+      bool operator>( const TCPInfoCandidate &c ) const { return activity > c.activity; };
+    };
+
+    /**
+     * TCPEstablishedSink that also keeps the TCP_INFO of the top busiest connections.
+     */
+    class TCPInfoSink : public TCPEstablishedSink {
+      public:
+        TCPInfoSink( const TCPListenSink &listen,
+                     unsigned int top,
+                     const std::unordered_map<ino_t,TCPConnectionSampler::Cumulative> &previous ) :
+          TCPEstablishedSink( listen ), top_( top ), previous_( previous ) {};
+        virtual void putInfo( const TCP4SocketInfo &info, const TCPInfo &tcpinfo ) {
+          TCPKey key;
+          bool server = classify( info, key );
+          count( key, server );
+          rank( key, server, info.inode, tcpinfo );
+        };
+        virtual void putInfo( const TCP6SocketInfo &info, const TCPInfo &tcpinfo ) {
+          TCPKey key;
+          bool server = classify( info, key );
+          count( key, server );
+          rank( key, server, info.inode, tcpinfo );
+        };
+        /** the cumulative counters by socket inode. */
+        std::unordered_map<ino_t,TCPConnectionSampler::Cumulative> current;
+        /** the busiest connections, the least busy on top. */
+        std::priority_queue< TCPInfoCandidate, std::vector<TCPInfoCandidate>, std::greater<TCPInfoCandidate> > top;
+      private:
+        void rank( const TCPKey &key, bool server, ino_t inode, const TCPInfo &tcpinfo ) {
+          if ( top_ == 0 ) return;
+          TCPInfoCandidate c;
+          c.delta.bytes = tcpinfo.bytes_acked + tcpinfo.bytes_received;
+          c.delta.retrans = tcpinfo.total_retrans;
+          c.delta.busy = tcpinfo.busy_time;
+          c.delta.rwnd_limited = tcpinfo.rwnd_limited;
+          c.delta.sndbuf_limited = tcpinfo.sndbuf_limited;
+          if ( inode ) {
+            current[inode] = c.delta;
+            std::unordered_map<ino_t,TCPConnectionSampler::Cumulative>::const_iterator p = previous_.find( inode );
+            if ( p != previous_.end() && p->second.bytes <= c.delta.bytes ) {
+              c.delta.bytes -= p->second.bytes;
+              c.delta.retrans -= std::min( c.delta.retrans, p->second.retrans );
+              c.delta.busy -= std::min( c.delta.busy, p->second.busy );
+              c.delta.rwnd_limited -= std::min( c.delta.rwnd_limited, p->second.rwnd_limited );
+              c.delta.sndbuf_limited -= std::min( c.delta.sndbuf_limited, p->second.sndbuf_limited );
+            }
+          }
+          c.activity = c.delta.bytes;
+          if ( top.size() < top_ ) {
+            c.server = server;
+            c.key = key;
+            c.info = tcpinfo;
+            top.push( c );
+          } else if ( c.activity > top.top().activity ) {
+            c.server = server;
+            c.key = key;
+            c.info = tcpinfo;
+            top.pop();
+            top.push( c );
+          }
+        };
+        /** the number of connections to keep. */
+        unsigned int top_;
+        /** the cumulative counters by socket inode at the previous sample. */
+        const std::unordered_map<ino_t,TCPConnectionSampler::Cumulative> &previous_;
+    };
+
+    /**
+     * Nearest rank percentile of sorted values.
+     */
+    double percentile( const std::vector<double> &sorted, double p ) {
+      if ( sorted.empty() ) return 0;
+      size_t i = (size_t)( p * ( sorted.size() - 1 ) + 0.5 );
+      return sorted[ std::min( i, sorted.size() - 1 ) ];
+    }
+
+    /**
+     * Summarize the TCP_INFO of the connections of a TCPKey.
+     */
+    TCPInfoSummary summarizeTCPInfo( const std::vector<const TCPInfoCandidate*> &candidates ) {
+      TCPInfoSummary summary;
+      std::vector<double> rtt, rttvar, cwnd, rate;
+      for ( std::vector<const TCPInfoCandidate*>::const_iterator c = candidates.begin(); c != candidates.end(); c++ ) {
+        rtt.push_back( (*c)->info.rtt / 1.0E6 );
+        rttvar.push_back( (*c)->info.rttvar / 1.0E6 );
+        cwnd.push_back( (*c)->info.snd_cwnd );
+        rate.push_back( (*c)->info.delivery_rate );
+        summary.retrans += (*c)->delta.retrans;
+        summary.busy += (*c)->delta.busy / 1.0E6;
+        summary.rwnd_limited += (*c)->delta.rwnd_limited / 1.0E6;
+        summary.sndbuf_limited += (*c)->delta.sndbuf_limited / 1.0E6;
+      }
+      std::sort( rtt.begin(), rtt.end() );
+      std::sort( rttvar.begin(), rttvar.end() );
+      std::sort( cwnd.begin(), cwnd.end() );
+      std::sort( rate.begin(), rate.end() );
+      summary.sampled = candidates.size();
+      summary.rtt_p50 = percentile( rtt, 0.5 );
+      summary.rtt_p95 = percentile( rtt, 0.95 );
+      summary.rttvar_p50 = percentile( rttvar, 0.5 );
+      summary.cwnd_p50 = percentile( cwnd, 0.5 );
+      summary.delivery_rate_p50 = percentile( rate, 0.5 );
+      return summary;
+    }
+
+    /**
+     * Attach the TCP_INFO summaries to the counters.
+     */
+    void attachTCPInfo( const std::map< TCPKey,std::vector<const TCPInfoCandidate*> > &groups, TCPKeyCounterVector &counters ) {
+      if ( groups.empty() ) return;
+      for ( TCPKeyCounterVector::iterator i = counters.begin(); i != counters.end(); i++ ) {
+        std::map< TCPKey,std::vector<const TCPInfoCandidate*> >::const_iterator g = groups.find( i->getKey() );
+        if ( g != groups.end() ) *i = TCPKeyCounter( i->getKey(), i->getEsta(), summarizeTCPInfo( g->second ) );
+      }
+    }
+
+    void TCPConnectionSampler::sample( TCPKeyCounterVector &servers, TCPKeyCounterVector &clients ) {
+      TCPListenSink listen;
+      streamTCPSockets( AF_INET, getTCPStateFlag( TCP_LISTEN ), listen );
+      streamTCPSockets( AF_INET6, getTCPStateFlag( TCP_LISTEN ), listen );
+      TCPInfoSink established( listen, top_, previous_ );
+      streamTCPSockets( AF_INET, getTCPStateFlag( TCP_ESTABLISHED ), established, true );
+      streamTCPSockets( AF_INET6, getTCPStateFlag( TCP_ESTABLISHED ), established, true );
+      previous_.swap( established.current );
+      established.servers.getCounters( servers );
+      established.clients.getCounters( clients );
+
+      std::vector<TCPInfoCandidate> top;
+      top.reserve( established.top.size() );
+      while ( !established.top.empty() ) {
+        top.push_back( established.top.top() );
+        established.top.pop();
+      }
+      std::map< TCPKey,std::vector<const TCPInfoCandidate*> > server_groups;
+      std::map< TCPKey,std::vector<const TCPInfoCandidate*> > client_groups;
+      for ( std::vector<TCPInfoCandidate>::const_iterator c = top.begin(); c != top.end(); c++ ) {
+        if ( c->server ) server_groups[c->key].push_back( &(*c) );
+        else client_groups[c->key].push_back( &(*c) );
+      }
+      attachTCPInfo( server_groups, servers );
+      attachTCPInfo( client_groups, clients );
+    }
+
+    /**
+     * Keeps the TCP_INFO byte counters of the sockets streamed to it.
+     */
+    class ProcessNetSink : public TCPSocketSink {
+      public:
+        virtual void put( const TCP4SocketInfo &info ) {};
+        virtual void put( const TCP6SocketInfo &info ) {};
+        virtual void putInfo( const TCP4SocketInfo &info, const TCPInfo &tcpinfo ) { keep( info.inode, tcpinfo ); };
+        virtual void putInfo( const TCP6SocketInfo &info, const TCPInfo &tcpinfo ) { keep( info.inode, tcpinfo ); };
+        /** the cumulative counters by socket inode. */
+        std::unordered_map<ino_t,ProcessNetSampler::Cumulative> current;
+      private:
+        void keep( ino_t inode, const TCPInfo &tcpinfo ) {
+          if ( !inode ) return;
+          ProcessNetSampler::Cumulative c;
+          c.sent = tcpinfo.bytes_acked;
+          c.received = tcpinfo.bytes_received;
+          current[inode] = c;
+        };
+    };
+
+    void ProcessNetSampler::sample( ProcessNetStatVector &stats ) {
+      stats.clear();
+      // listening sockets move no data and sockets in TIME_WAIT have no inode
+      unsigned int states = TCP_STATES_ALL & ~getTCPStateFlag( TCP_LISTEN ) & ~getTCPStateFlag( TCP_TIME_WAIT );
+      ProcessNetSink sink;
+      streamTCPSockets( AF_INET, states, sink, true );
+      streamTCPSockets( AF_INET6, states, sink, true );
+      previous_.swap( sink.current );
+      if ( !primed_ ) {
+        primed_ = true;
+        return;
+      }
+      // previous_ now holds this sample, sink.current the previous one
+      std::unordered_map<ino_t,Cumulative> moved;
+      process::SocketOwnerMap owners;
+      for ( std::unordered_map<ino_t,Cumulative>::const_iterator c = previous_.begin(); c != previous_.end(); c++ ) {
+        Cumulative d = c->second;
+        std::unordered_map<ino_t,Cumulative>::const_iterator p = sink.current.find( c->first );
+        if ( p != sink.current.end() ) {
+          d.sent -= std::min( d.sent, p->second.sent );
+          d.received -= std::min( d.received, p->second.received );
+        }
+        if ( d.sent || d.received ) {
+          moved[c->first] = d;
+          owners[c->first] = 0;
+        }
+      }
+      if ( moved.empty() ) return;
+      process::getSocketOwners( owners, true );
+      std::unordered_map<pid_t,ProcessNetStat> procs;
+      for ( std::unordered_map<ino_t,Cumulative>::const_iterator m = moved.begin(); m != moved.end(); m++ ) {
+        pid_t pid = owners[m->first];
+        if ( !pid ) continue;
+        std::unordered_map<pid_t,ProcessNetStat>::iterator p = procs.find( pid );
+        if ( p == procs.end() ) {
+          ProcessNetStat stat;
+          stat.pid = pid;
+          stat.connections = 0;
+          stat.bytes_sent = 0;
+          stat.bytes_received = 0;
+          p = procs.insert( std::make_pair( pid, stat ) ).first;
+        }
+        p->second.connections++;
+        p->second.bytes_sent += m->second.sent;
+        p->second.bytes_received += m->second.received;
+      }
+      stats.reserve( procs.size() );
+      for ( std::unordered_map<pid_t,ProcessNetStat>::const_iterator p = procs.begin(); p != procs.end(); p++ ) {
+        stats.push_back( p->second );
       }
-      clients.sort();
+      std::sort( stats.begin(), stats.end() );
     }
 
   }
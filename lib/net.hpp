@@ -42,9 +42,12 @@
 #include <ostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <arpa/inet.h>
+#include <string.h>
 
 namespace leanux {
 
@@ -53,11 +56,6 @@ namespace leanux {
    */
   namespace net {
 
-    /**
-     * initialize net library
-     */
-    void init();
-
     /**
      * TCP connection states.
      */
@@ -100,12 +98,23 @@ namespace leanux {
      */
     std::string getDeviceMACAddress( const std::string &device );
 
+    /**
+     * Vendor registration of a MAC address prefix (Organizationally Unique Identifier).
+     */
     struct OUI {
-      std::string vendor;
-      std::string countrycode;
-      std::list<std::string> address;
+      std::string vendor;               /**< the vendor name. */
+      std::string countrycode;          /**< the country code of the vendor. */
+      std::list<std::string> address;   /**< the vendor address lines. */
     };
 
+    /**
+     * Get the OUI registration of a MAC address from oui.txt. The first call maps a sorted binary
+     * index of oui.txt, or builds one and writes it to /var/cache/leanux/oui.idx (when root) or
+     * to .leanux-oui.idx in the user configuration directory, so later lookups are a binary
+     * search. When no index can be built, oui.txt is scanned.
+     * @param mac the MAC address as in xx:xx:xx:xx:xx:xx.
+     * @param oui the OUI to fill, empty if not found or if there is no oui.txt.
+     */
     void getMACOUI( const std::string &mac, OUI &oui );
 
     /**
@@ -189,6 +198,11 @@ namespace leanux {
      */
     std::ostream& operator<<( std::ostream& os, const TCP4SocketInfo &inf );
 
+    /**
+     * Dump a TCP6Socket to stream.
+     */
+    std::ostream& operator<<( std::ostream& os, const TCP6SocketInfo &inf );
+
     /**
      * Enumerate network devices.
      * @param devices the list of device names to fill.
@@ -207,6 +221,102 @@ namespace leanux {
      */
     void enumTCP6Sockets( std::list<TCP6SocketInfo> &sockets );
 
+    /**
+     * Get the bit of a TCPState in a TCP state mask.
+     * @param state the TCPState.
+     * @return the state mask bit.
+     */
+    inline unsigned int getTCPStateFlag( TCPState state ) { return 1U << state; }
+
+    /** TCP state mask matching all states. */
+    const unsigned int TCP_STATES_ALL = 0xfff;
+
+    /**
+     * The TCP_INFO (struct tcp_info) fields of a connection used by leanux. Fields the
+     * kernel does not report are 0.
+     */
+    struct TCPInfo {
+      unsigned int rtt;              /**< smoothed round trip time in microseconds. */
+      unsigned int rttvar;           /**< round trip time variation in microseconds. */
+      unsigned int snd_cwnd;         /**< congestion window in segments. */
+      unsigned int total_retrans;    /**< segments retransmitted over the connection lifetime. */
+      unsigned long delivery_rate;   /**< recent delivery rate in bytes per second. */
+      unsigned long busy_time;       /**< microseconds busy sending data. */
+      unsigned long rwnd_limited;    /**< microseconds sending was limited by the receive window. */
+      unsigned long sndbuf_limited;  /**< microseconds sending was limited by the send buffer. */
+      unsigned long bytes_acked;     /**< bytes sent and acknowledged. */
+      unsigned long bytes_received;  /**< bytes received. */
+    };
+
+    /**
+     * Receives the sockets streamed by streamTCPSockets, one at a time, so that
+     * no list of all sockets needs to be built.
+     */
+    class TCPSocketSink {
+      public:
+        virtual ~TCPSocketSink() {};
+
+        /**
+         * Receive a TCP4 socket.
+         * @param info the TCP4SocketInfo.
+         */
+        virtual void put( const TCP4SocketInfo &info ) = 0;
+
+        /**
+         * Receive a TCP6 socket.
+         * @param info the TCP6SocketInfo.
+         */
+        virtual void put( const TCP6SocketInfo &info ) = 0;
+
+        /**
+         * Receive a TCP4 socket with its TCP_INFO, called instead of put when the
+         * TCP_INFO is requested and available. The default calls put.
+         * @param info the TCP4SocketInfo.
+         * @param tcpinfo the TCPInfo.
+         */
+        virtual void putInfo( const TCP4SocketInfo &info, const TCPInfo &tcpinfo ) { put( info ); };
+
+        /**
+         * Receive a TCP6 socket with its TCP_INFO, called instead of put when the
+         * TCP_INFO is requested and available. The default calls put.
+         * @param info the TCP6SocketInfo.
+         * @param tcpinfo the TCPInfo.
+         */
+        virtual void putInfo( const TCP6SocketInfo &info, const TCPInfo &tcpinfo ) { put( info ); };
+    };
+
+    /**
+     * Stream TCP sockets in one of the states from the kernel through NETLINK_SOCK_DIAG (inet_diag).
+     * The states are filtered in the kernel, and the binary records are handed to the sink as they
+     * are received, which is much cheaper than parsing /proc/net/tcp on hosts with many sockets.
+     * @param family AF_INET or AF_INET6.
+     * @param states mask of states to return, see getTCPStateFlag.
+     * @param sink the TCPSocketSink receiving the sockets.
+     * @param info if true, the TCP_INFO is requested (INET_DIAG_INFO) and passed to TCPSocketSink::putInfo.
+     * @return false if sock_diag is not available and no socket was streamed, errno then holds the reason.
+     * @throw Oops if the dump fails after sockets were streamed.
+     */
+    bool diagTCPSockets( int family, unsigned int states, TCPSocketSink &sink, bool info = false );
+
+    /**
+     * Stream TCP sockets in one of the states from /proc/net/tcp or /proc/net/tcp6.
+     * @param family AF_INET or AF_INET6.
+     * @param states mask of states to return, see getTCPStateFlag.
+     * @param sink the TCPSocketSink receiving the sockets.
+     */
+    void procTCPSockets( int family, unsigned int states, TCPSocketSink &sink );
+
+    /**
+     * Stream TCP sockets in one of the states through diagTCPSockets, or through procTCPSockets
+     * if sock_diag is not available.
+     * @param family AF_INET or AF_INET6.
+     * @param states mask of states to return, see getTCPStateFlag.
+     * @param sink the TCPSocketSink receiving the sockets.
+     * @param info if true, request the TCP_INFO, which is not available from /proc.
+     * @return true if sock_diag was used.
+     */
+    bool streamTCPSockets( int family, unsigned int states, TCPSocketSink &sink, bool info = false );
+
     /**
      * Get human readable name for a tcp state.
      * @param tcp_state the tcp state.
@@ -244,6 +354,57 @@ namespace leanux {
      */
     std::string resolveIP( const std::string &addr );
 
+    /** Shared state of a Resolver and its threads. */
+    struct ResolverState;
+
+    /**
+     * Asynchronous reverse DNS. A bounded pool of threads calls resolveIP, so an unreachable
+     * name server stalls the threads, not the caller. Results are kept in an LRU cache, names
+     * for positive_ttl seconds and failures for negative_ttl seconds. Thread safe.
+     */
+    class Resolver {
+      public:
+        /**
+         * Construct, threads are started as lookups are queued.
+         * @param workers the maximum number of resolving threads.
+         * @param capacity the maximum number of cached addresses, which also bounds the queue.
+         * @param positive_ttl seconds a resolved name is cached.
+         * @param negative_ttl seconds a failed lookup is cached.
+         */
+        Resolver( unsigned int workers = 4, size_t capacity = 1024,
+                  unsigned int positive_ttl = 3600, unsigned int negative_ttl = 300 );
+
+        /**
+         * Stop the threads, a thread still waiting on a name server exits once it returns.
+         */
+        ~Resolver();
+
+        /**
+         * Get the name of an address without blocking. On a cache miss, or when the cached
+         * entry expired, the address is queued for a thread to resolve.
+         * @param addr the IPv4 or IPv6 address.
+         * @return the cached name, or addr if the name is not (yet) known.
+         */
+        std::string lookup( const std::string &addr );
+
+        /**
+         * Wait for the queued lookups to complete.
+         * @param ms the maximum number of milliseconds to wait.
+         * @return true if no lookups are outstanding.
+         */
+        bool wait( unsigned int ms );
+
+      private:
+        /** not copyable. */
+        Resolver( const Resolver& );
+
+        /** not assignable. */
+        Resolver& operator=( const Resolver& );
+
+        /** state shared with the threads, which may outlive the resolver. */
+        std::shared_ptr<ResolverState> state_;
+    };
+
     /**
      * Get the service name, eg 'ssh' for port 22.
      * @param port the port number of the service
@@ -321,6 +482,73 @@ namespace leanux {
      */
     std::ostream& operator<<( std::ostream& os, const UDP4SocketInfo &inf );
 
+    /**
+     * Index of the TCP4, TCP6, UDP4 and Unix domain sockets by inode. Each protocol table is
+     * read once (the TCP sockets through streamTCPSockets), so resolving the sockets of a
+     * process costs one hash lookup per file descriptor instead of a scan of the tables,
+     * as the find..SocketByINode functions do. The index is a snapshot, refresh rebuilds it.
+     */
+    class SocketIndex {
+      public:
+        /**
+         * Construct and build the index.
+         */
+        SocketIndex() { refresh(); };
+
+        /**
+         * Rebuild the index from the current sockets.
+         */
+        void refresh();
+
+        /**
+         * Find a TCP4 socket.
+         * @param inode the inode to match.
+         * @param info the TCP4SocketInfo to fill if an entry is found.
+         * @return true when the inode is found.
+         */
+        bool findTCP4( ino_t inode, TCP4SocketInfo &info ) const;
+
+        /**
+         * Find a TCP6 socket.
+         * @param inode the inode to match.
+         * @param info the TCP6SocketInfo to fill if an entry is found.
+         * @return true when the inode is found.
+         */
+        bool findTCP6( ino_t inode, TCP6SocketInfo &info ) const;
+
+        /**
+         * Find a UDP4 socket.
+         * @param inode the inode to match.
+         * @param info the UDP4SocketInfo to fill if an entry is found.
+         * @return true when the inode is found.
+         */
+        bool findUDP4( ino_t inode, UDP4SocketInfo &info ) const;
+
+        /**
+         * Find a Unix domain socket.
+         * @param inode the inode to match.
+         * @param info the UnixDomainSocketInfo to fill if an entry is found.
+         * @return true when the inode is found.
+         */
+        bool findUnixDomain( ino_t inode, UnixDomainSocketInfo &info ) const;
+
+        /**
+         * The number of indexed sockets.
+         * @return the number of sockets.
+         */
+        size_t size() const { return tcp4_.size() + tcp6_.size() + udp4_.size() + unix_.size(); };
+
+      private:
+        /** TCP4 sockets by inode. */
+        std::unordered_map<ino_t,TCP4SocketInfo> tcp4_;
+        /** TCP6 sockets by inode. */
+        std::unordered_map<ino_t,TCP6SocketInfo> tcp6_;
+        /** UDP4 sockets by inode. */
+        std::unordered_map<ino_t,UDP4SocketInfo> udp4_;
+        /** Unix domain sockets by inode. */
+        std::unordered_map<ino_t,UnixDomainSocketInfo> unix_;
+    };
+
     /**
      * Network device statistics as in /proc/net/dev.
      */
@@ -343,6 +571,18 @@ namespace leanux {
       unsigned long tx_collisions; /**< the number of transmit collisions. */
       unsigned long tx_carrier;    /**< the number of carrier losses during transmit. */
       unsigned long tx_compressed; /**< the number of compressed packets transmitted. */
+
+      bool detailed;                    /**< true if the error breakdown below was filled by linkNetStat. */
+      unsigned long rx_length_errors;   /**< received packets with a bad length, part of rx_frame. */
+      unsigned long rx_over_errors;     /**< receiver ring buffer overflows, part of rx_frame. */
+      unsigned long rx_crc_errors;      /**< received packets with a CRC error, part of rx_frame. */
+      unsigned long rx_frame_errors;    /**< received frame alignment errors, part of rx_frame. */
+      unsigned long rx_missed_errors;   /**< packets missed by the host, part of rx_dropped. */
+      unsigned long rx_nohandler;       /**< packets dropped for lack of a protocol handler. */
+      unsigned long tx_aborted_errors;  /**< aborted transmits, part of tx_carrier. */
+      unsigned long tx_carrier_errors;  /**< carrier errors, part of tx_carrier. */
+      unsigned long tx_window_errors;   /**< late collisions, part of tx_carrier. */
+      unsigned long tx_heartbeat_errors;/**< heartbeat (SQE test) errors, part of tx_carrier. */
     };
 
     /**
@@ -367,11 +607,70 @@ namespace leanux {
      */
     typedef std::vector<NetStat> NetStatDeviceVector;
 
+    /**
+     * Selects network devices by name for getNetStat. The name is tested before any
+     * NetStat is allocated, so hosts with many container (veth) devices can skip
+     * them cheaply.
+     */
+    class NetDeviceFilter {
+      public:
+        NetDeviceFilter() {};
+
+        /**
+         * Construct with a list of device name prefixes to exclude.
+         * @param prefixes the prefixes, surrounding blanks are stripped and empty items ignored.
+         */
+        NetDeviceFilter( const std::list<std::string> &prefixes );
+
+        /**
+         * Exclude devices whose name starts with prefix.
+         * @param prefix the device name prefix, like "veth".
+         */
+        void exclude( const std::string &prefix );
+
+        /**
+         * Test a device name.
+         * @param device the device name.
+         * @return false if the device name matches an excluded prefix.
+         */
+        bool accept( const char *device ) const;
+
+        /**
+         * True if nothing is excluded.
+         */
+        bool empty() const { return prefixes_.empty(); };
+
+      private:
+        /** the excluded prefixes. */
+        std::vector<std::string> prefixes_;
+    };
+
+    /**
+     * Get network device statistics from a RTM_GETSTATS dump (linux 4.7), or from a RTM_GETLINK
+     * dump on older kernels, reading rtnl_link_stats64 directly. The device names are resolved
+     * in each call, so a renamed device is never reported under its old name.
+     * Besides the /proc/net/dev compatible fields, the error breakdown is filled
+     * and NetStat::detailed is set.
+     * @param stats the NetStatDeviceMap to fill.
+     * @param filter if not null, only devices accepted by the filter are added.
+     * @return false if rtnetlink is unavailable, stats is then empty and errno holds the reason.
+     */
+    bool linkNetStat( NetStatDeviceMap &stats, const NetDeviceFilter *filter = 0 );
+
     /**
      * Get network device statistics from /proc/net/dev.
      * @param stats the NetStatDeviceMap to fill with /proc/net/dev contents.
+     * @param filter if not null, only devices accepted by the filter are added.
      */
-    void getNetStat( NetStatDeviceMap &stats );
+    void procNetStat( NetStatDeviceMap &stats, const NetDeviceFilter *filter = 0 );
+
+    /**
+     * Get network device statistics through linkNetStat, or through procNetStat
+     * if rtnetlink is not available.
+     * @param stats the NetStatDeviceMap to fill.
+     * @param filter if not null, only devices accepted by the filter are added.
+     */
+    void getNetStat( NetStatDeviceMap &stats, const NetDeviceFilter *filter = 0 );
 
     /**
      * Get the delta of two NetStatDeviceMap objects, sorted
@@ -382,8 +681,213 @@ namespace leanux {
      */
     void getNetStatDelta( const NetStatDeviceMap& snap1, const NetStatDeviceMap& snap2, NetStatDeviceVector& delta );
 
+    /**
+     * Kernel protocol counters from /proc/net/snmp, /proc/net/netstat and /proc/net/snmp6.
+     * Only a curated set of counters is kept. The IP and UDP counters are the sum of the
+     * IPv4 and IPv6 counters, the TCP counters in /proc/net/snmp already cover both.
+     */
+    struct ProtoStat {
+      unsigned long ip_in_receives;       /**< IP datagrams received, Ip/Ip6 InReceives. */
+      unsigned long ip_in_delivers;       /**< IP datagrams delivered to upper layer protocols, InDelivers. */
+      unsigned long ip_out_requests;      /**< IP datagrams supplied for transmission, OutRequests. */
+      unsigned long ip_in_discards;       /**< received IP datagrams discarded for lack of resources, InDiscards. */
+      unsigned long ip_out_discards;      /**< outgoing IP datagrams discarded for lack of resources, OutDiscards. */
+      unsigned long ip_out_no_routes;     /**< outgoing IP datagrams discarded for lack of a route, OutNoRoutes. */
+      unsigned long ip_reasm_fails;       /**< IP reassembly failures, ReasmFails. */
+
+      unsigned long tcp_active_opens;     /**< outgoing TCP connection attempts, Tcp ActiveOpens. */
+      unsigned long tcp_passive_opens;    /**< incoming TCP connections, Tcp PassiveOpens. */
+      unsigned long tcp_attempt_fails;    /**< failed TCP connection attempts, Tcp AttemptFails. */
+      unsigned long tcp_estab_resets;     /**< resets of established TCP connections, Tcp EstabResets. */
+      unsigned long tcp_in_segs;          /**< TCP segments received, Tcp InSegs. */
+      unsigned long tcp_out_segs;         /**< TCP segments sent, Tcp OutSegs. */
+      unsigned long tcp_retrans_segs;     /**< TCP segments retransmitted, Tcp RetransSegs. */
+      unsigned long tcp_in_errs;          /**< TCP segments received in error, Tcp InErrs. */
+      unsigned long tcp_out_rsts;         /**< TCP resets sent, Tcp OutRsts. */
+
+      unsigned long tcp_listen_overflows; /**< times a listen (accept) queue was full, TcpExt ListenOverflows. */
+      unsigned long tcp_listen_drops;     /**< SYNs dropped on listening sockets, TcpExt ListenDrops. */
+      unsigned long tcp_reqq_full_drops;  /**< SYNs dropped because the SYN queue was full, TcpExt TCPReqQFullDrop. */
+      unsigned long tcp_syn_retrans;      /**< SYN and SYN/ACK retransmits, TcpExt TCPSynRetrans. */
+      unsigned long tcp_timeouts;         /**< TCP retransmission timeouts, TcpExt TCPTimeouts. */
+      unsigned long tcp_memory_pressures; /**< times TCP entered memory pressure, TcpExt TCPMemoryPressures. */
+      unsigned long tcp_abort_on_memory;  /**< TCP connections aborted for lack of memory, TcpExt TCPAbortOnMemory. */
+      unsigned long tcp_prune_called;     /**< receive queue prunes due to socket buffer overrun, TcpExt PruneCalled. */
+      unsigned long tcp_backlog_drops;    /**< segments dropped because the socket backlog was full, TcpExt TCPBacklogDrop. */
+
+      unsigned long udp_in_datagrams;     /**< UDP datagrams received, Udp/Udp6 InDatagrams. */
+      unsigned long udp_out_datagrams;    /**< UDP datagrams sent, OutDatagrams. */
+      unsigned long udp_no_ports;         /**< UDP datagrams received for a port without listener, NoPorts. */
+      unsigned long udp_in_errors;        /**< UDP datagrams received in error, InErrors. */
+      unsigned long udp_rcvbuf_errors;    /**< UDP datagrams dropped because the receive buffer was full, RcvbufErrors. */
+      unsigned long udp_sndbuf_errors;    /**< UDP datagrams dropped because the send buffer was full, SndbufErrors. */
+    };
+
+    /**
+     * Reads ProtoStat counters. The counter names (header lines) are mapped to ProtoStat
+     * fields on the first read, later reads only parse the values, the map is rebuilt if
+     * the header lines change.
+     */
+    class ProtoStatReader {
+      public:
+        ProtoStatReader() {};
+
+        /**
+         * Read the protocol counters.
+         * @param stat the ProtoStat to fill, counters that are not found are 0.
+         */
+        void read( ProtoStat &stat );
+
+      private:
+        /** ProtoStat field for a counter, 0 if the counter is not kept. */
+        typedef unsigned long ProtoStat::*Field;
+
+        /** a header line and the fields of its values, in order. */
+        struct Table {
+          std::string header;
+          std::vector<Field> fields;
+        };
+
+        /** read a /proc/net/snmp or /proc/net/netstat style file. */
+        void readTables( const char *file, std::vector<Table> &tables, ProtoStat &stat );
+
+        /** read the /proc/net/snmp6 style file. */
+        void readPairs( const char *file, Table &table, ProtoStat &stat );
+
+        /** tables of /proc/net/snmp. */
+        std::vector<Table> snmp_;
+        /** tables of /proc/net/netstat. */
+        std::vector<Table> netstat_;
+        /** the names (as header) and fields of /proc/net/snmp6. */
+        Table snmp6_;
+    };
+
+    /**
+     * Get the delta of two ProtoStat.
+     * @param stat1 the earlier ProtoStat.
+     * @param stat2 the later ProtoStat.
+     * @param delta receives stat2 - stat1.
+     */
+    void getProtoStatDelta( const ProtoStat &stat1, const ProtoStat &stat2, ProtoStat &delta );
+
+    /**
+     * Per-CPU packet processing statistics from /proc/net/softnet_stat.
+     */
+    struct SoftNetStat {
+      unsigned int cpu;              /**< the logical CPU. */
+      unsigned long processed;       /**< packets processed from the backlog and NAPI polls. */
+      unsigned long dropped;         /**< packets dropped because the backlog was full (net.core.netdev_max_backlog). */
+      unsigned long time_squeeze;    /**< times the softirq ran out of budget or time with work left (net.core.netdev_budget). */
+      unsigned long received_rps;    /**< times the CPU was woken to process packets steered to it by RPS. */
+      unsigned long flow_limit;      /**< packets dropped by the flow limit. */
+    };
+
+    /**
+     * Compare two SoftNetStat structs.
+     * Criterium is dropped+time_squeeze, processed, cpu.
+     * @param s1 the first SoftNetStat.
+     * @param s2 the second SoftNetStat.
+     * @return 1 if s1 < s2.
+     */
+    inline int operator<( const SoftNetStat& s1, const SoftNetStat &s2 ) {
+      unsigned long p1 = s1.dropped + s1.time_squeeze;
+      unsigned long p2 = s2.dropped + s2.time_squeeze;
+      return p1 > p2 || ( p1 == p2 && ( s1.processed > s2.processed || ( s1.processed == s2.processed && s1.cpu < s2.cpu ) ) );
+    }
+
+    /**
+     * A map of logical CPU to SoftNetStat statistics.
+     */
+    typedef std::map<unsigned int,SoftNetStat> SoftNetStatMap;
+
+    /**
+     * A vector of SoftNetStat objects.
+     */
+    typedef std::vector<SoftNetStat> SoftNetStatVector;
+
+    /**
+     * Get the per-CPU softnet statistics. Offline CPUs are not listed. Kernels before 5.10
+     * do not report the CPU, which is then taken from the line number.
+     * @param stats the SoftNetStatMap to fill.
+     */
+    void getSoftNetStat( SoftNetStatMap &stats );
+
+    /**
+     * Get the delta of two SoftNetStatMap objects, sorted
+     * by using int operator<( const SoftNetStat& s1, const SoftNetStat &s2 ).
+     * @param snap1 first SoftNetStatMap.
+     * @param snap2 second SoftNetStatMap.
+     * @param delta the SoftNetStatVector to fill.
+     */
+    void getSoftNetStatDelta( const SoftNetStatMap& snap1, const SoftNetStatMap& snap2, SoftNetStatVector& delta );
+
+    /**
+     * Transmit queue statistics from /sys/class/net/<device>/queues/tx-<n>. The receive
+     * queues have no counters in sysfs. The byte queue limits (BQL) are zero for drivers
+     * without BQL support.
+     */
+    struct NetQueueStat {
+      std::string device;            /**< the name of the device. */
+      unsigned int queue;            /**< the transmit queue number. */
+      unsigned long tx_timeout;      /**< transmit timeouts, the watchdog found the queue stopped too long. */
+      unsigned long bql_stall_cnt;   /**< stalls detected by BQL, 0 on kernels before 6.9. */
+      unsigned long bql_inflight;    /**< bytes queued to the hardware, a gauge. */
+      unsigned long bql_limit;       /**< bytes BQL allows in flight, a gauge. */
+
       /**
-       * Utility structure to key TCP connections. by (ip,port,user).
+       * True if the queue is near its limit or saw timeouts or stalls.
+       * @return true if hot.
+       */
+      bool isHot() const { return tx_timeout > 0 || bql_stall_cnt > 0 || ( bql_limit > 0 && bql_inflight * 10 >= bql_limit * 9 ); };
+    };
+
+    /**
+     * Compare two NetQueueStat structs.
+     * Criterium is tx_timeout+bql_stall_cnt, inflight/limit ratio, device, queue.
+     * @param q1 the first NetQueueStat.
+     * @param q2 the second NetQueueStat.
+     * @return 1 if q1 < q2.
+     */
+    inline int operator<( const NetQueueStat& q1, const NetQueueStat &q2 ) {
+      unsigned long e1 = q1.tx_timeout + q1.bql_stall_cnt;
+      unsigned long e2 = q2.tx_timeout + q2.bql_stall_cnt;
+      if ( e1 != e2 ) return e1 > e2;
+      double f1 = q1.bql_limit ? (double)q1.bql_inflight / q1.bql_limit : 0.0;
+      double f2 = q2.bql_limit ? (double)q2.bql_inflight / q2.bql_limit : 0.0;
+      if ( f1 != f2 ) return f1 > f2;
+      return q1.device < q2.device || ( q1.device == q2.device && q1.queue < q2.queue );
+    }
+
+    /**
+     * A map of 'device/tx-n' to NetQueueStat statistics.
+     */
+    typedef std::map<std::string,NetQueueStat> NetQueueStatMap;
+
+    /**
+     * A vector of NetQueueStat objects.
+     */
+    typedef std::vector<NetQueueStat> NetQueueStatVector;
+
+    /**
+     * Get the transmit queue statistics of all network devices.
+     * @param stats the NetQueueStatMap to fill.
+     * @param filter if not null, only queues of devices accepted by the filter are added.
+     */
+    void getNetQueueStat( NetQueueStatMap &stats, const NetDeviceFilter *filter = 0 );
+
+    /**
+     * Get the delta of two NetQueueStatMap objects, sorted by using
+     * int operator<( const NetQueueStat& q1, const NetQueueStat &q2 ). The counters
+     * are subtracted, the BQL gauges are taken from snap2.
+     * @param snap1 first NetQueueStatMap.
+     * @param snap2 second NetQueueStatMap.
+     * @param delta the NetQueueStatVector to fill.
+     */
+    void getNetQueueStatDelta( const NetQueueStatMap& snap1, const NetQueueStatMap& snap2, NetQueueStatVector& delta );
+
+      /**
+       * Utility structure to key TCP connections by (ip,port,user).
+       * The address is kept in binary form, getIP formats it only when asked.
        * @internal
        */
       class TCPKey {
@@ -391,40 +895,107 @@ namespace leanux {
           /**
            * Default constructor.
            */
-          TCPKey() { ip_ = ""; port_ = 0; uid_ = 0; };
+          TCPKey() { family_ = 0; memset( addr_, 0, sizeof(addr_) ); port_ = 0; uid_ = 0; };
 
           /**
-           * Assignment constructor.
+           * Construct from a binary address.
+           * @param family AF_INET or AF_INET6.
+           * @param addr the address in network format, 4 bytes for AF_INET, 16 bytes for AF_INET6.
+           * @param port the port.
+           * @param uid the uid.
            */
-          TCPKey( std::string ip, unsigned int port, unsigned int uid ) { ip_ = ip; port_ = port; uid_ = uid; };
+          TCPKey( int family, const void *addr, unsigned int port, unsigned int uid ) {
+            family_ = family;
+            memset( addr_, 0, sizeof(addr_) );
+            memcpy( addr_, addr, family == AF_INET6 ? 16 : 4 );
+            port_ = port;
+            uid_ = uid;
+          };
 
           /**
-           * Copy constructor.
+           * Construct from a human readable IPv4 or IPv6 address, as returned by getIP.
+           * An address that cannot be parsed yields an empty getIP.
+           * @param ip the address.
+           * @param port the port.
+           * @param uid the uid.
            */
-          TCPKey( const TCPKey &key ) { ip_ = key.ip_; port_ = key.port_; uid_ = key.uid_; };
+          TCPKey( const std::string &ip, unsigned int port, unsigned int uid );
 
           /**
            * compare two TCPKey objects.
            * @param s the TCPKey to compare to.
            * @return true if *this < s.
            */
-          bool operator<( const TCPKey& s ) const { return ip_ < s.ip_ || (ip_ == s.ip_ && port_ < s.port_ ) || (ip_ == s.ip_ && port_ == s.port_ && uid_ < s.uid_); };
+          bool operator<( const TCPKey& s ) const {
+            if ( family_ != s.family_ ) return family_ < s.family_;
+            int c = memcmp( addr_, s.addr_, sizeof(addr_) );
+            if ( c != 0 ) return c < 0;
+            if ( port_ != s.port_ ) return port_ < s.port_;
+            return uid_ < s.uid_;
+          };
 
-          std::string getIP() const { return ip_; };
+          /**
+           * test two TCPKey objects for equality.
+           * @param s the TCPKey to compare to.
+           * @return true if *this == s.
+           */
+          bool operator==( const TCPKey& s ) const {
+            return family_ == s.family_ && port_ == s.port_ && uid_ == s.uid_ && memcmp( addr_, s.addr_, sizeof(addr_) ) == 0;
+          };
+
+          /**
+           * Hash of the key.
+           * @return the hash value.
+           */
+          size_t hash() const;
+
+          /**
+           * The address in human readable format, formatted on each call.
+           * @return the address.
+           */
+          std::string getIP() const;
+
+          /**
+           * @return the address family, AF_INET or AF_INET6.
+           */
+          int getFamily() const { return family_; };
 
           unsigned int getPort() const { return port_; };
 
           unsigned int getUID() const { return uid_; };
 
         private:
-          /** the local IP used by the server process. */
-          std::string ip_;
+          /** the address family. */
+          unsigned short family_;
 
-          /** the TCP port used by the server process. */
-          unsigned int port_;
+          /** the port. */
+          unsigned short port_;
 
-          /** the uid_ running the server process. */
+          /** the uid. */
           unsigned int uid_;
+
+          /** the address in network format, IPv4 addresses use the first 4 bytes. */
+          unsigned char addr_[16];
+      };
+
+      /**
+       * TCP_INFO of the sampled connections of a TCPKey, summarized over a sample interval.
+       * Percentiles are taken over the sampled connections, the times and retransmits are
+       * summed over the interval.
+       */
+      struct TCPInfoSummary {
+        TCPInfoSummary() : sampled(0), rtt_p50(0), rtt_p95(0), rttvar_p50(0), cwnd_p50(0),
+                           delivery_rate_p50(0), retrans(0), busy(0), rwnd_limited(0), sndbuf_limited(0) {};
+        unsigned int sampled;          /**< number of connections summarized, 0 if none. */
+        double rtt_p50;                /**< median smoothed round trip time in seconds. */
+        double rtt_p95;                /**< 95th percentile smoothed round trip time in seconds. */
+        double rttvar_p50;             /**< median round trip time variation in seconds. */
+        double cwnd_p50;               /**< median congestion window in segments. */
+        double delivery_rate_p50;      /**< median delivery rate in bytes per second. */
+        unsigned long retrans;         /**< segments retransmitted. */
+        double busy;                   /**< seconds busy sending data. */
+        double rwnd_limited;           /**< seconds sending was limited by the receive window. */
+        double sndbuf_limited;         /**< seconds sending was limited by the send buffer. */
       };
 
       /**
@@ -439,30 +1010,150 @@ namespace leanux {
            */
           TCPKeyCounter( const TCPKey& key, unsigned int esta ) { key_ = key; esta_ = esta; };
 
+          /**
+           * Constructor.
+           * @param key the TCPKey.
+           * @param esta the number of establised connections.
+           * @param info the TCP_INFO summary.
+           */
+          TCPKeyCounter( const TCPKey& key, unsigned int esta, const TCPInfoSummary &info ) { key_ = key; esta_ = esta; info_ = info; };
+
           /**
            * Compare TCPKeyCounter entries on number of establised connections.
            * @param s TCPKeyCounter to compare to.
            * @return true if *this  < s.
            */
-          bool operator<( const TCPKeyCounter& s ) const { return esta_ > s.esta_; };
+          bool operator<( const TCPKeyCounter& s ) const { return esta_ > s.esta_ || ( esta_ == s.esta_ && key_ < s.key_ ); };
 
-          TCPKey getKey() const { return key_; };
+          const TCPKey& getKey() const { return key_; };
 
           unsigned int getEsta() const { return esta_; };
 
+          /**
+           * The TCP_INFO summary, TCPInfoSummary::sampled is 0 if none of the connections
+           * was among the sampled connections.
+           */
+          const TCPInfoSummary& getInfo() const { return info_; };
+
         private:
           /** TCPKey of the connection. */
           TCPKey key_;
           /** number of established connections. */
           unsigned int esta_;
+          /** TCP_INFO summary. */
+          TCPInfoSummary info_;
+      };
+
+      /** vector of TCPKeyCounter. */
+      typedef std::vector<TCPKeyCounter> TCPKeyCounterVector;
+
+      /**
+       * Return the number of established TCP connections grouped by (ip,port,uid), ordered
+       * by descending number of connections. The sockets are aggregated on binary keys in a
+       * hash table, so time and memory are linear in the number of sockets.
+       * @param servers receives the server (local ip) TCPKeyCounters.
+       * @param clients receives the client (remote ip) TCPKeyCounters.
+       */
+      void getTCPConnectionCounters( TCPKeyCounterVector &servers, TCPKeyCounterVector &clients );
+
+      /**
+       * Counts established TCP connections like getTCPConnectionCounters, and summarizes the
+       * TCP_INFO of the busiest connections per TCPKey. The busiest connections are those that
+       * moved the most bytes since the previous sample (since connect on the first sample), for
+       * which the cumulative counters of all established connections are kept between samples.
+       * The TCP_INFO needs sock_diag, without it no summaries are made.
+       */
+      class TCPConnectionSampler {
+        public:
+          /**
+           * Constructor.
+           * @param top the number of busiest connections to summarize, 0 for none.
+           */
+          TCPConnectionSampler( unsigned int top ) : top_( top ) {};
+
+          /**
+           * Sample the connections.
+           * @param servers receives the server (local ip) TCPKeyCounters.
+           * @param clients receives the client (remote ip) TCPKeyCounters.
+           */
+          void sample( TCPKeyCounterVector &servers, TCPKeyCounterVector &clients );
+
+          /**
+           * The cumulative TCP_INFO counters of a connection.
+           */
+          struct Cumulative {
+            unsigned long bytes;
+            unsigned long retrans;
+            unsigned long busy;
+            unsigned long rwnd_limited;
+            unsigned long sndbuf_limited;
+          };
+
+        private:
+          /** number of connections to summarize. */
+          unsigned int top_;
+          /** cumulative counters by socket inode at the previous sample. */
+          std::unordered_map<ino_t,Cumulative> previous_;
       };
 
       /**
-       * Return the number of established TCP connections grouped by (ip,port,uid).
-       * @param servers receives the server (local ip) TCPKeyCounter list.
-       * @param clients receives the client (remote ip) TCPKeyCounter list.
+       * TCP traffic of a process between two ProcessNetSampler samples.
        */
-      void getTCPConnectionCounters( std::list<TCPKeyCounter> &servers, std::list<TCPKeyCounter> &clients );
+      struct ProcessNetStat {
+        pid_t pid;                     /**< the process owning the connections. */
+        unsigned long connections;     /**< the number of connections that moved data. */
+        unsigned long bytes_sent;      /**< bytes sent and acknowledged. */
+        unsigned long bytes_received;  /**< bytes received. */
+      };
+
+      /**
+       * Sort ProcessNetStat busiest first.
+       * Criterium is bytes sent+received, pid.
+       */
+      inline bool operator<( const ProcessNetStat& p1, const ProcessNetStat& p2 ) {
+        return (p1.bytes_sent + p1.bytes_received > p2.bytes_sent + p2.bytes_received) ||
+               (p1.bytes_sent + p1.bytes_received == p2.bytes_sent + p2.bytes_received && p1.pid < p2.pid );
+      }
+
+      /**
+       * A std::vector of ProcessNetStat.
+       */
+      typedef std::vector<ProcessNetStat> ProcessNetStatVector;
+
+      /**
+       * Attributes TCP traffic to processes. Each sample streams the TCP sockets with their
+       * TCP_INFO byte counters through sock_diag, and resolves the owners of the sockets that
+       * moved data since the previous sample with a single process::getSocketOwners pass, so
+       * the cost is linear in the number of sockets plus open files. When no socket moved data,
+       * the pass over the processes is skipped. Traffic on sockets whose owner is not visible to
+       * the caller is not attributed. The TCP_INFO needs sock_diag, without it no traffic is seen.
+       */
+      class ProcessNetSampler {
+        public:
+          /** Constructor. */
+          ProcessNetSampler() : primed_( false ) {};
+
+          /**
+           * Sample the per process traffic since the previous sample. The first sample only
+           * records the socket counters and returns no traffic.
+           * @param stats receives the ProcessNetStat of the processes that moved data, busiest first.
+           */
+          void sample( ProcessNetStatVector &stats );
+
+          /**
+           * The cumulative byte counters of a connection.
+           */
+          struct Cumulative {
+            unsigned long sent;
+            unsigned long received;
+          };
+
+        private:
+          /** cumulative counters by socket inode at the previous sample. */
+          std::unordered_map<ino_t,Cumulative> previous_;
+          /** true once the first sample has been taken. */
+          bool primed_;
+      };
 
   }
 }
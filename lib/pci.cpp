@@ -56,20 +56,94 @@ namespace leanux {
 
   namespace pci {
 
-    std::string PCIDeviceDatabase = "/usr/share/misc/pci.ids";
-
     const PCIAddress NullPCIAddress = {0xffff, 0xffff, 0xffff, 0xffff};
 
-    void init() {
-      if ( util::fileReadAccess( "/usr/share/misc/pci.ids" ) ) {
-        PCIDeviceDatabase = "/usr/share/misc/pci.ids";
-      } else
-      if ( util::fileReadAccess( "/usr/share/hwdata/pci.ids" ) ) {
-        PCIDeviceDatabase = "/usr/share/hwdata/pci.ids";
-      } else
-      if ( util::fileReadAccess( "/usr/share/pci.ids" ) ) {
-        PCIDeviceDatabase = "/usr/share/pci.ids";
-      } else throw Oops( __FILE__, __LINE__, "leanux cannot find pci.ids file" );
+    /**
+     * Parse n hex digits.
+     * @return false if s does not start with n hex digits.
+     */
+    bool parseHexId( const char *s, int n, uint32_t &id ) {
+      id = 0;
+      for ( int i = 0; i < n; i++ ) {
+        if ( !isxdigit( s[i] ) ) return false;
+        id = id * 16 + ( isdigit( s[i] ) ? s[i] - '0' : tolower( s[i] ) - 'a' + 10 );
+      }
+      return true;
+    }
+
+    const std::string& IdsDatabase::getPath() {
+      std::call_once( loaded_, &IdsDatabase::load, this );
+      return path_;
+    }
+
+    void IdsDatabase::load() {
+      for ( std::vector<std::string>::const_iterator p = paths_.begin(); p != paths_.end(); ++p ) {
+        if ( util::fileReadAccess( *p ) ) {
+          path_ = *p;
+          break;
+        }
+      }
+      if ( path_ == "" ) return;
+      std::ifstream f( path_.c_str() );
+      std::string s;
+      bool in_vendor = false;
+      bool in_device = false;
+      uint32_t vendor = 0;
+      uint32_t device = 0;
+      uint32_t subvendor = 0;
+      uint32_t subdevice = 0;
+      while ( getline( f, s ) ) {
+        if ( s.length() == 0 || s[0] == '#' ) continue;
+        const char *c = s.c_str();
+        if ( c[0] != '\t' ) {
+          // 'vvvv  vendor', anything else (like 'C 00  class') ends the vendor section
+          in_vendor = s.length() > 6 && parseHexId( c, 4, vendor ) && c[4] == ' ' && c[5] == ' ';
+          in_device = false;
+          if ( in_vendor ) vendors_.insert( std::make_pair( vendor, s.substr( 6 ) ) );
+        } else if ( c[1] != '\t' ) {
+          // '\tdddd  device'
+          in_device = in_vendor && s.length() > 7 && parseHexId( c + 1, 4, device ) && c[5] == ' ' && c[6] == ' ';
+          if ( in_device ) devices_.insert( std::make_pair( vendor << 16 | device, s.substr( 7 ) ) );
+        } else if ( in_device ) {
+          // '\t\tssss dddd  subsystem'
+          if ( s.length() > 13 && parseHexId( c + 2, 4, subvendor ) && c[6] == ' ' && parseHexId( c + 7, 4, subdevice ) ) {
+            uint64_t key = (uint64_t)( vendor << 16 | device ) << 32 | subvendor << 16 | subdevice;
+            subdevices_.insert( std::make_pair( key, s.substr( 13 ) ) );
+          }
+        }
+      }
+    }
+
+    bool IdsDatabase::getVendor( unsigned int vendor, std::string &name ) {
+      std::call_once( loaded_, &IdsDatabase::load, this );
+      std::unordered_map<uint32_t,std::string>::const_iterator i = vendors_.find( vendor );
+      if ( i == vendors_.end() ) return false;
+      name = i->second;
+      return true;
+    }
+
+    bool IdsDatabase::getDevice( unsigned int vendor, unsigned int device, std::string &name ) {
+      std::call_once( loaded_, &IdsDatabase::load, this );
+      std::unordered_map<uint32_t,std::string>::const_iterator i = devices_.find( vendor << 16 | device );
+      if ( i == devices_.end() ) return false;
+      name = i->second;
+      return true;
+    }
+
+    bool IdsDatabase::getSubDevice( unsigned int vendor, unsigned int device,
+                                    unsigned int subvendor, unsigned int subdevice, std::string &name ) {
+      std::call_once( loaded_, &IdsDatabase::load, this );
+      uint64_t key = (uint64_t)( vendor << 16 | device ) << 32 | subvendor << 16 | subdevice;
+      std::unordered_map<uint64_t,std::string>::const_iterator i = subdevices_.find( key );
+      if ( i == subdevices_.end() ) return false;
+      name = i->second;
+      return true;
+    }
+
+    IdsDatabase& getPCIDatabase() {
+      static const char* paths[] = { "/usr/share/misc/pci.ids", "/usr/share/hwdata/pci.ids", "/usr/share/pci.ids" };
+      static IdsDatabase db( std::vector<std::string>( paths, paths + sizeof(paths)/sizeof(paths[0]) ) );
+      return db;
     }
 
     std::string getEBDF( const PCIAddress &id ) {
@@ -513,69 +587,11 @@ namespace leanux {
       inf.subdevice = "";
       inf.pciclass = getPCIHardwareClassString( id.pciclass );
       inf.pcisubclass = getPCISubClassString( id.pciclass );
-      std::stringstream ss;
-      ss << std::hex;
-      ss << std::setfill('0') << std::setw(4) << id.vendor;
-      std::string hex_vendor = ss.str();
-      ss.str("");
-      ss << std::setfill('0') << std::setw(4) << id.device;
-      std::string hex_device = ss.str();
-      ss.str("");
-      ss << std::setfill('0') << std::setw(4) << id.subvendor << ' ' << id.subdevice;
-      std::string hex_subdevice = ss.str();
-
-      std::ifstream f( PCIDeviceDatabase.c_str() );
-      if ( !f.good() ) throw Oops( __FILE__, __LINE__, "error opening pci.ids" );
-
-      /**
-       * 0 = initial      (aka EVENDOR_NOT_FOUND)
-       * 1 = vendor found (aka EDEVICE_NOT_FOUND)
-       * 2 = device found
-       * 3 = subdevice found
-       */
-      int state = 0;
-
-      bool giveup = false;
-      while ( f.good() && !f.eof() && !giveup && state != 3 ) {
-        std::string s = "";
-        getline( f, s );
-
-        if ( s[0] != '#' ) {
-
-          switch ( state ) {
-            case 0:
-              if ( strncmp( s.c_str(), hex_vendor.c_str(), 4 ) == 0 ) {
-                inf.vendor = s.substr( 6 );
-                state = 1;
-              }
-              break;
-            case 1:
-              if ( s[0] != '\t' ) {
-                //we hit another vendor line, so device not found
-                giveup = true;
-              } else {
-                if ( strncmp( s.c_str()+1, hex_device.c_str(), 4 ) == 0 ) {
-                  inf.device = s.substr(7);
-                  state = 2;
-                }
-              }
-              break;
-            case 2:
-              if ( s[0] != '\t' || s[1] != '\t' ) {
-                //possible subvendors exhausted, giveup
-                giveup = true;
-              } else {
-                if ( strncmp( s.c_str()+2, hex_subdevice.c_str(), 9 ) == 0 ) {
-                  inf.subdevice = s.substr(13);
-                  state = 3;
-                }
-              }
-              break;
-
-          }
-        }
-      }
-      return ( state == 2 || state == 3 );
+      IdsDatabase &db = getPCIDatabase();
+      if ( !db.getVendor( id.vendor, inf.vendor ) ) return false;
+      if ( !db.getDevice( id.vendor, id.device, inf.device ) ) return false;
+      db.getSubDevice( id.vendor, id.device, id.subvendor, id.subdevice, inf.subdevice );
+      return true;
     }
 
     /**
@@ -37,8 +37,12 @@
 
 #include <string>
 #include <list>
+#include <mutex>
 #include <ostream>
 #include <iomanip>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
 #include "oops.hpp"
 
 /**
@@ -57,16 +61,80 @@ namespace leanux {
    */
 
     /**
-     * The location of the system's PCI device database.
-     * This varies among GNU/Linux distributions, set by
-     * and see pci::init().
+     * A database in pci.ids format, which usb.ids shares. The first lookup locates the
+     * file and parses it once into hash tables, after which lookups are O(1). A missing
+     * database is not an error, lookups then fail.
      */
-    extern std::string PCIDeviceDatabase;
+    class IdsDatabase {
+      public:
+        /**
+         * Construct, nothing is read yet.
+         * @param paths the candidate locations, which vary among GNU/Linux distributions.
+         */
+        IdsDatabase( const std::vector<std::string> &paths ) : paths_(paths) {};
+
+        /**
+         * Get the path of the database in use.
+         * @return the path, empty if none of the candidates is readable.
+         */
+        const std::string& getPath();
+
+        /**
+         * Get a vendor name.
+         * @param vendor the vendor id.
+         * @param name set to the vendor name if found.
+         * @return true if found.
+         */
+        bool getVendor( unsigned int vendor, std::string &name );
+
+        /**
+         * Get a device name.
+         * @param vendor the vendor id.
+         * @param device the device id.
+         * @param name set to the device name if found.
+         * @return true if found.
+         */
+        bool getDevice( unsigned int vendor, unsigned int device, std::string &name );
+
+        /**
+         * Get a subsystem name.
+         * @param vendor the vendor id.
+         * @param device the device id.
+         * @param subvendor the subsystem vendor id.
+         * @param subdevice the subsystem device id.
+         * @param name set to the subsystem name if found.
+         * @return true if found.
+         */
+        bool getSubDevice( unsigned int vendor, unsigned int device,
+                           unsigned int subvendor, unsigned int subdevice, std::string &name );
+
+      private:
+        /** locate and parse the database, once. */
+        void load();
+
+        /** candidate locations. */
+        std::vector<std::string> paths_;
+
+        /** guards load. */
+        std::once_flag loaded_;
+
+        /** the database in use. */
+        std::string path_;
+
+        /** vendor names by vendor id. */
+        std::unordered_map<uint32_t,std::string> vendors_;
+
+        /** device names by (vendor,device). */
+        std::unordered_map<uint32_t,std::string> devices_;
+
+        /** subsystem names by (vendor,device,subvendor,subdevice). */
+        std::unordered_map<uint64_t,std::string> subdevices_;
+    };
 
     /**
-     * Initialize pci namespace.
+     * The system's PCI device database (pci.ids).
      */
-    void init();
+    IdsDatabase& getPCIDatabase();
 
     /**
      * String path relative to /sys/devices identifying the PCI device
@@ -218,7 +286,8 @@ namespace leanux {
 
     /**
      * Get PCI device info based on (vendor,device)
-     * function retrieves data from /usr/share/misc/pci.ids
+     * function retrieves data from the pci.ids database.
+     * @see getPCIDatabase.
      * @param id the PCIHardwareId of the PCI device.
      * @param inf the PCIHardwareInfo to fill.
      * @return true when the device is found, in which case subdevicestring may be empty.
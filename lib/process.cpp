@@ -43,12 +43,17 @@
 #include <iostream>
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <errno.h>
+#include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 
 
  namespace leanux {
@@ -59,7 +64,7 @@
       std::stringstream path;
       stat.pid = pid;
       stat.comm = "";
-      path << "/proc/" << pid << "/task/" << pid << "/stat";
+      path << util::ProcFS::proc().getDir() << "/" << pid << "/task/" << pid << "/stat";
       std::ifstream ifs( path.str().c_str() );
       std::string s;
       getline( ifs, s );
@@ -122,7 +127,7 @@
 
     std::string getWChan( pid_t pid ) {
       std::stringstream ss;
-      ss << "/proc/" << pid << "/wchan";
+      ss << util::ProcFS::proc().getDir() << "/" << pid << "/wchan";
       std::string result = "";
       try {
         result = util::fileReadString( ss.str() );
@@ -135,7 +140,7 @@
 
     bool getProcPidIO( pid_t pid, ProcPidIO &io ) {\
       std::stringstream ss;
-      ss << "/proc/" << pid << "/io";
+      ss << util::ProcFS::proc().getDir() << "/" << pid << "/io";
       std::ifstream ifs( ss.str().c_str() );
       if ( ifs.good() ) {
         while ( ifs.good() && !ifs.eof() ) {
@@ -156,7 +161,7 @@
 
     std::string getProcCmdLine( pid_t pid ) {
       std::stringstream ss;
-      ss << "/proc/" << pid << "/cmdline";
+      ss << util::ProcFS::proc().getDir() << "/" << pid << "/cmdline";
       std::string result = "";
       FILE *file = fopen( ss.str().c_str(), "r" );
       if ( file ) {
@@ -173,7 +178,7 @@
     void getAllProcPidStat( ProcPidStatMap &stats ) {
       stats.clear();
       std::set<pid_t> threadset;
-      std::string path = "/proc";
+      std::string path = util::ProcFS::proc().getDir();
       DIR *pidd;
       struct dirent *piddir;
       pidd = opendir( path.c_str() );
@@ -182,7 +187,7 @@
           if ( isdigit( piddir->d_name[0] ) ) {
             pid_t pid = atoi( piddir->d_name );
             if ( pid ) {
-              std::string tpath = "/proc/" + (std::string)piddir->d_name + "/task";
+              std::string tpath = path + "/" + (std::string)piddir->d_name + "/task";
               DIR *tidd;
               struct dirent *tiddir;
               tidd = opendir( tpath.c_str() );
@@ -219,7 +224,7 @@
     void getOpenFiles( pid_t pid, OpenFileMap &files ) {
       files.clear();
       std::stringstream path;
-      path << "/proc/" << pid << "/fd";
+      path << util::ProcFS::proc().getDir() << "/" << pid << "/fd";
       DIR *d;
       struct dirent *dir;
       d = opendir( path.str().c_str() );
@@ -241,6 +246,85 @@
       closedir( d );
     }
 
+    /**
+     * Directory entry as returned by the getdents64 system call.
+     */
+    struct LinuxDirent64 {
+      uint64_t       d_ino;
+      int64_t        d_off;
+      unsigned short d_reclen;
+      unsigned char  d_type;
+      char           d_name[1];
+    };
+
+    /**
+     * Reads directory entries from a directory file descriptor with getdents64, a buffer
+     * at a time and without allocating per entry.
+     */
+    class DirentReader {
+      public:
+        DirentReader( int fd ) : fd_( fd ), pos_( 0 ), size_( 0 ) {};
+
+        /**
+         * Get the next entry name.
+         * @return the name, or 0 at the end of the directory.
+         */
+        const char* next() {
+          if ( pos_ >= size_ ) {
+            long r = syscall( SYS_getdents64, fd_, buf_, sizeof(buf_) );
+            if ( r <= 0 ) return 0;
+            size_ = r;
+            pos_ = 0;
+          }
+          const LinuxDirent64 *d = reinterpret_cast<const LinuxDirent64*>( buf_ + pos_ );
+          pos_ += d->d_reclen;
+          return d->d_name;
+        };
+
+      private:
+        int fd_;
+        long pos_;
+        long size_;
+        char buf_[16384] __attribute__((aligned(8)));
+    };
+
+    void getSocketOwners( SocketOwnerMap &owners, bool known ) {
+      if ( !known ) owners.clear();
+      else if ( owners.empty() ) return;
+      int procfd = open( util::ProcFS::proc().getDir().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+      if ( procfd < 0 ) throw Oops( __FILE__, __LINE__, errno );
+      DirentReader pids( procfd );
+      size_t resolved = 0;
+      const char *pid_name;
+      while ( ( pid_name = pids.next() ) != 0 && !( known && resolved == owners.size() ) ) {
+        if ( !isdigit( pid_name[0] ) ) continue;
+        char fd_path[64];
+        snprintf( fd_path, sizeof(fd_path), "%s/fd", pid_name );
+        int fdfd = openat( procfd, fd_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+        if ( fdfd < 0 ) continue;
+        pid_t pid = atoi( pid_name );
+        DirentReader fds( fdfd );
+        const char *fd_name;
+        while ( ( fd_name = fds.next() ) != 0 ) {
+          if ( !isdigit( fd_name[0] ) ) continue;
+          char link[64];
+          ssize_t r = readlinkat( fdfd, fd_name, link, sizeof(link) - 1 );
+          if ( r < 9 || strncmp( link, "socket:[", 8 ) != 0 ) continue;
+          link[r] = 0;
+          ino_t inode = strtoul( link + 8, 0, 10 );
+          if ( known ) {
+            SocketOwnerMap::iterator o = owners.find( inode );
+            if ( o != owners.end() && o->second == 0 ) {
+              o->second = pid;
+              resolved++;
+            }
+          } else owners.insert( std::make_pair( inode, pid ) );
+        }
+        close( fdfd );
+      }
+      close( procfd );
+    }
+
     void deltaProcPidStats( const ProcPidStatMap &snap1, const ProcPidStatMap &snap2, ProcPidStatDeltaVector &delta ) {
       delta.clear();
       for ( ProcPidStatMap::const_iterator s2 = snap2.begin(); s2 != snap2.end(); ++s2 ) {
@@ -335,7 +419,7 @@
 
     bool getProcUid( pid_t pid, uid_t &uid ) {
       std::stringstream ss;
-      ss << "/proc/" << pid << "/status";
+      ss << util::ProcFS::proc().getDir() << "/" << pid << "/status";
       std::ifstream ifs( ss.str().c_str() );
       bool found = false;
       if ( ifs.good() ) {
@@ -41,6 +41,7 @@
 #include <map>
 #include <list>
 #include <vector>
+#include <unordered_map>
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -223,6 +224,25 @@ namespace leanux {
      */
     void getOpenFiles( pid_t pid, OpenFileMap &files );
 
+    /**
+     * A std::unordered_map of pids keyed by socket inode.
+     */
+    typedef std::unordered_map<ino_t,pid_t> SocketOwnerMap;
+
+    /**
+     * Map socket inodes to the pid of the process holding them open, in a single pass over
+     * /proc/[pid]/fd. The directories are read with getdents64 and the links with readlinkat
+     * relative to the directory descriptors, so the cost is linear in the number of processes
+     * plus open files, and no path is built per file. A socket shared by several processes
+     * maps to the first pid found.
+     * @param owners the SocketOwnerMap to fill.
+     * @param known if true, only the inodes already in owners are resolved, and inodes no
+     * process is found for keep pid 0. If false, owners is cleared and receives all sockets.
+     * @root only root can see the open files of any process,
+     * other users can only see open files of their own processes.
+     */
+    void getSocketOwners( SocketOwnerMap &owners, bool known = false );
+
 
     /** Delta of a pid's stats. */
     struct ProcPidStatDelta {
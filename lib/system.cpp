@@ -67,12 +67,9 @@ namespace leanux {
     std::string version = system::getKernelVersion();
     if ( version < kernel_required )
       throw Oops( __FILE__, __LINE__, "leanux requires at least " + kernel_required + ", this kernel is " + version );
-    if ( !util::directoryExists( "/proc" ) ) throw Oops( __FILE__, __LINE__, "leanux requires /proc procfs" );
-    if ( !util::directoryExists( "/sys" ) ) throw Oops( __FILE__, __LINE__, "leanux requires /sys sysfs" );
-    pci::init();
+    if ( !util::directoryExists( util::ProcFS::proc().getDir() ) ) throw Oops( __FILE__, __LINE__, "leanux requires /proc procfs" );
+    if ( !util::directoryExists( util::SysFS::sys().getDir() ) ) throw Oops( __FILE__, __LINE__, "leanux requires /sys sysfs" );
     block::init();
-    net::init();
-    usb::init();
   }
 
   namespace system {
@@ -113,7 +110,7 @@ namespace leanux {
 
     std::string  getBoardName() {
       try {
-        return util::fileReadString( "/sys/class/dmi/id/board_name" );
+        return util::fileReadString( util::SysFS::path( "class/dmi/id/board_name" ) );
       }
       catch ( const Oops &oops ) {
         return "";
@@ -122,7 +119,7 @@ namespace leanux {
 
     std::string  getBoardVendor() {
       try {
-        return util::fileReadString( "/sys/class/dmi/id/board_vendor" );
+        return util::fileReadString( util::SysFS::path( "class/dmi/id/board_vendor" ) );
       }
       catch ( const Oops &oops ) {
         return "";
@@ -131,7 +128,7 @@ namespace leanux {
 
     std::string  getBoardVersion() {
       try {
-        return util::fileReadString( "/sys/class/dmi/id/board_version" );
+        return util::fileReadString( util::SysFS::path( "class/dmi/id/board_version" ) );
       }
       catch ( const Oops &oops ) {
         return "";
@@ -139,8 +136,8 @@ namespace leanux {
     }
 
     ChassisType getChassisType() {
-      if ( util::fileReadAccess( "/sys/class/dmi/id/chassis_type" ) )
-        return (ChassisType)util::fileReadInt( "/sys/class/dmi/id/chassis_type" );
+      if ( util::fileReadAccess( util::SysFS::path( "class/dmi/id/chassis_type" ) ) )
+        return (ChassisType)util::fileReadInt( util::SysFS::path( "class/dmi/id/chassis_type" ) );
       else
         return ChassisTypeUnknown;
     }
@@ -164,14 +161,14 @@ namespace leanux {
     }
 
     double getUptime() {
-      double d;
-      std::ifstream i( "/proc/uptime" );
-      i >> d;
+      double d = 0;
+      const char *s = util::ProcFS::proc().read( "uptime" );
+      if ( s ) sscanf( s, "%lf", &d );
       return d;
     }
 
     time_t getBootTime() {
-      std::ifstream ifs( "/proc/stat" );
+      std::ifstream ifs( util::ProcFS::path( "stat" ).c_str() );
       double t = 0;
       while ( ifs.good() && !ifs.eof() ) {
         std::string  s;
@@ -194,34 +191,28 @@ namespace leanux {
     }
 
     void getOpenFiles( unsigned long *used, unsigned long *max ) {
-      std::ifstream ifs( "/proc/sys/fs/file-nr" );
+      const char *s = util::ProcFS::proc().read( "sys/fs/file-nr" );
       unsigned long dummy;
-      if ( ifs.good() && !ifs.eof() ) {
-        std::string s = "";
-        getline( ifs, s );
-        if ( sscanf( s.c_str(), "%lu %lu %lu", used, &dummy, max ) != 3 ) {
+      if ( s && *s ) {
+        if ( sscanf( s, "%lu %lu %lu", used, &dummy, max ) != 3 ) {
           throw Oops( __FILE__, __LINE__, "failed to parse /proc/sys/fs/file-nr" );
         }
       }
     }
 
     void getOpenInodes( unsigned long *used, unsigned long *free ) {
-      std::ifstream ifs( "/proc/sys/fs/inode-nr" );
-      if ( ifs.good() && !ifs.eof() ) {
-        std::string s = "";
-        getline( ifs, s );
-        if ( sscanf( s.c_str(), "%lu %lu", used, free ) != 2 ) {
+      const char *s = util::ProcFS::proc().read( "sys/fs/inode-nr" );
+      if ( s && *s ) {
+        if ( sscanf( s, "%lu %lu", used, free ) != 2 ) {
           throw Oops( __FILE__, __LINE__, "failed to parse /proc/sys/fs/inode-nr" );
         }
       }
     }
 
     void getNumProcesses( unsigned long *processes ) {
-      std::ifstream ifs( "/proc/loadavg" );
-      if ( ifs.good() && !ifs.eof() ) {
-        std::string s = "";
-        getline( ifs, s );
-        int r = sscanf( s.c_str(), "%*f %*f %*f %*u/%lu", processes );
+      const char *s = util::ProcFS::proc().read( "loadavg" );
+      if ( s && *s ) {
+        int r = sscanf( s, "%*f %*f %*f %*u/%lu", processes );
         if ( r != 1 ) {
           throw Oops( __FILE__, __LINE__, "failed to parse /proc/loadavg" );
         }
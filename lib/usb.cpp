@@ -59,18 +59,10 @@ namespace leanux {
 
   namespace usb {
 
-    std::string USBDeviceDatabase = "/usr/share/misc/pci.ids";
-
-    void init() {
-      if ( util::fileReadAccess( "/usr/share/misc/usb.ids" ) ) {
-        USBDeviceDatabase = "/usr/share/misc/usb.ids";
-      } else
-      if ( util::fileReadAccess( "/usr/share/hwdata/usb.ids" ) ) {
-        USBDeviceDatabase = "/usr/share/hwdata/usb.ids";
-      } else
-      if ( util::fileReadAccess( "/usr/share/usb.ids" ) ) {
-        USBDeviceDatabase = "/usr/share/usb.ids";
-      } else throw Oops( __FILE__, __LINE__, "leanux cannot find usb.ids file" );
+    pci::IdsDatabase& getUSBDatabase() {
+      static const char* paths[] = { "/usr/share/misc/usb.ids", "/usr/share/hwdata/usb.ids", "/usr/share/usb.ids" };
+      static pci::IdsDatabase db( std::vector<std::string>( paths, paths + sizeof(paths)/sizeof(paths[0]) ) );
+      return db;
     }
 
     void enumUSBDevices( std::list<USBDevicePath> &paths ) {
@@ -146,47 +138,14 @@ namespace leanux {
       inf.idProduct = "";
       std::stringstream ss;
       ss << std::hex;
-      ss << std::setfill('0') << std::setw(4) << id.idVendor;
-      std::string hex_vendor = ss.str();
-      ss.str("");
       ss << std::setfill('0') << std::setw(4) << id.idProduct;
       std::string hex_product = ss.str();
       inf.idProduct = "unknown product id 0x" + hex_product;
 
-      std::ifstream f( USBDeviceDatabase.c_str() );
-      if ( !f.good() ) throw Oops( __FILE__, __LINE__, "error opening usb.ids" );
-
-      int state = 0;
-
-      bool giveup = false;
-      while ( f.good() && !f.eof() && !giveup && state != 2 ) {
-        std::string s = "";
-        getline( f, s );
-
-        if ( s[0] != '#' ) {
-
-          switch ( state ) {
-            case 0:
-              if ( strncmp( s.c_str(), hex_vendor.c_str(), 4 ) == 0 ) {
-                inf.idVendor = s.substr( 6 );
-                state = 1;
-              }
-              break;
-            case 1:
-              if ( s[0] != '\t' ) {
-                //we hit another vendor line, so device not found
-                giveup = true;
-              } else {
-                if ( strncmp( s.c_str()+1, hex_product.c_str(), 4 ) == 0 ) {
-                  inf.idProduct = s.substr(7);
-                  state = 2;
-                }
-              }
-              break;
-          }
-        }
-      }
-      return ( state >= 1 );
+      pci::IdsDatabase &db = getUSBDatabase();
+      if ( !db.getVendor( id.idVendor, inf.idVendor ) ) return false;
+      db.getDevice( id.idVendor, id.idProduct, inf.idProduct );
+      return true;
     }
 
     USBDevicePath getParent( const USBDevicePath &path ) {
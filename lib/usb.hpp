@@ -41,6 +41,7 @@
 #include <ostream>
 #include <iomanip>
 #include <oops.hpp>
+#include "pci.hpp"
 
 /**
  * \example example_usb.cpp
@@ -57,16 +58,9 @@ namespace leanux {
   namespace usb {
 
     /**
-     * initialize usb namespace.
+     * The system's USB device database (usb.ids), in pci.ids format.
      */
-    void init();
-
-    /**
-     * The location of the system's PCI device database.
-     * This varies among GNU/Linux distributions, set by
-     * and see pci::init().
-     */
-    extern std::string USBDeviceDatabase;
+    pci::IdsDatabase& getUSBDatabase();
 
     /**
      * Indentifies hardware (documented in usb.ids).
@@ -139,6 +133,8 @@ namespace leanux {
     /**
      * Translate an USBHardwareId into an USBHardwareInfo by using the
      * system (/usr/share) usb.ids database.
+     * @return true if the vendor is found.
+     * @see getUSBDatabase.
      */
     bool getUSBHardwareInfo( const USBHardwareId &id, USBHardwareInfo &inf );
 
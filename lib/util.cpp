@@ -47,6 +47,8 @@
 #include <pwd.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <ctype.h>
 
 #include <limits.h>
 #include <stdlib.h>
@@ -56,6 +58,8 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <vector>
 
 namespace leanux {
 
@@ -97,41 +101,238 @@ namespace leanux {
       }
     }
 
-    std::string fileReadString( const std::string &filename ) {
-      std::ifstream i( filename.c_str() );
-      std::string result = "";
-      if ( i.good() ) {
-        getline( i, result );
-      } else throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+    /**
+     * Read a file descriptor to end of file into the thread-local buffer, which grows as needed
+     * and is kept for the next read.
+     * @return the zero-terminated contents, empty if the descriptor cannot be read.
+     */
+    const char* readDescriptor( int fd, size_t *size ) {
+      static thread_local std::vector<char> buffer( 4096 );
+      size_t used = 0;
+      while ( true ) {
+        if ( buffer.size() - used < 2 ) buffer.resize( buffer.size() * 2 );
+        ssize_t r = ::read( fd, &buffer[used], buffer.size() - used - 1 );
+        if ( r < 0 && errno == EINTR ) continue;
+        if ( r <= 0 ) break;
+        used += r;
+      }
+      buffer[used] = 0;
+      if ( size ) *size = used;
+      return &buffer[0];
+    }
+
+    /**
+     * Skip the leading white space as operator>> would.
+     */
+    inline const char* skipSpace( const char *s ) {
+      while ( isspace( (unsigned char)*s ) ) s++;
+      return s;
+    }
+
+    PseudoFS::PseudoFS( const std::string &dir ) : dir_( dir ) {
+      fd_ = open( dir_.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC );
+    }
+
+    PseudoFS::~PseudoFS() {
+      if ( fd_ >= 0 ) close( fd_ );
+    }
+
+    void PseudoFS::reset( const std::string &dir ) {
+      if ( fd_ >= 0 ) close( fd_ );
+      dir_ = dir;
+      fd_ = open( dir_.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC );
+    }
+
+    const char* PseudoFS::read( const char *path, size_t *size ) const {
+      int fd = -1;
+      if ( fd_ >= 0 ) fd = openat( fd_, path, O_RDONLY | O_CLOEXEC );
+      else fd = open( ( dir_ + "/" + path ).c_str(), O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 ) return 0;
+      const char *result = readDescriptor( fd, size );
+      close( fd );
       return result;
     }
 
-    long fileReadHexString( const std::string &filename ) {
-      std::ifstream i( filename.c_str() );
-      long result = -1;
-      i >> std::hex;
-      if ( i.good() ) {
-        i >> result;
-      } else throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+    bool PseudoFS::readLine( const char *path, std::string &value ) const {
+      const char *s = read( path );
+      if ( !s ) return false;
+      value.assign( s, strcspn( s, "\n" ) );
+      return true;
+    }
+
+    bool PseudoFS::readUL( const char *path, unsigned long &value ) const {
+      const char *s = read( path );
+      if ( !s ) return false;
+      s = skipSpace( s );
+      char *end = 0;
+      unsigned long v = strtoul( s, &end, 10 );
+      if ( end == s ) return false;
+      value = v;
+      return true;
+    }
+
+    bool PseudoFS::readInt( const char *path, int &value ) const {
+      const char *s = read( path );
+      if ( !s ) return false;
+      s = skipSpace( s );
+      char *end = 0;
+      long v = strtol( s, &end, 10 );
+      if ( end == s ) return false;
+      value = (int)std::max( (long)INT_MIN, std::min( (long)INT_MAX, v ) );
+      return true;
+    }
+
+    bool PseudoFS::readHex( const char *path, long &value ) const {
+      const char *s = read( path );
+      if ( !s ) return false;
+      s = skipSpace( s );
+      char *end = 0;
+      long v = strtol( s, &end, 16 );
+      if ( end == s ) return false;
+      value = v;
+      return true;
+    }
+
+    /**
+     * The directory containing proc and sys, empty for the live trees. Function local, as
+     * the sysdevice roots are bound during static initialization.
+     */
+    std::string& pseudoFSRoot() {
+      static std::string root = "";
+      return root;
+    }
+
+    /** the PseudoFS of /proc. */
+    PseudoFS& procFS() {
+      static PseudoFS fs( pseudoFSRoot() + "/proc" );
+      return fs;
+    }
+
+    /** the PseudoFS of /sys. */
+    PseudoFS& sysFS() {
+      static PseudoFS fs( pseudoFSRoot() + "/sys" );
+      return fs;
+    }
+
+    /** the PseudoFS of /sys/class/block. */
+    PseudoFS& blockFS() {
+      static PseudoFS fs( pseudoFSRoot() + "/sys/class/block" );
+      return fs;
+    }
+
+    /** the PseudoFS of /sys/class/net. */
+    PseudoFS& netFS() {
+      static PseudoFS fs( pseudoFSRoot() + "/sys/class/net" );
+      return fs;
+    }
+
+    /** the PseudoFS of /sys/devices/system/cpu. */
+    PseudoFS& cpuFS() {
+      static PseudoFS fs( pseudoFSRoot() + "/sys/devices/system/cpu" );
+      return fs;
+    }
+
+    /** the path of /sys/devices. */
+    std::string& devicesDir() {
+      static std::string dir = pseudoFSRoot() + "/sys/devices";
+      return dir;
+    }
+
+    /** the path of /sys/bus. */
+    std::string& busDir() {
+      static std::string dir = pseudoFSRoot() + "/sys/bus";
+      return dir;
+    }
+
+    void setPseudoFSRoot( const std::string &root ) {
+      pseudoFSRoot() = root;
+      procFS().reset( root + "/proc" );
+      sysFS().reset( root + "/sys" );
+      blockFS().reset( root + "/sys/class/block" );
+      netFS().reset( root + "/sys/class/net" );
+      cpuFS().reset( root + "/sys/devices/system/cpu" );
+      devicesDir() = root + "/sys/devices";
+      busDir() = root + "/sys/bus";
+    }
+
+    const std::string& getPseudoFSRoot() {
+      return pseudoFSRoot();
+    }
+
+    const char* PseudoFS::readAbsolute( const std::string &filename, size_t *size ) {
+      // most specific first
+      const PseudoFS* fss[] = { &blockFS(), &netFS(), &cpuFS(), &sysFS(), &procFS() };
+      for ( size_t p = 0; p < sizeof(fss) / sizeof(PseudoFS*); p++ ) {
+        const std::string &dir = fss[p]->getDir();
+        if ( filename.length() > dir.length() + 1 &&
+             filename[dir.length()] == '/' &&
+             filename.compare( 0, dir.length(), dir ) == 0 ) {
+          return fss[p]->read( filename.c_str() + dir.length() + 1, size );
+        }
+      }
+      int fd = open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+      if ( fd < 0 ) return 0;
+      const char *result = readDescriptor( fd, size );
+      close( fd );
       return result;
     }
 
+    const PseudoFS& ProcFS::proc() {
+      return procFS();
+    }
+
+    const PseudoFS& SysFS::sys() {
+      return sysFS();
+    }
+
+    const PseudoFS& SysFS::block() {
+      return blockFS();
+    }
+
+    const PseudoFS& SysFS::net() {
+      return netFS();
+    }
+
+    const PseudoFS& SysFS::cpu() {
+      return cpuFS();
+    }
+
+    const std::string& SysFS::devices() {
+      return devicesDir();
+    }
+
+    const std::string& SysFS::bus() {
+      return busDir();
+    }
+
+    std::string fileReadString( const std::string &filename ) {
+      const char *s = PseudoFS::readAbsolute( filename );
+      if ( !s ) throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+      return std::string( s, strcspn( s, "\n" ) );
+    }
+
+    long fileReadHexString( const std::string &filename ) {
+      const char *s = PseudoFS::readAbsolute( filename );
+      if ( !s ) throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+      s = skipSpace( s );
+      if ( !*s ) return -1;
+      return strtol( s, 0, 16 );
+    }
+
     int fileReadInt( const std::string &filename ) {
-      std::ifstream i( filename.c_str() );
-      int result = -1;
-      if ( i.good() ) {
-        i >> result;
-      } else throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
-      return result;
+      const char *s = PseudoFS::readAbsolute( filename );
+      if ( !s ) throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+      s = skipSpace( s );
+      if ( !*s ) return -1;
+      return (int)std::max( (long)INT_MIN, std::min( (long)INT_MAX, strtol( s, 0, 10 ) ) );
     }
 
     unsigned long fileReadUL( const std::string &filename ) {
-      std::ifstream i( filename.c_str() );
-      unsigned long result = 0;
-      if ( i.good() ) {
-        i >> result;
-      } else throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
-      return result;
+      const char *s = PseudoFS::readAbsolute( filename );
+      if ( !s ) throw Oops( __FILE__, __LINE__, "failed to open '" + filename + "'" );
+      s = skipSpace( s );
+      if ( !*s ) return 0;
+      return strtoul( s, 0, 10 );
     }
 
     void Sleep( time_t seconds, long nanoseconds ) {
@@ -119,6 +119,161 @@ namespace leanux {
      */
     unsigned long fileReadUL( const std::string &filename );
 
+    /**
+     * Reads the small pseudo files of procfs and sysfs below a directory. The directory is opened
+     * once with O_PATH and kept, files are opened relative to it with openat and read into a
+     * thread-local buffer that is reused between reads, and the typed helpers parse from that
+     * buffer without allocating. Use the instances of ProcFS and SysFS.
+     */
+    class PseudoFS {
+      public:
+        /**
+         * Open the directory.
+         * @param dir the absolute path of the directory.
+         */
+        PseudoFS( const std::string &dir );
+
+        /** Close the directory. */
+        ~PseudoFS();
+
+        /**
+         * Close the directory and open another.
+         * @param dir the absolute path of the directory.
+         */
+        void reset( const std::string &dir );
+
+        /**
+         * Get the directory.
+         * @return the absolute path of the directory.
+         */
+        const std::string& getDir() const { return dir_; };
+
+        /**
+         * Read a file into the thread-local buffer. The contents are valid until the next read
+         * by the same thread.
+         * @param path the file path relative to the directory.
+         * @param size if not null, receives the number of bytes read.
+         * @return the zero-terminated contents, or 0 if the file cannot be opened.
+         */
+        const char* read( const char *path, size_t *size = 0 ) const;
+
+        /**
+         * Read the first line of a file.
+         * @param path the file path relative to the directory.
+         * @param value receives the first line without the newline.
+         * @return false if the file cannot be opened.
+         */
+        bool readLine( const char *path, std::string &value ) const;
+
+        /**
+         * Read an unsigned long from a file.
+         * @param path the file path relative to the directory.
+         * @param value receives the value.
+         * @return false if the file cannot be opened or holds no number.
+         */
+        bool readUL( const char *path, unsigned long &value ) const;
+
+        /**
+         * Read a signed int from a file.
+         * @param path the file path relative to the directory.
+         * @param value receives the value.
+         * @return false if the file cannot be opened or holds no number.
+         */
+        bool readInt( const char *path, int &value ) const;
+
+        /**
+         * Read a hexadecimal signed long from a file, such as 0x1c.
+         * @param path the file path relative to the directory.
+         * @param value receives the value.
+         * @return false if the file cannot be opened or holds no number.
+         */
+        bool readHex( const char *path, long &value ) const;
+
+        /**
+         * Read a file by absolute path, relative to the ProcFS or SysFS directory the path is
+         * in, or by the path itself if it is in none.
+         * @param filename the absolute path.
+         * @param size if not null, receives the number of bytes read.
+         * @return the zero-terminated contents, or 0 if the file cannot be opened.
+         */
+        static const char* readAbsolute( const std::string &filename, size_t *size = 0 );
+
+      private:
+        PseudoFS( const PseudoFS& );
+        PseudoFS& operator=( const PseudoFS& );
+
+        /** the absolute path of the directory. */
+        std::string dir_;
+
+        /** the O_PATH descriptor of the directory, -1 if it could not be opened. */
+        int fd_;
+    };
+
+    /**
+     * The PseudoFS of /proc.
+     */
+    class ProcFS {
+      public:
+        /**
+         * Get the PseudoFS of /proc.
+         */
+        static const PseudoFS& proc();
+
+        /**
+         * Get the absolute path of a file or directory below /proc.
+         * @param path the path relative to /proc, such as "net/dev".
+         * @return the path below the current root, see setPseudoFSRoot.
+         */
+        static std::string path( const std::string &path ) { return proc().getDir() + "/" + path; };
+    };
+
+    /**
+     * The PseudoFS instances of the sysfs directories leanux reads from.
+     */
+    class SysFS {
+      public:
+        /** Get the PseudoFS of /sys. */
+        static const PseudoFS& sys();
+
+        /** Get the PseudoFS of /sys/class/block. */
+        static const PseudoFS& block();
+
+        /** Get the PseudoFS of /sys/class/net. */
+        static const PseudoFS& net();
+
+        /** Get the PseudoFS of /sys/devices/system/cpu. */
+        static const PseudoFS& cpu();
+
+        /** Get the absolute path of /sys/devices. */
+        static const std::string& devices();
+
+        /** Get the absolute path of /sys/bus. */
+        static const std::string& bus();
+
+        /**
+         * Get the absolute path of a file or directory below /sys.
+         * @param path the path relative to /sys, such as "class/block".
+         * @return the path below the current root, see setPseudoFSRoot.
+         */
+        static std::string path( const std::string &path ) { return sys().getDir() + "/" + path; };
+    };
+
+    /**
+     * Set the directory the procfs and sysfs trees are read from, so that the collectors can
+     * run against a copy or a synthetic tree. The root /tmp/tree reads /tmp/tree/proc and
+     * /tmp/tree/sys, the empty root (the default) reads the live /proc and /sys. All ProcFS
+     * and SysFS directories, and with them sysdevice::sysdevice_root, follow the root. The change
+     * is not thread safe, set the root before sampling.
+     * @param root the directory containing proc and sys, without trailing '/'.
+     */
+    void setPseudoFSRoot( const std::string &root );
+
+    /**
+     * Get the directory the procfs and sysfs trees are read from.
+     * @return the root, empty for the live /proc and /sys.
+     */
+    const std::string& getPseudoFSRoot();
+
     /**
      * Test if the path is an existing directory.
      * @param path the directory to test for existence.
@@ -51,7 +51,7 @@ namespace leanux {
 
     void getVMStat( VMStat &stat ) {
       {
-        std::ifstream procvmstat( "/proc/vmstat" );
+        std::ifstream procvmstat( util::ProcFS::path( "vmstat" ).c_str() );
         stat.nr_free_pages = 0;
         stat.nr_inactive_anon = 0;
         stat.nr_inactive_file = 0;
@@ -120,7 +120,7 @@ namespace leanux {
         }
       }
       {
-        std::ifstream procmeminfo( "/proc/meminfo" );
+        std::ifstream procmeminfo( util::ProcFS::path( "meminfo" ).c_str() );
         stat.mem_total = 0;
         stat.committed_as = 0;
         while ( procmeminfo.good() ) {
@@ -142,7 +142,7 @@ namespace leanux {
 
     void getSwapInfo( std::list<SwapInfo> &swaps ) {
       swaps.clear();
-      std::ifstream fs( "/proc/swaps" );
+      std::ifstream fs( util::ProcFS::path( "swaps" ).c_str() );
       std::string s;
       getline( fs, s );
       SwapInfo inf;
@@ -159,19 +159,19 @@ namespace leanux {
     }
 
     ssize_t getDirtyBytes() {
-      return util::fileReadUL( "/proc/sys/vm/dirty_bytes" );
+      return util::fileReadUL( util::ProcFS::path( "sys/vm/dirty_bytes" ) );
     }
 
     ssize_t getDirtyRatio() {
-      return util::fileReadUL( "/proc/sys/vm/dirty_ratio" );
+      return util::fileReadUL( util::ProcFS::path( "sys/vm/dirty_ratio" ) );
     }
 
     ssize_t getDirtyBackgroundBytes() {
-      return util::fileReadUL( "/proc/sys/vm/dirty_background_bytes" );
+      return util::fileReadUL( util::ProcFS::path( "sys/vm/dirty_background_bytes" ) );
     }
 
     ssize_t getDirtyBackgroundRatio() {
-      return util::fileReadUL( "/proc/sys/vm/dirty_background_ratio" );
+      return util::fileReadUL( util::ProcFS::path( "sys/vm/dirty_background_ratio" ) );
     }
 
     double getDirtyPressure( ssize_t ram, ssize_t dirtied ) {
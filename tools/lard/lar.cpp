@@ -212,21 +212,29 @@ namespace leanux {
         IOSnap iosnap;
         SchedSnap schedsnap;
         NetSnap netsnap;
+        ProtoSnap protosnap;
+        SoftNetSnap softnetsnap;
         VMSnap vmsnap;
         ProcSnap procsnap;
         ResSnap ressnap;
         MountSnap mountsnap;
+        NFSSnap nfssnap;
         TCPEstaSnap tcpestasnap;
+        ProcNetSnap procnetsnap;
         timesnap.startSnap();
         cpusnap.startSnap();
         iosnap.startSnap();
         schedsnap.startSnap();
         netsnap.startSnap();
+        protosnap.startSnap();
+        softnetsnap.startSnap();
         vmsnap.startSnap();
         procsnap.startSnap();
         ressnap.startSnap();
         mountsnap.startSnap();
+        nfssnap.startSnap();
         tcpestasnap.startSnap();
+        procnetsnap.startSnap();
 
         while ( !stopped ) {
 
@@ -268,6 +276,14 @@ namespace leanux {
             netsnap.storeSnap( db, snapid, timesnap_seconds );
             netsnap.startSnap();
 
+            protosnap.stopSnap();
+            protosnap.storeSnap( db, snapid, timesnap_seconds );
+            protosnap.startSnap();
+
+            softnetsnap.stopSnap();
+            softnetsnap.storeSnap( db, snapid, timesnap_seconds );
+            softnetsnap.startSnap();
+
             vmsnap.stopSnap();
             vmsnap.storeSnap( db, snapid, timesnap_seconds );
             vmsnap.startSnap();
@@ -280,10 +296,18 @@ namespace leanux {
             mountsnap.storeSnap( db, snapid, timesnap_seconds );
             mountsnap.startSnap();
 
+            nfssnap.stopSnap();
+            nfssnap.storeSnap( db, snapid, timesnap_seconds );
+            nfssnap.startSnap();
+
             tcpestasnap.stopSnap();
             tcpestasnap.storeSnap( db, snapid, timesnap_seconds );
             tcpestasnap.startSnap();
 
+            procnetsnap.stopSnap();
+            procnetsnap.storeSnap( db, snapid, timesnap_seconds );
+            procnetsnap.startSnap();
+
             procsnap.stopSnap();
             procsnap.storeSnap( db, snapid, timesnap_seconds );
             procsnap.startSnap();
@@ -376,13 +400,17 @@ namespace leanux {
             util::ConfigFile::declareParameter( "MAX_DISKS", LARD_CONF_MAX_DISKS_DEFAULT, LARD_CONF_MAX_DISKS_DESCR, LARD_CONF_MAX_DISKS_COMMENT );
             util::ConfigFile::declareParameter( "MAX_MOUNTS", LARD_CONF_MAX_MOUNTS_DEFAULT, LARD_CONF_MAX_MOUNTS_DESCR, LARD_CONF_MAX_MOUNTS_COMMENT );
             util::ConfigFile::declareParameter( "MAX_PROCESSES", LARD_CONF_MAX_PROCESSES_DEFAULT, LARD_CONF_MAX_PROCESSES_DESCR, LARD_CONF_MAX_PROCESSES_COMMENT );
+            util::ConfigFile::declareParameter( "NET_DEVICE_EXCLUDE", LARD_CONF_NET_DEVICE_EXCLUDE_DEFAULT, LARD_CONF_NET_DEVICE_EXCLUDE_DESCR, LARD_CONF_NET_DEVICE_EXCLUDE_COMMENT );
             util::ConfigFile::declareParameter( "RETAIN_DAYS", LARD_CONF_RETAIN_DAYS_DEFAULT, LARD_CONF_RETAIN_DAYS_DESCR, LARD_CONF_RETAIN_DAYS_COMMENT );
             util::ConfigFile::declareParameter( "MAX_DB_SIZE", LARD_CONF_MAX_DB_SIZE_DEFAULT, LARD_CONF_MAX_DB_SIZE_DESCR, LARD_CONF_MAX_DB_SIZE_COMMENT );
             util::ConfigFile::declareParameter( "SNAPSHOT_CHECKPOINT", LARD_CONF_SNAPSHOT_CHECKPOINT_DEFAULT, LARD_CONF_SNAPSHOT_CHECKPOINT_DESCR, LARD_CONF_SNAPSHOT_CHECKPOINT_COMMENT );
             util::ConfigFile::declareParameter( "SNAPSHOT_INTERVAL", LARD_CONF_SNAPSHOT_INTERVAL_DEFAULT, LARD_CONF_SNAPSHOT_INTERVAL_DESCR, LARD_CONF_SNAPSHOT_INTERVAL_COMMENT );
             util::ConfigFile::declareParameter( "MAINTENANCE_INTERVAL", LARD_CONF_MAINTENANCE_INTERVAL_DEFAULT, LARD_CONF_MAINTENANCE_INTERVAL_DESCR, LARD_CONF_MAINTENANCE_INTERVAL_COMMENT );
+            util::ConfigFile::declareParameter( "INFLIGHT_SAMPLE_HZ", LARD_CONF_INFLIGHT_SAMPLE_HZ_DEFAULT, LARD_CONF_INFLIGHT_SAMPLE_HZ_DESCR, LARD_CONF_INFLIGHT_SAMPLE_HZ_COMMENT );
             util::ConfigFile::declareParameter( "LOG_LEVEL", LARD_CONF_LOG_LEVEL_DEFAULT, LARD_CONF_LOG_LEVEL_DESCR, LARD_CONF_LOG_LEVEL_COMMENT );
             util::ConfigFile::declareParameter( "SQLITE_SOFT_HEAPLIMIT", LARD_CONF_SQLITE_SOFT_HEAPLIMIT_DEFAULT, LARD_CONF_SQLITE_SOFT_HEAPLIMIT_DESCR, LARD_CONF_SQLITE_SOFT_HEAPLIMIT_COMMENT );
+            util::ConfigFile::declareParameter( "TCP_INFO_TOP", LARD_CONF_TCP_INFO_TOP_DEFAULT, LARD_CONF_TCP_INFO_TOP_DESCR, LARD_CONF_TCP_INFO_TOP_COMMENT );
+            util::ConfigFile::declareParameter( "PROCESS_NET_TOP", LARD_CONF_PROCESS_NET_TOP_DEFAULT, LARD_CONF_PROCESS_NET_TOP_DESCR, LARD_CONF_PROCESS_NET_TOP_COMMENT );
             util::ConfigFile::declareParameter( "COMMAND_ARGS_IGNORE", LARD_CONF_COMMAND_ARGS_IGNORE_DEFAULT, LARD_CONF_COMMAND_ARGS_IGNORE_DESCR, LARD_CONF_COMMAND_ARGS_IGNORE_COMMENT );
             util::ConfigFile::setConfig( "lard", options.config );
             util::ConfigFile::getConfig()->write();
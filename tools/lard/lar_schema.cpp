@@ -49,7 +49,7 @@ namespace leanux {
   namespace tools {
     namespace lard {
 
-      int schema_version = 1977;
+      int schema_version = 1986;
 
       void createTableStatus( persist::Database &db ) {
         persist::DDL ddl( db );
@@ -202,6 +202,18 @@ namespace leanux {
                      "  iodones  REAL NOT NULL,    -- SCSI errors per second\n"
                      "  ioreqs   REAL NOT NULL,    -- SCSI errors per second\n"
                      "  ioerrs   REAL NOT NULL,    -- SCSI errors per second\n"
+                     "  wback    REAL NOT NULL DEFAULT 0, -- bytes under writeback at snapshot end\n"
+                     "  reclaim  REAL NOT NULL DEFAULT 0, -- dirty bytes not yet under writeback at snapshot end\n"
+                     "  dthresh  REAL NOT NULL DEFAULT 0, -- dirty bytes threshold of the disk at snapshot end, writers are throttled beyond\n"
+                     "  dirtieds REAL NOT NULL DEFAULT 0, -- average bytes dirtied per second\n"
+                     "  writtens REAL NOT NULL DEFAULT 0, -- average bytes written back per second\n"
+                     "  ds       REAL NOT NULL DEFAULT 0, -- average discards per second\n"
+                     "  dbs      REAL NOT NULL DEFAULT 0, -- average discarded bytes per second\n"
+                     "  adtm     REAL NOT NULL DEFAULT 0, -- average discard time in seconds\n"
+                     "  fls      REAL NOT NULL DEFAULT 0, -- average flushes per second\n"
+                     "  afltm    REAL NOT NULL DEFAULT 0, -- average flush time in seconds\n"
+                     "  rinfl    REAL NOT NULL DEFAULT 0, -- reads in flight at snapshot end\n"
+                     "  winfl    REAL NOT NULL DEFAULT 0, -- writes in flight at snapshot end\n"
                      "  PRIMARY KEY (snapshot,disk),\n"
                      "  FOREIGN KEY (disk) REFERENCES disk(id),\n"
                      "  FOREIGN KEY (snapshot) REFERENCES snapshot(id)\n"
@@ -270,6 +282,79 @@ namespace leanux {
         ddl.execute();
       }
 
+      void createTableSoftnetstat( persist::Database &db ) {
+        persist::DDL ddl( db );
+        ddl.prepare( "CREATE TABLE IF NOT EXISTS softnetstat (\n"
+                     "  snapshot  INTEGER NOT NULL, -- snapshot id\n"
+                     "  cpu       INTEGER NOT NULL, -- logical cpu\n"
+                     "  processed REAL NOT NULL, -- packets processed per second\n"
+                     "  dropped   REAL NOT NULL, -- packets dropped on a full backlog per second\n"
+                     "  squeeze   REAL NOT NULL, -- softirq out of budget or time with work left per second\n"
+                     "  rps       REAL NOT NULL, -- RPS wakeups per second\n"
+                     "  flowlimit REAL NOT NULL, -- packets dropped by the flow limit per second\n"
+                     "  PRIMARY KEY (snapshot,cpu),\n"
+                     "  FOREIGN KEY (snapshot) REFERENCES snapshot(id)\n"
+                     ")" );
+        ddl.execute();
+      }
+
+      void createTableNicqueuestat( persist::Database &db ) {
+        persist::DDL ddl( db );
+        ddl.prepare( "CREATE TABLE IF NOT EXISTS nicqueuestat (\n"
+                     "  snapshot  INTEGER NOT NULL, -- snapshot id\n"
+                     "  nic       INTEGER NOT NULL, -- nic id\n"
+                     "  queue     INTEGER NOT NULL, -- transmit queue number\n"
+                     "  txtimeout REAL NOT NULL, -- transmit timeouts per second\n"
+                     "  stalls    REAL NOT NULL, -- BQL detected stalls per second\n"
+                     "  inflight  INTEGER NOT NULL, -- bytes queued to the hardware at snapshot end\n"
+                     "  bqllimit  INTEGER NOT NULL, -- BQL limit in bytes at snapshot end\n"
+                     "  PRIMARY KEY (snapshot,nic,queue),\n"
+                     "  FOREIGN KEY (nic) REFERENCES nic(id),\n"
+                     "  FOREIGN KEY (snapshot) REFERENCES snapshot(id)\n"
+                     ")" );
+        ddl.execute();
+      }
+
+      void createTableProtostat( persist::Database &db ) {
+        persist::DDL ddl( db );
+        ddl.prepare( "CREATE TABLE IF NOT EXISTS protostat (\n"
+                     "  snapshot       INTEGER PRIMARY KEY NOT NULL, -- snapshot id\n"
+                     "  ipinrecv       REAL NOT NULL, -- IP datagrams received per second, IPv4 and IPv6\n"
+                     "  ipindeliv      REAL NOT NULL, -- IP datagrams delivered to upper layer protocols per second\n"
+                     "  ipoutreq       REAL NOT NULL, -- IP datagrams sent per second\n"
+                     "  ipindisc       REAL NOT NULL, -- received IP datagrams discarded for lack of resources per second\n"
+                     "  ipoutdisc      REAL NOT NULL, -- outgoing IP datagrams discarded for lack of resources per second\n"
+                     "  ipnoroute      REAL NOT NULL, -- outgoing IP datagrams discarded for lack of a route per second\n"
+                     "  ipreasmfail    REAL NOT NULL, -- IP reassembly failures per second\n"
+                     "  tcpactopen     REAL NOT NULL, -- outgoing TCP connection attempts per second\n"
+                     "  tcppasopen     REAL NOT NULL, -- incoming TCP connections per second\n"
+                     "  tcpattfail     REAL NOT NULL, -- failed TCP connection attempts per second\n"
+                     "  tcpestrst      REAL NOT NULL, -- resets of established TCP connections per second\n"
+                     "  tcpinsegs      REAL NOT NULL, -- TCP segments received per second\n"
+                     "  tcpoutsegs     REAL NOT NULL, -- TCP segments sent per second\n"
+                     "  tcpretrans     REAL NOT NULL, -- TCP segments retransmitted per second\n"
+                     "  tcpinerrs      REAL NOT NULL, -- TCP segments received in error per second\n"
+                     "  tcpoutrsts     REAL NOT NULL, -- TCP resets sent per second\n"
+                     "  tcplstovf      REAL NOT NULL, -- listen queue overflows per second\n"
+                     "  tcplstdrop     REAL NOT NULL, -- SYNs dropped on listening sockets per second\n"
+                     "  tcpreqqdrop    REAL NOT NULL, -- SYNs dropped on a full SYN queue per second\n"
+                     "  tcpsynretr     REAL NOT NULL, -- SYN and SYN/ACK retransmits per second\n"
+                     "  tcptimeout     REAL NOT NULL, -- TCP retransmission timeouts per second\n"
+                     "  tcpmempress    REAL NOT NULL, -- times TCP entered memory pressure per second\n"
+                     "  tcpmemabort    REAL NOT NULL, -- TCP connections aborted for lack of memory per second\n"
+                     "  tcpprune       REAL NOT NULL, -- TCP receive queue prunes per second\n"
+                     "  tcpbacklogdrop REAL NOT NULL, -- TCP segments dropped on a full socket backlog per second\n"
+                     "  udpindgrams    REAL NOT NULL, -- UDP datagrams received per second, IPv4 and IPv6\n"
+                     "  udpoutdgrams   REAL NOT NULL, -- UDP datagrams sent per second\n"
+                     "  udpnoports     REAL NOT NULL, -- UDP datagrams received for a port without listener per second\n"
+                     "  udpinerrs      REAL NOT NULL, -- UDP datagrams received in error per second\n"
+                     "  udprcvbuferrs  REAL NOT NULL, -- UDP datagrams dropped on a full receive buffer per second\n"
+                     "  udpsndbuferrs  REAL NOT NULL, -- UDP datagrams dropped on a full send buffer per second\n"
+                     "  FOREIGN KEY (snapshot) REFERENCES snapshot(id)\n"
+                     ")" );
+        ddl.execute();
+      }
+
       void createTableVmstat( persist::Database &db ) {
         persist::DDL ddl( db );
         ddl.prepare( "CREATE TABLE IF NOT EXISTS vmstat (\n"
@@ -420,6 +505,7 @@ namespace leanux {
                      "  awtm     REAL NOT NULL,      -- average write duration in seconds, includes queue time\n"
                      "  growth   REAL NOT NULL,      -- increase/decrease of the mountpoint (filesystem) in bytes in this snapshot\n"
                      "  used     REAL NOT NULL,      -- size of the mountpoint (filesystem) in bytes\n"
+                     "  stale    INTEGER NOT NULL DEFAULT 0, -- 1 if the filesystem did not answer in time and used is the last known value\n"
                      "  PRIMARY KEY (snapshot,mountpoint),\n"
                      "  FOREIGN KEY (snapshot)  REFERENCES snapshot(id),\n"
                      "  FOREIGN KEY (mountpoint)  REFERENCES mountpoint(id)\n"
@@ -430,6 +516,65 @@ namespace leanux {
         ddl.execute();
       }
 
+      void createTableIohisto( persist::Database &db ) {
+        persist::DDL ddl( db );
+        ddl.prepare( "CREATE TABLE IF NOT EXISTS iohisto (\n"
+                     "  snapshot INTEGER NOT NULL, -- snapshot id\n"
+                     "  disk     INTEGER NOT NULL, -- disk id\n"
+                     "  samples  INTEGER NOT NULL, -- number of requests in flight samples\n"
+                     "  q0       INTEGER NOT NULL, -- samples with 0 requests in flight\n"
+                     "  q1       INTEGER NOT NULL, -- samples with 1 request in flight\n"
+                     "  q2       INTEGER NOT NULL, -- samples with 2 requests in flight\n"
+                     "  q3       INTEGER NOT NULL, -- samples with 3-4 requests in flight\n"
+                     "  q4       INTEGER NOT NULL, -- samples with 5-8 requests in flight\n"
+                     "  q5       INTEGER NOT NULL, -- samples with 9-16 requests in flight\n"
+                     "  q6       INTEGER NOT NULL, -- samples with 17-32 requests in flight\n"
+                     "  q7       INTEGER NOT NULL, -- samples with more than 32 requests in flight\n"
+                     "  u0       INTEGER NOT NULL, -- seconds with utilization below 10%\n"
+                     "  u1       INTEGER NOT NULL, -- seconds with utilization 10-20%\n"
+                     "  u2       INTEGER NOT NULL, -- seconds with utilization 20-30%\n"
+                     "  u3       INTEGER NOT NULL, -- seconds with utilization 30-40%\n"
+                     "  u4       INTEGER NOT NULL, -- seconds with utilization 40-50%\n"
+                     "  u5       INTEGER NOT NULL, -- seconds with utilization 50-60%\n"
+                     "  u6       INTEGER NOT NULL, -- seconds with utilization 60-70%\n"
+                     "  u7       INTEGER NOT NULL, -- seconds with utilization 70-80%\n"
+                     "  u8       INTEGER NOT NULL, -- seconds with utilization 80-90%\n"
+                     "  u9       INTEGER NOT NULL, -- seconds with utilization 90-100%\n"
+                     "  PRIMARY KEY (snapshot,disk),\n"
+                     "  FOREIGN KEY (disk) REFERENCES disk(id),\n"
+                     "  FOREIGN KEY (snapshot) REFERENCES snapshot(id)\n"
+                     ")" );
+        ddl.execute();
+
+        ddl.reset();
+        ddl.prepare( "CREATE INDEX IF NOT EXISTS i_iohisto_disk ON iohisto( disk )" );
+        ddl.execute();
+      }
+
+      void createTableNfsopstat( persist::Database &db ) {
+        persist::DDL ddl( db );
+        ddl.prepare( "CREATE TABLE IF NOT EXISTS nfsopstat (\n"
+                     "  snapshot INTEGER NOT NULL,   -- snapshot id\n"
+                     "  mountpoint INTEGER NOT NULL, -- mountpoint id of the NFS mount\n"
+                     "  op       TEXT NOT NULL,      -- NFS operation (READ, WRITE, GETATTR, ...)\n"
+                     "  ops      REAL NOT NULL,      -- average operations per second\n"
+                     "  retrans  REAL NOT NULL,      -- average retransmissions per second\n"
+                     "  timeouts REAL NOT NULL,      -- average major timeouts per second\n"
+                     "  sbs      REAL NOT NULL,      -- average bytes sent per second, includes RPC headers\n"
+                     "  rbs      REAL NOT NULL,      -- average bytes received per second, includes RPC headers\n"
+                     "  qtm      REAL NOT NULL,      -- average queue time in seconds per operation\n"
+                     "  rtt      REAL NOT NULL,      -- average round trip time in seconds per operation\n"
+                     "  exe      REAL NOT NULL,      -- average execution time in seconds per operation, includes queue time and rtt\n"
+                     "  PRIMARY KEY (snapshot,mountpoint,op),\n"
+                     "  FOREIGN KEY (snapshot)  REFERENCES snapshot(id),\n"
+                     "  FOREIGN KEY (mountpoint)  REFERENCES mountpoint(id)\n"
+                     ")" );
+        ddl.execute();
+        ddl.reset();
+        ddl.prepare( "CREATE INDEX IF NOT EXISTS i_nfsopstat_mountpoint ON nfsopstat( mountpoint )" );
+        ddl.execute();
+      }
+
       void createTableTcpkey( persist::Database &db ) {
         persist::DDL ddl( db );
         ddl.prepare( "CREATE TABLE IF NOT EXISTS tcpkey (\n"
@@ -449,6 +594,16 @@ namespace leanux {
                      "  snapshot INTEGER NOT NULL, -- snapshot id\n"
                      "  tcpkey   INTEGER NOT NULL, -- tcpkey id\n"
                      "  esta     INTEGER NOT NULL, -- number of established connections at snapshot end\n"
+                     "  infoconns INTEGER NOT NULL DEFAULT 0, -- number of busiest connections sampled for TCP_INFO\n"
+                     "  rttp50   REAL NOT NULL DEFAULT 0, -- median smoothed round trip time in seconds\n"
+                     "  rttp95   REAL NOT NULL DEFAULT 0, -- 95th percentile smoothed round trip time in seconds\n"
+                     "  rttvarp50 REAL NOT NULL DEFAULT 0, -- median round trip time variation in seconds\n"
+                     "  cwndp50  REAL NOT NULL DEFAULT 0, -- median congestion window in segments\n"
+                     "  dlvratep50 REAL NOT NULL DEFAULT 0, -- median delivery rate in bytes/s\n"
+                     "  retrans  REAL NOT NULL DEFAULT 0, -- segments retransmitted/s\n"
+                     "  busy     REAL NOT NULL DEFAULT 0, -- seconds/s busy sending\n"
+                     "  rwndlim  REAL NOT NULL DEFAULT 0, -- seconds/s sending limited by the receive window\n"
+                     "  sndbuflim REAL NOT NULL DEFAULT 0, -- seconds/s sending limited by the send buffer\n"
                      "  PRIMARY KEY (snapshot,tcpkey),\n"
                      "  FOREIGN KEY (snapshot)  REFERENCES snapshot(id),\n"
                      "  FOREIGN KEY (tcpkey)  REFERENCES tcpkey(id)\n"
@@ -462,6 +617,16 @@ namespace leanux {
                      "  snapshot INTEGER NOT NULL, -- snapshot id\n"
                      "  tcpkey   INTEGER NOT NULL, -- tcpkey id\n"
                      "  esta     INTEGER NOT NULL, -- number of established connections at snapshot end\n"
+                     "  infoconns INTEGER NOT NULL DEFAULT 0, -- number of busiest connections sampled for TCP_INFO\n"
+                     "  rttp50   REAL NOT NULL DEFAULT 0, -- median smoothed round trip time in seconds\n"
+                     "  rttp95   REAL NOT NULL DEFAULT 0, -- 95th percentile smoothed round trip time in seconds\n"
+                     "  rttvarp50 REAL NOT NULL DEFAULT 0, -- median round trip time variation in seconds\n"
+                     "  cwndp50  REAL NOT NULL DEFAULT 0, -- median congestion window in segments\n"
+                     "  dlvratep50 REAL NOT NULL DEFAULT 0, -- median delivery rate in bytes/s\n"
+                     "  retrans  REAL NOT NULL DEFAULT 0, -- segments retransmitted/s\n"
+                     "  busy     REAL NOT NULL DEFAULT 0, -- seconds/s busy sending\n"
+                     "  rwndlim  REAL NOT NULL DEFAULT 0, -- seconds/s sending limited by the receive window\n"
+                     "  sndbuflim REAL NOT NULL DEFAULT 0, -- seconds/s sending limited by the send buffer\n"
                      "  PRIMARY KEY (snapshot,tcpkey),\n"
                      "  FOREIGN KEY (snapshot)  REFERENCES snapshot(id),\n"
                      "  FOREIGN KEY (tcpkey)  REFERENCES tcpkey(id)\n"
@@ -469,6 +634,23 @@ namespace leanux {
         ddl.execute();
       }
 
+      void createTableProcnetstat( persist::Database &db ) {
+        persist::DDL ddl( db );
+        ddl.prepare( "CREATE TABLE IF NOT EXISTS procnetstat (\n"
+                     "  snapshot INTEGER NOT NULL, -- snapshot id\n"
+                     "  pid      INTEGER NOT NULL, -- process id\n"
+                     "  uid      INTEGER NOT NULL, -- process uid\n"
+                     "  cmd      INTEGER NOT NULL, -- command id\n"
+                     "  conns    INTEGER NOT NULL, -- number of TCP connections that moved data\n"
+                     "  sendbs   REAL NOT NULL,    -- TCP bytes/s sent and acknowledged\n"
+                     "  recvbs   REAL NOT NULL,    -- TCP bytes/s received\n"
+                     "  PRIMARY KEY (snapshot,pid),\n"
+                     "  FOREIGN KEY (snapshot)  REFERENCES snapshot(id),\n"
+                     "  FOREIGN KEY (cmd)  REFERENCES cmd(id)\n"
+                     ")" );
+        ddl.execute();
+      }
+
       void createSchema( persist::Database &db ) {
         createTableStatus( db );
         createTableSnapshot( db );
@@ -476,8 +658,12 @@ namespace leanux {
         createTableSchedstat( db );
         createTableDisk( db );
         createTableIostat( db );
+        createTableIohisto( db );
         createTableNic( db );
         createTableNetstat( db );
+        createTableProtostat( db );
+        createTableSoftnetstat( db );
+        createTableNicqueuestat( db );
         createTableVmstat( db );
         createTableCmd( db );
         createTableWchan( db );
@@ -485,9 +671,11 @@ namespace leanux {
         createTableResstat( db );
         createTableMountpoint( db );
         createTableMountstat( db );
+        createTableNfsopstat( db );
         createTableTcpkey( db );
         createTableTcpserverstat( db );
         createTableTcpclientstat( db );
+        createTableProcnetstat( db );
       }
 
       void deleteSnapshots( persist::Database &db, long snapid ) {
@@ -507,10 +695,27 @@ namespace leanux {
         dml.execute();
         dml.reset();
 
+        dml.prepare( "delete from iohisto where snapshot<=:snapid" );
+        dml.bind( 1, snapid );
+        dml.execute();
+        dml.reset();
+
         dml.prepare( "delete from netstat where snapshot<=:snapid" );
         dml.bind( 1, snapid );
         dml.execute();
         dml.reset();
+        dml.prepare( "delete from protostat where snapshot<=:snapid" );
+        dml.bind( 1, snapid );
+        dml.execute();
+        dml.reset();
+        dml.prepare( "delete from softnetstat where snapshot<=:snapid" );
+        dml.bind( 1, snapid );
+        dml.execute();
+        dml.reset();
+        dml.prepare( "delete from nicqueuestat where snapshot<=:snapid" );
+        dml.bind( 1, snapid );
+        dml.execute();
+        dml.reset();
 
         dml.prepare( "delete from vmstat where snapshot<=:snapid" );
         dml.bind( 1, snapid );
@@ -532,6 +737,11 @@ namespace leanux {
         dml.execute();
         dml.reset();
 
+        dml.prepare( "delete from nfsopstat where snapshot<=:snapid" );
+        dml.bind( 1, snapid );
+        dml.execute();
+        dml.reset();
+
         dml.prepare( "delete from tcpserverstat where snapshot<=:snapid" );
         dml.bind( 1, snapid );
         dml.execute();
@@ -542,6 +752,11 @@ namespace leanux {
         dml.execute();
         dml.reset();
 
+        dml.prepare( "delete from procnetstat where snapshot<=:snapid" );
+        dml.bind( 1, snapid );
+        dml.execute();
+        dml.reset();
+
         dml.prepare( "delete from snapshot where id<=:snapid" );
         dml.bind( 1, snapid );
         dml.execute();
@@ -551,11 +766,11 @@ namespace leanux {
         dml.execute();
         dml.reset();
 
-        dml.prepare( "delete from nic where id not in (select distinct nic from netstat)" );
+        dml.prepare( "delete from nic where id not in (select distinct nic from netstat union select distinct nic from nicqueuestat)" );
         dml.execute();
         dml.reset();
 
-        dml.prepare( "delete from cmd where id not in (select distinct cmd from procstat)" );
+        dml.prepare( "delete from cmd where id not in (select distinct cmd from procstat union select distinct cmd from procnetstat)" );
         dml.execute();
         dml.reset();
 
@@ -563,7 +778,7 @@ namespace leanux {
         dml.execute();
         dml.reset();
 
-        dml.prepare( "delete from mountpoint where id not in (select distinct mountpoint from mountstat)" );
+        dml.prepare( "delete from mountpoint where id not in (select distinct mountpoint from mountstat union select distinct mountpoint from nfsopstat)" );
         dml.execute();
         dml.close();
 
@@ -623,6 +838,25 @@ namespace leanux {
         ddl.close();
       }
 
+      /**
+       * Add a column to an existing table, unless the table already has the column.
+       * @param db the Database.
+       * @param table the table name.
+       * @param column the column name.
+       * @param definition the column type and constraints.
+       */
+      void addColumn( persist::Database &db, const std::string &table, const std::string &column, const std::string &definition ) {
+        persist::Query qry( db );
+        qry.prepare( "PRAGMA table_info(" + table + ")" );
+        while ( qry.step() ) {
+          if ( qry.getText(1) == column ) return;
+        }
+        qry.close();
+        persist::DDL ddl( db );
+        ddl.prepare( "ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition );
+        ddl.execute();
+      }
+
       void updateSchema( persist::Database &db ) {
         int db_version = db.getUserVersion();
         if ( db_version < schema_version ) {
@@ -630,6 +864,47 @@ namespace leanux {
           ss << "upgrading schema from version " << db_version << " to version " << schema_version;
           sysLog( LOG_STAT, util::ConfigFile::getConfig()->getIntValue("LOG_LEVEL"), ss.str() );
         }
+        if ( db_version < 1978 ) {
+          addColumn( db, "mountstat", "stale", "INTEGER NOT NULL DEFAULT 0" );
+        }
+        if ( db_version < 1980 ) {
+          addColumn( db, "iostat", "wback", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "reclaim", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "dthresh", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "dirtieds", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "writtens", "REAL NOT NULL DEFAULT 0" );
+        }
+        if ( db_version < 1981 ) {
+          addColumn( db, "iostat", "ds", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "dbs", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "adtm", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "fls", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "afltm", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "rinfl", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "iostat", "winfl", "REAL NOT NULL DEFAULT 0" );
+        }
+        if ( db_version < 1984 ) {
+          addColumn( db, "tcpserverstat", "infoconns", "INTEGER NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "rttp50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "rttp95", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "rttvarp50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "cwndp50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "dlvratep50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "retrans", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "busy", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "rwndlim", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpserverstat", "sndbuflim", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "infoconns", "INTEGER NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "rttp50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "rttp95", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "rttvarp50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "cwndp50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "dlvratep50", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "retrans", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "busy", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "rwndlim", "REAL NOT NULL DEFAULT 0" );
+          addColumn( db, "tcpclientstat", "sndbuflim", "REAL NOT NULL DEFAULT 0" );
+        }
         db.setUserVersion( schema_version );
       }
 
@@ -98,12 +98,29 @@ namespace leanux {
         return db.lastInsertRowid();
       }
 
+      IOSnap::IOSnap() : Snapshot() {
+        int hz = util::ConfigFile::getConfig()->getIntValue("INFLIGHT_SAMPLE_HZ");
+        if ( hz > 0 ) {
+          try {
+            sampler_.reset( new block::InflightSampler( hz ) );
+          }
+          catch ( const Oops &oops ) {
+            sysLog( LOG_WARN, util::ConfigFile::getConfig()->getIntValue("LOG_LEVEL"), oops.getMessage() );
+          }
+        }
+      }
+
       void IOSnap::startSnap() {
         block::getStats( stat1_ );
+        block::getBDIStats( bdi1_ );
+        // discard what was sampled outside the snapshot interval
+        if ( sampler_ ) sampler_->collect( histos_ );
       }
 
       void IOSnap::stopSnap() {
         block::getStats( stat2_ );
+        block::getBDIStats( bdi2_ );
+        if ( sampler_ ) sampler_->collect( histos_ );
       }
 
       long IOSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
@@ -115,9 +132,10 @@ namespace leanux {
         sort( vec.begin(), vec.end(), sorter );
         for ( block::MajorMinorVector::const_iterator d = vec.begin(); d != vec.end(); d++ ) {
           //if ( (*d).isWholeDisk() && (delta[*d].reads + delta[*d].writes + delta[*d].iorequest_cnt) > 0 ) {
-          if ( (*d).isWholeDisk() ) {
-            std::string sdiskid = (*d).getDiskId();
-            std::string ssyspath = (*d).getSysPath();
+          const block::DeviceDescriptor &desc = (*d).getDescriptor();
+          if ( desc.wholedisk ) {
+            const std::string &sdiskid = desc.diskid;
+            std::string ssyspath = desc.syspath;
             size_t p = ssyspath.rfind("/");
             ssyspath  = ssyspath.substr(0,p);
             long diskid = 0;
@@ -129,20 +147,21 @@ namespace leanux {
               diskid = qry.getLong(0);
               persist::DML dml(db);
               dml.prepare( "UPDATE disk set device=:device WHERE id=:id" );
-              dml.bind( 1, diskid );
+              dml.bind( 1, desc.name );
+              dml.bind( 2, diskid );
               dml.execute();
             } else {
               persist::DML dml(db);
               dml.prepare( "INSERT INTO disk (device,syspath,wwn,model) VALUES (:device,:syspath,:wwn,:model)" );
-              dml.bind( 1, (*d).getName() );
+              dml.bind( 1, desc.name );
               dml.bind( 2, ssyspath );
               dml.bind( 3, sdiskid );
-              dml.bind( 4, (*d).getModel() );
+              dml.bind( 4, desc.model );
               dml.execute();
               diskid = db.lastInsertRowid();
             }
             persist::DML dml(db);
-            dml.prepare( "INSERT INTO iostat (snapshot,disk,util,svctm,rs,ws,rbs,wbs,artm,awtm,qsz,iodones,ioreqs,ioerrs) VALUES ( \
+            dml.prepare( "INSERT INTO iostat (snapshot,disk,util,svctm,rs,ws,rbs,wbs,artm,awtm,qsz,iodones,ioreqs,ioerrs,wback,reclaim,dthresh,dirtieds,writtens,ds,dbs,adtm,fls,afltm,rinfl,winfl) VALUES ( \
               :snapid, \
               :disk, \
               :util, \
@@ -156,7 +175,19 @@ namespace leanux {
               :qsz, \
               :iodones, \
               :ioreqs, \
-              :ioerrs \
+              :ioerrs, \
+              :wback, \
+              :reclaim, \
+              :dthresh, \
+              :dirtieds, \
+              :writtens, \
+              :ds, \
+              :dbs, \
+              :adtm, \
+              :fls, \
+              :afltm, \
+              :rinfl, \
+              :winfl \
               )" );
             dml.bind( 1, snapid );
             dml.bind( 2, diskid );
@@ -164,15 +195,60 @@ namespace leanux {
             if ( delta[*d].reads + delta[*d].writes > 0 ) dml.bind( 4, delta[*d].io_ms/1000.0/(delta[*d].reads + delta[*d].writes)  ); else dml.bind(4, 0 );
             dml.bind( 5, delta[*d].reads/seconds );
             dml.bind( 6, delta[*d].writes/seconds );
-            dml.bind( 7, delta[*d].read_sectors*(*d).getSectorSize()/seconds );
-            dml.bind( 8, delta[*d].write_sectors*(*d).getSectorSize()/seconds );
+            dml.bind( 7, delta[*d].read_sectors*desc.sectorsize/seconds );
+            dml.bind( 8, delta[*d].write_sectors*desc.sectorsize/seconds );
             if ( delta[*d].reads > 0 ) dml.bind( 9, delta[*d].read_ms/1000.0/delta[*d].reads ); else dml.bind( 9, 0 );
             if ( delta[*d].writes > 0 ) dml.bind( 10, delta[*d].write_ms/1000.0/delta[*d].writes ); else dml.bind( 10, 0 );
             dml.bind( 11, (double)delta[*d].io_in_progress );
             dml.bind( 12, (double)delta[*d].iodone_cnt/seconds );
             dml.bind( 13, (double)delta[*d].iorequest_cnt/seconds );
             dml.bind( 14, (double)delta[*d].ioerr_cnt/seconds );
+            block::BDIStatsMap::const_iterator b1 = bdi1_.find( *d );
+            block::BDIStatsMap::const_iterator b2 = bdi2_.find( *d );
+            if ( b2 != bdi2_.end() ) {
+              dml.bind( 15, (double)b2->second.writeback );
+              dml.bind( 16, (double)b2->second.reclaimable );
+              dml.bind( 17, (double)b2->second.dirty_thresh );
+            } else {
+              dml.bind( 15, 0 );
+              dml.bind( 16, 0 );
+              dml.bind( 17, 0 );
+            }
+            if ( b1 != bdi1_.end() && b2 != bdi2_.end() &&
+                 b2->second.dirtied >= b1->second.dirtied && b2->second.written >= b1->second.written ) {
+              dml.bind( 18, (b2->second.dirtied - b1->second.dirtied)/seconds );
+              dml.bind( 19, (b2->second.written - b1->second.written)/seconds );
+            } else {
+              dml.bind( 18, 0 );
+              dml.bind( 19, 0 );
+            }
+            dml.bind( 20, delta[*d].discards/seconds );
+            dml.bind( 21, delta[*d].discard_sectors*desc.sectorsize/seconds );
+            if ( delta[*d].discards > 0 ) dml.bind( 22, delta[*d].discard_ms/1000.0/delta[*d].discards ); else dml.bind( 22, 0 );
+            dml.bind( 23, delta[*d].flushes/seconds );
+            if ( delta[*d].flushes > 0 ) dml.bind( 24, delta[*d].flush_ms/1000.0/delta[*d].flushes ); else dml.bind( 24, 0 );
+            dml.bind( 25, (double)delta[*d].inflight_reads );
+            dml.bind( 26, (double)delta[*d].inflight_writes );
             dml.execute();
+            block::InflightHistoMap::const_iterator h = histos_.find( *d );
+            if ( h != histos_.end() && h->second.samples > 0 ) {
+              persist::DML hdml(db);
+              hdml.prepare( "INSERT INTO iohisto (snapshot,disk,samples,q0,q1,q2,q3,q4,q5,q6,q7,u0,u1,u2,u3,u4,u5,u6,u7,u8,u9) VALUES ( \
+                :snapid, :disk, :samples, \
+                :q0, :q1, :q2, :q3, :q4, :q5, :q6, :q7, \
+                :u0, :u1, :u2, :u3, :u4, :u5, :u6, :u7, :u8, :u9 \
+                )" );
+              hdml.bind( 1, snapid );
+              hdml.bind( 2, diskid );
+              hdml.bind( 3, (long)h->second.samples );
+              for ( unsigned int b = 0; b < block::inflight_depth_buckets; b++ ) {
+                hdml.bind( 4 + b, (long)h->second.depth[b] );
+              }
+              for ( unsigned int b = 0; b < block::inflight_util_buckets; b++ ) {
+                hdml.bind( 4 + block::inflight_depth_buckets + b, (long)h->second.util[b] );
+              }
+              hdml.execute();
+            }
             stored_disks++;
           }
           if ( stored_disks >= util::ConfigFile::getConfig()->getIntValue("MAX_DISKS") ) break;
@@ -260,36 +336,42 @@ namespace leanux {
 
 
 
+      /**
+       * Get the nic id of a network device, inserting the nic if new.
+       */
+      long getNicId( const persist::Database &db, const std::string &device ) {
+        std::string mac = net::getDeviceMACAddress( device );
+        std::string syspath = net::getSysPath( device );
+        persist::Query qry(db);
+        qry.prepare( "SELECT id FROM nic WHERE mac=:mac and syspath=:syspath" );
+        qry.bind( 1, mac );
+        qry.bind( 2, syspath );
+        if ( qry.step() ) return qry.getLong(0);
+        persist::DML dml(db);
+        dml.prepare( "INSERT INTO nic (device,mac,syspath) VALUES (:device,:mac,:syspath)" );
+        dml.bind( 1, device );
+        dml.bind( 2, mac );
+        dml.bind( 3, syspath );
+        dml.execute();
+        return db.lastInsertRowid();
+      }
+
+      NetSnap::NetSnap() : Snapshot(), filter_( util::ConfigFile::getConfig()->getStringListValue("NET_DEVICE_EXCLUDE") ) {
+      }
+
       void NetSnap::startSnap() {
-        net::getNetStat( stat1_ );
+        net::getNetStat( stat1_, &filter_ );
       }
 
       void NetSnap::stopSnap() {
-        net::getNetStat( stat2_ );
+        net::getNetStat( stat2_, &filter_ );
       }
 
       long NetSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
         for ( net::NetStatDeviceMap::const_iterator s2 = stat2_.begin(); s2 != stat2_.end(); ++s2 ) {
           net::NetStatDeviceMap::const_iterator s1 = stat1_.find(s2->first);
           if ( s1 != stat1_.end() ) {
-            std::string mac = net::getDeviceMACAddress( s1->first );
-            std::string syspath = net::getSysPath( s1->first );
-            long nicid = 0;
-            persist::Query qry(db);
-            qry.prepare( "SELECT id FROM nic WHERE mac=:mac and syspath=:syspath" );
-            qry.bind( 1, mac );
-            qry.bind( 2, syspath );
-            if ( qry.step() ) {
-              nicid = qry.getLong(0);
-            } else {
-              persist::DML dml(db);
-              dml.prepare( "INSERT INTO nic (device,mac,syspath) VALUES (:device,:mac,:syspath)" );
-              dml.bind( 1, s1->first );
-              dml.bind( 2, mac );
-              dml.bind( 3, syspath );
-              dml.execute();
-              nicid = db.lastInsertRowid();
-            }
+            long nicid = getNicId( db, s1->first );
             persist::DML dml(db);
             dml.prepare( "INSERT INTO netstat (snapshot,nic,rxbs,txbs,rxpkts,txpkts,rxerrs,txerrs) VALUES ( \
               :snapid, \
@@ -325,6 +407,166 @@ namespace leanux {
 
 
 
+      SoftNetSnap::SoftNetSnap() : Snapshot(), filter_( util::ConfigFile::getConfig()->getStringListValue("NET_DEVICE_EXCLUDE") ) {
+      }
+
+      void SoftNetSnap::startSnap() {
+        net::getSoftNetStat( softnet1_ );
+        net::getNetQueueStat( queue1_, &filter_ );
+      }
+
+      void SoftNetSnap::stopSnap() {
+        net::getSoftNetStat( softnet2_ );
+        net::getNetQueueStat( queue2_, &filter_ );
+      }
+
+      long SoftNetSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
+        // CPUs that processed no packets and queues without BQL or incidents are not stored
+        persist::DML dml(db);
+        dml.prepare( "INSERT INTO softnetstat (snapshot,cpu,processed,dropped,squeeze,rps,flowlimit) VALUES ( \
+          :snapid, \
+          :cpu, \
+          :processed, \
+          :dropped, \
+          :squeeze, \
+          :rps, \
+          :flowlimit \
+          )" );
+        net::SoftNetStatVector softnet;
+        net::getSoftNetStatDelta( softnet1_, softnet2_, softnet );
+        for ( net::SoftNetStatVector::const_iterator s = softnet.begin(); s != softnet.end(); ++s ) {
+          if ( softnet1_.find( (*s).cpu ) == softnet1_.end() ) continue;
+          if ( (*s).processed == 0 && (*s).dropped == 0 && (*s).time_squeeze == 0 ) continue;
+          dml.reset();
+          dml.bind( 1, snapid );
+          dml.bind( 2, (long)(*s).cpu );
+          dml.bind( 3, (*s).processed/seconds );
+          dml.bind( 4, (*s).dropped/seconds );
+          dml.bind( 5, (*s).time_squeeze/seconds );
+          dml.bind( 6, (*s).received_rps/seconds );
+          dml.bind( 7, (*s).flow_limit/seconds );
+          dml.execute();
+        }
+
+        persist::DML qdml(db);
+        qdml.prepare( "INSERT INTO nicqueuestat (snapshot,nic,queue,txtimeout,stalls,inflight,bqllimit) VALUES ( \
+          :snapid, \
+          :nic, \
+          :queue, \
+          :txtimeout, \
+          :stalls, \
+          :inflight, \
+          :bqllimit \
+          )" );
+        net::NetQueueStatVector queues;
+        net::getNetQueueStatDelta( queue1_, queue2_, queues );
+        std::map<std::string,long> nicids;
+        for ( net::NetQueueStatVector::const_iterator q = queues.begin(); q != queues.end(); ++q ) {
+          std::stringstream key;
+          key << (*q).device << "/tx-" << (*q).queue;
+          if ( queue1_.find( key.str() ) == queue1_.end() ) continue;
+          if ( (*q).bql_limit == 0 && (*q).tx_timeout == 0 && (*q).bql_stall_cnt == 0 ) continue;
+          std::map<std::string,long>::const_iterator n = nicids.find( (*q).device );
+          if ( n == nicids.end() ) n = nicids.insert( std::make_pair( (*q).device, getNicId( db, (*q).device ) ) ).first;
+          qdml.reset();
+          qdml.bind( 1, snapid );
+          qdml.bind( 2, n->second );
+          qdml.bind( 3, (long)(*q).queue );
+          qdml.bind( 4, (*q).tx_timeout/seconds );
+          qdml.bind( 5, (*q).bql_stall_cnt/seconds );
+          qdml.bind( 6, (long)(*q).bql_inflight );
+          qdml.bind( 7, (long)(*q).bql_limit );
+          qdml.execute();
+        }
+        return 0;
+      }
+
+      void ProtoSnap::startSnap() {
+        reader_.read( stat1_ );
+      }
+
+      void ProtoSnap::stopSnap() {
+        reader_.read( stat2_ );
+      }
+
+      long ProtoSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
+        net::ProtoStat delta;
+        net::getProtoStatDelta( stat1_, stat2_, delta );
+        persist::DML dml(db);
+        dml.prepare( "INSERT INTO protostat (snapshot,ipinrecv,ipindeliv,ipoutreq,ipindisc,ipoutdisc,ipnoroute,ipreasmfail, \
+                      tcpactopen,tcppasopen,tcpattfail,tcpestrst,tcpinsegs,tcpoutsegs,tcpretrans,tcpinerrs,tcpoutrsts, \
+                      tcplstovf,tcplstdrop,tcpreqqdrop,tcpsynretr,tcptimeout,tcpmempress,tcpmemabort,tcpprune,tcpbacklogdrop, \
+                      udpindgrams,udpoutdgrams,udpnoports,udpinerrs,udprcvbuferrs,udpsndbuferrs) VALUES ( \
+                     :snapid, \
+                     :ipinrecv, \
+                     :ipindeliv, \
+                     :ipoutreq, \
+                     :ipindisc, \
+                     :ipoutdisc, \
+                     :ipnoroute, \
+                     :ipreasmfail, \
+                     :tcpactopen, \
+                     :tcppasopen, \
+                     :tcpattfail, \
+                     :tcpestrst, \
+                     :tcpinsegs, \
+                     :tcpoutsegs, \
+                     :tcpretrans, \
+                     :tcpinerrs, \
+                     :tcpoutrsts, \
+                     :tcplstovf, \
+                     :tcplstdrop, \
+                     :tcpreqqdrop, \
+                     :tcpsynretr, \
+                     :tcptimeout, \
+                     :tcpmempress, \
+                     :tcpmemabort, \
+                     :tcpprune, \
+                     :tcpbacklogdrop, \
+                     :udpindgrams, \
+                     :udpoutdgrams, \
+                     :udpnoports, \
+                     :udpinerrs, \
+                     :udprcvbuferrs, \
+                     :udpsndbuferrs )" );
+        dml.bind( 1, snapid );
+        dml.bind( 2, delta.ip_in_receives / seconds );
+        dml.bind( 3, delta.ip_in_delivers / seconds );
+        dml.bind( 4, delta.ip_out_requests / seconds );
+        dml.bind( 5, delta.ip_in_discards / seconds );
+        dml.bind( 6, delta.ip_out_discards / seconds );
+        dml.bind( 7, delta.ip_out_no_routes / seconds );
+        dml.bind( 8, delta.ip_reasm_fails / seconds );
+        dml.bind( 9, delta.tcp_active_opens / seconds );
+        dml.bind( 10, delta.tcp_passive_opens / seconds );
+        dml.bind( 11, delta.tcp_attempt_fails / seconds );
+        dml.bind( 12, delta.tcp_estab_resets / seconds );
+        dml.bind( 13, delta.tcp_in_segs / seconds );
+        dml.bind( 14, delta.tcp_out_segs / seconds );
+        dml.bind( 15, delta.tcp_retrans_segs / seconds );
+        dml.bind( 16, delta.tcp_in_errs / seconds );
+        dml.bind( 17, delta.tcp_out_rsts / seconds );
+        dml.bind( 18, delta.tcp_listen_overflows / seconds );
+        dml.bind( 19, delta.tcp_listen_drops / seconds );
+        dml.bind( 20, delta.tcp_reqq_full_drops / seconds );
+        dml.bind( 21, delta.tcp_syn_retrans / seconds );
+        dml.bind( 22, delta.tcp_timeouts / seconds );
+        dml.bind( 23, delta.tcp_memory_pressures / seconds );
+        dml.bind( 24, delta.tcp_abort_on_memory / seconds );
+        dml.bind( 25, delta.tcp_prune_called / seconds );
+        dml.bind( 26, delta.tcp_backlog_drops / seconds );
+        dml.bind( 27, delta.udp_in_datagrams / seconds );
+        dml.bind( 28, delta.udp_out_datagrams / seconds );
+        dml.bind( 29, delta.udp_no_ports / seconds );
+        dml.bind( 30, delta.udp_in_errors / seconds );
+        dml.bind( 31, delta.udp_rcvbuf_errors / seconds );
+        dml.bind( 32, delta.udp_sndbuf_errors / seconds );
+        dml.execute();
+        return 0;
+      }
+
+
+
       void VMSnap::startSnap() {
         vmem::getVMStat( stat1_ );
       }
@@ -405,6 +647,32 @@ namespace leanux {
 
 
 
+      /**
+       * Get the cmd id of a process, inserting the cmd if new. The arguments are not stored
+       * for the commands in COMMAND_ARGS_IGNORE.
+       */
+      long getCmdId( const persist::Database &db, pid_t pid, const std::string &comm ) {
+        std::list<std::string> excludecmdargs = util::ConfigFile::getConfig()->getStringListValue("COMMAND_ARGS_IGNORE");
+        std::string args = process::getProcCmdLine( pid );
+        for ( std::list<std::string>::const_iterator e = excludecmdargs.begin(); e != excludecmdargs.end(); e++ ) {
+          if ( strncmp( (*e).c_str(), comm.c_str(), task_comm_len ) == 0 ) {
+            args = "";
+            break;
+          }
+        }
+        persist::Query qry(db);
+        qry.prepare( "SELECT id FROM cmd WHERE cmd=:cmd and args=:args" );
+        qry.bind( 1, comm );
+        qry.bind( 2, args );
+        if ( qry.step() ) return qry.getLong(0);
+        persist::DML dml(db);
+        dml.prepare( "INSERT INTO cmd (cmd, args) VALUES (:cmd, :args)" );
+        dml.bind( 1, comm );
+        dml.bind( 2, args );
+        dml.execute();
+        return db.lastInsertRowid();
+      }
+
       void ProcSnap::startSnap() {
         process::getAllProcPidStat( snap1_ );
       }
@@ -419,9 +687,6 @@ namespace leanux {
         process::StatsSorter my_sorter( leanux::process::StatsSorter::top );
         std::sort( delta.begin(), delta.end(), my_sorter );
 
-        persist::Query qry_cmd(db);
-        qry_cmd.prepare( "SELECT id FROM cmd WHERE cmd=:cmd and args=:args" );
-
         persist::Query qry_wchan(db);
         qry_wchan.prepare( "SELECT id FROM wchan WHERE wchan=:wchan" );
 
@@ -430,28 +695,7 @@ namespace leanux {
         long wchanid = 0;
         long max_proc = util::ConfigFile::getConfig()->getIntValue("MAX_PROCESSES");
         for ( leanux::process::ProcPidStatDeltaVector::const_iterator i = delta.begin(); i != delta.end() && maxrow < max_proc; i++, maxrow++ ) {
-          qry_cmd.reset();
-          std::list<std::string> excludecmdargs = util::ConfigFile::getConfig()->getStringListValue("COMMAND_ARGS_IGNORE");
-          std::string args = process::getProcCmdLine( (*i).pid );
-          for ( std::list<std::string>::const_iterator e = excludecmdargs.begin(); e != excludecmdargs.end(); e++ ) {
-            if ( strncmp( (*e).c_str(), snap2_[(*i).pid].comm.c_str(), task_comm_len ) == 0 ) {
-              args = "";
-              break;
-            }
-          }
-
-          qry_cmd.bind( 1, snap2_[(*i).pid].comm );
-          qry_cmd.bind( 2, args );
-          if ( qry_cmd.step() ) {
-            cmdid = qry_cmd.getLong(0);
-          } else {
-            persist::DML dml(db);
-            dml.prepare( "INSERT INTO cmd (cmd, args) VALUES (:cmd, :args)" );
-            dml.bind( 1, snap2_[(*i).pid].comm );
-            dml.bind( 2, args );
-            dml.execute();
-            cmdid = db.lastInsertRowid();
-          }
+          cmdid = getCmdId( db, (*i).pid, snap2_[(*i).pid].comm );
 
           if ( (*i).state == 'D' ) {
             qry_wchan.reset();
@@ -547,8 +791,6 @@ namespace leanux {
 
 
 
-      std::map<std::string,block::MajorMinor> MountSnap::devicefilecache_;
-
       void MountSnap::startSnap() {
         block::getStats( stat1_ );
       }
@@ -559,15 +801,17 @@ namespace leanux {
         fsbytes1_ = fsbytes2_;
 
         std::map<block::MajorMinor,block::MountInfo> mounts;
-        enumMounts( mounts, devicefilecache_ );
+        enumMounts( mounts );
+        std::list<std::string> mountpoints;
         for ( std::map<block::MajorMinor,block::MountInfo>::const_iterator m = mounts.begin(); m != mounts.end(); ++m ) {
-          fsbytes2_[m->second.mountpoint] = block::getMountUsedBytes( m->second.mountpoint );
+          mountpoints.push_back( m->second.mountpoint );
         }
+        fsusage_.sample( mountpoints, fsbytes2_ );
       }
 
       long MountSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
         std::map<block::MajorMinor,block::MountInfo> mounts;
-        block::enumMounts( mounts, devicefilecache_ );
+        block::enumMounts( mounts );
         block::DeviceStatsMap delta;
         block::MajorMinorVector vec;
         block::deltaDeviceStats( stat1_, stat2_, delta, vec );
@@ -608,7 +852,7 @@ namespace leanux {
             }
 
             persist::DML dml(db);
-            dml.prepare( "INSERT INTO mountstat VALUES ( \
+            dml.prepare( "INSERT INTO mountstat (snapshot,mountpoint,util,svctm,rs,ws,rbs,wbs,artm,awtm,growth,used,stale) VALUES ( \
               :snapid, \
               :mountpoint, \
               :util, \
@@ -620,7 +864,8 @@ namespace leanux {
               :artm, \
               :awtm, \
               :growth, \
-              :used \
+              :used, \
+              :stale \
               )" );
             dml.bind( 1, snapid );
             dml.bind( 2, mpid );
@@ -644,16 +889,22 @@ namespace leanux {
             if ( isswap ) {
               dml.bind( 11, 0 );
               dml.bind( 12, 0 );
+              dml.bind( 13, 0 );
             } else {
-              std::map<std::string,unsigned long>::const_iterator m1,m2;
+              block::MountUsageMap::const_iterator m1,m2;
               m1 = fsbytes1_.find( m->second.mountpoint );
               m2 = fsbytes2_.find( m->second.mountpoint );
               if ( m1 != fsbytes1_.end() && m2 != fsbytes2_.end() ) {
-                dml.bind( 11, ((double)m2->second-(double)m1->second)/seconds );
-                dml.bind( 12, (double)m2->second );
+                if ( m1->second.stale || m2->second.stale )
+                  dml.bind( 11, 0 );
+                else
+                  dml.bind( 11, ((double)m2->second.used-(double)m1->second.used)/seconds );
+                dml.bind( 12, (double)m2->second.used );
+                dml.bind( 13, m2->second.stale ? 1 : 0 );
               } else {
                 dml.bind( 11, 0 );
                 dml.bind( 12, 0 );
+                dml.bind( 13, 0 );
               }
             }
             dml.execute();
@@ -667,17 +918,107 @@ namespace leanux {
 
 
 
+      void NFSSnap::startSnap() {
+        block::getNFSMountStats( stat1_ );
+      }
+
+      void NFSSnap::stopSnap() {
+        block::getNFSMountStats( stat2_ );
+      }
+
+      long NFSSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
+        block::NFSMountStatsMap delta;
+        block::deltaNFSMountStats( stat1_, stat2_, delta );
+        persist::Query qry(db);
+        qry.prepare( "SELECT id FROM mountpoint WHERE mountpoint=:mountpoint" );
+        persist::DML dml(db);
+        dml.prepare( "INSERT INTO nfsopstat (snapshot,mountpoint,op,ops,retrans,timeouts,sbs,rbs,qtm,rtt,exe) VALUES ( \
+          :snapid, \
+          :mountpoint, \
+          :op, \
+          :ops, \
+          :retrans, \
+          :timeouts, \
+          :sbs, \
+          :rbs, \
+          :qtm, \
+          :rtt, \
+          :exe \
+          )" );
+        for ( block::NFSMountStatsMap::const_iterator m = delta.begin(); m != delta.end(); ++m ) {
+          if ( m->second.empty() ) continue;
+          qry.reset();
+          qry.bind( 1, m->first );
+          long mpid = 0;
+          if ( qry.step() ) {
+            mpid = qry.getLong(0);
+          } else {
+            persist::DML ins(db);
+            ins.prepare( "INSERT INTO mountpoint (mountpoint) VALUES (:mountpoint)" );
+            ins.bind( 1, m->first );
+            ins.execute();
+            mpid = db.lastInsertRowid();
+          }
+          for ( block::NFSOpStatsMap::const_iterator o = m->second.begin(); o != m->second.end(); ++o ) {
+            const block::NFSOpStats &s = o->second;
+            dml.reset();
+            dml.bind( 1, snapid );
+            dml.bind( 2, mpid );
+            dml.bind( 3, o->first );
+            dml.bind( 4, s.ops/seconds );
+            dml.bind( 5, s.trans > s.ops ? (s.trans-s.ops)/seconds : 0.0 );
+            dml.bind( 6, s.timeouts/seconds );
+            dml.bind( 7, s.bytes_sent/seconds );
+            dml.bind( 8, s.bytes_recv/seconds );
+            dml.bind( 9, s.queue_ms/1000.0/s.ops );
+            dml.bind( 10, s.rtt_ms/1000.0/s.ops );
+            dml.bind( 11, s.execute_ms/1000.0/s.ops );
+            dml.execute();
+          }
+        }
+        return 0;
+      }
+
+      TCPEstaSnap::TCPEstaSnap() : Snapshot(),
+        sampler_( std::max( 0, util::ConfigFile::getConfig()->getIntValue("TCP_INFO_TOP") ) ) {
+        // the first sample only records the cumulative TCP_INFO counters, so that the
+        // first snapshot ranks and rates connections by the interval, not their lifetime
+        if ( util::ConfigFile::getConfig()->getIntValue("TCP_INFO_TOP") > 0 ) {
+          net::TCPKeyCounterVector server;
+          net::TCPKeyCounterVector client;
+          sampler_.sample( server, client );
+        }
+      }
+
+      /**
+       * Bind the TCP_INFO summary of a TCPKeyCounter to the tcpserverstat or tcpclientstat
+       * columns infoconns..sndbuflim, starting at bind position first.
+       */
+      void bindTCPInfo( persist::DML &dml, int first, const net::TCPInfoSummary &info, double seconds ) {
+        dml.bind( first, (long)info.sampled );
+        dml.bind( first + 1, info.rtt_p50 );
+        dml.bind( first + 2, info.rtt_p95 );
+        dml.bind( first + 3, info.rttvar_p50 );
+        dml.bind( first + 4, info.cwnd_p50 );
+        dml.bind( first + 5, info.delivery_rate_p50 );
+        dml.bind( first + 6, info.retrans / seconds );
+        dml.bind( first + 7, info.busy / seconds );
+        dml.bind( first + 8, info.rwnd_limited / seconds );
+        dml.bind( first + 9, info.sndbuf_limited / seconds );
+      }
+
       long TCPEstaSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
 
-        std::list<net::TCPKeyCounter> server;
-        std::list<net::TCPKeyCounter> client;
-        getTCPConnectionCounters( server, client );
+        net::TCPKeyCounterVector server;
+        net::TCPKeyCounterVector client;
+        sampler_.sample( server, client );
 
         persist::Query qry(db);
         qry.prepare( "SELECT id FROM tcpkey WHERE ip=:ip AND port=:port AND uid=:uid" );
-        for ( std::list<net::TCPKeyCounter>::const_iterator i = server.begin(); i!= server.end(); i++ ) {
+        for ( net::TCPKeyCounterVector::const_iterator i = server.begin(); i!= server.end(); i++ ) {
+          std::string ip = (*i).getKey().getIP();
           qry.reset();
-          qry.bind( 1, (*i).getKey().getIP() );
+          qry.bind( 1, ip );
           qry.bind( 2, (long)(*i).getKey().getPort() );
           qry.bind( 3, (long)(*i).getKey().getUID() );
           long tcpkeyid = 0;
@@ -686,7 +1027,7 @@ namespace leanux {
           } else {
             persist::DML dml(db);
             dml.prepare( "INSERT INTO tcpkey (ip,port,uid) VALUES (:ip,:port,:uid)" );
-            dml.bind( 1, (*i).getKey().getIP() );
+            dml.bind( 1, ip );
             dml.bind( 2, (long)(*i).getKey().getPort() );
             dml.bind( 3, (long)(*i).getKey().getUID() );
             dml.execute();
@@ -694,22 +1035,35 @@ namespace leanux {
           }
 
           persist::DML dml(db);
-          dml.prepare( "INSERT INTO tcpserverstat VALUES ( \
+          dml.prepare( "INSERT INTO tcpserverstat \
+            (snapshot,tcpkey,esta,infoconns,rttp50,rttp95,rttvarp50,cwndp50,dlvratep50,retrans,busy,rwndlim,sndbuflim) VALUES ( \
             :snapid, \
             :tcpkey, \
-            :esta \
+            :esta, \
+            :infoconns, \
+            :rttp50, \
+            :rttp95, \
+            :rttvarp50, \
+            :cwndp50, \
+            :dlvratep50, \
+            :retrans, \
+            :busy, \
+            :rwndlim, \
+            :sndbuflim \
             )" );
           dml.bind( 1, snapid );
           dml.bind( 2, tcpkeyid );
           dml.bind( 3, (long)(*i).getEsta() );
+          bindTCPInfo( dml, 4, (*i).getInfo(), seconds );
           dml.execute();
           qry.reset();
         }
 
 
-        for ( std::list<net::TCPKeyCounter>::const_iterator i = client.begin(); i!= client.end(); i++ ) {
+        for ( net::TCPKeyCounterVector::const_iterator i = client.begin(); i!= client.end(); i++ ) {
+          std::string ip = (*i).getKey().getIP();
           qry.prepare( "SELECT id FROM tcpkey WHERE ip=:ip AND port=:port AND uid=:uid" );
-          qry.bind( 1, (*i).getKey().getIP() );
+          qry.bind( 1, ip );
           qry.bind( 2, (long)(*i).getKey().getPort() );
           qry.bind( 3, (long)(*i).getKey().getUID() );
           long tcpkeyid = 0;
@@ -718,7 +1072,7 @@ namespace leanux {
           } else {
             persist::DML dml(db);
             dml.prepare( "INSERT INTO tcpkey (ip,port,uid) VALUES (:ip,:port,:uid)" );
-            dml.bind( 1, (*i).getKey().getIP() );
+            dml.bind( 1, ip );
             dml.bind( 2, (long)(*i).getKey().getPort() );
             dml.bind( 3, (long)(*i).getKey().getUID() );
             dml.execute();
@@ -726,20 +1080,75 @@ namespace leanux {
           }
 
           persist::DML dml(db);
-          dml.prepare( "INSERT INTO tcpclientstat VALUES ( \
+          dml.prepare( "INSERT INTO tcpclientstat \
+            (snapshot,tcpkey,esta,infoconns,rttp50,rttp95,rttvarp50,cwndp50,dlvratep50,retrans,busy,rwndlim,sndbuflim) VALUES ( \
             :snapid, \
             :tcpkey, \
-            :esta \
+            :esta, \
+            :infoconns, \
+            :rttp50, \
+            :rttp95, \
+            :rttvarp50, \
+            :cwndp50, \
+            :dlvratep50, \
+            :retrans, \
+            :busy, \
+            :rwndlim, \
+            :sndbuflim \
             )" );
           dml.bind( 1, snapid );
           dml.bind( 2, tcpkeyid );
           dml.bind( 3, (long)(*i).getEsta() );
+          bindTCPInfo( dml, 4, (*i).getInfo(), seconds );
           dml.execute();
           qry.reset();
         }
         return 0;
       }
 
+      ProcNetSnap::ProcNetSnap() : Snapshot(),
+        top_( std::max( 0, util::ConfigFile::getConfig()->getIntValue("PROCESS_NET_TOP") ) ) {
+        // the first sample only records the socket counters
+        if ( top_ ) sampler_.sample( stats_ );
+      }
+
+      void ProcNetSnap::startSnap() {
+      }
+
+      void ProcNetSnap::stopSnap() {
+        if ( top_ ) sampler_.sample( stats_ );
+      }
+
+      long ProcNetSnap::storeSnap( const persist::Database &db, long snapid, double seconds ) {
+        persist::DML dml(db);
+        dml.prepare( "INSERT INTO procnetstat (snapshot,pid,uid,cmd,conns,sendbs,recvbs) VALUES ( \
+          :snapid, \
+          :pid, \
+          :uid, \
+          :cmd, \
+          :conns, \
+          :sendbs, \
+          :recvbs \
+          )" );
+        int maxrow = 0;
+        for ( net::ProcessNetStatVector::const_iterator i = stats_.begin(); i != stats_.end() && maxrow < top_; i++ ) {
+          process::ProcPidStat stat;
+          uid_t uid = 0;
+          if ( !process::getProcPidStat( (*i).pid, stat ) || !process::getProcUid( (*i).pid, uid ) ) continue;
+          dml.reset();
+          dml.bind( 1, snapid );
+          dml.bind( 2, (long)(*i).pid );
+          dml.bind( 3, (long)uid );
+          dml.bind( 4, getCmdId( db, (*i).pid, stat.comm ) );
+          dml.bind( 5, (long)(*i).connections );
+          dml.bind( 6, (*i).bytes_sent / seconds );
+          dml.bind( 7, (*i).bytes_received / seconds );
+          dml.execute();
+          maxrow++;
+        }
+        return 0;
+      }
+
     }; // namespace lard
   }; // namespace tools
 }; // namespace leanux
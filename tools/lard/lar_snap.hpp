@@ -85,7 +85,7 @@ namespace leanux {
 
       class IOSnap : public Snapshot {
         public:
-          IOSnap() : Snapshot() {};
+          IOSnap();
           virtual ~IOSnap() {};
 
           virtual void startSnap();
@@ -95,6 +95,11 @@ namespace leanux {
         protected:
           block::DeviceStatsMap stat1_;
           block::DeviceStatsMap stat2_;
+          block::BDIStatsMap bdi1_;
+          block::BDIStatsMap bdi2_;
+          /** samples requests in flight if INFLIGHT_SAMPLE_HZ > 0. */
+          std::shared_ptr<block::InflightSampler> sampler_;
+          block::InflightHistoMap histos_;
       };
 
       class CPUSnap : public Snapshot {
@@ -129,7 +134,7 @@ namespace leanux {
 
       class NetSnap : public Snapshot {
         public:
-          NetSnap() : Snapshot() {};
+          NetSnap();
           virtual ~NetSnap() {};
 
           virtual void startSnap();
@@ -138,6 +143,39 @@ namespace leanux {
         protected:
           net::NetStatDeviceMap stat1_;
           net::NetStatDeviceMap stat2_;
+          /** devices excluded by NET_DEVICE_EXCLUDE. */
+          net::NetDeviceFilter filter_;
+      };
+
+      class ProtoSnap : public Snapshot {
+        public:
+          ProtoSnap() : Snapshot() {};
+          virtual ~ProtoSnap() {};
+
+          virtual void startSnap();
+          virtual void stopSnap();
+          virtual long storeSnap( const persist::Database &db, long snapid, double seconds );
+        protected:
+          net::ProtoStatReader reader_;
+          net::ProtoStat stat1_;
+          net::ProtoStat stat2_;
+      };
+
+      class SoftNetSnap : public Snapshot {
+        public:
+          SoftNetSnap();
+          virtual ~SoftNetSnap() {};
+
+          virtual void startSnap();
+          virtual void stopSnap();
+          virtual long storeSnap( const persist::Database &db, long snapid, double seconds );
+        protected:
+          net::SoftNetStatMap softnet1_;
+          net::SoftNetStatMap softnet2_;
+          net::NetQueueStatMap queue1_;
+          net::NetQueueStatMap queue2_;
+          /** devices excluded by NET_DEVICE_EXCLUDE. */
+          net::NetDeviceFilter filter_;
       };
 
       class VMSnap : public Snapshot {
@@ -186,22 +224,54 @@ namespace leanux {
           virtual void stopSnap();
           virtual long storeSnap( const persist::Database &db, long snapid, double seconds );
         protected:
-          static std::map<std::string,block::MajorMinor> devicefilecache_;
           block::DeviceStatsMap stat1_;
           block::DeviceStatsMap stat2_;
-          std::map<std::string,unsigned long> fsbytes1_;
-          std::map<std::string,unsigned long> fsbytes2_;
+          block::MountUsageSampler fsusage_;
+          block::MountUsageMap fsbytes1_;
+          block::MountUsageMap fsbytes2_;
+      };
+
+      class NFSSnap : public Snapshot {
+        public:
+          NFSSnap() : Snapshot() {};
+          virtual ~NFSSnap() {};
+
+          virtual void startSnap();
+          virtual void stopSnap();
+          virtual long storeSnap( const persist::Database &db, long snapid, double seconds );
+        protected:
+          block::NFSMountStatsMap stat1_;
+          block::NFSMountStatsMap stat2_;
       };
 
       class TCPEstaSnap : public Snapshot {
         public:
-          TCPEstaSnap() : Snapshot() {};
+          TCPEstaSnap();
           virtual ~TCPEstaSnap() {};
 
           virtual void startSnap() {};
           virtual void stopSnap() {};
           virtual long storeSnap( const persist::Database &db, long snapid, double seconds );
         protected:
+          /** counts connections and samples TCP_INFO of the TCP_INFO_TOP busiest. */
+          net::TCPConnectionSampler sampler_;
+      };
+
+      class ProcNetSnap : public Snapshot {
+        public:
+          ProcNetSnap();
+          virtual ~ProcNetSnap() {};
+
+          virtual void startSnap();
+          virtual void stopSnap();
+          virtual long storeSnap( const persist::Database &db, long snapid, double seconds );
+        protected:
+          /** the number of processes to store, PROCESS_NET_TOP. */
+          int top_;
+          /** attributes TCP traffic to processes. */
+          net::ProcessNetSampler sampler_;
+          /** the traffic per process over the snapshot. */
+          net::ProcessNetStatVector stats_;
       };
 
     }; // namespace lard
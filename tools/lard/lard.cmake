@@ -5,6 +5,10 @@ set( LARD_CONF_DATABASE_PAGE_SIZE_DEFAULT "4096" )
 set( LARD_CONF_DATABASE_PAGE_SIZE_DESCR "sqlite3 database page size" )
 set( LARD_CONF_DATABASE_PAGE_SIZE_COMMENT "a larger page size shows some space and performance benefits at the expense of some memory and a bigger WAL file. this parameter only has effect when the database is first created" )
 
+set( LARD_CONF_INFLIGHT_SAMPLE_HZ_DEFAULT "0" )
+set( LARD_CONF_INFLIGHT_SAMPLE_HZ_DESCR "disk requests in flight samples per second, 0 (disabled) or 10 up to 100" )
+set( LARD_CONF_INFLIGHT_SAMPLE_HZ_COMMENT "when enabled, a thread samples the requests in flight of each disk to store queue depth and utilization histograms each snapshot. higher frequencies see shorter bursts at the expense of some cpu" )
+
 set( LARD_CONF_LOG_LEVEL_DEFAULT "2" )
 set( LARD_CONF_LOG_LEVEL_DESCR "0 only errors, 1 +warnings, 2 +status, 3 +info, 4 +debug" )
 set( LARD_CONF_LOG_LEVEL_COMMENT "specify which log messages are written to the syslog" )
@@ -18,6 +22,10 @@ set( LARD_CONF_MAX_MOUNTS_DESCR "limit the number of mount points for which stat
 set( LARD_CONF_MAX_PROCESSES_DEFAULT "16" )
 set( LARD_CONF_MAX_PROCESSES_DESCR "limit the number of processes for which statistics are stored each snapshot" )
 
+set( LARD_CONF_NET_DEVICE_EXCLUDE_DEFAULT "" )
+set( LARD_CONF_NET_DEVICE_EXCLUDE_DESCR "comma-separated list of network device name prefixes to exclude, like veth" )
+set( LARD_CONF_NET_DEVICE_EXCLUDE_COMMENT "container hosts may have thousands of short-lived virtual network devices. excluded devices are skipped before their statistics are read" )
+
 set( LARD_CONF_RETAIN_DAYS_DEFAULT "31" )
 set( LARD_CONF_RETAIN_DAYS_DESCR "limit the number of days a snapshot is retained" )
 set( LARD_CONF_RETAIN_DAYS_COMMENT "each maintenance interval, snapshots exceeding RETAIN_DAYS are deleted. note that MAX_DB_SIZE takes precedence over RETAIN_DAYS if MAX_DB_SIZE>0" )
@@ -38,6 +46,14 @@ set( LARD_CONF_MAINTENANCE_INTERVAL_DEFAULT "120" )
 set( LARD_CONF_MAINTENANCE_INTERVAL_DESCR "maintenance (purge) interval in minutes" )
 set( LARD_CONF_MAINTENANCE_INTERVAL_COMMENT "each maintenance interval snapshots that exceed either MAX_DB_SIZE or RETAIN_DAYS are removed, and the database is vacuumed and analyzed" )
 
+set( LARD_CONF_TCP_INFO_TOP_DEFAULT "32" )
+set( LARD_CONF_TCP_INFO_TOP_DESCR "number of busiest established TCP connections for which TCP_INFO is stored each snapshot, 0 disables" )
+set( LARD_CONF_TCP_INFO_TOP_COMMENT "the connections that moved the most bytes since the previous snapshot are queried for round trip time, congestion window, retransmits and send limits, summarized per server or client address and port. the kernel must support sock_diag" )
+
+set( LARD_CONF_PROCESS_NET_TOP_DEFAULT "16" )
+set( LARD_CONF_PROCESS_NET_TOP_DESCR "number of processes moving the most TCP bytes for which network traffic is stored each snapshot, 0 disables" )
+set( LARD_CONF_PROCESS_NET_TOP_COMMENT "the TCP byte counters of the connections are attributed to the processes holding the sockets open. only the processes visible to lard are seen. the kernel must support sock_diag" )
+
 set( LARD_CONF_SQLITE_SOFT_HEAPLIMIT_DEFAULT "4194304" )
 set( LARD_CONF_SQLITE_SOFT_HEAPLIMIT_DESCR "soft limit for the SQLite heap" )
 set( LARD_CONF_SQLITE_SOFT_HEAPLIMIT_COMMENT "SQLite will try to stay below this limit. Operations such as hash joins and sorts benefit from adequate memory" )
@@ -55,6 +55,11 @@
 #include <signal.h>
 #include <sys/time.h>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <getopt.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -62,7 +67,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <limits.h>
-#include <linux/kdev_t.h>
+#include <sys/sysmacros.h>
 
 namespace leanux {
   namespace tools {
@@ -80,6 +85,8 @@ namespace leanux {
         bool        opt_t;   /**< -t : shows tree */
         bool        opt_f;   /**< -f : shows filesystem info */
         bool        opt_l;   /**< -l : shows LVM details */
+        bool        opt_T;   /**< -T, --timing : show gathering timing summary */
+        unsigned int jobs;   /**< -j, --jobs : number of threads gathering device attributes */
         std::string device;  /**< the specified device (empty if not specified) */
       };
 
@@ -92,6 +99,17 @@ namespace leanux {
          std::cout << LEANUX_VERSION << std::endl;
       }
 
+      /**
+       * The default number of threads gathering device attributes, the number of
+       * logical CPUs up to 8.
+       * @return the default number of jobs.
+       */
+      unsigned int defaultJobs() {
+        unsigned int jobs = std::thread::hardware_concurrency();
+        if ( jobs == 0 ) jobs = 1;
+        return std::min( jobs, 8u );
+      }
+
       /**
        * Print command help.
        */
@@ -122,6 +140,12 @@ namespace leanux {
         std::cout << "lblk -f <file>" << std::endl;
         std::cout << "  list storage tree supporting the named file (which may be a mount point)." << std::endl;
         std::cout << std::endl;
+        std::cout << "-j, --jobs <n>" << std::endl;
+        std::cout << "  gather device attributes on n threads (default " << defaultJobs() << ")." << std::endl;
+        std::cout << std::endl;
+        std::cout << "-T, --timing" << std::endl;
+        std::cout << "  show how long gathering device attributes took." << std::endl;
+        std::cout << std::endl;
       }
 
       /**
@@ -137,11 +161,32 @@ namespace leanux {
         options.opt_h = false;
         options.opt_f = false;
         options.opt_l = false;
+        options.opt_t = false;
+        options.opt_T = false;
+        options.jobs = defaultJobs();
         options.opt_w = "";
         options.device = "";
+        static struct option long_options[] = {
+          { "jobs",   required_argument, 0, 'j' },
+          { "timing", no_argument,       0, 'T' },
+          { 0, 0, 0, 0 }
+        };
         int opt;
-        while ( (opt = getopt( argc, argv, "vlfthmdw:" ) ) != -1 ) {
+        while ( (opt = getopt_long( argc, argv, "vlfthmdw:j:T", long_options, 0 ) ) != -1 ) {
           switch ( opt ) {
+            case 'j': {
+                char *end = 0;
+                long jobs = strtol( optarg, &end, 10 );
+                if ( *end != 0 || jobs < 1 || jobs > 256 ) {
+                  std::cerr << "--jobs requires a number from 1 up to 256" << std::endl;
+                  return false;
+                }
+                options.jobs = jobs;
+              }
+              break;
+            case 'T':
+              options.opt_T = true;
+              break;
             case 'd':
               options.opt_d = true;
               break;
@@ -189,69 +234,136 @@ namespace leanux {
       };
 
       /**
-       * Write the tree of holders above and including mm, append to tab, starting with level.
-       * @param mm the device MajorMinor.
-       * @param tab the Tabular to write to.
-       * @param level start level (indent) for the tree.
+       * A table cell, the column caption and the value.
        */
-      void printHolderTree( const block::MajorMinor &mm, Tabular& tab, unsigned int level = 0 ) {
-        if ( tab.columnCount() == 0 ) {
-          tab.addColumn( "holder tree", false );
-          tab.addColumn( "dev", false );
-          tab.addColumn( "class", false );
-          tab.addColumn( "size" );
-          tab.addColumn( "svct" );
-          tab.addColumn( "r/(r+w)" );
-          tab.addColumn( "description", false );
+      typedef std::pair<std::string,std::string> Cell;
+
+      /**
+       * The cells gathered for a device in output order, which may span multiple rows.
+       */
+      typedef std::vector<Cell> Cells;
+
+      /**
+       * Gathers Cells for a single device.
+       */
+      typedef std::function<void( const block::MajorMinor&, Cells& )> Gatherer;
+
+      /**
+       * Timing of the gathering phases, as shown with --timing.
+       */
+      struct GatherTiming {
+        unsigned int jobs;              /**< the number of threads used */
+        size_t devices;                 /**< the number of devices gathered */
+        double elapsed;                 /**< wall clock seconds spent gathering */
+        double device_seconds;          /**< seconds spent gathering over all devices */
+        double slowest;                 /**< seconds spent on the slowest device */
+        block::MajorMinor slowest_mm;   /**< the slowest device */
+      };
+
+      /**
+       * The timing of the gathering phases.
+       */
+      GatherTiming timing = { 0, 0, 0.0, 0.0, 0.0, block::MajorMinor::invalid };
+
+      /**
+       * Append the gathered cells to the Tabular.
+       * @param tab the Tabular to append to.
+       * @param cells the gathered cells.
+       */
+      void appendCells( Tabular &tab, const Cells &cells ) {
+        for ( Cells::const_iterator c = cells.begin(); c != cells.end(); c++ ) {
+          tab.appendString( c->first, c->second );
         }
-        std::list<std::string> holders;
-        std::list<std::string> parts;
-        std::string devname = block::MajorMinor::getNameByMajorMinor( mm );
-        std::stringstream ss;
-        if ( level > 0 ) ss << std::setfill(' ') << std::setw(level*2) << " " << std::setfill(' ');
-        ss << mm.getName();
-        tab.appendString( "holder tree", ss.str() );
-        ss.str("");
-        ss << mm;
-        tab.appendString( "dev", ss.str() );
-        tab.appendString( "class", mm.getClassStr() );
-        tab.appendString( "size", util::ByteStr( mm.getSize(), 3 ) );
+      }
 
-        block::DeviceStats stats;
-        if ( mm.getStats( stats ) ) {
-          if ( stats.reads+stats.writes > 0 ) {
-            tab.appendString( "svct", util::TimeStrSec( (stats.io_ms/1000.0) / (double)(stats.reads+stats.writes) ) );
-            tab.appendString( "r/(r+w)", util::NumStr( (double)stats.reads/(double)(stats.reads+stats.writes) ) );
-          } else {
-            tab.appendString( "svct", " " );
-            tab.appendString( "r/(r+w)", " " );
+      /**
+       * Gather the cells of each device on options.jobs threads. Each device reads a dozen
+       * sysfs and udev attributes, which adds up to seconds on hosts with thousands of LUNs.
+       * The cells are stored by device index, so that the output order is the device order
+       * regardless of which thread gathered a device.
+       * @param devices the devices.
+       * @param gather the Gatherer called for each device.
+       * @param cells receives the Cells of each device, in device order.
+       * @throw Oops the first Oops thrown by gather, after all threads finished.
+       */
+      void gatherDevices( const std::vector<block::MajorMinor> &devices, const Gatherer &gather, std::vector<Cells> &cells ) {
+        util::Stopwatch sw;
+        cells.clear();
+        cells.resize( devices.size() );
+        std::vector<double> seconds( devices.size(), 0.0 );
+        std::vector<std::string> errors( devices.size() );
+        std::atomic<size_t> next( 0 );
+        auto worker = [&]() {
+          for ( size_t i = next++; i < devices.size(); i = next++ ) {
+            util::Stopwatch dsw;
+            try {
+              gather( devices[i], cells[i] );
+            }
+            catch ( const Oops &oops ) {
+              errors[i] = oops.getMessage();
+            }
+            seconds[i] = dsw.stop();
+          }
+        };
+        unsigned int jobs = std::min( (size_t)options.jobs, devices.size() );
+        if ( jobs > 1 ) {
+          std::vector<std::thread> threads;
+          for ( unsigned int j = 0; j < jobs; j++ ) threads.push_back( std::thread( worker ) );
+          for ( std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); t++ ) t->join();
+        } else worker();
+
+        timing.jobs = std::max( timing.jobs, jobs );
+        timing.devices += devices.size();
+        timing.elapsed += sw.stop();
+        for ( size_t i = 0; i < devices.size(); i++ ) {
+          timing.device_seconds += seconds[i];
+          if ( seconds[i] > timing.slowest ) {
+            timing.slowest = seconds[i];
+            timing.slowest_mm = devices[i];
           }
-        } else {
-          tab.appendString( "svct", " " );
-          tab.appendString( "r/(r+w)", " " );
         }
+        for ( size_t i = 0; i < devices.size(); i++ ) {
+          if ( errors[i] != "" ) throw Oops( __FILE__, __LINE__, errors[i] );
+        }
+      }
 
-        tab.appendString( "description", mm.getDescription() );
+      /**
+       * Write the gathering timing summary.
+       * @param os the ostream to write to.
+       */
+      void printTiming( std::ostream &os ) {
+        if ( timing.devices == 0 ) return;
+        os << "gathered " << timing.devices << " devices in " << util::TimeStrSec( timing.elapsed );
+        os << " using " << timing.jobs << ( timing.jobs == 1 ? " job" : " jobs" );
+        os << ", " << util::TimeStrSec( timing.device_seconds ) << " device time";
+        os << ", " << util::TimeStrSec( timing.device_seconds / timing.devices ) << " per device";
+        os << ", slowest " << timing.slowest_mm.getName() << " " << util::TimeStrSec( timing.slowest ) << std::endl;
+      }
 
-        mm.getPartitions( parts );
-        mm.getHolders( holders );
-        for ( std::list<std::string>::const_iterator d = holders.begin(); d != holders.end(); d++ ) {
-          printHolderTree( block::MajorMinor::getMajorMinorByName( (*d) ), tab, level+1 );
-        }
-        for ( std::list<std::string>::const_iterator d = parts.begin(); d != parts.end(); d++ ) {
-          printHolderTree( block::MajorMinor::getMajorMinorByName( (*d) ), tab, level+1 );
+      /**
+       * Gather the service time and read ratio of a device.
+       * @param mm the device MajorMinor.
+       * @param cells the Cells to append to.
+       */
+      void gatherStats( const block::MajorMinor &mm, Cells &cells ) {
+        block::DeviceStats stats;
+        if ( mm.getStats( stats ) && stats.reads+stats.writes > 0 ) {
+          cells.push_back( Cell( "svct", util::TimeStrSec( (stats.io_ms/1000.0) / (double)(stats.reads+stats.writes) ) ) );
+          cells.push_back( Cell( "r/(r+w)", util::NumStr( (double)stats.reads/(double)(stats.reads+stats.writes) ) ) );
+        } else {
+          cells.push_back( Cell( "svct", " " ) );
+          cells.push_back( Cell( "r/(r+w)", " " ) );
         }
       }
 
       /**
-       * Write the tree of slaves beneath and including mm, append to tab, starting with level.
-       * @param mm the device MajorMinor.
-       * @param tab the Tabular to write to.
-       * @param level start level (indent) for the tree.
+       * Add the columns of a holder or slave tree to tab, if not yet added.
+       * @param tab the Tabular.
+       * @param caption the caption of the tree column.
        */
-      void printSlaveTree( const block::MajorMinor &mm, Tabular& tab, unsigned int level = 0 ) {
+      void addTreeColumns( Tabular &tab, const std::string &caption ) {
         if ( tab.columnCount() == 0 ) {
-          tab.addColumn( "slave tree", false );
+          tab.addColumn( caption, false );
           tab.addColumn( "dev", false );
           tab.addColumn( "class", false );
           tab.addColumn( "size" );
@@ -259,45 +371,59 @@ namespace leanux {
           tab.addColumn( "r/(r+w)" );
           tab.addColumn( "description", false );
         }
-        std::list<std::string> slaves;
-        std::string devname = block::MajorMinor::getNameByMajorMinor( mm );
+      }
+
+      /**
+       * Gather the tree of holders above, or of slaves beneath, and including mm, starting with level.
+       * @param mm the device MajorMinor.
+       * @param topology the block device Topology.
+       * @param holders true for the holder tree, false for the slave tree.
+       * @param cells the Cells to append to.
+       * @param level start level (indent) for the tree.
+       */
+      void gatherTree( const block::MajorMinor &mm, const block::Topology &topology, bool holders, Cells &cells, unsigned int level = 0 ) {
         std::stringstream ss;
         if ( level > 0 ) ss << std::setfill(' ') << std::setw(level*2) << " " << std::setfill(' ');
         ss << mm.getName();
-        tab.appendString( "slave tree", ss.str() );
+        cells.push_back( Cell( holders ? "holder tree" : "slave tree", ss.str() ) );
         ss.str("");
         ss << mm;
-        tab.appendString( "dev", ss.str() );
-        tab.appendString( "class", mm.getClassStr() );
-        tab.appendString( "size", util::ByteStr( mm.getSize(), 3 ) );
-
-        block::DeviceStats stats;
-        if ( mm.getStats( stats ) ) {
-          if ( stats.reads+stats.writes > 0 ) {
-            tab.appendString( "svct", util::TimeStrSec( (stats.io_ms/1000.0) / (double)(stats.reads+stats.writes) ) );
-            tab.appendString( "r/(r+w)", util::NumStr( (double)stats.reads/(double)(stats.reads+stats.writes) ) );
-          } else {
-            tab.appendString( "svct", " " );
-            tab.appendString( "r/(r+w)", " " );
-          }
-        } else {
-          tab.appendString( "svct", " " );
-          tab.appendString( "r/(r+w)", " " );
+        cells.push_back( Cell( "dev", ss.str() ) );
+        cells.push_back( Cell( "class", mm.getClassStr() ) );
+        cells.push_back( Cell( "size", util::ByteStr( mm.getSize(), 3 ) ) );
+        gatherStats( mm, cells );
+        cells.push_back( Cell( "description", mm.getDescription() ) );
+
+        const std::list<block::MajorMinor> &next = holders ? topology.getHolders( mm ) : topology.getSlaves( mm );
+        for ( std::list<block::MajorMinor>::const_iterator d = next.begin(); d != next.end(); d++ ) {
+          gatherTree( *d, topology, holders, cells, level+1 );
         }
+      }
 
-        tab.appendString( "description", mm.getDescription() );
-
-        mm.getSlaves( slaves );
-        for ( std::list<std::string>::const_iterator d = slaves.begin(); d != slaves.end(); d++ ) {
-          printSlaveTree( block::MajorMinor::getMajorMinorByName( (*d) ), tab, level+1 );
-        }
-        if ( mm.isPartition() ) {
-          block::MajorMinor wd = block::MajorMinor::deriveWholeDisk( mm );
-          if ( ! (wd == mm ) ) {
-            printSlaveTree( wd, tab, level+1 );
-          }
-        }
+      /**
+       * Write the tree of holders above and including mm, append to tab.
+       * @param mm the device MajorMinor.
+       * @param topology the block device Topology.
+       * @param tab the Tabular to write to.
+       */
+      void printHolderTree( const block::MajorMinor &mm, const block::Topology &topology, Tabular& tab ) {
+        addTreeColumns( tab, "holder tree" );
+        Cells cells;
+        gatherTree( mm, topology, true, cells );
+        appendCells( tab, cells );
+      }
 
+      /**
+       * Write the tree of slaves beneath and including mm, append to tab.
+       * @param mm the device MajorMinor.
+       * @param topology the block device Topology.
+       * @param tab the Tabular to write to.
+       */
+      void printSlaveTree( const block::MajorMinor &mm, const block::Topology &topology, Tabular& tab ) {
+        addTreeColumns( tab, "slave tree" );
+        Cells cells;
+        gatherTree( mm, topology, false, cells );
+        appendCells( tab, cells );
       }
 
       /**
@@ -308,16 +434,19 @@ namespace leanux {
         std::list<block::MajorMinor> pvs;
         block::enumLVMPVS( pvs );
         if ( pvs.size() > 0 ) {
+          std::vector<block::MajorMinor> devices( pvs.begin(), pvs.end() );
+          block::Topology topology;
+          std::vector<Cells> cells;
           Tabular tab;
-          for ( std::list<block::MajorMinor>::const_iterator p = pvs.begin(); p != pvs.end(); p++ ) {
-            printHolderTree( *p, tab );
-          }
+          addTreeColumns( tab, "holder tree" );
+          gatherDevices( devices, [&topology]( const block::MajorMinor &mm, Cells &c ) { gatherTree( mm, topology, true, c ); }, cells );
+          for ( std::vector<Cells>::const_iterator c = cells.begin(); c != cells.end(); c++ ) appendCells( tab, *c );
           tab.dump(os);
           tab.clear();
           os << std::endl;
-          for ( std::list<block::MajorMinor>::const_iterator p = pvs.begin(); p != pvs.end(); p++ ) {
-            printSlaveTree( *p, tab );
-          }
+          addTreeColumns( tab, "slave tree" );
+          gatherDevices( devices, [&topology]( const block::MajorMinor &mm, Cells &c ) { gatherTree( mm, topology, false, c ); }, cells );
+          for ( std::vector<Cells>::const_iterator c = cells.begin(); c != cells.end(); c++ ) appendCells( tab, *c );
           tab.dump(os);
         } else {
           os << "no LVM physical volumes found." << std::endl;
@@ -336,12 +465,28 @@ namespace leanux {
           if ( !mm.isValid() ) mm =  block::MajorMinor( st.st_rdev );
           if ( mm.isValid() && block::MajorMinor::getNameByMajorMinor(mm) != "" ) {
             Tabular tab;
-            printSlaveTree( mm, tab );
+            block::Topology topology;
+            printSlaveTree( mm, topology, tab );
             tab.dump( os );
           } else throw Oops( __FILE__, __LINE__, "filesystem stat returns invalid block device" );
         } else throw Oops( __FILE__, __LINE__, "file not found" );
       }
 
+      /**
+       * Gather a listAllDevices row.
+       * @param mm the device MajorMinor.
+       * @param cells the Cells to append to.
+       */
+      void gatherDevice( const block::MajorMinor &mm, Cells &cells ) {
+        cells.push_back( Cell( "device", mm.getName() ) );
+        std::stringstream ss;
+        ss << mm;
+        cells.push_back( Cell( "dev", ss.str() ) );
+        cells.push_back( Cell( "class", mm.getClassStr() ) );
+        cells.push_back( Cell( "size", util::ByteStr( mm.getSize(), 3 ) ) );
+        cells.push_back( Cell( "description", mm.getDescription() ) );
+      }
+
       /**
        * Table listing all devices.
        * @param os the ostream to write to.
@@ -355,18 +500,40 @@ namespace leanux {
         table.addColumn( "class", false );
         table.addColumn( "size" );
         table.addColumn( "description", false );
-        for ( std::list<block::MajorMinor>::const_iterator i = devices.begin(); i != devices.end(); i++ ) {
-          table.appendString( "device", (*i).getName() );
-          std::stringstream ss;
-          ss << (*i);
-          table.appendString( "dev", ss.str() );
-          table.appendString( "class", (*i).getClassStr() );
-          table.appendString( "size", util::ByteStr( (*i).getSize(), 3 ) );
-          table.appendString( "description", (*i).getDescription() );
-        }
+        std::vector<Cells> cells;
+        gatherDevices( std::vector<block::MajorMinor>( devices.begin(), devices.end() ), gatherDevice, cells );
+        for ( std::vector<Cells>::const_iterator c = cells.begin(); c != cells.end(); c++ ) appendCells( table, *c );
         table.dump( std::cout );
       }
 
+      /**
+       * Gather a listAllDisks row, no cells if the disk has no size or does not match the -w substring.
+       * @param mm the disk MajorMinor.
+       * @param cells the Cells to append to.
+       */
+      void gatherDisk( const block::MajorMinor &mm, Cells &cells ) {
+        if ( mm.getSize() == 0 ) return;
+        std::string wwn = mm.getWWN();
+        if ( options.opt_w.length() > 0 && wwn.find( options.opt_w ) == std::string::npos ) return;
+        cells.push_back( Cell( "disk", mm.getName() ) );
+        std::stringstream ss;
+        ss << mm;
+        cells.push_back( Cell( "dev", ss.str() ) );
+        cells.push_back( Cell( "devicefile", mm.getDeviceFile() ) );
+        cells.push_back( Cell( "class", mm.getClassStr() ) );
+        cells.push_back( Cell( "address", mm.getSCSIHCTL() ) );
+        cells.push_back( Cell( "model", mm.getModel() ) );
+        cells.push_back( Cell( "size", util::ByteStr( mm.getSize(), 3 ) ) );
+        if ( mm.getRotational() ) {
+          ss.str("");
+          ss << mm.getRPM() << "RPM";
+          cells.push_back( Cell( "type", ss.str() ) );
+        } else cells.push_back( Cell( "type", "SSD" ) );
+        cells.push_back( Cell( "sect", util::ByteStr( mm.getSectorSize(), 3 ) ) );
+        cells.push_back( Cell( "wwn", wwn ) );
+        gatherStats( mm, cells );
+      }
+
       /**
        * Table listing all disks.
        * @param os the ostream to write to.
@@ -387,42 +554,43 @@ namespace leanux {
         table.addColumn( "wwn", false );
         table.addColumn( "svct" );
         table.addColumn( "r/(r+w)" );
-        for ( std::list<block::MajorMinor>::const_iterator i = devices.begin(); i != devices.end(); i++ ) {
-          if ( (*i).getSize() > 0 ) {
-            if ( options.opt_w.length() == 0  || (options.opt_w.length() > 0 && (*i).getWWN().find( options.opt_w ) != std::string::npos) ) {
-              table.appendString( "disk", (*i).getName() );
-              std::stringstream ss;
-              ss << (*i);
-              table.appendString( "dev", ss.str() );
-              table.appendString( "devicefile", (*i).getDeviceFile() );
-              table.appendString( "class", (*i).getClassStr() );
-              table.appendString( "address", (*i).getSCSIHCTL() );
-              table.appendString( "model", (*i).getModel() );
-              table.appendString( "size", util::ByteStr( (*i).getSize(), 3 ) );
-              if ( (*i).getRotational() ) {
-                ss.str("");
-                ss << (*i).getRPM() << "RPM";
-                table.appendString( "type", ss.str() );
-              } else table.appendString( "type", "SSD" );
-              table.appendString( "sect", util::ByteStr( (*i).getSectorSize(), 3 ) );
-              table.appendString( "wwn", (*i).getWWN() );
-
-              block::DeviceStats stats;
-              if ( (*i).getStats( stats ) ) {
-                if ( stats.reads+stats.writes > 0 ) {
-                  table.appendString( "svct", util::TimeStrSec( (stats.io_ms/1000.0) / (double)(stats.reads+stats.writes) ) );
-                  table.appendString( "r/(r+w)", util::NumStr( (double)stats.reads/(double)(stats.reads+stats.writes) ) );
-                } else {
-                  table.appendString( "svct", " " );
-                  table.appendString( "r/(r+w)", "" );
-                }
-              }
-            }
-          }
-        }
+        std::vector<Cells> cells;
+        gatherDevices( std::vector<block::MajorMinor>( devices.begin(), devices.end() ), gatherDisk, cells );
+        for ( std::vector<Cells>::const_iterator c = cells.begin(); c != cells.end(); c++ ) appendCells( table, *c );
         table.dump( std::cout );
       }
 
+      /**
+       * Gather a listAllMetaDisks row.
+       * @param mm the MetaDisk MajorMinor.
+       * @param cells the Cells to append to.
+       */
+      void gatherMetaDisk( const block::MajorMinor &mm, Cells &cells ) {
+        cells.push_back( Cell( "metadisk", mm.getName() ) );
+        std::stringstream ss;
+        ss << mm;
+        cells.push_back( Cell( "dev", ss.str() ) );
+        cells.push_back( Cell( "name", mm.getMDName() ) );
+        cells.push_back( Cell( "size", util::ByteStr( mm.getSize(), 3 ) ) );
+        cells.push_back( Cell( "level", mm.getMDLevel() ) );
+        ss.str("");
+        ss << mm.getMDDevices();
+        cells.push_back( Cell( "disks", ss.str() ) );
+        cells.push_back( Cell( "chunk", util::ByteStr( mm.getMDChunkSize(), 3) ) );
+        cells.push_back( Cell( "metadata", mm.getMDMetaDataVersion() ) );
+        ss.str("");
+        ss << mm.getMDArrayState();
+        cells.push_back( Cell( "array", ss.str() ) );
+        std::vector<block::MajorMinor> disks;
+        mm.getMDRaidDisks( disks );
+        ss.str("");
+        for ( std::vector<block::MajorMinor>::const_iterator d = disks.begin(); d != disks.end(); d++ ) {
+          if ( d != disks.begin() ) ss << "," << (*d).getName() ; else ss << (*d).getName();
+        }
+        cells.push_back( Cell( "devices", ss.str() ) );
+        cells.push_back( Cell( "state", mm.getMDRaidDiskStates() ) );
+      }
+
       /**
        * Table listing all MetaDisks.
        * @param os the ostream to write to.
@@ -430,6 +598,14 @@ namespace leanux {
       void listAllMetaDisks( std::ostream& os  ) {
         std::list<block::MajorMinor> devices;
         block::enumDevices( devices );
+        std::vector<block::MajorMinor> metadisks;
+        for ( std::list<block::MajorMinor>::const_iterator i = devices.begin(); i != devices.end(); i++ ) {
+          if ( (*i).isMetaDisk() ) metadisks.push_back( *i );
+        }
+        if ( metadisks.size() == 0 ) {
+          std::cout << "no metadisks found." << std::endl;
+          return;
+        }
         Tabular table;
         table.addColumn( "metadisk" );
         table.addColumn( "dev" );
@@ -442,37 +618,10 @@ namespace leanux {
         table.addColumn( "array" );
         table.addColumn( "devices" );
         table.addColumn( "state" );
-        unsigned int count = 0;
-        for ( std::list<block::MajorMinor>::const_iterator i = devices.begin(); i != devices.end(); i++ ) {
-          if ( (*i).isMetaDisk() ) {
-            count++;
-            table.appendString( "metadisk", (*i).getName() );
-            std::stringstream ss;
-            ss << (*i);
-            table.appendString( "dev", ss.str() );
-            table.appendString( "name", (*i).getMDName() );
-            table.appendString( "size", util::ByteStr( (*i).getSize(), 3 ) );
-            table.appendString( "level", (*i).getMDLevel() );
-            ss.str("");
-            ss << (*i).getMDDevices();
-            table.appendString( "disks", ss.str() );
-            table.appendString( "chunk", util::ByteStr( (*i).getMDChunkSize(), 3) );
-            table.appendString( "metadata", (*i).getMDMetaDataVersion() );
-            ss.str("");
-            ss << (*i).getMDArrayState();
-            table.appendString( "array", ss.str() );
-            std::vector<block::MajorMinor> disks;
-            (*i).getMDRaidDisks( disks );
-            ss.str("");
-            for ( std::vector<block::MajorMinor>::const_iterator d = disks.begin(); d != disks.end(); d++ ) {
-              if ( d != disks.begin() ) ss << "," << (*d).getName() ; else ss << (*d).getName();
-            }
-
-            table.appendString( "devices", ss.str() );
-            table.appendString( "state", (*i).getMDRaidDiskStates() );
-          }
-        }
-        if ( count ) table.dump( std::cout ); else std::cout << "no metadisks found." << std::endl;
+        std::vector<Cells> cells;
+        gatherDevices( metadisks, gatherMetaDisk, cells );
+        for ( std::vector<Cells>::const_iterator c = cells.begin(); c != cells.end(); c++ ) appendCells( table, *c );
+        table.dump( std::cout );
       }
 
       /**
@@ -734,25 +883,25 @@ namespace leanux {
           std::string resolved_path = util::realPath( options.device );
           struct stat st;
           if ( !stat( resolved_path.c_str(), &st ) ) {
-            return block::MajorMinor( MAJOR(st.st_rdev), MINOR(st.st_rdev) );
+            return block::MajorMinor( major(st.st_rdev), minor(st.st_rdev) );
           }
           //maybe it is a mapper device?
           std::stringstream ss;
           ss << "/dev/mapper/" << options.device;
           if ( !stat( ss.str().c_str(), &st ) ) {
-            return block::MajorMinor( MAJOR(st.st_rdev), MINOR(st.st_rdev) );
+            return block::MajorMinor( major(st.st_rdev), minor(st.st_rdev) );
           }
           //or a by-id
           ss.str("");
           ss << "/dev/disk/by-id/" << options.device;
           if ( !stat( ss.str().c_str(), &st ) ) {
-            return block::MajorMinor( MAJOR(st.st_rdev), MINOR(st.st_rdev) );
+            return block::MajorMinor( major(st.st_rdev), minor(st.st_rdev) );
           }
           //or a by-uuid
           ss.str("");
           ss << "/dev/disk/by-uuid/" << options.device;
           if ( !stat( ss.str().c_str(), &st ) ) {
-            return block::MajorMinor( MAJOR(st.st_rdev), MINOR(st.st_rdev) );
+            return block::MajorMinor( major(st.st_rdev), minor(st.st_rdev) );
           }
         } else return mm;
         return block::MajorMinor::invalid;
@@ -769,13 +918,14 @@ namespace leanux {
                 block::MajorMinor mm = parseDeviceArg();
                 if ( mm.isValid() ) {
                   if ( options.opt_t ) {
+                    block::Topology topology;
                     Tabular htab;
-                    printHolderTree( mm, htab );
+                    printHolderTree( mm, topology, htab );
                     if ( htab.rowCount() > 2 ) {
                       htab.dump( std::cout );
                     }
                     Tabular stab;
-                    printSlaveTree( mm, stab );
+                    printSlaveTree( mm, topology, stab );
                     if ( stab.rowCount() > 2 ) {
                       if ( htab.rowCount() > 2 ) std::cout << std::endl;
                       stab.dump( std::cout );
@@ -836,6 +986,7 @@ namespace leanux {
 
           if ( getOptions( argc, argv ) ) {
             runOptions();
+            if ( options.opt_T ) printTiming( std::cerr );
           } else printHelp();
         }
         catch ( const Oops &oops ) {
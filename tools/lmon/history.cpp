@@ -37,6 +37,7 @@
 
 #include "history.hpp"
 #include "math.h"
+#include <algorithm>
 
 namespace leanux {
 
@@ -347,6 +348,25 @@ namespace leanux {
 
           procview.delta.push_back(stat);
         }
+        procview.pidnet.clear();
+        if ( hasColumn( "procnetstat", "pid" ) ) {
+          persist::Query qprocnet( *db_ );
+          qprocnet.prepare( "SELECT"
+                            "  pid,"
+                            "  sum(sendbs+recvbs) "
+                            "FROM"
+                            "  procnetstat "
+                            "WHERE"
+                            "  snapshot>=:min"
+                            "  AND"
+                            "  snapshot<=:max "
+                            "GROUP BY pid" );
+          qprocnet.bind( 1, snap_start_ );
+          qprocnet.bind( 2, snap_end_ );
+          while ( qprocnet.step() ) {
+            procview.pidnet[qprocnet.getLong(0)] = qprocnet.getDouble(1)/dt;
+          }
+        }
         procview.sample_count = 2;
       }
 
@@ -387,13 +407,20 @@ namespace leanux {
           netview.delta.push_back(stat);
         }
 
+        // the TCP_INFO round trip times are averaged over the snapshots that sampled any
+        std::string infocols = hasColumn( "tcpserverstat", "infoconns" ) ?
+          "  sum(s.infoconns),"
+          "  avg(CASE WHEN s.infoconns>0 THEN s.rttp50 END),"
+          "  avg(CASE WHEN s.infoconns>0 THEN s.rttp95 END) " :
+          "  0, 0, 0 ";
+
         netview.tcpserver.clear();
         persist::Query qserver( *db_ );
         qserver.prepare( "SELECT"
                          "  k.ip,"
                          "  k.port,"
                          "  k.uid,"
-                         "  avg(s.esta) "
+                         "  avg(s.esta), " + infocols +
                          "FROM"
                          " tcpkey k,"
                          " tcpserverstat s "
@@ -409,7 +436,11 @@ namespace leanux {
         qserver.bind( 2, snap_end_ );
         while ( qserver.step() ) {
           net::TCPKey key( qserver.getText(0), qserver.getLong(1), qserver.getLong(2) );
-          net::TCPKeyCounter cnt( key, qserver.getLong(3) );
+          net::TCPInfoSummary info;
+          info.sampled = qserver.getLong(4);
+          info.rtt_p50 = qserver.getDouble(5);
+          info.rtt_p95 = qserver.getDouble(6);
+          net::TCPKeyCounter cnt( key, qserver.getLong(3), info );
           netview.tcpserver.push_back( cnt );
         }
 
@@ -419,7 +450,7 @@ namespace leanux {
                          "  k.ip,"
                          "  k.port,"
                          "  k.uid,"
-                         "  avg(s.esta) "
+                         "  avg(s.esta), " + infocols +
                          "FROM"
                          " tcpkey k,"
                          " tcpclientstat s "
@@ -435,13 +466,145 @@ namespace leanux {
         qclient.bind( 2, snap_end_ );
         while ( qclient.step() ) {
           net::TCPKey key( qclient.getText(0), qclient.getLong(1), qclient.getLong(2) );
-          net::TCPKeyCounter cnt( key, qclient.getLong(3) );
+          net::TCPInfoSummary info;
+          info.sampled = qclient.getLong(4);
+          info.rtt_p50 = qclient.getDouble(5);
+          info.rtt_p95 = qclient.getDouble(6);
+          net::TCPKeyCounter cnt( key, qclient.getLong(3), info );
           netview.tcpclient.push_back( cnt );
         }
 
+        // the rates are turned back into counts over the snapshot seconds, as sampled realtime
+        netview.proto = net::ProtoStat();
+        netview.proto_seconds = 0;
+        if ( hasColumn( "protostat", "snapshot" ) ) {
+          persist::Query qproto( *db_ );
+          qproto.prepare( "SELECT"
+                          "  sum(p.tcpoutsegs*(s.istop-s.istart)),"
+                          "  sum(p.tcpretrans*(s.istop-s.istart)),"
+                          "  sum(p.tcplstdrop*(s.istop-s.istart)),"
+                          "  sum(p.tcpmempress*(s.istop-s.istart)),"
+                          "  sum(p.udprcvbuferrs*(s.istop-s.istart)),"
+                          "  sum(p.udpsndbuferrs*(s.istop-s.istart)),"
+                          "  sum(s.istop-s.istart) "
+                          "FROM"
+                          "  protostat p,"
+                          "  snapshot s "
+                          "WHERE"
+                          "  p.snapshot=s.id"
+                          "  AND"
+                          "  s.id>=:min"
+                          "  AND"
+                          "  s.id<=:max" );
+          qproto.bind( 1, snap_start_ );
+          qproto.bind( 2, snap_end_ );
+          if ( qproto.step() && !qproto.isNull(6) ) {
+            netview.proto.tcp_out_segs = qproto.getDouble(0);
+            netview.proto.tcp_retrans_segs = qproto.getDouble(1);
+            netview.proto.tcp_listen_drops = qproto.getDouble(2);
+            netview.proto.tcp_memory_pressures = qproto.getDouble(3);
+            netview.proto.udp_rcvbuf_errors = qproto.getDouble(4);
+            netview.proto.udp_sndbuf_errors = qproto.getDouble(5);
+            netview.proto_seconds = qproto.getDouble(6);
+          }
+        }
+
+        netview.softnet.clear();
+        netview.queues.clear();
+        netview.softnet_seconds = 0;
+        if ( hasColumn( "softnetstat", "snapshot" ) ) {
+          persist::Query qseconds( *db_ );
+          qseconds.prepare( "SELECT sum(istop-istart) FROM snapshot WHERE id>=:min AND id<=:max" );
+          qseconds.bind( 1, snap_start_ );
+          qseconds.bind( 2, snap_end_ );
+          if ( qseconds.step() ) netview.softnet_seconds = qseconds.getDouble(0);
+
+          persist::Query qsoftnet( *db_ );
+          qsoftnet.prepare( "SELECT"
+                            "  n.cpu,"
+                            "  sum(n.processed*(s.istop-s.istart)),"
+                            "  sum(n.dropped*(s.istop-s.istart)),"
+                            "  sum(n.squeeze*(s.istop-s.istart)),"
+                            "  sum(n.rps*(s.istop-s.istart)),"
+                            "  sum(n.flowlimit*(s.istop-s.istart)) "
+                            "FROM"
+                            "  softnetstat n,"
+                            "  snapshot s "
+                            "WHERE"
+                            "  n.snapshot=s.id"
+                            "  AND"
+                            "  s.id>=:min"
+                            "  AND"
+                            "  s.id<=:max "
+                            "GROUP BY n.cpu" );
+          qsoftnet.bind( 1, snap_start_ );
+          qsoftnet.bind( 2, snap_end_ );
+          while ( qsoftnet.step() ) {
+            net::SoftNetStat stat;
+            stat.cpu = qsoftnet.getInt(0);
+            stat.processed = qsoftnet.getDouble(1);
+            stat.dropped = qsoftnet.getDouble(2);
+            stat.time_squeeze = qsoftnet.getDouble(3);
+            stat.received_rps = qsoftnet.getDouble(4);
+            stat.flow_limit = qsoftnet.getDouble(5);
+            netview.softnet.push_back( stat );
+          }
+          std::sort( netview.softnet.begin(), netview.softnet.end() );
+
+          // the BQL gauges show the fullest the queue was in the range
+          persist::Query qqueue( *db_ );
+          qqueue.prepare( "SELECT"
+                          "  c.device,"
+                          "  q.queue,"
+                          "  sum(q.txtimeout*(s.istop-s.istart)),"
+                          "  sum(q.stalls*(s.istop-s.istart)),"
+                          "  max(q.inflight),"
+                          "  max(q.bqllimit) "
+                          "FROM"
+                          "  nicqueuestat q,"
+                          "  nic c,"
+                          "  snapshot s "
+                          "WHERE"
+                          "  q.snapshot=s.id"
+                          "  AND"
+                          "  q.nic=c.id"
+                          "  AND"
+                          "  s.id>=:min"
+                          "  AND"
+                          "  s.id<=:max "
+                          "GROUP BY c.device, q.queue" );
+          qqueue.bind( 1, snap_start_ );
+          qqueue.bind( 2, snap_end_ );
+          while ( qqueue.step() ) {
+            net::NetQueueStat stat;
+            stat.device = qqueue.getText(0);
+            stat.queue = qqueue.getInt(1);
+            stat.tx_timeout = qqueue.getDouble(2);
+            stat.bql_stall_cnt = qqueue.getDouble(3);
+            stat.bql_inflight = qqueue.getLong(4);
+            stat.bql_limit = qqueue.getLong(5);
+            netview.queues.push_back( stat );
+          }
+          std::sort( netview.queues.begin(), netview.queues.end() );
+        }
+      }
+
+      bool LardHistory::hasColumn( const std::string &table, const std::string &column ) {
+        persist::Query qry( *db_ );
+        qry.prepare( "PRAGMA table_info(" + table + ")" );
+        while ( qry.step() ) {
+          if ( qry.getText(1) == column ) return true;
+        }
+        return false;
       }
 
       void LardHistory::fetchXIOView( XIOView &ioview ) {
+        std::string bdicols = hasColumn( "iostat", "dthresh" ) ?
+          "  avg(i.wback), avg(i.reclaim), avg(i.dthresh), avg(i.dirtieds), avg(i.writtens) " :
+          "  0, 0, 0, 0, 0 ";
+        std::string extcols = hasColumn( "iostat", "ds" ) ?
+          "  avg(i.ds), avg(i.dbs), avg(i.adtm), avg(i.fls), avg(i.afltm), avg(i.rinfl), avg(i.winfl) " :
+          "  0, 0, 0, 0, 0, 0, 0 ";
         persist::Query qiostat( *db_ );
         qiostat.prepare( "SELECT"
                          "  d.device,"
@@ -457,7 +620,9 @@ namespace leanux {
                          "  avg(i.qsz), "
                          "  avg(i.iodones), "
                          "  avg(i.ioreqs), "
-                         "  avg(i.ioerrs) "
+                         "  avg(i.ioerrs), " +
+                         bdicols + "," +
+                         extcols +
                          "FROM "
                          "  iostat i,"
                          "  disk d "
@@ -489,6 +654,21 @@ namespace leanux {
           stat.iodone_cnt     = qiostat.getDouble(11);
           stat.iorequest_cnt  = qiostat.getDouble(12);
           stat.ioerr_cnt      = qiostat.getDouble(13);
+          stat.wback          = qiostat.getDouble(14);
+          stat.reclaim        = qiostat.getDouble(15);
+          stat.dthresh        = qiostat.getDouble(16);
+          stat.dirtieds       = qiostat.getDouble(17);
+          stat.writtens       = qiostat.getDouble(18);
+          stat.ds             = qiostat.getDouble(19);
+          stat.dbs            = qiostat.getDouble(20);
+          stat.adtm           = qiostat.getDouble(21);
+          stat.fls            = qiostat.getDouble(22);
+          stat.afltm          = qiostat.getDouble(23);
+          stat.rinfl          = qiostat.getDouble(24);
+          stat.winfl          = qiostat.getDouble(25);
+          stat.paths          = 0;
+          stat.putil          = 0;
+          stat.stale          = false;
           ioview.iostats[device] = stat;
           ioview.iosorted.push_back(device);
         }
@@ -532,9 +712,59 @@ namespace leanux {
           stat.artm           = qmntstat.getDouble(7);
           stat.awtm           = qmntstat.getDouble(8);
           stat.growths            = qmntstat.getDouble(9);
+          stat.paths              = 0;
+          stat.putil              = 0;
+          stat.stale              = false;
           ioview.mountstats[mountpoint] = stat;
           ioview.mountsorted.push_back(mountpoint);
         }
+
+        ioview.nfsstats.clear();
+        ioview.nfssorted.clear();
+        // databases from before the nfsopstat table have no NFS data
+        persist::Query qnfstab( *db_ );
+        qnfstab.prepare( "SELECT count(*) FROM sqlite_master WHERE type='table' AND name='nfsopstat'" );
+        if ( !qnfstab.step() || qnfstab.getLong(0) == 0 ) return;
+        // operations without requests are not stored, so average over the snapshots, not the rows
+        persist::Query qnfsstat( *db_ );
+        qnfsstat.prepare( "SELECT"
+                         "  m.mountpoint,"
+                         "  sum(n.ops)/s.snaps,"
+                         "  sum(n.rtt*n.ops)/sum(n.ops),"
+                         "  sum(CASE WHEN n.op='READ' THEN n.ops ELSE 0 END)/s.snaps,"
+                         "  sum(CASE WHEN n.op='WRITE' THEN n.ops ELSE 0 END)/s.snaps,"
+                         "  sum(n.rbs)/s.snaps,"
+                         "  sum(n.sbs)/s.snaps,"
+                         "  sum(n.exe*n.ops)/sum(n.ops),"
+                         "  sum(n.retrans)/s.snaps "
+                         "FROM "
+                         "  nfsopstat n,"
+                         "  mountpoint m,"
+                         "  (SELECT count(*) snaps FROM snapshot WHERE id>=:min AND id<=:max) s "
+                         "WHERE "
+                         "  n.mountpoint = m.id"
+                         "  AND"
+                         "  n.snapshot>=:min"
+                         "  AND"
+                         "  n.snapshot<=:max "
+                         "GROUP BY m.mountpoint "
+                         "ORDER BY sum(n.ops) DESC" );
+        qnfsstat.bind( 1, snap_start_ );
+        qnfsstat.bind( 2, snap_end_ );
+        while ( qnfsstat.step() ) {
+          XNFSRec stat;
+          stat.mountpoint     = qnfsstat.getText(0);
+          stat.ops            = qnfsstat.getDouble(1);
+          stat.rtt            = qnfsstat.getDouble(2);
+          stat.rs             = qnfsstat.getDouble(3);
+          stat.ws             = qnfsstat.getDouble(4);
+          stat.rbs            = qnfsstat.getDouble(5);
+          stat.wbs            = qnfsstat.getDouble(6);
+          stat.exe            = qnfsstat.getDouble(7);
+          stat.retrans        = qnfsstat.getDouble(8);
+          ioview.nfsstats[stat.mountpoint] = stat;
+          ioview.nfssorted.push_back(stat.mountpoint);
+        }
       }
 
       void LardHistory::fetchXSysView( XSysView &sysview ) {
@@ -98,6 +98,15 @@ namespace leanux {
 
           bool getCPUStatRange( SnapRange range );
 
+          /**
+           * Test if a table in the lard database has a column, which is not the case
+           * for databases from before the column was added.
+           * @param table the table name.
+           * @param column the column name.
+           * @return true if the table has the column.
+           */
+          bool hasColumn( const std::string &table, const std::string &column );
+
           persist::Database *db_;
 
           long snap_start_;
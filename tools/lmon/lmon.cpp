@@ -135,6 +135,9 @@ namespace leanux {
           leanux::util::ConfigFile::declareParameter( "IOVIEW_MIN_HEIGHT", "4", "minimum height (#rows) for disk and mount IO view" );
           leanux::util::ConfigFile::declareParameter( "IOVIEW_MAX_HEIGHT", "14", "maximum height (#rows) for disk and mount IO view" );
           leanux::util::ConfigFile::declareParameter( "NETVIEW_MIN_HEIGHT", "4", "minimum height (#rows) for network and TCP view" );
+          leanux::util::ConfigFile::declareParameter( "NETVIEW_RESOLVE", "0", "1 to show TCP peer names, resolved in the background (sends reverse DNS queries), 0 to show IP addresses" );
+          leanux::util::ConfigFile::declareParameter( "NETVIEW_TCP_INFO_TOP", "16", "number of busiest TCP connections for which the round trip time is sampled, 0 disables" );
+          leanux::util::ConfigFile::declareParameter( "NETVIEW_EXCLUDE", "", "comma-separated list of network device name prefixes not shown, like veth" );
 
           leanux::util::ConfigFile::setConfig( "lmon", leanux::util::getUserConfigDir() + "/.leanux-lmon" );
 
@@ -46,6 +46,7 @@
 #include "util.hpp"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <set>
 
@@ -198,6 +199,8 @@ namespace leanux {
         vio_ = 0;
         vprocess_ = 0;
         vnetwork_ = 0;
+        resolver_ = 0;
+        if ( leanux::util::ConfigFile::getConfig()->getIntValue( "NETVIEW_RESOLVE" ) ) resolver_ = new net::Resolver();
         initTerminal();
         screenResize();
         doupdate();
@@ -217,6 +220,7 @@ namespace leanux {
         delete vsys_;
         delete vheader_;
         delete vfooter_;
+        delete resolver_;
         start_color();
         Screen::resetTerminal();
       }
@@ -999,17 +1003,19 @@ namespace leanux {
       }
 
       unsigned int IOView::max_mountpoint_width_;
-      std::map<std::string,block::MajorMinor> IOView::devicefilecache_;
 
       int IOView::getOptimalHeight()  {
         std::list<vmem::SwapInfo> swaps;
         vmem::getSwapInfo( swaps );
         std::map<block::MajorMinor,block::MountInfo> mounts;
-        block::enumMounts( mounts, devicefilecache_ );
+        block::enumMounts( mounts );
+        block::NFSMountStatsMap nfs;
+        block::getNFSMountStats( nfs );
+        size_t nfs_lines = nfs.size() > 0 ? nfs.size() + 2 : 0;
         return
           std::max( (size_t)leanux::util::ConfigFile::getConfig()->getIntValue( "IOVIEW_MIN_HEIGHT" ),
                     std::min( (size_t)leanux::util::ConfigFile::getConfig()->getIntValue( "IOVIEW_MAX_HEIGHT" ),
-                              std::max( (size_t)block::getAttachedWholeDisks(), mounts.size() + swaps.size() )
+                              std::max( (size_t)block::getAttachedWholeDisks(), mounts.size() + swaps.size() + nfs_lines )
                               + 3
                             )
                   );
@@ -1054,6 +1060,15 @@ namespace leanux {
         const unsigned int ioreq_width = 5;
         const unsigned int ioerr_width = 5;
         const unsigned int fsg_width = 7;
+        const unsigned int paths_width = 5;
+        const unsigned int putil_width = 7;
+        const unsigned int wbks_width = 5;
+        const unsigned int dirty_width = 5;
+        // writeback statistics require debugfs, only show them when available
+        bool show_bdi = false;
+        for ( IORecMap::const_iterator d = data.iostats.begin(); d != data.iostats.end() && !show_bdi; d++ ) {
+          show_bdi = d->second.dthresh > 0;
+        }
         werase( window_ );
         std::stringstream ss;
         ss << "Disk IO";
@@ -1076,6 +1091,10 @@ namespace leanux {
         textOutMoveXRA( x, 1, iodone_width, attr_bold_text_, "dones" );
         textOutMoveXRA( x, 1, ioreq_width, attr_bold_text_, "reqs" );
         textOutMoveXRA( x, 1, ioerr_width, attr_bold_text_, "errs" );
+        if ( show_bdi ) {
+          textOutMoveXRA( x, 1, wbks_width, attr_bold_text_, "wbk/s" );
+          textOutMoveXRA( x, 1, dirty_width, attr_bold_text_, "dirty" );
+        }
 
         unsigned int fs_start = x;
 
@@ -1116,6 +1135,17 @@ namespace leanux {
                 textOutMoveXRA( x, y, ioerr_width, COLOR_PAIR( screen_->palette_.getColorBlockedProc() ), util::NumStr(dstat->second.ioerr_cnt ) );
               else
                 textOutMoveXRA( x, y, ioerr_width, attr_normal_text_, util::NumStr(dstat->second.ioerr_cnt ) );
+              if ( show_bdi ) {
+                textOutMoveXRA( x, y, wbks_width, attr_normal_text_, util::ByteStr( dstat->second.writtens, 2 ) );
+                // dirty bytes relative to the threshold beyond which writers to the device are throttled
+                if ( dstat->second.dthresh > 0 ) {
+                  double dirty = ( dstat->second.wback + dstat->second.reclaim ) / dstat->second.dthresh;
+                  if ( dirty >= 1.0 )
+                    textOutMoveXRA( x, y, dirty_width, COLOR_PAIR( screen_->palette_.getColorBlockedProc() ), util::NumStr( dirty ) );
+                  else
+                    textOutMoveXRA( x, y, dirty_width, attr_normal_text_, util::NumStr( dirty ) );
+                } else x += dirty_width + 1;
+              }
               y++;
             }
             s_disk_util += (double)dstat->second.util;
@@ -1138,6 +1168,13 @@ namespace leanux {
 
         unsigned int right_required = fs_start + max_mountpoint_width_ + util_width + svct_width + rs_width + ws_width + rbs_width + wbs_width + 7;
         unsigned int right_optional = right_required + artm_width + awtm_width + rsz_width + wsz_width + 3;
+        unsigned int right_paths = right_optional + fsg_width + paths_width + putil_width + 3;
+        // stacked devices beneath the filesystems, only when there are any
+        bool show_paths = false;
+        for ( IORecMap::const_iterator m = data.mountstats.begin(); m != data.mountstats.end() && !show_paths; m++ ) {
+          show_paths = m->second.paths > 0;
+        }
+        show_paths = show_paths && right_paths < (unsigned int)width_;
 
         if ( right_required < (unsigned int)width_ ) {
 
@@ -1148,6 +1185,9 @@ namespace leanux {
           for ( std::vector<std::string>::const_iterator m = data.mountsorted.begin(); m != data.mountsorted.end(); ++m ) {
             if ( util::shortenString(*m,mmpw).length() > max_mountpoint_width_ ) max_mountpoint_width_ = util::shortenString(*m,mmpw).length();
           }
+          for ( std::vector<std::string>::const_iterator m = data.nfssorted.begin(); m != data.nfssorted.end(); ++m ) {
+            if ( util::shortenString(*m,mmpw).length() > max_mountpoint_width_ ) max_mountpoint_width_ = util::shortenString(*m,mmpw).length();
+          }
           double s_fs_util = 0.0;
           double s_fs_read = 0.0;
           double s_fs_write = 0.0;
@@ -1168,6 +1208,10 @@ namespace leanux {
             textOutMoveXRA( x, 1, wsz_width, attr_bold_text_, "wsz" );
             textOutMoveXRA( x, 1, fsg_width, attr_bold_text_, "grow/s" );
           }
+          if ( show_paths ) {
+            textOutMoveXRA( x, 1, paths_width, attr_bold_text_, "paths" );
+            textOutMoveXRA( x, 1, putil_width, attr_bold_text_, "putil" );
+          }
           y = 2;
           unsigned int mount_count = 0;
           for ( std::vector<std::string>::const_iterator d = data.mountsorted.begin(); d != data.mountsorted.end(); d++ ) {
@@ -1192,7 +1236,18 @@ namespace leanux {
                   if ( dstat->second.ws > 0 )
                     textOutMoveXRA( x, y, wsz_width, attr_normal_text_, util::ByteStr((double)dstat->second.wbs / dstat->second.ws, 3 ) );
                   else x += wsz_width + 1;
-                  textOutMoveXRA( x, y, fsg_width, attr_normal_text_, util::ByteStr( dstat->second.growths, 3 ) );
+                  if ( dstat->second.stale )
+                    textOutMoveXRA( x, y, fsg_width, COLOR_PAIR( screen_->palette_.getColorBlockedProc() ), "stale" );
+                  else
+                    textOutMoveXRA( x, y, fsg_width, attr_normal_text_, util::ByteStr( dstat->second.growths, 3 ) );
+                }
+                if ( show_paths ) {
+                  if ( dstat->second.paths > 0 ) {
+                    std::stringstream paths;
+                    paths << dstat->second.paths;
+                    textOutMoveXRA( x, y, paths_width, attr_normal_text_, paths.str() );
+                    textOutMoveXRA( x, y, putil_width, attr_normal_text_, util::NumStr( dstat->second.putil, 3 ) );
+                  } else x += paths_width + putil_width + 2;
                 }
 
                 y++;
@@ -1213,6 +1268,45 @@ namespace leanux {
             textOutMoveXRA( x, y, ws_width, attr_bold_text_, util::NumStr( s_fs_write ) );
             textOutMoveXRA( x, y, rbs_width, attr_bold_text_, util::ByteStr( s_fs_rb, 2 ) );
             textOutMoveXRA( x, y, wbs_width, attr_bold_text_, util::ByteStr( s_fs_wb, 2 ) );
+            y++;
+          }
+
+          // NFS mounts have no block device, show their client RPC statistics below the filesystems
+          if ( data.nfssorted.size() > 0 && y < height_ - 2 ) {
+            x = fs_start + 1;
+            textOutMoveXRA( x, y, max_mountpoint_width_, attr_bold_text_, "nfs mount" );
+            textOutMoveXRA( x, y, util_width, attr_bold_text_, "ops/s" );
+            textOutMoveXRA( x, y, svct_width, attr_bold_text_, "rtt" );
+            textOutMoveXRA( x, y, rs_width, attr_bold_text_, "r/s" );
+            textOutMoveXRA( x, y, ws_width, attr_bold_text_, "w/s" );
+            textOutMoveXRA( x, y, rbs_width, attr_bold_text_, "rb/s" );
+            textOutMoveXRA( x, y, wbs_width, attr_bold_text_, "wb/s" );
+            if ( right_optional < (unsigned int)width_ ) {
+              textOutMoveXRA( x, y, artm_width, attr_bold_text_, "exe" );
+              textOutMoveXRA( x, y, awtm_width, attr_bold_text_, "retr/s" );
+            }
+            y++;
+            for ( std::vector<std::string>::const_iterator d = data.nfssorted.begin(); d != data.nfssorted.end() && y < height_ - 1; d++ ) {
+              NFSRecMap::const_iterator nstat = data.nfsstats.find(*d);
+              if ( nstat != data.nfsstats.end() ) {
+                x = fs_start + 1;
+                textOutMoveXRA( x, y, max_mountpoint_width_, attr_normal_text_, util::shortenString(*d, mmpw) );
+                textOutMoveXRA( x, y, util_width, attr_normal_text_, util::NumStr( nstat->second.ops ) );
+                textOutMoveXRA( x, y, svct_width, attr_normal_text_, util::TimeStrSec( nstat->second.rtt ) );
+                textOutMoveXRA( x, y, rs_width, attr_normal_text_, util::NumStr( nstat->second.rs ) );
+                textOutMoveXRA( x, y, ws_width, attr_normal_text_, util::NumStr( nstat->second.ws ) );
+                textOutMoveXRA( x, y, rbs_width, attr_normal_text_, util::ByteStr( nstat->second.rbs, 2 ) );
+                textOutMoveXRA( x, y, wbs_width, attr_normal_text_, util::ByteStr( nstat->second.wbs, 2 ) );
+                if ( right_optional < (unsigned int)width_ ) {
+                  textOutMoveXRA( x, y, artm_width, attr_normal_text_, util::TimeStrSec( nstat->second.exe ) );
+                  if ( nstat->second.retrans > 0 )
+                    textOutMoveXRA( x, y, awtm_width, COLOR_PAIR( screen_->palette_.getColorBlockedProc() ), util::NumStr( nstat->second.retrans ) );
+                  else
+                    textOutMoveXRA( x, y, awtm_width, attr_normal_text_, util::NumStr( nstat->second.retrans ) );
+                }
+                y++;
+              }
+            }
           }
         }
 
@@ -1251,8 +1345,9 @@ namespace leanux {
         const int width_majflt = 7;
         const int width_rss = 6;
         const int width_vsz = 6;
+        const int width_net = 6;
         const int width_fixed = width_pid + width_pgrp + width_q + width_user + width_comm + width_time + width_utime + width_stime
-          + width_iotime + width_minflt + width_majflt + width_rss + width_vsz + 11;
+          + width_iotime + width_minflt + width_majflt + width_rss + width_vsz + width_net + 12;
 
         width_wchan_ = std::max( width_wchan_, (int)16 );
         //if ( width_wchan_ < 5 ) width_wchan_ = 5;
@@ -1287,6 +1382,7 @@ namespace leanux {
           textOutMoveXRA( x, 1, width_majflt, attr_bold_text_, "majflt" );
           textOutMoveXRA( x, 1, width_rss, attr_bold_text_, "rss" );
           textOutMoveXRA( x, 1, width_vsz, attr_bold_text_, "vsz" );
+          textOutMoveXRA( x, 1, width_net, attr_bold_text_, "net/s" );
           if (width_arg0  > 4 ) {
             textOut( x, 1,  attr_bold_text_, "args" );
           }
@@ -1300,6 +1396,7 @@ namespace leanux {
             double s_time = 0;
             double s_minflt = 0;
             double s_majflt = 0;
+            double s_net = 0;
             int y = 2;
 
             for ( process::ProcPidStatDeltaVector::const_iterator i = data.delta.begin(); i != data.delta.end(); i++ ) {
@@ -1327,6 +1424,8 @@ namespace leanux {
                 textOutMoveXRA( x, y, width_majflt, text_attr, util::NumStr( (*i).majflt, 3 ) );
                 textOutMoveXRA( x, y, width_rss, text_attr, util::ByteStr( (*i).rss * leanux::system::getPageSize() , 3 ) );
                 textOutMoveXRA( x, y, width_vsz, text_attr, util::ByteStr( (*i).vsize, 3 ) );
+                std::map<pid_t,double>::const_iterator n = data.pidnet.find( (*i).pid );
+                textOutMoveXRA( x, y, width_net, text_attr, n != data.pidnet.end() ? util::ByteStr( n->second, 3 ) : "" );
                 if ( width_ > x + width_arg0 ) {
                   std::map<pid_t,std::string>::const_iterator a = data.pidargs.find((*i).pid);
                   std::string args = a->second;
@@ -1349,6 +1448,9 @@ namespace leanux {
               s_minflt += (*i).minflt;
               s_majflt += (*i).majflt;
             }
+            for ( std::map<pid_t,double>::const_iterator n = data.pidnet.begin(); n != data.pidnet.end(); n++ ) {
+              s_net += n->second;
+            }
             x = width_pid + width_pgrp + width_q + width_user + 4;
             textOutMoveXRA( x, y, width_comm, attr_bold_text_, "total" );
             textOutMoveXRA( x, y, width_time, attr_bold_text_, util::NumStr( s_time, 3 ) );
@@ -1357,15 +1459,85 @@ namespace leanux {
             textOutMoveXRA( x, y, width_iotime, attr_bold_text_, util::NumStr( s_iotime, 3 ) );
             textOutMoveXRA( x, y, width_minflt, attr_bold_text_, util::NumStr( s_minflt, 3 ) );
             textOutMoveXRA( x, y, width_majflt, attr_bold_text_, util::NumStr( s_majflt, 3 ) );
+            x += width_rss + width_vsz + 2;
+            textOutMoveXRA( x, y, width_net, attr_bold_text_, util::ByteStr( s_net, 3 ) );
           }
         }
 
         wnoutrefresh( window_ );
       }
 
+      std::string NetView::getAddressText( const net::TCPKey &key ) const {
+        std::string ip = key.getIP();
+        if ( !screen_->getResolver() ) return ip;
+        std::string name = screen_->getResolver()->lookup( ip );
+        if ( name.length() > max_host_width ) name = name.substr( 0, max_host_width - 1 ) + "~";
+        return name;
+      }
+
+      void NetView::protoIndicators( int x, int maxx, const XNetView &data ) {
+        struct Indicator {
+          const char *label;
+          unsigned long value;
+          bool alert;
+        };
+        double dt = data.proto_seconds;
+        if ( dt <= 0.0 ) return;
+        const net::ProtoStat &p = data.proto;
+        // retransmits are alerted when over 1% of the sent segments
+        Indicator indicators[] = {
+          { "retr/s", p.tcp_retrans_segs, p.tcp_retrans_segs * 100 > p.tcp_out_segs },
+          { "lstdrop/s", p.tcp_listen_drops, p.tcp_listen_drops > 0 },
+          { "mempress/s", p.tcp_memory_pressures, p.tcp_memory_pressures > 0 },
+          { "udpbuferr/s", p.udp_rcvbuf_errors + p.udp_sndbuf_errors, p.udp_rcvbuf_errors + p.udp_sndbuf_errors > 0 }
+        };
+        for ( size_t i = 0; i < sizeof(indicators)/sizeof(Indicator); i++ ) {
+          std::string text = std::string(" ") + indicators[i].label + " " + util::NumStr( indicators[i].value / dt ) + " ";
+          if ( x + (int)text.length() >= maxx ) break;
+          textOut( x, 0, indicators[i].alert ? attr_alert_text_ : attr_normal_text_, text );
+          x += text.length();
+        }
+      }
+
+      void NetView::softnetSection( int x, int width, const XNetView &data ) {
+        const unsigned int cpu_width = 4;
+        const unsigned int pkt_width = 7;
+        const unsigned int drop_width = 6;
+        const unsigned int sqz_width = 6;
+        vLine( 1, height_, x, attr_line_ );
+        textOut( x + 1, 0, attr_bold_text_, "Softnet" );
+        double dt = data.softnet_seconds;
+        if ( dt <= 0.0 ) return;
+        int tx = x + 9;
+        for ( net::NetQueueStatVector::const_iterator q = data.queues.begin(); q != data.queues.end() && (*q).isHot(); q++ ) {
+          std::stringstream ss;
+          ss << " " << (*q).device << ":tx" << (*q).queue << " ";
+          if ( tx + (int)ss.str().length() >= x + width ) break;
+          textOut( tx, 0, attr_alert_text_, ss.str() );
+          tx += ss.str().length();
+        }
+        int cx = x + 1;
+        textOutMoveXRA( cx, 1, cpu_width, attr_bold_text_, "cpu" );
+        textOutMoveXRA( cx, 1, pkt_width, attr_bold_text_, "pkt/s" );
+        textOutMoveXRA( cx, 1, drop_width, attr_bold_text_, "drop/s" );
+        textOutMoveXRA( cx, 1, sqz_width, attr_bold_text_, "sqz/s" );
+        int y = 2;
+        for ( net::SoftNetStatVector::const_iterator i = data.softnet.begin(); i != data.softnet.end() && y < height_; i++ ) {
+          if ( (*i).processed == 0 && (*i).dropped == 0 && (*i).time_squeeze == 0 ) continue;
+          int attr = (*i).dropped > 0 || (*i).time_squeeze > 0 ? attr_alert_text_ : attr_normal_text_;
+          cx = x + 1;
+          textOutMoveXRA( cx, y, cpu_width, attr, (*i).cpu );
+          textOutMoveXRA( cx, y, pkt_width, attr, util::NumStr( (*i).processed / dt ) );
+          textOutMoveXRA( cx, y, drop_width, attr, util::NumStr( (*i).dropped / dt ) );
+          textOutMoveXRA( cx, y, sqz_width, attr, util::NumStr( (*i).time_squeeze / dt ) );
+          y++;
+        }
+      }
+
       int NetView::getOptimalHeight() {
         net::NetStatDeviceMap stat;
-        net::getNetStat( stat );
+        net::NetDeviceFilter filter( leanux::util::ConfigFile::getConfig()->getStringListValue( "NETVIEW_EXCLUDE" ) );
+        net::getNetStat( stat, &filter );
         return std::max( (size_t)getMinHeight(), stat.size()+3 );
       }
 
@@ -1409,6 +1581,7 @@ namespace leanux {
         textOutMoveXRA( x, 1, txerr_width, attr_bold_text_, "txerr/s" );
         server_start = x;
         if ( data.sample_count > 1 ) {
+          protoIndicators( 9, server_start, data );
           int y = 2;
           double s_rx_bytes = 0.0;
           double s_tx_bytes = 0.0;
@@ -1445,59 +1618,76 @@ namespace leanux {
         }
         // server analysis
         int server_width = 30;
+        if ( data.sample_count > 1 && width_ >= server_start + softnet_width + server_width ) {
+          softnetSection( server_start, softnet_width, data );
+          server_start += softnet_width;
+        }
         if ( width_ >= server_start + server_width ) {
+          // only the rows that fit are formatted
+          size_t rows = height_ > 2 ? height_ - 2 : 0;
+          std::vector<std::string> server_ips;
           unsigned int max_server_ip_width_ = 0;
-          for ( std::list<net::TCPKeyCounter>::const_iterator i = data.tcpserver.begin(); i != data.tcpserver.end(); i++ ) {
-            if ( (*i).getKey().getIP().length() > max_server_ip_width_ ) max_server_ip_width_ = (*i).getKey().getIP().length();
+          for ( net::TCPKeyCounterVector::const_iterator i = data.tcpserver.begin(); i != data.tcpserver.end() && server_ips.size() < rows; i++ ) {
+            server_ips.push_back( getAddressText( (*i).getKey() ) );
+            if ( server_ips.back().length() > max_server_ip_width_ ) max_server_ip_width_ = server_ips.back().length();
           }
 
+          std::vector<std::string> client_ips;
           unsigned int max_client_ip_width_ = 0;
-          for ( std::list<net::TCPKeyCounter>::const_iterator i = data.tcpclient.begin(); i != data.tcpclient.end(); i++ ) {
-            if ( (*i).getKey().getIP().length() > max_client_ip_width_ ) max_client_ip_width_ = (*i).getKey().getIP().length();
+          for ( net::TCPKeyCounterVector::const_iterator i = data.tcpclient.begin(); i != data.tcpclient.end() && client_ips.size() < rows; i++ ) {
+            client_ips.push_back( getAddressText( (*i).getKey() ) );
+            if ( client_ips.back().length() > max_client_ip_width_ ) max_client_ip_width_ = client_ips.back().length();
           }
 
           const unsigned int port_width = 6;
           const unsigned int uid_width = 9;
           const unsigned int esta_width = 6;
+          const unsigned int rtt_width = 7;
 
           int j = 2;
           int x = server_start+1;
 
-          if ( server_start + max_server_ip_width_ + port_width + port_width + esta_width + 6 < (unsigned int)width_ ) {
+          if ( server_start + max_server_ip_width_ + port_width + port_width + esta_width + rtt_width + 7 < (unsigned int)width_ ) {
             vLine( 1, height_ , server_start, attr_line_ );
             textOut( server_start+1, 0, attr_bold_text_, "TCP server" );
-            for ( std::list<net::TCPKeyCounter>::const_iterator i = data.tcpserver.begin(); i != data.tcpserver.end() && j < height_; i++, j++ ) {
+            for ( net::TCPKeyCounterVector::const_iterator i = data.tcpserver.begin(); i != data.tcpserver.end() && j < height_; i++, j++ ) {
               x = server_start+1;
-              textOutMoveXRA( x, j, max_server_ip_width_, attr_normal_text_, (*i).getKey().getIP() );
+              textOutMoveXRA( x, j, max_server_ip_width_, attr_normal_text_, server_ips[j-2] );
               textOutMoveXRA( x, j, port_width, attr_normal_text_, (*i).getKey().getPort() );
               textOutMoveXRA( x, j, uid_width, attr_normal_text_, system::getUserName( (*i).getKey().getUID() ) );
               textOutMoveXRA( x, j, esta_width, attr_normal_text_, (*i).getEsta() );
+              if ( (*i).getInfo().sampled )
+                textOutMoveXRA( x, j, rtt_width, attr_normal_text_, util::TimeStrSec( (*i).getInfo().rtt_p50 ) );
             }
             x = server_start + 1;
             textOutMoveXRA( x, 1, max_server_ip_width_, attr_bold_text_, "address" );
             textOutMoveXRA( x, 1, port_width, attr_bold_text_, "port" );
             textOutMoveXRA( x, 1, uid_width, attr_bold_text_, "user" );
             textOutMoveXRA( x, 1, esta_width, attr_bold_text_, "#conn" );
+            textOutMoveXRA( x, 1, rtt_width, attr_bold_text_, "rtt" );
 
             int client_start = x;
 
-            if ( client_start + max_client_ip_width_ + port_width + port_width + esta_width + 6 < (unsigned int)width_ ) {
+            if ( client_start + max_client_ip_width_ + port_width + port_width + esta_width + rtt_width + 7 < (unsigned int)width_ ) {
 
               vLine( 1, height_ , client_start, attr_line_ );
               textOut( client_start+1, 0, attr_bold_text_, "TCP client" );
               j = 2;
-              for ( std::list<net::TCPKeyCounter>::const_iterator i = data.tcpclient.begin(); i != data.tcpclient.end() && j < height_; i++, j++ ) {
+              for ( net::TCPKeyCounterVector::const_iterator i = data.tcpclient.begin(); i != data.tcpclient.end() && j < height_; i++, j++ ) {
                 x = client_start + 1;
-                textOutMoveXRA( x, j, max_client_ip_width_, attr_normal_text_, (*i).getKey().getIP() );
+                textOutMoveXRA( x, j, max_client_ip_width_, attr_normal_text_, client_ips[j-2] );
                 textOutMoveXRA( x, j, port_width, attr_normal_text_, (*i).getKey().getPort() );
                 textOutMoveXRA( x, j, uid_width, attr_normal_text_, system::getUserName( (*i).getKey().getUID() ) );
                 textOutMoveXRA( x, j, esta_width, attr_normal_text_, (*i).getEsta() );
+                if ( (*i).getInfo().sampled )
+                  textOutMoveXRA( x, j, rtt_width, attr_normal_text_, util::TimeStrSec( (*i).getInfo().rtt_p50 ) );
               }
               x = client_start + 1;
               textOutMoveXRA( x, 1, max_client_ip_width_, attr_bold_text_, "address" );
               textOutMoveXRA( x, 1, port_width, attr_bold_text_, "port" );
               textOutMoveXRA( x, 1, uid_width, attr_bold_text_, "user" );
               textOutMoveXRA( x, 1, esta_width, attr_bold_text_, "#conn" );
+              textOutMoveXRA( x, 1, rtt_width, attr_bold_text_, "rtt" );
             }
           }
         }
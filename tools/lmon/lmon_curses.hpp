@@ -531,8 +531,6 @@ namespace leanux {
           /** Maximum width of the filesystem mountpoint column. */
           static unsigned int max_mountpoint_width_;
 
-          /** cache of device special files to MajorMinor */
-          static std::map<std::string,block::MajorMinor> devicefilecache_;
       };
 
       /**
@@ -633,6 +631,37 @@ namespace leanux {
            */
           static int getOptimalHeight();
         protected:
+          /**
+           * The text shown for a TCP address, the name if the Screen resolves and the name
+           * is known, the IP otherwise.
+           * @param key the TCPKey.
+           * @return the text, at most max_host_width characters.
+           */
+          std::string getAddressText( const net::TCPKey &key ) const;
+
+          /** the maximum width of a resolved name. */
+          static const size_t max_host_width = 32;
+
+          /**
+           * Show TCP and UDP health indicators (retransmits, listen drops, memory pressure,
+           * UDP buffer errors) on the top line, alerted when problematic.
+           * @param x the x to start at.
+           * @param maxx the indicators end before maxx.
+           * @param data the XNetView.
+           */
+          void protoIndicators( int x, int maxx, const XNetView &data );
+
+          /**
+           * Show the per-CPU softnet statistics, alerting CPUs that dropped packets or ran out
+           * of softirq budget, with the hot transmit queues on the top line.
+           * @param x the x of the section's left line.
+           * @param width the width of the section.
+           * @param data the XNetView.
+           */
+          void softnetSection( int x, int width, const XNetView &data );
+
+          /** the width of the softnet section. */
+          static const int softnet_width = 28;
       };
 
       /**
@@ -788,6 +817,12 @@ namespace leanux {
            */
           Palette palette_;
 
+          /**
+           * Get the reverse DNS resolver for the NetView.
+           * @return the resolver, or 0 if NETVIEW_RESOLVE is off.
+           */
+          net::Resolver* getResolver() const { return resolver_; };
+
         private:
 
           /**
@@ -834,6 +869,9 @@ namespace leanux {
           /** Network View. */
           View* vnetwork_;
 
+          /** Resolves TCP peer addresses, outlives the NetView across resizes. */
+          net::Resolver* resolver_;
+
           /**
            * Structure to hold the terminal size (columns,lines).
            */
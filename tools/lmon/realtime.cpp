@@ -36,6 +36,7 @@
  */
 
 #include "realtime.hpp"
+#include "configfile.hpp"
 #include "system.hpp"
 #include "util.hpp"
 #include <sys/time.h>
@@ -48,9 +49,9 @@ namespace leanux {
 
     namespace lmon {
 
-      std::map<std::string,block::MajorMinor> RealtimeSampler::devicefilecache_;
-
-      RealtimeSampler::RealtimeSampler() : xioview_(), xsysview_(), xnetview_(), xprocview_() {
+      RealtimeSampler::RealtimeSampler() : xioview_(), xsysview_(), xnetview_(), xprocview_(),
+        netfilter_( util::ConfigFile::getConfig()->getStringListValue( "NETVIEW_EXCLUDE" ) ), protosnap1_(), protosnap2_(),
+        tcpsampler_( std::max( 0, util::ConfigFile::getConfig()->getIntValue( "NETVIEW_TCP_INFO_TOP" ) ) ) {
         xsysview_.pagesize_ = system::getPageSize();
         cpu::getCPUInfo( cpuinfo_ );
         mounted_bytes_1_ = 0;
@@ -61,16 +62,23 @@ namespace leanux {
       }
 
       void RealtimeSampler::sample( int cpubarheight ) {
+        sampleFSUsage();
         sampleXSysView( cpubarheight );
         sampleXIOView();
         sampleXNetView();
         sampleXProcView();
       }
 
+      void RealtimeSampler::sampleFSUsage() {
+        block::enumMountpoints( mountpoints_ );
+        fsusage_.sample( mountpoints_, fsused_ );
+      }
+
       void RealtimeSampler::sampleXProcView() {
         xprocview_.t1 = xprocview_.t2;
         xprocview_.pidargs.clear();
         xprocview_.piduids.clear();
+        xprocview_.pidnet.clear();
         if ( !xprocview_.disabled ) {
           procsnap1_ = procsnap2_;
           gettimeofday( &xprocview_.t2, 0 );
@@ -102,6 +110,11 @@ namespace leanux {
               xprocview_.piduids[(*i).pid] = uid;
               xprocview_.pidargs[(*i).pid] = process::getProcCmdLine( (*i).pid );
             }
+            net::ProcessNetStatVector procnet;
+            procnetsampler_.sample( procnet );
+            for ( net::ProcessNetStatVector::const_iterator i = procnet.begin(); i != procnet.end(); i++ ) {
+              if ( dt > 0 ) xprocview_.pidnet[(*i).pid] = ( (*i).bytes_sent + (*i).bytes_received ) / dt;
+            }
           }
         } else {
           unsigned long procs_now;
@@ -118,7 +131,7 @@ namespace leanux {
         xnetview_.t1 = xnetview_.t2;
         gettimeofday( &xnetview_.t2, 0 );
         netsnap1_ = netsnap2_;
-        net::getNetStat( netsnap2_ );
+        net::getNetStat( netsnap2_, &netfilter_ );
         net::getNetStatDelta( netsnap1_, netsnap2_, xnetview_.delta );
         double dt = util::deltaTime( xnetview_.t1, xnetview_.t2 );
         for ( net::NetStatDeviceVector::iterator i = xnetview_.delta.begin(); i != xnetview_.delta.end(); i++ ) {
@@ -129,7 +142,18 @@ namespace leanux {
           (*i).rx_errors /= dt;
           (*i).tx_errors /= dt;
         }
-        getTCPConnectionCounters( xnetview_.tcpserver, xnetview_.tcpclient );
+        protosnap1_ = protosnap2_;
+        protoreader_.read( protosnap2_ );
+        net::getProtoStatDelta( protosnap1_, protosnap2_, xnetview_.proto );
+        xnetview_.proto_seconds = dt;
+        softnetsnap1_ = softnetsnap2_;
+        net::getSoftNetStat( softnetsnap2_ );
+        net::getSoftNetStatDelta( softnetsnap1_, softnetsnap2_, xnetview_.softnet );
+        queuesnap1_ = queuesnap2_;
+        net::getNetQueueStat( queuesnap2_, &netfilter_ );
+        net::getNetQueueStatDelta( queuesnap1_, queuesnap2_, xnetview_.queues );
+        xnetview_.softnet_seconds = dt;
+        tcpsampler_.sample( xnetview_.tcpserver, xnetview_.tcpclient );
         xnetview_.sample_count++;
       }
 
@@ -141,6 +165,8 @@ namespace leanux {
         gettimeofday( &xioview_.t2, 0 );
         double dt = util::deltaTime( xioview_.t1, xioview_.t2 );
         block::getStats( diskstats2_ );
+        bdistats1_ = bdistats2_;
+        block::getBDIStats( bdistats2_ );
         xioview_.iosorted.clear();
         xioview_.iostats.clear();
         xioview_.mountsorted.clear();
@@ -148,15 +174,20 @@ namespace leanux {
         block::deltaDeviceStats( diskstats1_, diskstats2_, devicestats, sorted );
         block::StatsSorter sorter(&devicestats);
         sort( sorted.begin(), sorted.end(), sorter );
+        topology_.refresh();
+        block::DeviceStatsMap rolled;
+        topology_.rollUp( devicestats, rolled );
 
         for ( block::MajorMinorVector::const_iterator s = sorted.begin(); s != sorted.end(); s++ ) {
+          const block::DeviceDescriptor &desc = (*s).getDescriptor();
           XIORec rec;
-          rec.device = (*s).getName();
+          rec.device = desc.name;
+          rec.stale = false;
           rec.util  = devicestats[*s].io_ms / 1000.0 / dt;
           rec.rs    = devicestats[*s].reads / dt;
           rec.ws    = devicestats[*s].writes / dt;
-          rec.rbs   = devicestats[*s].read_sectors * (*s).getSectorSize() / dt;
-          rec.wbs   = devicestats[*s].write_sectors * (*s).getSectorSize() / dt;
+          rec.rbs   = devicestats[*s].read_sectors * desc.sectorsize / dt;
+          rec.wbs   = devicestats[*s].write_sectors * desc.sectorsize / dt;
           if ( devicestats[*s].reads != 0 )
             rec.artm  = devicestats[*s].read_ms / 1000.0 / devicestats[*s].reads;
           else
@@ -176,38 +207,74 @@ namespace leanux {
           rec.iodone_cnt = devicestats[*s].iodone_cnt / dt;
           rec.iorequest_cnt = devicestats[*s].iorequest_cnt / dt;
           rec.ioerr_cnt = devicestats[*s].ioerr_cnt / dt;
-          if ( xioview_.iostats.find( (*s).getName() ) == xioview_.iostats.end() ) {
-            xioview_.iostats[ (*s).getName() ] = rec;
-            if ( (*s).isWholeDisk() ) {
-              xioview_.iosorted.push_back((*s).getName());
+          rec.wback = rec.reclaim = rec.dthresh = rec.dirtieds = rec.writtens = 0;
+          rec.paths = 0;
+          rec.putil = 0;
+          rec.ds    = devicestats[*s].discards / dt;
+          rec.dbs   = devicestats[*s].discard_sectors * desc.sectorsize / dt;
+          rec.adtm  = devicestats[*s].discards ? devicestats[*s].discard_ms / 1000.0 / devicestats[*s].discards : 0;
+          rec.fls   = devicestats[*s].flushes / dt;
+          rec.afltm = devicestats[*s].flushes ? devicestats[*s].flush_ms / 1000.0 / devicestats[*s].flushes : 0;
+          rec.rinfl = devicestats[*s].inflight_reads;
+          rec.winfl = devicestats[*s].inflight_writes;
+          block::BDIStatsMap::const_iterator b1 = bdistats1_.find( *s );
+          block::BDIStatsMap::const_iterator b2 = bdistats2_.find( *s );
+          if ( b2 != bdistats2_.end() ) {
+            rec.wback = b2->second.writeback;
+            rec.reclaim = b2->second.reclaimable;
+            rec.dthresh = b2->second.dirty_thresh;
+            if ( b1 != bdistats1_.end() &&
+                 b2->second.dirtied >= b1->second.dirtied && b2->second.written >= b1->second.written ) {
+              rec.dirtieds = ( b2->second.dirtied - b1->second.dirtied ) / dt;
+              rec.writtens = ( b2->second.written - b1->second.written ) / dt;
+            }
+          }
+          if ( xioview_.iostats.find( desc.name ) == xioview_.iostats.end() ) {
+            xioview_.iostats[ desc.name ] = rec;
+            if ( desc.wholedisk ) {
+              xioview_.iosorted.push_back( desc.name );
             }
           }
         }
         vmem::getSwapInfo( swaps_ );
         xioview_.fsbytes1 = xioview_.fsbytes2;
         std::map<block::MajorMinor,block::MountInfo> mounts;
-        enumMounts( mounts, devicefilecache_ );
+        enumMounts( mounts );
 
 
-        for ( std::map<block::MajorMinor,block::MountInfo>::const_iterator m = mounts.begin(); m != mounts.end(); ++m ) {
-          xioview_.fsbytes2[m->second.mountpoint] = block::getMountUsedBytes( m->second.mountpoint );
-        }
+        xioview_.fsbytes2 = fsused_;
         // map MajorMinor to mountpoint
         for ( block::MajorMinorVector::const_iterator s = sorted.begin(); s != sorted.end(); s++ ) {
-          XIORec rec;
+          const XIORec &io = xioview_.iostats[(*s).getDescriptor().name];
           std::map<block::MajorMinor,block::MountInfo>::const_iterator m = mounts.find(*s);
           if ( m != mounts.end() ) {
-            xioview_.mountstats[m->second.mountpoint].util  = xioview_.iostats[(*s).getName()].util;
-            xioview_.mountstats[m->second.mountpoint].rs    = xioview_.iostats[(*s).getName()].rs;
-            xioview_.mountstats[m->second.mountpoint].ws    = xioview_.iostats[(*s).getName()].ws;
-            xioview_.mountstats[m->second.mountpoint].rbs   = xioview_.iostats[(*s).getName()].rbs;
-            xioview_.mountstats[m->second.mountpoint].wbs   = xioview_.iostats[(*s).getName()].wbs;
-            xioview_.mountstats[m->second.mountpoint].artm  = xioview_.iostats[(*s).getName()].artm;
-            xioview_.mountstats[m->second.mountpoint].awtm  = xioview_.iostats[(*s).getName()].awtm;
-            xioview_.mountstats[m->second.mountpoint].svctm = xioview_.iostats[(*s).getName()].svctm;
-            xioview_.mountstats[m->second.mountpoint].svctm = xioview_.iostats[(*s).getName()].svctm;
+            xioview_.mountstats[m->second.mountpoint].util  = io.util;
+            xioview_.mountstats[m->second.mountpoint].rs    = io.rs;
+            xioview_.mountstats[m->second.mountpoint].ws    = io.ws;
+            xioview_.mountstats[m->second.mountpoint].rbs   = io.rbs;
+            xioview_.mountstats[m->second.mountpoint].wbs   = io.wbs;
+            xioview_.mountstats[m->second.mountpoint].artm  = io.artm;
+            xioview_.mountstats[m->second.mountpoint].awtm  = io.awtm;
+            xioview_.mountstats[m->second.mountpoint].svctm = io.svctm;
+            xioview_.mountstats[m->second.mountpoint].svctm = io.svctm;
             xioview_.mountstats[m->second.mountpoint].device = m->second.mountpoint;
-            xioview_.mountstats[m->second.mountpoint].growths = ((double)xioview_.fsbytes2[m->second.mountpoint] - (double)xioview_.fsbytes1[m->second.mountpoint])/dt;
+            // the devices beneath the filesystem device, such as the partitions, disks or paths under a logical volume
+            xioview_.mountstats[m->second.mountpoint].paths = 0;
+            xioview_.mountstats[m->second.mountpoint].putil = 0;
+            const std::list<block::MajorMinor> &leaves = topology_.getLeaves( *s );
+            if ( !( leaves.size() == 1 && leaves.front() == *s ) ) {
+              xioview_.mountstats[m->second.mountpoint].paths = leaves.size();
+              block::DeviceStatsMap::const_iterator r = rolled.find( *s );
+              if ( r != rolled.end() && leaves.size() > 0 )
+                xioview_.mountstats[m->second.mountpoint].putil = r->second.io_ms / 1000.0 / dt / leaves.size();
+            }
+            const block::MountUsage &used1 = xioview_.fsbytes1[m->second.mountpoint];
+            const block::MountUsage &used2 = xioview_.fsbytes2[m->second.mountpoint];
+            xioview_.mountstats[m->second.mountpoint].stale = used1.stale || used2.stale;
+            if ( xioview_.mountstats[m->second.mountpoint].stale )
+              xioview_.mountstats[m->second.mountpoint].growths = 0;
+            else
+              xioview_.mountstats[m->second.mountpoint].growths = ((double)used2.used - (double)used1.used)/dt;
             xioview_.mountsorted.push_back(m->second.mountpoint);
           } else {
             //include swap filesystems
@@ -218,22 +285,59 @@ namespace leanux {
                 mi.device = "";
                 mi.fstype = "swap";
                 mi.mountpoint = "swap:" + (*i).devicefile;
-                xioview_.mountstats[mi.mountpoint].util  = xioview_.iostats[(*s).getName()].util;
-                xioview_.mountstats[mi.mountpoint].rs    = xioview_.iostats[(*s).getName()].rs;
-                xioview_.mountstats[mi.mountpoint].ws    = xioview_.iostats[(*s).getName()].ws;
-                xioview_.mountstats[mi.mountpoint].rbs   = xioview_.iostats[(*s).getName()].rbs;
-                xioview_.mountstats[mi.mountpoint].wbs   = xioview_.iostats[(*s).getName()].wbs;
-                xioview_.mountstats[mi.mountpoint].artm  = xioview_.iostats[(*s).getName()].artm;
-                xioview_.mountstats[mi.mountpoint].awtm  = xioview_.iostats[(*s).getName()].awtm;
-                xioview_.mountstats[mi.mountpoint].svctm = xioview_.iostats[(*s).getName()].svctm;
-                xioview_.mountstats[mi.mountpoint].svctm = xioview_.iostats[(*s).getName()].svctm;
+                xioview_.mountstats[mi.mountpoint].util  = io.util;
+                xioview_.mountstats[mi.mountpoint].rs    = io.rs;
+                xioview_.mountstats[mi.mountpoint].ws    = io.ws;
+                xioview_.mountstats[mi.mountpoint].rbs   = io.rbs;
+                xioview_.mountstats[mi.mountpoint].wbs   = io.wbs;
+                xioview_.mountstats[mi.mountpoint].artm  = io.artm;
+                xioview_.mountstats[mi.mountpoint].awtm  = io.awtm;
+                xioview_.mountstats[mi.mountpoint].svctm = io.svctm;
+                xioview_.mountstats[mi.mountpoint].svctm = io.svctm;
                 xioview_.mountstats[mi.mountpoint].device = mi.mountpoint;
+                xioview_.mountstats[mi.mountpoint].paths = 0;
+                xioview_.mountstats[mi.mountpoint].putil = 0;
                 xioview_.mountsorted.push_back(mi.mountpoint);
                 break;
               }
             }
           }
         }
+
+        nfsstats1_ = nfsstats2_;
+        block::getNFSMountStats( nfsstats2_ );
+        block::NFSMountStatsMap nfsdelta;
+        block::deltaNFSMountStats( nfsstats1_, nfsstats2_, nfsdelta );
+        xioview_.nfsstats.clear();
+        xioview_.nfssorted.clear();
+        std::multimap<double,std::string> nfsbyops;
+        for ( block::NFSMountStatsMap::const_iterator m = nfsdelta.begin(); m != nfsdelta.end(); ++m ) {
+          XNFSRec rec;
+          rec.mountpoint = m->first;
+          rec.ops = rec.rs = rec.ws = rec.rbs = rec.wbs = rec.retrans = 0;
+          unsigned long ops = 0, rtt_ms = 0, execute_ms = 0;
+          for ( block::NFSOpStatsMap::const_iterator o = m->second.begin(); o != m->second.end(); ++o ) {
+            ops += o->second.ops;
+            rtt_ms += o->second.rtt_ms;
+            execute_ms += o->second.execute_ms;
+            rec.rbs += o->second.bytes_recv;
+            rec.wbs += o->second.bytes_sent;
+            if ( o->second.trans > o->second.ops ) rec.retrans += o->second.trans - o->second.ops;
+            if ( o->first == "READ" ) rec.rs = o->second.ops / dt;
+            else if ( o->first == "WRITE" ) rec.ws = o->second.ops / dt;
+          }
+          rec.ops = ops / dt;
+          rec.rbs /= dt;
+          rec.wbs /= dt;
+          rec.retrans /= dt;
+          rec.rtt = ops ? rtt_ms / 1000.0 / ops : 0;
+          rec.exe = ops ? execute_ms / 1000.0 / ops : 0;
+          xioview_.nfsstats[m->first] = rec;
+          nfsbyops.insert( std::pair<double,std::string>( -rec.ops, m->first ) );
+        }
+        for ( std::multimap<double,std::string>::const_iterator n = nfsbyops.begin(); n != nfsbyops.end(); ++n ) {
+          xioview_.nfssorted.push_back( n->second );
+        }
         xioview_.sample_count++;
       }
 
@@ -249,7 +353,10 @@ namespace leanux {
         vmem::getVMStat( vmstat2_ );
         vmem::getSwapInfo( swaps_ );
         mounted_bytes_1_ = mounted_bytes_2_;
-        mounted_bytes_2_ = leanux::block::getMountUsedBytes();
+        mounted_bytes_2_ = 0;
+        for ( std::list<std::string>::const_iterator m = mountpoints_.begin(); m != mountpoints_.end(); ++m ) {
+          mounted_bytes_2_ += fsused_[*m].used;
+        }
         xsysview_.cpu_delta.clear();
         leanux::cpu::deltaStats( cpustat1_, cpustat2_, xsysview_.cpu_delta );
         //normalize the cpu_delta to sample interval resulting in CPU seconds/clock second.
@@ -71,6 +71,7 @@ namespace leanux {
           void resetCPUTrail() { xsysview_.cpurtpast.clear(); };
 
         protected:
+          void sampleFSUsage();
           void sampleXSysView( int cpubarheight );
           void sampleXIOView();
           void sampleXNetView();
@@ -107,6 +108,30 @@ namespace leanux {
           /** Later DeviceStatsMap snapshot. */
           block::DeviceStatsMap diskstats2_;
 
+          /** The block device stacking, to roll up statistics to the devices beneath. */
+          block::Topology topology_;
+
+          /** Earlier BDIStatsMap snapshot. */
+          block::BDIStatsMap bdistats1_;
+
+          /** Later BDIStatsMap snapshot. */
+          block::BDIStatsMap bdistats2_;
+
+          /** Earlier NFSMountStatsMap snapshot. */
+          block::NFSMountStatsMap nfsstats1_;
+
+          /** Later NFSMountStatsMap snapshot. */
+          block::NFSMountStatsMap nfsstats2_;
+
+
+          /** Samples filesystem usage without blocking on hung filesystems. */
+          block::MountUsageSampler fsusage_;
+
+          /** Mountpoints as listed by block::enumMountpoints. */
+          std::list<std::string> mountpoints_;
+
+          /** Latest filesystem usage per mountpoint. */
+          block::MountUsageMap fsused_;
 
           unsigned long mounted_bytes_1_;
 
@@ -118,15 +143,42 @@ namespace leanux {
           /** cpu model info */
           cpu::CPUInfo cpuinfo_;
 
-          /** cache of device special files to MajorMinor */
-          static std::map<std::string,block::MajorMinor> devicefilecache_;
-
           /** earlier snap. */
           net::NetStatDeviceMap netsnap1_;
 
           /** later snap. */
           net::NetStatDeviceMap netsnap2_;
 
+          /** network devices excluded by NETVIEW_EXCLUDE. */
+          net::NetDeviceFilter netfilter_;
+
+          /** reads the protocol counters. */
+          net::ProtoStatReader protoreader_;
+
+          /** earlier protocol counters. */
+          net::ProtoStat protosnap1_;
+
+          /** later protocol counters. */
+          net::ProtoStat protosnap2_;
+
+          /** earlier softnet statistics. */
+          net::SoftNetStatMap softnetsnap1_;
+
+          /** later softnet statistics. */
+          net::SoftNetStatMap softnetsnap2_;
+
+          /** earlier transmit queue statistics. */
+          net::NetQueueStatMap queuesnap1_;
+
+          /** later transmit queue statistics. */
+          net::NetQueueStatMap queuesnap2_;
+
+          /** counts TCP connections and samples TCP_INFO of the NETVIEW_TCP_INFO_TOP busiest. */
+          net::TCPConnectionSampler tcpsampler_;
+
+          /** attributes TCP traffic to processes for the ProcessView. */
+          net::ProcessNetSampler procnetsampler_;
+
           /** earlier snap. */
           process::ProcPidStatMap procsnap1_;
 
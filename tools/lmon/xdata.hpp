@@ -87,6 +87,9 @@ namespace leanux {
         std::map<pid_t,std::string> pidargs;
         std::map<pid_t,uid_t> piduids;
 
+        /** TCP bytes/s sent and received by the processes that moved data. */
+        std::map<pid_t,double> pidnet;
+
         bool disabled;
 
       };
@@ -108,10 +111,25 @@ namespace leanux {
         net::NetStatDeviceVector delta;
 
         /** TCP server connections */
-        std::list<net::TCPKeyCounter> tcpserver;
+        net::TCPKeyCounterVector tcpserver;
 
         /** TCP client connections */
-        std::list<net::TCPKeyCounter> tcpclient;
+        net::TCPKeyCounterVector tcpclient;
+
+        /** protocol counter delta over proto_seconds. */
+        net::ProtoStat proto;
+
+        /** the number of seconds covered by proto, 0 if unknown. */
+        double proto_seconds;
+
+        /** per-CPU softnet delta over softnet_seconds, sorted with problem CPUs first. */
+        net::SoftNetStatVector softnet;
+
+        /** transmit queue delta over softnet_seconds, sorted with hot queues first. */
+        net::NetQueueStatVector queues;
+
+        /** the number of seconds covered by softnet and queues, 0 if unknown. */
+        double softnet_seconds;
       };
 
       /**
@@ -132,10 +150,65 @@ namespace leanux {
         double iodone_cnt;
         double iorequest_cnt;
         double ioerr_cnt;
+        /** bytes under writeback. */
+        double wback;
+        /** dirty bytes not yet under writeback. */
+        double reclaim;
+        /** dirty bytes threshold of the backing device, 0 if unknown. */
+        double dthresh;
+        /** bytes dirtied per second. */
+        double dirtieds;
+        /** bytes written back per second. */
+        double writtens;
+        /** discards per second. */
+        double ds;
+        /** bytes discarded per second. */
+        double dbs;
+        /** average discard time in seconds. */
+        double adtm;
+        /** flushes per second. */
+        double fls;
+        /** average flush time in seconds. */
+        double afltm;
+        /** reads in flight at the end of the sample interval. */
+        double rinfl;
+        /** writes in flight at the end of the sample interval. */
+        double winfl;
+        /** number of devices at the bottom of the stack beneath the device, 0 if not stacked. */
+        unsigned int paths;
+        /** average utilization of the devices at the bottom of the stack. */
+        double putil;
+        /** filesystem usage did not answer in time, growths is unknown. */
+        bool stale;
       };
 
       typedef std::map<std::string,XIORec> IORecMap;
 
+      /**
+       * NFS client statistics of a NFS mount in a form suitable for XIOView.
+       */
+      struct XNFSRec {
+        std::string mountpoint;
+        /** operations per second, all operations. */
+        double ops;
+        /** average round trip time per operation. */
+        double rtt;
+        /** READ operations per second. */
+        double rs;
+        /** WRITE operations per second. */
+        double ws;
+        /** bytes received per second, all operations. */
+        double rbs;
+        /** bytes sent per second, all operations. */
+        double wbs;
+        /** average execution time per operation. */
+        double exe;
+        /** retransmissions per second. */
+        double retrans;
+      };
+
+      typedef std::map<std::string,XNFSRec> NFSRecMap;
+
       /**
        * Data record for IOView display
        */
@@ -155,8 +228,12 @@ namespace leanux {
         IORecMap mountstats;
         std::vector<std::string> mountsorted;
 
-        std::map<std::string,unsigned long> fsbytes1;
-        std::map<std::string,unsigned long> fsbytes2;
+        block::MountUsageMap fsbytes1;
+        block::MountUsageMap fsbytes2;
+
+        /** NFS mounts, sorted by ops in nfssorted. */
+        NFSRecMap nfsstats;
+        std::vector<std::string> nfssorted;
       };
 
       /**
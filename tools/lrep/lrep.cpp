@@ -35,6 +35,7 @@
  */
 
 #include <list>
+#include <map>
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -79,6 +80,8 @@ namespace leanux {
       const string timeline_background_color = "backgroundColor: '#E0E0E0'";
       const string timeline_fontsize = "fontSize: 10";
       const long max_chart_pixels = 800;
+      const long max_resolve_prefetch = 256;
+      const unsigned int resolve_wait_ms = 5000;
 
       const double one_gib = 1024.0*1024.0*1024.0;
 
@@ -160,9 +163,9 @@ namespace leanux {
       stringstream jschart;
 
       /**
-       * map of ip's to resolved names to prevent repeated DNS requests
+       * background resolver caching ip's to names, prevents repeated DNS requests
        */
-      map<string,string> resolvemap;
+      net::Resolver resolver;
 
       /**
        * deterministic transform of arbitray strings into valid javascript identifiers
@@ -179,16 +182,62 @@ namespace leanux {
       }
 
       /**
-       * get from cache or DNS request on cache miss
+       * names of the addresses as resolved by prefetchNames, frozen so that the resolver
+       * threads completing after resolve_wait_ms cannot change labels halfway through the report.
+       */
+      map<string,string> resolved_names;
+
+      /**
+       * get the name frozen by prefetchNames, returns the ip itself if it was not resolved in time.
        */
       string resolveCacheIP( const string &ip ) {
-        string r = "";
-        map<string,string>::const_iterator i = resolvemap.find( ip );
-        if ( i == resolvemap.end() ) {
-          r = net::resolveIP( ip );
-          resolvemap[ip] = r;
-        } else r = i->second;
-        return r;
+        map<string,string>::const_iterator r = resolved_names.find( ip );
+        if ( r != resolved_names.end() ) return r->second;
+        return ip;
+      }
+
+      /**
+       * Queue the addresses that will appear in the report to the resolver and wait at
+       * most resolve_wait_ms for the answers, so that slow or dead DNS servers cannot stall
+       * report generation - unresolved addresses are reported as ip. The names known once
+       * the wait is over are copied into resolved_names and used for the rest of the report.
+       */
+      void prefetchNames( const persist::Database &db ) {
+        list<std::string> netdevices;
+        net::enumDevices( netdevices );
+        for ( list<std::string>::const_iterator n = netdevices.begin(); n != netdevices.end(); n++ ) {
+          list<std::string> ip4;
+          net::getDeviceIP4Addresses( *n, ip4 );
+          for ( list<std::string>::const_iterator i = ip4.begin(); i != ip4.end(); i++ ) {
+            resolved_names[*i] = resolver.lookup( *i );
+          }
+        }
+        persist::Query qry( db );
+        qry.prepare( "select ip from (select tcpkey.ip ip, sum(esta) esta from tcpserverstat, tcpkey where tcpserverstat.tcpkey=tcpkey.id and snapshot>=:from and snapshot <=:to group by tcpkey.ip "
+                     " union all select tcpkey.ip ip, sum(esta) esta from tcpclientstat, tcpkey where tcpclientstat.tcpkey=tcpkey.id and snapshot>=:from and snapshot <=:to group by tcpkey.ip) "
+                     " group by ip order by sum(esta) desc limit :limit" );
+        qry.bind( 1, snaprange.snap_min );
+        qry.bind( 2, snaprange.snap_max );
+        qry.bind( 3, max_resolve_prefetch );
+        while ( qry.step() ) {
+          resolved_names[qry.getText(0)] = resolver.lookup( qry.getText(0) );
+        }
+        resolver.wait( resolve_wait_ms );
+        for ( map<string,string>::iterator r = resolved_names.begin(); r != resolved_names.end(); r++ ) {
+          r->second = resolver.lookup( r->first );
+        }
+      }
+
+      /**
+       * test if a table has a column, which is not the case in databases from older lard versions.
+       */
+      bool hasColumn( const persist::Database &db, const string &table, const string &column ) {
+        persist::Query qry( db );
+        qry.prepare( "PRAGMA table_info(" + table + ")" );
+        while ( qry.step() ) {
+          if ( qry.getText(1) == column ) return true;
+        }
+        return false;
       }
 
       /**
@@ -355,11 +404,70 @@ namespace leanux {
         }
       }
 
+      /**
+       * queue depth and utilization histograms from the requests in flight samples (if lard sampled them).
+       * @return true if there is data to chart.
+       */
+      bool chartDiskInflightHisto( const persist::Database &db, const string &qdom, const string &udom, long diskid ) {
+        if ( !hasColumn( db, "iohisto", "q0" ) ) return false;
+        persist::Query qry(db);
+        qry.prepare( "select sum(samples),sum(q0),sum(q1),sum(q2),sum(q3),sum(q4),sum(q5),sum(q6),sum(q7),"
+                     "sum(u0),sum(u1),sum(u2),sum(u3),sum(u4),sum(u5),sum(u6),sum(u7),sum(u8),sum(u9) "
+                     "from iohisto where disk=:disk and snapshot>=:from and snapshot <=:to" );
+        qry.bind( 1, diskid );
+        qry.bind( 2, snaprange.snap_min );
+        qry.bind( 3, snaprange.snap_max );
+        if ( !qry.step() || qry.getLong(0) == 0 ) return false;
+        stringstream ss;
+        ss << "disk" << diskid;
+        double samples = qry.getLong(0);
+        stringstream js;
+        js << "var " << qdom << "_data = google.visualization.arrayToDataTable([" << endl;
+        js << "['queue depth', '% of samples' ]";
+        for ( unsigned int b = 0; b < block::inflight_depth_buckets; b++ ) {
+          unsigned long low = block::InflightSampler::depthBucketLow( b );
+          js << "," << endl << "[ '";
+          if ( b == block::inflight_depth_buckets - 1 ) js << ">" << low - 1;
+          else if ( block::InflightSampler::depthBucketLow( b + 1 ) - 1 > low ) js << low << "-" << block::InflightSampler::depthBucketLow( b + 1 ) - 1;
+          else js << low;
+          js << "', " << qry.getLong( 1 + b ) / samples * 100.0 << " ]";
+        }
+        js << "]);" << endl;
+        js << "var " << qdom << "_options = {" << endl;
+        js << "title: '" << ss.str() << " queue depth histogram'," << endl;
+        js << timeline_background_color << ", " << endl;
+        js << "legend: {position: 'none' }," << endl;
+        js << "fontSize: 10," << endl;
+        js << "hAxis: { title: 'requests in flight', baselineColor: 'transparent' }," << endl;
+        js << "vAxis: { title: '% of samples' }" << endl;
+        js << "};" << endl;
+        js << "var " << qdom << " = new google.visualization.ColumnChart(document.getElementById('" << qdom << "'));" << endl;
+        js << qdom << ".draw(" << qdom << "_data, " << qdom << "_options);" << endl;
+
+        js << "var " << udom << "_data = google.visualization.arrayToDataTable([" << endl;
+        js << "['util', 'seconds' ]";
+        for ( unsigned int b = 0; b < block::inflight_util_buckets; b++ ) {
+          js << "," << endl << "[ '" << b * 10 << "-" << (b + 1) * 10 << "%', " << qry.getLong( 1 + block::inflight_depth_buckets + b ) << " ]";
+        }
+        js << "]);" << endl;
+        js << "var " << udom << "_options = {" << endl;
+        js << "title: '" << ss.str() << " per second utilization histogram'," << endl;
+        js << timeline_background_color << ", " << endl;
+        js << "legend: {position: 'none' }," << endl;
+        js << "fontSize: 10," << endl;
+        js << "hAxis: { title: 'utilization', baselineColor: 'transparent' }," << endl;
+        js << "vAxis: { title: 'seconds' }" << endl;
+        js << "};" << endl;
+        js << "var " << udom << " = new google.visualization.ColumnChart(document.getElementById('" << udom << "'));" << endl;
+        js << udom << ".draw(" << udom << "_data, " << udom << "_options);" << endl;
+
+        jschart << js.str();
+        return true;
+      }
 
       void htmlDiskHolderTreeLine( const persist::Database &db,
+                                  const block::Topology &topology,
                                   const block::MajorMinor &mm, unsigned int level ) {
-        std::list<std::string> holders;
-        std::list<std::string> parts;
         std::string devname = block::MajorMinor::getNameByMajorMinor( mm );
         std::stringstream ss;
         for ( unsigned int i = 0; i < level; i++ ) ss << "&nbsp;";
@@ -370,21 +478,26 @@ namespace leanux {
         html << "<td>" << ss.str() << "</td>" << endl;
         html << "<td>" << mm.getClassStr() << "</td>" << endl;
         html << "<td>" << util::ByteStr( mm.getSize(), 3 ) << "</td>" << endl;
+        // the devices at the bottom of the stack the I/O on this device lands on
+        ss.str("");
+        const std::list<block::MajorMinor> &leaves = topology.getLeaves( mm );
+        for ( std::list<block::MajorMinor>::const_iterator l = leaves.begin(); l != leaves.end(); l++ ) {
+          if ( *l == mm ) continue;
+          if ( ss.str().length() > 0 ) ss << " ";
+          ss << l->getName();
+        }
+        html << "<td>" << ss.str() << "</td>" << endl;
         html << "<td>" << mm.getDescription() << "</td></tr>" << endl;
 
-
-        mm.getPartitions( parts );
-        mm.getHolders( holders );
-        for ( std::list<std::string>::const_iterator d = holders.begin(); d != holders.end(); d++ ) {
-          htmlDiskHolderTreeLine( db, block::MajorMinor::getMajorMinorByName( (*d) ), level+1 );
-        }
-        for ( std::list<std::string>::const_iterator d = parts.begin(); d != parts.end(); d++ ) {
-          htmlDiskHolderTreeLine( db, block::MajorMinor::getMajorMinorByName( (*d) ), level+1 );
+        const std::list<block::MajorMinor> &holders = topology.getHolders( mm );
+        for ( std::list<block::MajorMinor>::const_iterator d = holders.begin(); d != holders.end(); d++ ) {
+          htmlDiskHolderTreeLine( db, topology, *d, level+1 );
         }
       }
 
       void htmlDiskHolderTree( const persist::Database &db,
                                const block::MajorMinor &mm ) {
+        block::Topology topology;
         html << "<table class=\"datatable\">" << endl;
         html << "<caption>" << mm.getName() << " holder tree</caption>" << endl;
         html << "<tr>" << endl;
@@ -392,9 +505,10 @@ namespace leanux {
         html << "<th>dev_t</th>" << endl;
         html << "<th>class</th>" << endl;
         html << "<th>size</th>" << endl;
+        html << "<th>lower devices</th>" << endl;
         html << "<th>description</th></tr>" << endl;
 
-        htmlDiskHolderTreeLine( db, mm, 0 );
+        htmlDiskHolderTreeLine( db, topology, mm, 0 );
 
         html << "</table>" << endl;
 
@@ -422,6 +536,15 @@ namespace leanux {
         chartDiskScvHisto( db, ss.str(), diskid, bucket );
         html << "<br/><div class=\"chart\" id='" << ss.str() << "' style='width: " << 600 << "px; height: " << 200 << "px;'></div>" << endl;
 
+        stringstream qdom;
+        qdom << "disk" << diskid << "_queue_histo";
+        stringstream udom;
+        udom << "disk" << diskid << "_util_histo";
+        if ( chartDiskInflightHisto( db, qdom.str(), udom.str(), diskid ) ) {
+          html << "<br/><div class=\"chart\" id='" << qdom.str() << "' style='width: " << 600 << "px; height: " << 200 << "px;'></div>" << endl;
+          html << "<br/><div class=\"chart\" id='" << udom.str() << "' style='width: " << 600 << "px; height: " << 200 << "px;'></div>" << endl;
+        }
+
         ss.str("");
         ss << "disk" << diskid << "_rsz_histo";
         chartDiskRSZHisto( db, ss.str(), diskid );
@@ -528,6 +651,35 @@ namespace leanux {
             }
             html << "</table>" << endl;
 
+            if ( hasColumn( db, "iostat", "ds" ) ) {
+              persist::Query extstats(db);
+              extstats.prepare( "select min(ds),min(dbs),min(adtm),min(fls),min(afltm),min(rinfl),min(winfl),"
+                                "max(ds),max(dbs),max(adtm),max(fls),max(afltm),max(rinfl),max(winfl),"
+                                "sum(ds)/cnt.num,sum(dbs)/cnt.num,avg(adtm),sum(fls)/cnt.num,avg(afltm),avg(rinfl),avg(winfl) "
+                                "from iostat, (select count(1) num from snapshot where id>=:from and id <=:to) cnt where disk=:disk and iostat.snapshot>=:from and iostat.snapshot <=:to" );
+              extstats.bind( 1, snaprange.snap_min );
+              extstats.bind( 2, snaprange.snap_max );
+              extstats.bind( 3, qry.getInt(0) );
+              html << "<table class=\"datatable\">" << endl;
+              html << "<caption>disk" << qry.getText(0) << " discards, flushes and in flight</caption>" << endl;
+              html << "<tr><th></th><th>discard/s</th><th>discard bytes/s</th><th>discard time (ms)</th><th>flush/s</th><th>flush time (ms)</th><th>reads in flight</th><th>writes in flight</th></tr>" << endl;
+              if ( extstats.step() ) {
+                const char* rows[] = { "min", "max", "avg" };
+                for ( int r = 0; r < 3; r++ ) {
+                  html << "<tr><th class='right'>" << rows[r] << "</th>" <<
+                    "<td>" << util::NumStr( extstats.getDouble(r*7), 3 ) << "</td>" <<
+                    "<td>" << util::ByteStr( extstats.getDouble(r*7+1), 3 ) << "</td>" <<
+                    "<td>" << util::NumStr( extstats.getDouble(r*7+2)*1000.0, 3 ) << "</td>" <<
+                    "<td>" << util::NumStr( extstats.getDouble(r*7+3), 3 ) << "</td>" <<
+                    "<td>" << util::NumStr( extstats.getDouble(r*7+4)*1000.0, 3 ) << "</td>" <<
+                    "<td>" << util::NumStr( extstats.getDouble(r*7+5), 3 ) << "</td>" <<
+                    "<td>" << util::NumStr( extstats.getDouble(r*7+6), 3 ) << "</td>" <<
+                    "</tr>" << endl;
+                }
+              }
+              html << "</table>" << endl;
+            }
+
             for ( std::multimap<std::string,block::MajorMinor>::const_iterator r = range.first; r != range.second; r++ ) {
               html << "<table class=\"datatable\">" << endl;
               html << "<caption>disk" << qry.getText(0) << " sysfs</caption>" << endl;
@@ -1118,6 +1270,52 @@ namespace leanux {
         return ss.str();
       }
 
+      /**
+       * Table of the TCP_INFO sampled from the busiest connections, per (ip,port) in the tcpserverstat
+       * or tcpclientstat table, ordered by descending 95th percentile round trip time.
+       */
+      string tableTCPPerformance( const persist::Database &db, const string &table, const string &caption ) {
+        stringstream ss;
+        if ( !hasColumn( db, table, "infoconns" ) ) return ss.str();
+        persist::Query qry(db);
+        qry.prepare( "select tcpkey.ip, tcpkey.port, sum(infoconns), avg(rttp50), avg(rttp95), avg(rttvarp50), avg(cwndp50), "
+                     "avg(dlvratep50), avg(retrans), sum(busy), sum(rwndlim), sum(sndbuflim) from " + table + ", tcpkey "
+                     "where " + table + ".tcpkey=tcpkey.id and infoconns>0 and snapshot>=:from and snapshot <=:to "
+                     "group by tcpkey.ip, tcpkey.port order by avg(rttp95) desc limit 10;" );
+        qry.bind( 1, snaprange.snap_min );
+        qry.bind( 2, snaprange.snap_max );
+        int iter = 0;
+        while ( qry.step() ) {
+          if ( iter == 0 ) {
+            ss << "<table class=\"datatable\">" << endl;
+            ss << "<caption>" << caption << "</caption>" << endl;
+            ss << "<tr><th>address</th><th>port</th><th title=\"connections sampled over all snapshots\">sampled</th>"
+                  "<th>rtt p50 (ms)</th><th>rtt p95 (ms)</th><th>rttvar p50 (ms)</th><th>cwnd p50</th>"
+                  "<th>delivery rate/s</th><th>retrans/s</th>"
+                  "<th title=\"percentage of busy time limited by the receive window\">rwnd limited %</th>"
+                  "<th title=\"percentage of busy time limited by the send buffer\">sndbuf limited %</th></tr>" << endl;
+          }
+          string dns = options.noresolv?qry.getText(0):resolveCacheIP( qry.getText(0) );
+          string netservicename = net::getServiceName( qry.getInt(1) );
+          double busy = qry.getDouble(9);
+          ss << "<tr><td>" << dns << "</td>" <<
+            "<td>" << qry.getText(1) << ( netservicename != "" && netservicename != qry.getText(1) ? " (" + netservicename + ")" : "" ) << "</td>" <<
+            "<td>" << qry.getLong(2) << "</td>" <<
+            "<td>" << util::NumStr( qry.getDouble(3)*1000.0, 3 ) << "</td>" <<
+            "<td>" << util::NumStr( qry.getDouble(4)*1000.0, 3 ) << "</td>" <<
+            "<td>" << util::NumStr( qry.getDouble(5)*1000.0, 3 ) << "</td>" <<
+            "<td>" << util::NumStr( qry.getDouble(6), 1 ) << "</td>" <<
+            "<td>" << util::ByteStr( qry.getDouble(7), 3 ) << "</td>" <<
+            "<td>" << util::NumStr( qry.getDouble(8), 3 ) << "</td>" <<
+            "<td>" << util::NumStr( busy > 0 ? qry.getDouble(10)/busy*100.0 : 0.0, 1 ) << "</td>" <<
+            "<td>" << util::NumStr( busy > 0 ? qry.getDouble(11)/busy*100.0 : 0.0, 1 ) << "</td>" <<
+            "</tr>" << endl;
+          iter++;
+        }
+        if ( iter ) ss << "</table>" << endl;
+        return ss.str();
+      }
+
       string chartTCPClientAverage( const persist::Database &db, const string &dom ) {
         stringstream js;
         persist::Query qry(db);
@@ -1441,9 +1639,11 @@ namespace leanux {
 
         html << "<a class=\"anchor\" id=\"reportaverage_tcpserver\"></a><h2>TCP server</h2>" << endl;
         html << chartTCPServerAverage( db, "global_tcpserver" );
+        html << tableTCPPerformance( db, "tcpserverstat", "TCP server performance of the busiest connections" );
 
         html << "<a class=\"anchor\" id=\"reportaverage_tcpclient\"></a><h2>TCP client</h2>" << endl;
         html << chartTCPClientAverage( db, "global_tcpclient" );
+        html << tableTCPPerformance( db, "tcpclientstat", "TCP client performance of the busiest connections" );
       }
 
       void chartCPUTimeLine( const persist::Database &db, const string &dom ) {
@@ -2765,6 +2965,120 @@ namespace leanux {
         os << "</div>" << endl;
       }
 
+      /**
+       * A protostat column and its label in a protocol timeline.
+       */
+      struct ProtoSeries {
+        const char *column;
+        const char *label;
+      };
+
+      /**
+       * Chart a timeline of protostat columns, one line per column.
+       */
+      void chartProtoTimeLine( const persist::Database &db, const string &dom, const string &title, const ProtoSeries *series, size_t count ) {
+        stringstream js;
+        stringstream sql;
+        sql << "select avg(snapshot.istop)";
+        for ( size_t i = 0; i < count; i++ ) sql << ", avg(" << series[i].column << ")";
+        sql << " from snapshot, protostat where snapshot.id=protostat.snapshot and snapshot.id>=:from and snapshot.id <=:to group by snapshot.istop/:bucket order by 1;";
+        persist::Query qry(db);
+        qry.prepare( sql.str() );
+        qry.bind( 1, snaprange.snap_min );
+        qry.bind( 2, snaprange.snap_max );
+        qry.bind( 3, snaprange.timeline_bucket );
+        int iter = 0;
+        while ( qry.step() ) {
+          if ( iter == 0 ) {
+            js << "var " << dom << "_data = google.visualization.arrayToDataTable([" << endl;
+            js << "['datetime'";
+            for ( size_t i = 0; i < count; i++ ) js << ", '" << series[i].label << "'";
+            js << " ]," << endl;
+          } else {
+            js << ",";
+          }
+          time_t istop = qry.getDouble(0);
+          struct tm *lt = localtime( &istop );
+          js << "[ new Date( " << lt->tm_year + 1900 << ", " << lt->tm_mon << ", " << lt->tm_mday << ", " << lt->tm_hour << ", " << lt->tm_min << ", " << lt->tm_sec << ", 0.0 )";
+          for ( size_t i = 0; i < count; i++ ) js << ", " << qry.getDouble( i + 1 );
+          js << " ]" << endl;
+          iter++;
+        }
+        if ( iter == 0 ) return;
+        js << "]);" << endl;
+        js << "var " << dom << "_options = {" << endl;
+        js << "title: '" << title << "'," << endl;
+        js << timeline_background_color << ", " << endl;
+        js << "lineWidth: 1," << endl;
+        js << timeline_legend << "," << endl;
+        js << timeline_fontsize << "," << endl;
+        js << timeline_chartarea << ", " << endl;
+        js << "};" << endl;
+        js << "var " << dom << " = new google.visualization.LineChart(document.getElementById('" << dom << "'));" << endl;
+        js << dom << ".draw(" << dom << "_data, " << dom << "_options);" << endl;
+
+        jschart << js.str();
+      }
+
+      /**
+       * The protocol counter timelines, skipped for databases from lard versions without protostat.
+       */
+      void htmlProtoTimeLines( const persist::Database &db ) {
+        if ( !hasColumn( db, "protostat", "snapshot" ) ) return;
+        const ProtoSeries tcpsegs[] = {
+          { "tcpinsegs", "in" },
+          { "tcpoutsegs", "out" },
+          { "tcpretrans", "retransmitted" }
+        };
+        const ProtoSeries tcpconns[] = {
+          { "tcpactopen", "active opens" },
+          { "tcppasopen", "passive opens" },
+          { "tcpattfail", "failed attempts" },
+          { "tcpestrst", "established resets" },
+          { "tcpoutrsts", "resets sent" }
+        };
+        const ProtoSeries tcpdrops[] = {
+          { "tcplstovf", "listen overflows" },
+          { "tcplstdrop", "listen drops" },
+          { "tcpreqqdrop", "SYN queue drops" },
+          { "tcpsynretr", "SYN retransmits" },
+          { "tcptimeout", "timeouts" },
+          { "tcpmempress", "memory pressure" },
+          { "tcpmemabort", "memory aborts" },
+          { "tcpprune", "prunes" },
+          { "tcpbacklogdrop", "backlog drops" }
+        };
+        const ProtoSeries udpdgrams[] = {
+          { "udpindgrams", "in" },
+          { "udpoutdgrams", "out" }
+        };
+        const ProtoSeries udperrs[] = {
+          { "udpnoports", "no port" },
+          { "udpinerrs", "receive errors" },
+          { "udprcvbuferrs", "receive buffer errors" },
+          { "udpsndbuferrs", "send buffer errors" }
+        };
+        const ProtoSeries iperrs[] = {
+          { "ipindisc", "in discards" },
+          { "ipoutdisc", "out discards" },
+          { "ipnoroute", "no route" },
+          { "ipreasmfail", "reassembly failures" }
+        };
+        html << "<a class=\"anchor\" id=\"timeline_proto\"></a><h2>Protocols</h2>" << endl;
+        chartProtoTimeLine( db, "tcpsegstimeline", "TCP segments per second", tcpsegs, sizeof(tcpsegs)/sizeof(ProtoSeries) );
+        htmlTimeLine( html, "tcpsegstimeline", "TCP segments per second timeline" );
+        chartProtoTimeLine( db, "tcpconnstimeline", "TCP connection events per second", tcpconns, sizeof(tcpconns)/sizeof(ProtoSeries) );
+        htmlTimeLine( html, "tcpconnstimeline", "TCP connection events per second timeline" );
+        chartProtoTimeLine( db, "tcpdropstimeline", "TCP drops, retransmits and memory pressure per second", tcpdrops, sizeof(tcpdrops)/sizeof(ProtoSeries) );
+        htmlTimeLine( html, "tcpdropstimeline", "TCP drops, retransmits and memory pressure per second timeline" );
+        chartProtoTimeLine( db, "udpdgramstimeline", "UDP datagrams per second", udpdgrams, sizeof(udpdgrams)/sizeof(ProtoSeries) );
+        htmlTimeLine( html, "udpdgramstimeline", "UDP datagrams per second timeline" );
+        chartProtoTimeLine( db, "udperrstimeline", "UDP errors per second", udperrs, sizeof(udperrs)/sizeof(ProtoSeries) );
+        htmlTimeLine( html, "udperrstimeline", "UDP errors per second timeline" );
+        chartProtoTimeLine( db, "iperrstimeline", "IP discards and errors per second", iperrs, sizeof(iperrs)/sizeof(ProtoSeries) );
+        htmlTimeLine( html, "iperrstimeline", "IP discards and errors per second timeline" );
+      }
+
       void htmlTimeLines( const persist::Database &db ) {
         html << "<a class=\"anchor\" id=\"timelines\"></a><h1>Timelines</h1>" << endl;
         html << "<p>Each datapoint in the below charts is an average over " << util::TimeStrSec( snaprange.timeline_bucket ) << ".</p>" << endl;
@@ -2842,6 +3156,8 @@ namespace leanux {
         htmlTimeLine( html, "nicrxbwtimeline", "NIC receive bandwidth timeline" );
         htmlTimeLine( html, "nictxbwtimeline", "NIC transmit bandwidth timeline" );
 
+        htmlProtoTimeLines( db );
+
         html << "<a class=\"anchor\" id=\"timeline_tcpserver\"></a><h2>TCP server</h2>" << endl;
         chartTCPServerTimeLine( db, "tcpservertimeline" );
         htmlTimeLine( html, "tcpservertimeline", "TCP server timeline" );
@@ -3278,6 +3594,14 @@ namespace leanux {
                 sw2.stop();
                 cout <<  setprecision(3) << sw2.getElapsedSeconds() << "s" << endl << flush;
 
+                if ( !options.noresolv ) {
+                  cout << "resolve names .. " << flush;
+                  sw2.start();
+                  prefetchNames( db );
+                  sw2.stop();
+                  cout <<  setprecision(3) << sw2.getElapsedSeconds() << "s" << endl << flush;
+                }
+
                 cout << "snapshot details .. " << flush;
                 sw2.start();
                 htmlSnapDetails( db );
@@ -3375,6 +3699,7 @@ namespace leanux {
                 doc << "<a href=\"#timeline_disk\">Disks</a>" << endl;
                 doc << "<a href=\"#timeline_mount\">Mountpoints</a>" << endl;
                 doc << "<a href=\"#timeline_nic\">NICs</a>" << endl;
+                if ( hasColumn( db, "protostat", "snapshot" ) ) doc << "<a href=\"#timeline_proto\">Protocols</a>" << endl;
                 doc << "<a href=\"#timeline_tcpserver\">TCP server</a>" << endl;
                 doc << "<a href=\"#timeline_tcpclient\">TCP client</a>" << endl;
                 doc << "</div>" << endl;